@@ -0,0 +1,279 @@
+#include "OSMChangeFile.h"
+#include "OSMXmlReader.h"
+
+#define LOCTEXT_NAMESPACE "StreetMapImporting"
+
+namespace OSMChangeFile
+{
+	/** Turns the elements of an OpenStreetMap change file into changed nodes and ways */
+	class FChangeParser : public IOSMXmlCallback
+	{
+
+	public:
+
+		FChangeParser( FOSMChangeFile& InChangeFile )
+			: ChangeFile( InChangeFile ),
+			  ParsingState( EParsingState::Document ),
+			  Action( EChangeAction::Modify ),
+			  CurrentNodeID( 0 ),
+			  CurrentWayID( 0 ),
+			  CurrentWayIndex( INDEX_NONE ),
+			  CurrentWayTagKey()
+		{
+		}
+
+		// IOSMXmlCallback overrides
+		virtual bool ProcessElement( const FAnsiStringView ElementName ) override
+		{
+			if( ParsingState == EParsingState::Document )
+			{
+				// Regular map files would parse fine too, but applying one as a change would throw away most of the map
+				if( !ElementName.Equals( ANSITEXTVIEW( "osmChange" ) ) )
+				{
+					return false;
+				}
+				ParsingState = EParsingState::Root;
+			}
+			else if( ParsingState == EParsingState::Root )
+			{
+				if( ElementName.Equals( ANSITEXTVIEW( "create" ) ) )
+				{
+					Action = EChangeAction::Create;
+					ParsingState = EParsingState::Action;
+				}
+				else if( ElementName.Equals( ANSITEXTVIEW( "modify" ) ) )
+				{
+					Action = EChangeAction::Modify;
+					ParsingState = EParsingState::Action;
+				}
+				else if( ElementName.Equals( ANSITEXTVIEW( "delete" ) ) )
+				{
+					Action = EChangeAction::Delete;
+					ParsingState = EParsingState::Action;
+				}
+			}
+			else if( ParsingState == EParsingState::Action )
+			{
+				if( ElementName.Equals( ANSITEXTVIEW( "node" ) ) )
+				{
+					ParsingState = EParsingState::Node;
+					CurrentNodeID = 0;
+					CurrentNode = FOSMChangeFile::FOSMChangedNode();
+				}
+				else if( ElementName.Equals( ANSITEXTVIEW( "way" ) ) )
+				{
+					ParsingState = EParsingState::Way;
+					CurrentWayID = 0;
+
+					// Deleted ways may still list their nodes and tags, but we don't need them
+					if( Action != EChangeAction::Delete )
+					{
+						CurrentWayIndex = ChangeFile.Batch.Ways.Num();
+						ChangeFile.Batch.AddWay();
+					}
+				}
+			}
+			else if( ParsingState == EParsingState::Way && CurrentWayIndex != INDEX_NONE )
+			{
+				if( ElementName.Equals( ANSITEXTVIEW( "nd" ) ) )
+				{
+					ParsingState = EParsingState::Way_NodeRef;
+				}
+				else if( ElementName.Equals( ANSITEXTVIEW( "tag" ) ) )
+				{
+					ParsingState = EParsingState::Way_Tag;
+				}
+			}
+
+			return true;
+		}
+
+		virtual bool ProcessAttribute( const FAnsiStringView AttributeName, const FAnsiStringView AttributeValue ) override
+		{
+			if( ParsingState == EParsingState::Node )
+			{
+				if( AttributeName.Equals( ANSITEXTVIEW( "id" ) ) )
+				{
+					CurrentNodeID = FOSMXmlReader::ParseInt64( AttributeValue );
+				}
+				else if( AttributeName.Equals( ANSITEXTVIEW( "lat" ) ) )
+				{
+					CurrentNode.Latitude = FOSMXmlReader::ParseDouble( AttributeValue );
+				}
+				else if( AttributeName.Equals( ANSITEXTVIEW( "lon" ) ) )
+				{
+					CurrentNode.Longitude = FOSMXmlReader::ParseDouble( AttributeValue );
+				}
+			}
+			else if( ParsingState == EParsingState::Way )
+			{
+				if( AttributeName.Equals( ANSITEXTVIEW( "id" ) ) )
+				{
+					CurrentWayID = FOSMXmlReader::ParseInt64( AttributeValue );
+					if( CurrentWayIndex != INDEX_NONE )
+					{
+						ChangeFile.Batch.Ways[ CurrentWayIndex ].ID = CurrentWayID;
+					}
+				}
+			}
+			else if( ParsingState == EParsingState::Way_NodeRef )
+			{
+				if( AttributeName.Equals( ANSITEXTVIEW( "ref" ) ) )
+				{
+					ChangeFile.Batch.AddWayNodeID( FOSMXmlReader::ParseInt64( AttributeValue ) );
+				}
+			}
+			else if( ParsingState == EParsingState::Way_Tag )
+			{
+				if( AttributeName.Equals( ANSITEXTVIEW( "k" ) ) )
+				{
+					CurrentWayTagKey = AttributeValue;
+				}
+				else if( AttributeName.Equals( ANSITEXTVIEW( "v" ) ) )
+				{
+					const bool bIsXmlEscaped = true;
+					ChangeFile.Batch.ApplyWayTag( ChangeFile.TagClassifier, ChangeFile.Batch.Ways[ CurrentWayIndex ], CurrentWayTagKey, AttributeValue, bIsXmlEscaped );
+				}
+			}
+
+			return true;
+		}
+
+		virtual bool ProcessClose( const FAnsiStringView ElementName ) override
+		{
+			if( ParsingState == EParsingState::Node )
+			{
+				// Nodes may have tags of their own, which we skip over
+				if( ElementName.Equals( ANSITEXTVIEW( "node" ) ) )
+				{
+					// Nodes that moved out of the area we import are as good as gone
+					CurrentNode.bIsDeleted = Action == EChangeAction::Delete || !ChangeFile.ClipRegion.Contains( CurrentNode.Latitude, CurrentNode.Longitude );
+					ChangeFile.ChangedNodes.Add( CurrentNodeID, CurrentNode );
+					ParsingState = EParsingState::Action;
+				}
+			}
+			else if( ParsingState == EParsingState::Way )
+			{
+				if( ElementName.Equals( ANSITEXTVIEW( "way" ) ) )
+				{
+					ChangeFile.ChangedWayIDs.Add( CurrentWayID );
+
+					// Ways that the tag rules don't keep are removed from the batch again, just like in a full import
+					const int32 WayCountBefore = ChangeFile.Batch.Ways.Num();
+					if( CurrentWayIndex != INDEX_NONE )
+					{
+						ChangeFile.Batch.FinishWay( ChangeFile.TagClassifier );
+					}
+					if( CurrentWayIndex != INDEX_NONE && ChangeFile.Batch.Ways.Num() == WayCountBefore )
+					{
+						ChangeFile.LatestWayIndices.Add( CurrentWayID, CurrentWayIndex );
+					}
+					else
+					{
+						ChangeFile.LatestWayIndices.Remove( CurrentWayID );
+					}
+					CurrentWayIndex = INDEX_NONE;
+
+					ParsingState = EParsingState::Action;
+				}
+			}
+			else if( ParsingState == EParsingState::Way_NodeRef )
+			{
+				ParsingState = EParsingState::Way;
+			}
+			else if( ParsingState == EParsingState::Way_Tag )
+			{
+				CurrentWayTagKey.Reset();
+				ParsingState = EParsingState::Way;
+			}
+			else if( ParsingState == EParsingState::Action )
+			{
+				// Relations are skipped over, so the only thing that can close here is the action itself
+				if( ElementName.Equals( ANSITEXTVIEW( "create" ) ) || ElementName.Equals( ANSITEXTVIEW( "modify" ) ) || ElementName.Equals( ANSITEXTVIEW( "delete" ) ) )
+				{
+					ParsingState = EParsingState::Root;
+				}
+			}
+
+			return true;
+		}
+
+		/** Returns true if we found the osmChange root element */
+		bool FoundRoot() const
+		{
+			return ParsingState != EParsingState::Document;
+		}
+
+	private:
+
+		enum class EParsingState
+		{
+			Document,
+			Root,
+			Action,
+			Node,
+			Way,
+			Way_NodeRef,
+			Way_Tag
+		};
+
+		enum class EChangeAction
+		{
+			Create,
+			Modify,
+			Delete
+		};
+
+		// The change file we're filling in
+		FOSMChangeFile& ChangeFile;
+
+		// Current state of parser
+		EParsingState ParsingState;
+
+		// What happened to the elements in the current section
+		EChangeAction Action;
+
+		// Node that is currently being parsed
+		int64 CurrentNodeID;
+		FOSMChangeFile::FOSMChangedNode CurrentNode;
+
+		// Way that is currently being parsed, and its index in the batch (or INDEX_NONE if it's being deleted)
+		int64 CurrentWayID;
+		int32 CurrentWayIndex;
+
+		// Current way's tag key string.  Points directly into the buffer we're parsing.
+		FAnsiStringView CurrentWayTagKey;
+	};
+}
+
+
+FOSMChangeFile::FOSMChangeFile( const FStreetMapImportSettings& ImportSettings )
+	: TagClassifier( ImportSettings ),
+	  ClipRegion( ImportSettings )
+{
+}
+
+
+bool FOSMChangeFile::LoadOpenStreetMapChangeFile( const TArrayView64<const uint8> Buffer, FText& OutErrorMessage )
+{
+	using namespace OSMChangeFile;
+
+	FChangeParser Parser( *this );
+	int64 ErrorLineNumber = 0;
+	FText ErrorMessage;
+	const bool bParsed = FOSMXmlReader::Parse( Buffer, Parser, []( const int64 BytesProcessed ) { return true; }, /* Out */ ErrorMessage, /* Out */ ErrorLineNumber );
+	if( !Parser.FoundRoot() )
+	{
+		OutErrorMessage = LOCTEXT( "ChangeFile_NotAChangeFile", "This isn't an OpenStreetMap change file (it has no osmChange element.)" );
+		return false;
+	}
+	if( !bParsed )
+	{
+		OutErrorMessage = FText::Format( LOCTEXT( "ChangeFile_XmlError", "{0} (line {1})" ), ErrorMessage, FText::AsNumber( ErrorLineNumber ) );
+		return false;
+	}
+
+	return true;
+}
+
+#undef LOCTEXT_NAMESPACE
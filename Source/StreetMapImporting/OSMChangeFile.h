@@ -0,0 +1,61 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "OSMFile.h"
+
+/** Loads an OpenStreetMap change file (.osc), which describes the nodes and ways that were created, modified or
+    deleted between two versions of the map.  Only the latest state of each node and way is kept.  Ways are classified
+    with the same tag rules as a full import, so ways that the import settings would skip are never kept. */
+class FOSMChangeFile
+{
+
+public:
+
+	/** Creates a change file loader that reads the file as described by the specified settings */
+	FOSMChangeFile( const FStreetMapImportSettings& ImportSettings );
+
+	/** Loads the changes from the contents of an OpenStreetMap change file.  The buffer is tokenized in place, so it
+	    must stay valid until loading has finished. */
+	bool LoadOpenStreetMapChangeFile( const TArrayView64<const uint8> Buffer, FText& OutErrorMessage );
+
+	/** Returns a string from the string pool */
+	FString GetString( const FOSMFile::FOSMStringRef& String ) const
+	{
+		return FString( String.Length, Batch.StringPool.GetData() + String.Offset );
+	}
+
+	/** Returns the IDs of the nodes along the specified way */
+	TArrayView<const int64> GetWayNodeIDs( const FOSMFile::FOSMWayInfo& Way ) const
+	{
+		return TArrayView<const int64>( Batch.WayNodeIDs.GetData() + Way.FirstNodeIndex, Way.NodeCount );
+	}
+
+
+	/** The latest state of a node that was created, modified or deleted */
+	struct FOSMChangedNode
+	{
+		double Latitude = 0.0;
+		double Longitude = 0.0;
+
+		// True if the node was deleted, or moved outside of the area we import
+		bool bIsDeleted = false;
+	};
+
+	// Tag rules, compiled from the import settings
+	const FOSMTagClassifier TagClassifier;
+
+	// Area of the map to import
+	const FOSMClipRegion ClipRegion;
+
+	// Every node that was created, modified or deleted, by ID
+	TMap<int64, FOSMChangedNode> ChangedNodes;
+
+	// IDs of every way that was created, modified or deleted, whether we keep it or not
+	TSet<int64> ChangedWayIDs;
+
+	// Ways that were created or modified and that the tag rules keep.  If a way changed more than once, earlier
+	// versions are still in here, so use LatestWayIndices to find the ones that count.
+	FOSMFile::FOSMBatch Batch;
+
+	// Index of the latest version of each way in the batch.  Ways that were deleted in the end aren't in here.
+	TMap<int64, int32> LatestWayIndices;
+};
@@ -0,0 +1,126 @@
+#include "OSMClipRegion.h"
+
+namespace OSMClipRegion
+{
+	// Most polygons are drawn by hand and have few vertices, but they may also be traced from an administrative
+	// boundary with many thousands.  We don't need more bands than that.
+	static const int32 MaxBandCount = 1024;
+}
+
+
+FOSMClipRegion::FOSMClipRegion( const FStreetMapImportSettings& ImportSettings )
+	: bIsEnabled( ImportSettings.bClipToBounds ),
+	  MinLatitude( ImportSettings.ClipMinLatitude ),
+	  MaxLatitude( ImportSettings.ClipMaxLatitude ),
+	  MinLongitude( ImportSettings.ClipMinLongitude ),
+	  MaxLongitude( ImportSettings.ClipMaxLongitude ),
+	  BandMinLatitude( 0.0 ),
+	  BandHeight( 0.0 )
+{
+	using namespace OSMClipRegion;
+
+	// Polygons need at least three points, anything less is ignored
+	const TArray<FVector2D>& Polygon = ImportSettings.ClipPolygon;
+	if( !bIsEnabled || Polygon.Num() < 3 )
+	{
+		return;
+	}
+
+	// Points store longitude in X and latitude in Y
+	double PolygonMinLatitude = TNumericLimits<double>::Max();
+	double PolygonMaxLatitude = TNumericLimits<double>::Lowest();
+	double PolygonMinLongitude = TNumericLimits<double>::Max();
+	double PolygonMaxLongitude = TNumericLimits<double>::Lowest();
+	PolygonLatitudes.Reserve( Polygon.Num() );
+	PolygonLongitudes.Reserve( Polygon.Num() );
+	for( const FVector2D& Point : Polygon )
+	{
+		PolygonLatitudes.Add( Point.Y );
+		PolygonLongitudes.Add( Point.X );
+		PolygonMinLatitude = FMath::Min( PolygonMinLatitude, Point.Y );
+		PolygonMaxLatitude = FMath::Max( PolygonMaxLatitude, Point.Y );
+		PolygonMinLongitude = FMath::Min( PolygonMinLongitude, Point.X );
+		PolygonMaxLongitude = FMath::Max( PolygonMaxLongitude, Point.X );
+	}
+
+	MinLatitude = FMath::Max( MinLatitude, PolygonMinLatitude );
+	MaxLatitude = FMath::Min( MaxLatitude, PolygonMaxLatitude );
+	MinLongitude = FMath::Max( MinLongitude, PolygonMinLongitude );
+	MaxLongitude = FMath::Min( MaxLongitude, PolygonMaxLongitude );
+
+	// Sort the edges into bands.  An edge goes into every band its latitude range overlaps.
+	const int32 VertexCount = PolygonLatitudes.Num();
+	const int32 BandCount = FMath::Clamp( VertexCount, 1, MaxBandCount );
+	BandMinLatitude = PolygonMinLatitude;
+	BandHeight = FMath::Max( ( PolygonMaxLatitude - PolygonMinLatitude ) / BandCount, UE_DOUBLE_SMALL_NUMBER );
+
+	auto GetBandIndex = [this, BandCount]( const double Latitude ) -> int32
+	{
+		return FMath::Clamp( (int32)( ( Latitude - BandMinLatitude ) / BandHeight ), 0, BandCount - 1 );
+	};
+
+	// Count first, so that all bands can share one array
+	BandEdgeOffsets.SetNumZeroed( BandCount + 1 );
+	for( int32 EdgeIndex = 0; EdgeIndex < VertexCount; ++EdgeIndex )
+	{
+		const double StartLatitude = PolygonLatitudes[ EdgeIndex ];
+		const double EndLatitude = PolygonLatitudes[ ( EdgeIndex + 1 ) % VertexCount ];
+		const int32 FirstBand = GetBandIndex( FMath::Min( StartLatitude, EndLatitude ) );
+		const int32 LastBand = GetBandIndex( FMath::Max( StartLatitude, EndLatitude ) );
+		for( int32 BandIndex = FirstBand; BandIndex <= LastBand; ++BandIndex )
+		{
+			++BandEdgeOffsets[ BandIndex + 1 ];
+		}
+	}
+	for( int32 BandIndex = 0; BandIndex < BandCount; ++BandIndex )
+	{
+		BandEdgeOffsets[ BandIndex + 1 ] += BandEdgeOffsets[ BandIndex ];
+	}
+
+	TArray<int32> NextBandEdges( BandEdgeOffsets.GetData(), BandCount );
+	BandEdges.SetNumUninitialized( BandEdgeOffsets[ BandCount ] );
+	for( int32 EdgeIndex = 0; EdgeIndex < VertexCount; ++EdgeIndex )
+	{
+		const double StartLatitude = PolygonLatitudes[ EdgeIndex ];
+		const double EndLatitude = PolygonLatitudes[ ( EdgeIndex + 1 ) % VertexCount ];
+		const int32 FirstBand = GetBandIndex( FMath::Min( StartLatitude, EndLatitude ) );
+		const int32 LastBand = GetBandIndex( FMath::Max( StartLatitude, EndLatitude ) );
+		for( int32 BandIndex = FirstBand; BandIndex <= LastBand; ++BandIndex )
+		{
+			BandEdges[ NextBandEdges[ BandIndex ]++ ] = EdgeIndex;
+		}
+	}
+}
+
+
+bool FOSMClipRegion::PolygonContains( const double Latitude, const double Longitude ) const
+{
+	const int32 VertexCount = PolygonLatitudes.Num();
+	const int32 BandCount = BandEdgeOffsets.Num() - 1;
+
+	const int32 BandIndex = FMath::Clamp( (int32)( ( Latitude - BandMinLatitude ) / BandHeight ), 0, BandCount - 1 );
+
+	// Count the edges crossed by a ray heading east from the location
+	bool bIsInside = false;
+	for( int32 BandEdgeIndex = BandEdgeOffsets[ BandIndex ]; BandEdgeIndex < BandEdgeOffsets[ BandIndex + 1 ]; ++BandEdgeIndex )
+	{
+		const int32 StartIndex = BandEdges[ BandEdgeIndex ];
+		const int32 EndIndex = ( StartIndex + 1 ) % VertexCount;
+		const double StartLatitude = PolygonLatitudes[ StartIndex ];
+		const double EndLatitude = PolygonLatitudes[ EndIndex ];
+
+		// Half-open, so that a ray passing exactly through a vertex only counts it once
+		if( ( StartLatitude > Latitude ) != ( EndLatitude > Latitude ) )
+		{
+			const double StartLongitude = PolygonLongitudes[ StartIndex ];
+			const double EndLongitude = PolygonLongitudes[ EndIndex ];
+			const double CrossingLongitude = StartLongitude + ( Latitude - StartLatitude ) * ( EndLongitude - StartLongitude ) / ( EndLatitude - StartLatitude );
+			if( Longitude < CrossingLongitude )
+			{
+				bIsInside = !bIsInside;
+			}
+		}
+	}
+
+	return bIsInside;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "StreetMap.h"
+
+/** The area of the map to import, from the import settings.  Nodes outside of it are thrown away as soon as they
+    are parsed, so importing a small window out of a large extract never holds the whole extract in memory. */
+class FOSMClipRegion
+{
+
+public:
+
+	/** Sets up the region from the specified settings */
+	FOSMClipRegion( const FStreetMapImportSettings& ImportSettings );
+
+	/** Returns true if the region is clipping anything at all */
+	bool IsEnabled() const
+	{
+		return bIsEnabled;
+	}
+
+	/** Returns true if the specified location is inside the region.  Safe to call from any thread. */
+	bool Contains( const double Latitude, const double Longitude ) const
+	{
+		if( !bIsEnabled )
+		{
+			return true;
+		}
+
+		if( Latitude < MinLatitude || Latitude > MaxLatitude || Longitude < MinLongitude || Longitude > MaxLongitude )
+		{
+			return false;
+		}
+
+		return PolygonLatitudes.Num() == 0 || PolygonContains( Latitude, Longitude );
+	}
+
+
+private:
+
+	/** Even-odd test against the clip polygon.  Only called for locations inside the polygon's bounds. */
+	bool PolygonContains( const double Latitude, const double Longitude ) const;
+
+	// Whether we clip anything
+	bool bIsEnabled;
+
+	// Bounds of the region.  When there is a polygon, these are clamped to the polygon's bounds.
+	double MinLatitude;
+	double MaxLatitude;
+	double MinLongitude;
+	double MaxLongitude;
+
+	// Polygon vertices, or empty if we only clip to the bounds
+	TArray<double> PolygonLatitudes;
+	TArray<double> PolygonLongitudes;
+
+	// Polygon edges are sorted into bands of latitude, so that each test only looks at the edges that could cross
+	// its row.  Edge indices for each band are in BandEdges, starting at BandEdgeOffsets[ BandIndex ].
+	double BandMinLatitude;
+	double BandHeight;
+	TArray<int32> BandEdgeOffsets;
+	TArray<int32> BandEdges;
+};
@@ -1,403 +1,962 @@
 #include "OSMFile.h"
-#include "Misc/FeedbackContext.h"
-
-FOSMFile::FOSMFile()
-	: ParsingState(ParsingState::Root),
-	  CurrentNodeID(0),
-	  CurrentNodeInfo(nullptr),
-	  CurrentWayInfo(nullptr),
-	  CurrentWayTagKey(nullptr)
+#include "OSMGzipStream.h"
+#include "OSMXmlReader.h"
+#include "OSMNodeSpill.h"
+#include "OSMPbfReader.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeExit.h"
+
+#define LOCTEXT_NAMESPACE "StreetMapImporting"
+
+namespace OSMFile
+{
+	// Approximate size of each chunk of an XML file that is tokenized on its own thread.  Files smaller than
+	// this are tokenized in one piece.
+	static const int64 XmlChunkSize = 16 * 1024 * 1024;
+
+	// How much of a compressed XML file is decompressed to find its bounds.  The <bounds> element comes right
+	// after the header.
+	static const int64 CompressedScanSize = 64 * 1024;
+
+	// When importing out of core, how much of the progress bar reading the file takes up.  The rest is for reading
+	// the nodes back from disk.
+	static const float OutOfCoreReadProgress = 0.8f;
+
+	// When importing out of core, how many nodes are read back from disk between progress updates
+	static const int64 SpilledNodesPerProgressUpdate = 1024 * 1024;
+
+	/** Appends a tag value to a string pool.  Only values from XML files have character entities to decode; a PBF
+	    string that happens to contain "&amp;" really does mean that. */
+	static void AppendTagValue( const FAnsiStringView Value, const bool bIsXmlEscaped, TArray<TCHAR>& Out )
+	{
+		if( bIsXmlEscaped )
+		{
+			FOSMXmlReader::AppendString( Value, Out );
+		}
+		else
+		{
+			const FUTF8ToTCHAR Converted( Value.GetData(), Value.Len() );
+			Out.Append( Converted.Get(), Converted.Length() );
+		}
+	}
+
+	// How many chunks of an XML file are tokenized at once.  Only this many batches are held in memory.
+	static int32 GetChunksPerGroup()
+	{
+		return FMath::Max( 1, FTaskGraphInterface::Get().GetNumWorkerThreads() + 1 );
+	}
+
+
+	/** Splits an XML file into chunks that start at top-level elements.  Nodes and ways never span a boundary, so each
+	    chunk can be tokenized on its own, and because the chunks are merged in file order the result is exactly the
+	    same as tokenizing the whole file in one go.  Returns the offset of each chunk, followed by the size of the file. */
+	static void SplitXmlIntoChunks( const TArrayView64<const uint8> Buffer, TArray<int64>& OutChunkOffsets )
+	{
+		OutChunkOffsets.Reset();
+		OutChunkOffsets.Add( 0 );
+		for( ;; )
+		{
+			const int64 NextChunkOffset = FOSMXmlReader::FindElementBoundary( Buffer, OutChunkOffsets.Last() + XmlChunkSize );
+			if( NextChunkOffset >= Buffer.Num() )
+			{
+				break;
+			}
+			OutChunkOffsets.Add( NextChunkOffset );
+		}
+		OutChunkOffsets.Add( Buffer.Num() );
+	}
+
+
+	/** Turns the elements from one chunk of an OpenStreetMap XML file into a batch.  Node references aren't resolved
+	    here, as the nodes may live in a different chunk.  That happens when the batch is merged. */
+	class FXmlBatchParser : public IOSMXmlCallback
+	{
+
+	public:
+
+		FXmlBatchParser( const FOSMFile::FOSMReadOptions& InOptions, FOSMFile::FOSMBatch& InBatch )
+			: Options( InOptions ),
+			  Batch( InBatch ),
+			  ParsingState( EParsingState::Root ),
+			  CurrentWayIndex( INDEX_NONE ),
+			  CurrentWayTagKey()
+		{
+		}
+
+		// IOSMXmlCallback overrides
+		virtual bool ProcessElement( const FAnsiStringView ElementName ) override
+		{
+			if( ParsingState == EParsingState::Root )
+			{
+				if( ElementName.Equals( ANSITEXTVIEW( "node" ) ) && Options.bReadNodes )
+				{
+					ParsingState = EParsingState::Node;
+					Batch.NodeIDs.Add( 0 );
+					Batch.NodeLatitudes.Add( 0.0 );
+					Batch.NodeLongitudes.Add( 0.0 );
+				}
+				else if( ElementName.Equals( ANSITEXTVIEW( "way" ) ) && Options.bReadWays )
+				{
+					ParsingState = EParsingState::Way;
+					CurrentWayIndex = Batch.Ways.Num();
+					Batch.AddWay();
+
+					// @todo: We're currently ignoring the "visible" tag on ways, which means that roads will always
+					//        be included in our data set.  It might be nice to make this an import option.
+				}
+			}
+			else if( ParsingState == EParsingState::Way )
+			{
+				if( ElementName.Equals( ANSITEXTVIEW( "nd" ) ) )
+				{
+					ParsingState = EParsingState::Way_NodeRef;
+				}
+				else if( ElementName.Equals( ANSITEXTVIEW( "tag" ) ) )
+				{
+					ParsingState = EParsingState::Way_Tag;
+				}
+			}
+
+			return true;
+		}
+
+		virtual bool ProcessAttribute( const FAnsiStringView AttributeName, const FAnsiStringView AttributeValue ) override
+		{
+			if( ParsingState == EParsingState::Node )
+			{
+				if( AttributeName.Equals( ANSITEXTVIEW( "id" ) ) )
+				{
+					Batch.NodeIDs.Last() = FOSMXmlReader::ParseInt64( AttributeValue );
+				}
+				else if( AttributeName.Equals( ANSITEXTVIEW( "lat" ) ) )
+				{
+					Batch.NodeLatitudes.Last() = FOSMXmlReader::ParseDouble( AttributeValue );
+				}
+				else if( AttributeName.Equals( ANSITEXTVIEW( "lon" ) ) )
+				{
+					Batch.NodeLongitudes.Last() = FOSMXmlReader::ParseDouble( AttributeValue );
+				}
+			}
+			else if( ParsingState == EParsingState::Way )
+			{
+				if( AttributeName.Equals( ANSITEXTVIEW( "id" ) ) )
+				{
+					Batch.Ways[ CurrentWayIndex ].ID = FOSMXmlReader::ParseInt64( AttributeValue );
+				}
+			}
+			else if( ParsingState == EParsingState::Way_NodeRef )
+			{
+				if( AttributeName.Equals( ANSITEXTVIEW( "ref" ) ) )
+				{
+					Batch.AddWayNodeID( FOSMXmlReader::ParseInt64( AttributeValue ) );
+				}
+			}
+			else if( ParsingState == EParsingState::Way_Tag )
+			{
+				if( AttributeName.Equals( ANSITEXTVIEW( "k" ) ) )
+				{
+					CurrentWayTagKey = AttributeValue;
+				}
+				else if( AttributeName.Equals( ANSITEXTVIEW( "v" ) ) )
+				{
+					const bool bIsXmlEscaped = true;
+					Batch.ApplyWayTag( Options.TagClassifier, Batch.Ways[ CurrentWayIndex ], CurrentWayTagKey, AttributeValue, bIsXmlEscaped );
+				}
+			}
+
+			return true;
+		}
+
+		virtual bool ProcessClose( const FAnsiStringView ElementName ) override
+		{
+			if( ParsingState == EParsingState::Node )
+			{
+				// Nodes may have tags of their own, which we skip over
+				if( ElementName.Equals( ANSITEXTVIEW( "node" ) ) )
+				{
+					Batch.FinishNode( Options );
+					ParsingState = EParsingState::Root;
+				}
+			}
+			else if( ParsingState == EParsingState::Way && ElementName.Equals( ANSITEXTVIEW( "way" ) ) )
+			{
+				Batch.FinishWay( Options.TagClassifier );
+				CurrentWayIndex = INDEX_NONE;
+
+				ParsingState = EParsingState::Root;
+			}
+			else if( ParsingState == EParsingState::Way_NodeRef )
+			{
+				ParsingState = EParsingState::Way;
+			}
+			else if( ParsingState == EParsingState::Way_Tag )
+			{
+				CurrentWayTagKey.Reset();
+				ParsingState = EParsingState::Way;
+			}
+
+			return true;
+		}
+
+	private:
+
+		enum class EParsingState
+		{
+			Root,
+			Node,
+			Way,
+			Way_NodeRef,
+			Way_Tag
+		};
+
+		// Decides what we read and keep
+		const FOSMFile::FOSMReadOptions& Options;
+
+		// Batch that we're filling in
+		FOSMFile::FOSMBatch& Batch;
+
+		// Current state of parser
+		EParsingState ParsingState;
+
+		// Index of the way that is currently being parsed in the batch's list of ways
+		int32 CurrentWayIndex;
+
+		// Current way's tag key string.  Points directly into the buffer we're parsing.
+		FAnsiStringView CurrentWayTagKey;
+	};
+}
+
+
+FOSMFile::FOSMFile( const FStreetMapImportSettings& ImportSettings )
+	: TagClassifier( ImportSettings ),
+	  ClipRegion( ImportSettings ),
+	  bOnlyKeepReferencedNodes( ImportSettings.bOnlyKeepReferencedNodes ),
+	  bOutOfCoreNodes( ImportSettings.bOutOfCoreNodes ),
+	  OutOfCoreNodeMemoryBudget( int64( FMath::Max( ImportSettings.OutOfCoreNodeMemoryBudget, 16 ) ) * 1024 * 1024 )
 {
 }
 		
 
 FOSMFile::~FOSMFile()
 {
-	// Clean up time
+}
+
+
+void FOSMFile::ScanOpenStreetMapFile( const TArrayView64<const uint8> Buffer, FOSMXmlSummary& OutSummary )
+{
+	using namespace OSMFile;
+
+	if( FOSMGzipStream::IsGzipData( Buffer ) )
 	{
-		for( auto* Way : Ways )
-		{
-			delete Way;
-		}
-		Ways.Empty();
-				
-		for( auto HashPair : NodeMap )
+		OutSummary = FOSMXmlSummary();
+		OutSummary.bIsCompressed = true;
+
+		FOSMGzipStream Stream( Buffer, CompressedScanSize, 1 );
+		TArray64<uint8> Window;
+		FText ErrorMessage;
+		if( Stream.ReadWindow( Window, ErrorMessage ) )
 		{
-			FOSMNodeInfo* NodeInfo = HashPair.Value;
-			delete NodeInfo;
+			FOSMXmlSummary WindowSummary;
+			FOSMXmlReader::Scan( TArrayView64<const uint8>( Window.GetData(), Window.Num() ), WindowSummary );
+			OutSummary.bHasBounds = WindowSummary.bHasBounds;
+			OutSummary.MinLatitude = WindowSummary.MinLatitude;
+			OutSummary.MaxLatitude = WindowSummary.MaxLatitude;
+			OutSummary.MinLongitude = WindowSummary.MinLongitude;
+			OutSummary.MaxLongitude = WindowSummary.MaxLongitude;
 		}
-		NodeMap.Empty();
+		return;
+	}
+
+	TArray<int64> ChunkOffsets;
+	SplitXmlIntoChunks( Buffer, ChunkOffsets );
+	const int32 ChunkCount = ChunkOffsets.Num() - 1;
+
+	TArray<FOSMXmlSummary> ChunkSummaries;
+	ChunkSummaries.SetNum( ChunkCount );
+	ParallelFor( ChunkCount, [&]( const int32 ChunkIndex )
+	{
+		FOSMXmlReader::Scan( Buffer.Slice( ChunkOffsets[ ChunkIndex ], ChunkOffsets[ ChunkIndex + 1 ] - ChunkOffsets[ ChunkIndex ] ), ChunkSummaries[ ChunkIndex ] );
+	} );
+
+	OutSummary = FOSMXmlSummary();
+	for( const FOSMXmlSummary& ChunkSummary : ChunkSummaries )
+	{
+		OutSummary.Merge( ChunkSummary );
 	}
 }
 
 
-bool FOSMFile::LoadOpenStreetMapFile( FString& OSMFilePath, const bool bIsFilePathActuallyTextBuffer, FFeedbackContext* FeedbackContext )
+bool FOSMFile::LoadOpenStreetMapFile( const TArrayView64<const uint8> Buffer, const FOSMXmlSummary& Summary, TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage )
 {
-	const bool bShowSlowTaskDialog = true;
-	const bool bShowCancelButton = true;
+	// The file's own bounds are only meaningful if we're importing all of it
+	if( Summary.bHasBounds && !ClipRegion.IsEnabled() )
+	{
+		MinLatitude = Summary.MinLatitude;
+		MaxLatitude = Summary.MaxLatitude;
+		MinLongitude = Summary.MinLongitude;
+		MaxLongitude = Summary.MaxLongitude;
+		bHasBoundsFromFile = true;
+	}
+
+	// When every node is kept in memory, we know exactly how many there will be.  The scan counts in 64 bits, and a
+	// count that doesn't fit in an array can't be kept in memory anyway, so there's no point reserving for it.
+	if( !bOnlyKeepReferencedNodes && !bOutOfCoreNodes && !ClipRegion.IsEnabled() && Summary.NodeCount <= MAX_int32 )
+	{
+		const int32 NodeCount = int32( Summary.NodeCount );
+		NodeIDs.Reserve( NodeCount );
+		NodeLatitudes.Reserve( NodeCount );
+		NodeLongitudes.Reserve( NodeCount );
+	}
 
 	FText ErrorMessage;
-	int32 ErrorLineNumber;
-	if( FFastXml::ParseXmlFile( 
-		this, 
-		bIsFilePathActuallyTextBuffer ? nullptr : *OSMFilePath, 
-		bIsFilePathActuallyTextBuffer ? OSMFilePath.GetCharArray().GetData() : nullptr, 
-		FeedbackContext, 
-		bShowSlowTaskDialog, 
-		bShowCancelButton, 
-		/* Out */ ErrorMessage, 
-		/* Out */ ErrorLineNumber ) )
+	int64 ErrorLineNumber = 0;
+	const bool bIsCompressed = FOSMGzipStream::IsGzipData( Buffer );
+	auto ReadPass = [&]( const FOSMReadOptions& Options, TFunctionRef<bool( float )> PassProgressCallback )
 	{
-		if( NodeMap.Num() > 0 )
+		return bIsCompressed ?
+			ReadCompressedXmlPass( Buffer, Options, PassProgressCallback, /* Out */ ErrorMessage, /* Out */ ErrorLineNumber ) :
+			ReadXmlPass( Buffer, Options, PassProgressCallback, /* Out */ ErrorMessage, /* Out */ ErrorLineNumber );
+	};
+
+	bool bSucceeded = false;
+	if( bOutOfCoreNodes )
+	{
+		// Nodes go straight to disk, so the ways and nodes can both be read in a single pass
+		NodeSpill = MakeUnique<FOSMNodeSpill>( OutOfCoreNodeMemoryBudget );
+		auto ReportReadProgress = [&ProgressCallback]( const float PassProgress ) { return ProgressCallback( PassProgress * OSMFile::OutOfCoreReadProgress ); };
+		bSucceeded = ReadPass( FOSMReadOptions( TagClassifier, ClipRegion ), ReportReadProgress );
+	}
+	else if( bOnlyKeepReferencedNodes )
+	{
+		// Read the ways first, so that we know which nodes they need.  Then read only those nodes.
+		auto ReportFirstPassProgress = [&ProgressCallback]( const float PassProgress ) { return ProgressCallback( PassProgress * 0.5f ); };
+		auto ReportSecondPassProgress = [&ProgressCallback]( const float PassProgress ) { return ProgressCallback( 0.5f + PassProgress * 0.5f ); };
+
+		FOSMReadOptions WayOptions( TagClassifier, ClipRegion );
+		WayOptions.bReadNodes = false;
+		if( ReadPass( WayOptions, ReportFirstPassProgress ) )
 		{
-			AverageLatitude /= NodeMap.Num();
-			AverageLongitude /= NodeMap.Num();
-		}
+			FOSMNodeIdSet ReferencedNodes;
+			BuildReferencedNodeSet( ReferencedNodes );
 
-		return true;
+			FOSMReadOptions NodeOptions( TagClassifier, ClipRegion );
+			NodeOptions.bReadWays = false;
+			NodeOptions.NodeFilter = &ReferencedNodes;
+			bSucceeded = ReadPass( NodeOptions, ReportSecondPassProgress );
+		}
+	}
+	else
+	{
+		bSucceeded = ReadPass( FOSMReadOptions( TagClassifier, ClipRegion ), ProgressCallback );
 	}
 
-	if( FeedbackContext != nullptr )
+	if( bSucceeded )
 	{
-		FeedbackContext->Logf(
-			ELogVerbosity::Error,
-			TEXT( "Failed to load OpenStreetMap XML file ('%s', Line %i)" ),
-			*ErrorMessage.ToString(),
-			ErrorLineNumber );
+		if( bOutOfCoreNodes )
+		{
+			auto ReportSpillProgress = [&ProgressCallback]( const float SpillProgress ) { return ProgressCallback( OSMFile::OutOfCoreReadProgress + SpillProgress * ( 1.0f - OSMFile::OutOfCoreReadProgress ) ); };
+			return FinishLoadingFromSpill( ReportSpillProgress, OutErrorMessage );
+		}
+
+		FinishLoading();
+		return true;
 	}
 
+	NodeSpill.Reset();
+	OutErrorMessage = FText::Format( LOCTEXT( "OSMFile_XmlError", "{0} (line {1})" ), ErrorMessage, FText::AsNumber( ErrorLineNumber ) );
 	return false;
 }
 
-		
-bool FOSMFile::ProcessXmlDeclaration( const TCHAR* ElementData, int32 XmlFileLineNumber )
+
+bool FOSMFile::ReadXmlPass( const TArrayView64<const uint8> Buffer, const FOSMReadOptions& Options, TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage, int64& OutErrorLineNumber )
 {
-	// Don't care about XML declaration
-	return true;
-}
+	using namespace OSMFile;
 
+	TArray<int64> ChunkOffsets;
+	SplitXmlIntoChunks( Buffer, ChunkOffsets );
+	const int32 ChunkCount = ChunkOffsets.Num() - 1;
+
+	// Tokenize the chunks in groups, so that only a bounded number of batches are held in memory at once
+	const int32 ChunksPerGroup = GetChunksPerGroup();
+	for( int32 FirstChunkIndex = 0; FirstChunkIndex < ChunkCount; FirstChunkIndex += ChunksPerGroup )
+	{
+		const int32 GroupChunkCount = FMath::Min( ChunksPerGroup, ChunkCount - FirstChunkIndex );
+
+		// The group's offsets include the end of its last chunk
+		if( !ReadXmlChunks( Buffer, TArrayView<const int64>( ChunkOffsets.GetData() + FirstChunkIndex, GroupChunkCount + 1 ), Options, /* Out */ OutErrorMessage, /* Out */ OutErrorLineNumber ) )
+		{
+			return false;
+		}
+
+		const int64 GroupEndOffset = ChunkOffsets[ FirstChunkIndex + GroupChunkCount ];
+		if( !ProgressCallback( float( double( GroupEndOffset ) / double( FMath::Max<int64>( Buffer.Num(), 1 ) ) ) ) )
+		{
+			OutErrorMessage = LOCTEXT( "OSMXmlReader_Cancelled", "Parsing was cancelled" );
+			OutErrorLineNumber = FOSMXmlReader::ComputeLineNumber( Buffer, GroupEndOffset );
+			return false;
+		}
+	}
 
-bool FOSMFile::ProcessComment( const TCHAR* Comment )
-{
-	// Don't care about comments
 	return true;
 }
-	
-	
-bool FOSMFile::ProcessElement( const TCHAR* ElementName, const TCHAR* ElementData, int32 XmlFileLineNumber )
+
+
+bool FOSMFile::ReadCompressedXmlPass( const TArrayView64<const uint8> CompressedBuffer, const FOSMReadOptions& Options, TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage, int64& OutErrorLineNumber )
 {
-	if( ParsingState == ParsingState::Root )
+	using namespace OSMFile;
+
+	// Windows are the same size as our chunks, and the decompression thread stays a group of chunks ahead of us, so
+	// it can decompress the next group while we tokenize this one
+	const int32 ChunksPerGroup = GetChunksPerGroup();
+	FOSMGzipStream Stream( CompressedBuffer, XmlChunkSize, ChunksPerGroup );
+
+	// Decompressed data that hasn't been tokenized yet.  Chunks only end at element boundaries, so whatever follows
+	// the last boundary we found waits here until the next window arrives.
+	TArray64<uint8> Pending;
+	TArray64<uint8> Window;
+	int64 PendingFirstLineNumber = 1;
+	bool bAtEnd = false;
+	int64 GroupSize = ChunksPerGroup * XmlChunkSize;
+	TArray<int64> ChunkOffsets;
+	while( !bAtEnd || Pending.Num() > 0 )
 	{
-		if( !FCString::Stricmp( ElementName, TEXT( "node" ) ) )
+		while( !bAtEnd && Pending.Num() < GroupSize )
 		{
-			ParsingState = ParsingState::Node;
-			CurrentNodeInfo = new FOSMNodeInfo();
-			CurrentNodeInfo->Latitude = 0.0;
-			CurrentNodeInfo->Longitude = 0.0;
+			if( !Stream.ReadWindow( Window, /* Out */ OutErrorMessage ) )
+			{
+				OutErrorLineNumber = PendingFirstLineNumber;
+				return false;
+			}
+			bAtEnd = Window.Num() == 0;
+			Pending.Append( Window );
 		}
-		else if( !FCString::Stricmp( ElementName, TEXT( "way" ) ) )
+
+		const TArrayView64<const uint8> PendingView( Pending.GetData(), Pending.Num() );
+		SplitXmlIntoChunks( PendingView, ChunkOffsets );
+
+		// Unless we've reached the end of the file, the last chunk may stop part way through an element
+		if( !bAtEnd )
 		{
-			ParsingState = ParsingState::Way;
-			CurrentWayInfo = new FOSMWayInfo();
-			CurrentWayInfo->Name.Empty();
-			CurrentWayInfo->Ref.Empty();
-			CurrentWayInfo->WayType = EOSMWayType::Other;
-			CurrentWayInfo->Height = 0.0;
-			CurrentWayInfo->bIsOneWay = false;
+			ChunkOffsets.Pop();
+			if( ChunkOffsets.Num() < 2 )
+			{
+				// Elements this big are unusual, but there's nothing for it except reading more
+				GroupSize += XmlChunkSize;
+				continue;
+			}
+		}
+
+		if( !ReadXmlChunks( PendingView, ChunkOffsets, Options, /* Out */ OutErrorMessage, /* Out */ OutErrorLineNumber ) )
+		{
+			OutErrorLineNumber += PendingFirstLineNumber - 1;
+			return false;
+		}
+
+		const int64 TokenizedSize = ChunkOffsets.Last();
+		PendingFirstLineNumber += FOSMXmlReader::ComputeLineNumber( PendingView, TokenizedSize ) - 1;
+		const bool bAllowShrinking = false;
+		Pending.RemoveAt( 0, TokenizedSize, bAllowShrinking );
+		GroupSize = ChunksPerGroup * XmlChunkSize;
 
-			// @todo: We're currently ignoring the "visible" tag on ways, which means that roads will always
-			//        be included in our data set.  It might be nice to make this an import option.
+		if( !ProgressCallback( Stream.GetProgress() ) )
+		{
+			OutErrorMessage = LOCTEXT( "OSMXmlReader_Cancelled", "Parsing was cancelled" );
+			OutErrorLineNumber = PendingFirstLineNumber;
+			return false;
 		}
 	}
-	else if( ParsingState == ParsingState::Way )
+
+	return true;
+}
+
+
+bool FOSMFile::ReadXmlChunks( const TArrayView64<const uint8> Buffer, const TArrayView<const int64> ChunkOffsets, const FOSMReadOptions& Options, FText& OutErrorMessage, int64& OutErrorLineNumber )
+{
+	using namespace OSMFile;
+
+	const int32 ChunkCount = ChunkOffsets.Num() - 1;
+
+	TArray<FOSMBatch> Batches;
+	TArray<FText> ChunkErrorMessages;
+	TArray<int64> ChunkErrorLineNumbers;
+	Batches.SetNum( ChunkCount );
+	ChunkErrorMessages.SetNum( ChunkCount );
+	ChunkErrorLineNumbers.SetNumZeroed( ChunkCount );
+
+	ParallelFor( ChunkCount, [&]( const int32 ChunkIndex )
+	{
+		const int64 ChunkOffset = ChunkOffsets[ ChunkIndex ];
+		const int64 ChunkSize = ChunkOffsets[ ChunkIndex + 1 ] - ChunkOffset;
+
+		FXmlBatchParser Parser( Options, Batches[ ChunkIndex ] );
+		FOSMXmlReader::Parse( 
+			Buffer.Slice( ChunkOffset, ChunkSize ),
+			Parser,
+			[]( const int64 BytesProcessed ) { return true; },
+			/* Out */ ChunkErrorMessages[ ChunkIndex ],
+			/* Out */ ChunkErrorLineNumbers[ ChunkIndex ] );
+	} );
+
+	for( int32 ChunkIndex = 0; ChunkIndex < ChunkCount; ++ChunkIndex )
 	{
-		if( !FCString::Stricmp( ElementName, TEXT( "nd" ) ) )
+		if( !ChunkErrorMessages[ ChunkIndex ].IsEmpty() )
 		{
-			ParsingState = ParsingState::Way_NodeRef;
+			// Line numbers are relative to the start of the chunk
+			OutErrorMessage = ChunkErrorMessages[ ChunkIndex ];
+			OutErrorLineNumber = FOSMXmlReader::ComputeLineNumber( Buffer, ChunkOffsets[ ChunkIndex ] ) + ChunkErrorLineNumbers[ ChunkIndex ] - 1;
+			return false;
 		}
-		else if( !FCString::Stricmp( ElementName, TEXT( "tag" ) ) )
+
+		MergeBatch( Batches[ ChunkIndex ] );
+	}
+
+	return true;
+}
+
+		
+bool FOSMFile::LoadOpenStreetMapPBFFile( const TArrayView64<const uint8> Buffer, TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage )
+{
+	bool bSucceeded = false;
+	if( bOutOfCoreNodes )
+	{
+		NodeSpill = MakeUnique<FOSMNodeSpill>( OutOfCoreNodeMemoryBudget );
+		auto ReportReadProgress = [&ProgressCallback]( const float PassProgress ) { return ProgressCallback( PassProgress * OSMFile::OutOfCoreReadProgress ); };
+		bSucceeded = ReadPbfPass( Buffer, FOSMReadOptions( TagClassifier, ClipRegion ), ReportReadProgress, /* Out */ OutErrorMessage );
+	}
+	else if( bOnlyKeepReferencedNodes )
+	{
+		// Read the ways first, so that we know which nodes they need.  Then read only those nodes.
+		auto ReportFirstPassProgress = [&ProgressCallback]( const float PassProgress ) { return ProgressCallback( PassProgress * 0.5f ); };
+		auto ReportSecondPassProgress = [&ProgressCallback]( const float PassProgress ) { return ProgressCallback( 0.5f + PassProgress * 0.5f ); };
+
+		FOSMReadOptions WayOptions( TagClassifier, ClipRegion );
+		WayOptions.bReadNodes = false;
+		if( ReadPbfPass( Buffer, WayOptions, ReportFirstPassProgress, /* Out */ OutErrorMessage ) )
 		{
-			ParsingState = ParsingState::Way_Tag;
+			FOSMNodeIdSet ReferencedNodes;
+			BuildReferencedNodeSet( ReferencedNodes );
+
+			FOSMReadOptions NodeOptions( TagClassifier, ClipRegion );
+			NodeOptions.bReadWays = false;
+			NodeOptions.NodeFilter = &ReferencedNodes;
+			bSucceeded = ReadPbfPass( Buffer, NodeOptions, ReportSecondPassProgress, /* Out */ OutErrorMessage );
 		}
 	}
+	else
+	{
+		bSucceeded = ReadPbfPass( Buffer, FOSMReadOptions( TagClassifier, ClipRegion ), ProgressCallback, /* Out */ OutErrorMessage );
+	}
 
-	return true;
+	if( bSucceeded && bOutOfCoreNodes )
+	{
+		auto ReportSpillProgress = [&ProgressCallback]( const float SpillProgress ) { return ProgressCallback( OSMFile::OutOfCoreReadProgress + SpillProgress * ( 1.0f - OSMFile::OutOfCoreReadProgress ) ); };
+		return FinishLoadingFromSpill( ReportSpillProgress, OutErrorMessage );
+	}
+
+	if( bSucceeded )
+	{
+		FinishLoading();
+	}
+
+	NodeSpill.Reset();
+	return bSucceeded;
 }
 
 
-bool FOSMFile::ProcessAttribute( const TCHAR* AttributeName, const TCHAR* AttributeValue )
+bool FOSMFile::ReadPbfPass( const TArrayView64<const uint8> Buffer, const FOSMReadOptions& Options, TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage )
 {
-	if( ParsingState == ParsingState::Node )
+	auto ProcessBatch = [this]( FOSMBatch& Batch ) -> bool
 	{
-		if( !FCString::Stricmp( AttributeName, TEXT( "id" ) ) )
+		MergeBatch( Batch );
+		return true;
+	};
+
+	return FOSMPbfReader::Parse( Buffer, Options, ProcessBatch, ProgressCallback, /* Out */ OutErrorMessage );
+}
+
+
+void FOSMFile::BuildReferencedNodeSet( FOSMNodeIdSet& OutNodeSet )
+{
+	// Until loading has finished, ways refer to their nodes by ID
+	OutNodeSet.Build( WayNodeIDs );
+
+	// At most this many nodes will be kept by the next pass
+	NodeIDs.Reserve( OutNodeSet.Num() );
+	NodeLatitudes.Reserve( OutNodeSet.Num() );
+	NodeLongitudes.Reserve( OutNodeSet.Num() );
+}
+
+
+void FOSMFile::FOSMBatch::FinishNode( const FOSMReadOptions& Options )
+{
+	if( !Options.ShouldKeepNode( NodeIDs.Last(), NodeLatitudes.Last(), NodeLongitudes.Last() ) )
+	{
+		const bool bAllowShrinking = false;
+		NodeIDs.Pop( bAllowShrinking );
+		NodeLatitudes.Pop( bAllowShrinking );
+		NodeLongitudes.Pop( bAllowShrinking );
+	}
+}
+
+
+FOSMFile::FOSMWayInfo& FOSMFile::FOSMBatch::AddWay()
+{
+	WayStringPoolStart = StringPool.Num();
+
+	FOSMWayInfo& NewWay = Ways.AddDefaulted_GetRef();
+	NewWay.ID = 0;
+	NewWay.FirstNodeIndex = WayNodeIDs.Num();
+	NewWay.NodeCount = 0;
+	NewWay.TagRuleIndex = INDEX_NONE;
+	NewWay.Height = 0.0;
+	NewWay.BuildingLevels = 0;
+	NewWay.bIsOneWay = false;
+	return NewWay;
+}
+
+
+void FOSMFile::FOSMBatch::FinishWay( const FOSMTagClassifier& TagClassifier )
+{
+	const FOSMWayInfo& Way = Ways.Last();
+	if( !TagClassifier.ShouldKeep( Way.TagRuleIndex ) )
+	{
+		// Everything the way added is at the end of our pools, so we can simply roll them back
+		const bool bAllowShrinking = false;
+		WayNodeIDs.SetNum( Way.FirstNodeIndex, bAllowShrinking );
+		StringPool.SetNum( WayStringPoolStart, bAllowShrinking );
+		Ways.Pop( bAllowShrinking );
+	}
+}
+
+
+void FOSMFile::FOSMBatch::ApplyWayTag( const FOSMTagClassifier& TagClassifier, FOSMWayInfo& Way, const FAnsiStringView Key, const FAnsiStringView Value, const bool bIsXmlEscaped )
+{
+	const FOSMTagClassifier::FTagMatch Match = TagClassifier.Classify( Key, Value );
+
+	// When several of the way's tags match rules, the rule listed first wins
+	if( Match.RuleIndex != INDEX_NONE && ( Way.TagRuleIndex == INDEX_NONE || Match.RuleIndex < Way.TagRuleIndex ) )
+	{
+		Way.TagRuleIndex = Match.RuleIndex;
+	}
+
+	if( Match.Key == EOSMTagKey::Name )
+	{
+		Way.Name.Offset = StringPool.Num();
+		OSMFile::AppendTagValue( Value, bIsXmlEscaped, StringPool );
+		Way.Name.Length = StringPool.Num() - Way.Name.Offset;
+	}
+	else if( Match.Key == EOSMTagKey::Ref )
+	{
+		Way.Ref.Offset = StringPool.Num();
+		OSMFile::AppendTagValue( Value, bIsXmlEscaped, StringPool );
+		Way.Ref.Length = StringPool.Num() - Way.Ref.Offset;
+	}
+	else if( Match.Key == EOSMTagKey::Height )
+	{
+		// Check to see if there is a space character in the height value.  For now, we're looking
+		// for straight-up floating point values.
+		int32 SpaceIndex;
+		if( !Value.FindChar( ' ', SpaceIndex ) )
 		{
-			CurrentNodeID = FPlatformString::Atoi64( AttributeValue );
+			// Okay, no space character.  So this has got to be a floating point number.  The OSM
+			// spec says that the height values are in meters.
+			Way.Height = FOSMXmlReader::ParseDouble( Value );
 		}
-		else if( !FCString::Stricmp( AttributeName, TEXT( "lat" ) ) )
+		else
 		{
-			CurrentNodeInfo->Latitude = FPlatformString::Atod( AttributeValue );
-
-			AverageLatitude += CurrentNodeInfo->Latitude;
-					
-			// Update minimum and maximum latitude
-			// @todo: Performance: Instead of computing our own bounding box, we could parse the "minlat" and
-			//        "minlon" tags from the OSM file
-			if( CurrentNodeInfo->Latitude < MinLatitude )
-			{
-				MinLatitude = CurrentNodeInfo->Latitude;
-			}
-			if( CurrentNodeInfo->Latitude > MaxLatitude )
-			{
-				MaxLatitude = CurrentNodeInfo->Latitude;
-			}
+			// Looks like the height value contains units of some sort.
+			// @todo: Add support for interpreting unit strings and converting the values
+		}
+	}
+	else if( Match.Key == EOSMTagKey::BuildingLevels )
+	{
+		Way.BuildingLevels = (int32)FOSMXmlReader::ParseInt64( Value );
+	}
+	else if( Match.Key == EOSMTagKey::OneWay )
+	{
+		if( Value.Equals( ANSITEXTVIEW( "yes" ), ESearchCase::IgnoreCase ) )
+		{
+			Way.bIsOneWay = true;
 		}
-		else if( !FCString::Stricmp( AttributeName, TEXT( "lon" ) ) )
+		else
 		{
-			CurrentNodeInfo->Longitude = FPlatformString::Atod( AttributeValue );
+			Way.bIsOneWay = false;
+		}
+	}
+}
 
-			AverageLongitude += CurrentNodeInfo->Longitude;
-					
-			// Update minimum and maximum longitude
-			if( CurrentNodeInfo->Longitude < MinLongitude )
-			{
-				MinLongitude = CurrentNodeInfo->Longitude;
-			}
-			if( CurrentNodeInfo->Longitude > MaxLongitude )
+
+void FOSMFile::MergeBatch( FOSMBatch& Batch )
+{
+	if( NodeSpill.IsValid() )
+	{
+		// Nodes go to disk.  The average location and bounds are worked out once they've been read back.
+		NodeSpill->Add( Batch.NodeIDs, Batch.NodeLatitudes, Batch.NodeLongitudes );
+	}
+	else
+	{
+		NodeIDs.Append( Batch.NodeIDs );
+		NodeLatitudes.Append( Batch.NodeLatitudes );
+		NodeLongitudes.Append( Batch.NodeLongitudes );
+
+		for( int32 BatchNodeIndex = 0; BatchNodeIndex < Batch.NodeIDs.Num(); ++BatchNodeIndex )
+		{
+			AverageLatitude += Batch.NodeLatitudes[ BatchNodeIndex ];
+			AverageLongitude += Batch.NodeLongitudes[ BatchNodeIndex ];
+		}
+
+		// Files usually tell us their bounds up front.  Otherwise we compute the bounds of the nodes we kept.
+		if( !bHasBoundsFromFile )
+		{
+			for( int32 BatchNodeIndex = 0; BatchNodeIndex < Batch.NodeIDs.Num(); ++BatchNodeIndex )
 			{
-				MaxLongitude = CurrentNodeInfo->Longitude;
+				const double Latitude = Batch.NodeLatitudes[ BatchNodeIndex ];
+				const double Longitude = Batch.NodeLongitudes[ BatchNodeIndex ];
+				MinLatitude = FMath::Min( MinLatitude, Latitude );
+				MaxLatitude = FMath::Max( MaxLatitude, Latitude );
+				MinLongitude = FMath::Min( MinLongitude, Longitude );
+				MaxLongitude = FMath::Max( MaxLongitude, Longitude );
 			}
 		}
 	}
-	else if( ParsingState == ParsingState::Way )
+
+	// Strings and node references are appended as they are, so only their offsets need to move
+	const int32 StringOffset = StringPool.Num();
+	StringPool.Append( Batch.StringPool );
+
+	const int32 WayNodeIDOffset = WayNodeIDs.Num();
+	WayNodeIDs.Append( Batch.WayNodeIDs );
+
+	Ways.Reserve( Ways.Num() + Batch.Ways.Num() );
+	for( const FOSMWayInfo& BatchWay : Batch.Ways )
+	{
+		FOSMWayInfo& Way = Ways.Add_GetRef( BatchWay );
+		Way.Name.Offset += StringOffset;
+		Way.Ref.Offset += StringOffset;
+		Way.FirstNodeIndex += WayNodeIDOffset;
+	}
+}
+
+
+void FOSMFile::FinishLoading()
+{
+	if( NodeIDs.Num() > 0 )
+	{
+		AverageLatitude /= NodeIDs.Num();
+		AverageLongitude /= NodeIDs.Num();
+	}
+
+	// Resolve the node references of every way at once, now that all of the nodes are known
+	NodeIdResolver.Build( NodeIDs );
+
+	TArray<int32> ResolvedNodeIndices;
+	ResolvedNodeIndices.SetNumUninitialized( WayNodeIDs.Num() );
+	NodeIdResolver.FindAll( WayNodeIDs, ResolvedNodeIndices );
+	WayNodeIDs.Empty();
+
+	FinishWays( ResolvedNodeIndices );
+}
+
+
+bool FOSMFile::FinishLoadingFromSpill( TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage )
+{
+	using namespace OSMFile;
+
+	check( NodeSpill.IsValid() );
+	ON_SCOPE_EXIT
 	{
-		// ...
+		NodeSpill.Reset();
+	};
+
+	if( !NodeSpill->Finish( /* Out */ OutErrorMessage ) )
+	{
+		return false;
 	}
-	else if( ParsingState == ParsingState::Way_NodeRef )
+
+	// Sort the ways' node references by ID, so that they can be matched up with the nodes coming back from disk,
+	// which are also in ID order, in a single sweep over both.  These are sorted in memory, outside of the node memory
+	// budget: they're far fewer than the nodes in the file, since most nodes aren't part of any way we keep.
+	TArray<int64> SortedWayNodeIDs;
+	TArray<int32> SortedWayNodeIndices;
+	FOSMNodeIdResolver::Sort( WayNodeIDs, SortedWayNodeIDs, SortedWayNodeIndices );
+
+	TArray<int32> ResolvedNodeIndices;
+	ResolvedNodeIndices.Init( INDEX_NONE, WayNodeIDs.Num() );
+	WayNodeIDs.Empty();
+
+	// At most this many nodes will be kept
+	int32 ReferencedNodeCount = 0;
+	for( int32 Index = 0; Index < SortedWayNodeIDs.Num(); ++Index )
 	{
-		if( !FCString::Stricmp( AttributeName, TEXT( "ref" ) ) )
+		if( Index == 0 || SortedWayNodeIDs[ Index ] != SortedWayNodeIDs[ Index - 1 ] )
 		{
-			FOSMNodeInfo* ReferencedNode = NodeMap.FindRef( FPlatformString::Atoi64( AttributeValue ) );
-			const int NewNodeIndex = CurrentWayInfo->Nodes.Num();
-			CurrentWayInfo->Nodes.Add( ReferencedNode );
-					
-			// Update the node with information about the way that is referencing it
-			{
-				FOSMWayRef NewWayRef;
-				NewWayRef.Way = CurrentWayInfo;
-				NewWayRef.NodeIndex = NewNodeIndex;
-				ReferencedNode->WayRefs.Add( NewWayRef );
-			}
+			++ReferencedNodeCount;
 		}
 	}
-	else if( ParsingState == ParsingState::Way_Tag )
+	NodeIDs.Reset( ReferencedNodeCount );
+	NodeLatitudes.Reset( ReferencedNodeCount );
+	NodeLongitudes.Reset( ReferencedNodeCount );
+
+	int32 NextSortedIndex = 0;
+	int64 ReadNodeCount = 0;
+	const int64 SpilledNodeCount = NodeSpill->Num();
+	auto JoinNode = [&]( const int64 NodeID, const double Latitude, const double Longitude ) -> bool
 	{
-		if( !FCString::Stricmp( AttributeName, TEXT( "k" ) ) )
+		while( NextSortedIndex < SortedWayNodeIDs.Num() && SortedWayNodeIDs[ NextSortedIndex ] < NodeID )
 		{
-			CurrentWayTagKey = AttributeValue;
+			++NextSortedIndex;
 		}
-		else if( !FCString::Stricmp( AttributeName, TEXT( "v" ) ) )
+
+		if( NextSortedIndex < SortedWayNodeIDs.Num() && SortedWayNodeIDs[ NextSortedIndex ] == NodeID )
 		{
-			if( !FCString::Stricmp( CurrentWayTagKey, TEXT( "name" ) ) )
+			// If the same ID was listed more than once, the last one wins, just like when the nodes are kept in memory
+			if( NodeIDs.Num() == 0 || NodeIDs.Last() != NodeID )
 			{
-				CurrentWayInfo->Name = AttributeValue;
+				NodeIDs.Add( NodeID );
+				NodeLatitudes.Add( Latitude );
+				NodeLongitudes.Add( Longitude );
 			}
-			else if( !FCString::Stricmp( CurrentWayTagKey, TEXT( "ref" ) ) )
+			else
 			{
-				CurrentWayInfo->Ref = AttributeValue;
+				NodeLatitudes.Last() = Latitude;
+				NodeLongitudes.Last() = Longitude;
 			}
-			else if( !FCString::Stricmp( CurrentWayTagKey, TEXT( "highway" ) ) )
+
+			const int32 NodeIndex = NodeIDs.Num() - 1;
+			for( int32 SortedIndex = NextSortedIndex; SortedIndex < SortedWayNodeIDs.Num() && SortedWayNodeIDs[ SortedIndex ] == NodeID; ++SortedIndex )
 			{
-				EOSMWayType WayType = EOSMWayType::Other;
-						
-				if( !FCString::Stricmp( AttributeValue, TEXT( "motorway" ) ) )
-				{
-					WayType = EOSMWayType::Motorway;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "motorway_link" ) ) )
-				{
-					WayType = EOSMWayType::Motorway_Link;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "trunk" ) ) )
-				{
-					WayType = EOSMWayType::Trunk;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "trunk_link" ) ) )
-				{
-					WayType = EOSMWayType::Trunk_Link;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "primary" ) ) )
-				{
-					WayType = EOSMWayType::Primary;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "primary_link" ) ) )
-				{
-					WayType = EOSMWayType::Primary_Link;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "secondary" ) ) )
-				{
-					WayType = EOSMWayType::Secondary;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "secondary_link" ) ) )
-				{
-					WayType = EOSMWayType::Secondary_Link;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "tertiary" ) ) )
-				{
-					WayType = EOSMWayType::Tertiary;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "tertiary_link" ) ) )
-				{
-					WayType = EOSMWayType::Tertiary_Link;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "residential" ) ) )
-				{
-					WayType = EOSMWayType::Residential;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "service" ) ) )
-				{
-					WayType = EOSMWayType::Service;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "unclassified" ) ) )
-				{
-					WayType = EOSMWayType::Unclassified;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "living_street" ) ) )
-				{
-					WayType = EOSMWayType::Living_Street;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "pedestrian" ) ) )
-				{
-					WayType = EOSMWayType::Pedestrian;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "track" ) ) )
-				{
-					WayType = EOSMWayType::Track;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "bus_guideway" ) ) )
-				{
-					WayType = EOSMWayType::Bus_Guideway;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "raceway" ) ) )
-				{
-					WayType = EOSMWayType::Raceway;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "road" ) ) )
-				{
-					WayType = EOSMWayType::Road;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "footway" ) ) )
-				{
-					WayType = EOSMWayType::Footway;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "cycleway" ) ) )
-				{
-					WayType = EOSMWayType::Cycleway;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "bridleway" ) ) )
-				{
-					WayType = EOSMWayType::Bridleway;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "steps" ) ) )
-				{
-					WayType = EOSMWayType::Steps;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "path" ) ) )
-				{
-					WayType = EOSMWayType::Path;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "proposed" ) ) )
-				{
-					WayType = EOSMWayType::Proposed;
-				}
-				else if( !FCString::Stricmp( AttributeValue, TEXT( "construction" ) ) )
-				{
-					WayType = EOSMWayType::Construction;
-				}
-				else
-				{
-					// Other type that we don't recognize yet.  See http://wiki.openstreetmap.org/wiki/Key:highway
-				}
-						
-						
-				CurrentWayInfo->WayType = WayType;
+				ResolvedNodeIndices[ SortedWayNodeIndices[ SortedIndex ] ] = NodeIndex;
 			}
-			else if( !FCString::Stricmp( CurrentWayTagKey, TEXT( "building" ) ) )
+		}
+
+		++ReadNodeCount;
+		return ReadNodeCount % SpilledNodesPerProgressUpdate != 0 || ProgressCallback( float( double( ReadNodeCount ) / double( SpilledNodeCount ) ) );
+	};
+
+	if( !NodeSpill->Read( JoinNode, /* Out */ OutErrorMessage ) )
+	{
+		if( OutErrorMessage.IsEmpty() )
+		{
+			OutErrorMessage = LOCTEXT( "OSMFile_SpillCancelled", "Reading nodes back from disk was cancelled" );
+		}
+		return false;
+	}
+
+	SortedWayNodeIDs.Empty();
+	SortedWayNodeIndices.Empty();
+
+	AverageLatitude = 0.0;
+	AverageLongitude = 0.0;
+	for( int32 NodeIndex = 0; NodeIndex < NodeIDs.Num(); ++NodeIndex )
+	{
+		AverageLatitude += NodeLatitudes[ NodeIndex ];
+		AverageLongitude += NodeLongitudes[ NodeIndex ];
+		if( !bHasBoundsFromFile )
+		{
+			MinLatitude = FMath::Min( MinLatitude, NodeLatitudes[ NodeIndex ] );
+			MaxLatitude = FMath::Max( MaxLatitude, NodeLatitudes[ NodeIndex ] );
+			MinLongitude = FMath::Min( MinLongitude, NodeLongitudes[ NodeIndex ] );
+			MaxLongitude = FMath::Max( MaxLongitude, NodeLongitudes[ NodeIndex ] );
+		}
+	}
+	if( NodeIDs.Num() > 0 )
+	{
+		AverageLatitude /= NodeIDs.Num();
+		AverageLongitude /= NodeIDs.Num();
+	}
+
+	// The nodes we kept are in ascending ID order, so the resolver can search them where they are
+	NodeIdResolver.Build( NodeIDs );
+
+	FinishWays( ResolvedNodeIndices );
+	return true;
+}
+
+
+void FOSMFile::FinishWays( const TArrayView<const int32> ResolvedNodeIndices )
+{
+	// Compact the resolved indices into the final pool.  Ways can reference nodes that aren't in the map, either
+	// because the extract was cut along a boundary or because we clipped them away ourselves.  Roads are cut into
+	// separate pieces wherever nodes are missing, rather than bridging the gap with a straight line, and buildings
+	// with missing nodes are skipped, as their outline would be wrong.
+	TArray<FOSMWayInfo> ResolvedWays;
+	ResolvedWays.Reserve( Ways.Num() );
+	WayNodeIndices.Reset( ResolvedNodeIndices.Num() );
+	for( const FOSMWayInfo& Way : Ways )
+	{
+		const int32 FirstResolvedIndex = Way.FirstNodeIndex;
+		const int32 LastResolvedIndex = Way.FirstNodeIndex + Way.NodeCount;
+
+		if( TagClassifier.GetRule( Way.TagRuleIndex ).bIsBuilding )
+		{
+			bool bHasAllNodes = true;
+			for( int32 ResolvedIndex = FirstResolvedIndex; bHasAllNodes && ResolvedIndex < LastResolvedIndex; ++ResolvedIndex )
 			{
-				CurrentWayInfo->WayType = EOSMWayType::Building;
+				bHasAllNodes = ResolvedNodeIndices[ ResolvedIndex ] != INDEX_NONE;
+			}
 
-				if( !FCString::Stricmp( AttributeValue, TEXT( "yes" ) ) )
-				{
-					CurrentWayInfo->WayType = EOSMWayType::Building;
-				}
-				else
-				{
-					// Other type that we don't recognize yet.  See http://wiki.openstreetmap.org/wiki/Key:building
-				}
+			if( bHasAllNodes )
+			{
+				FOSMWayInfo& NewWay = ResolvedWays.Add_GetRef( Way );
+				NewWay.FirstNodeIndex = WayNodeIndices.Num();
+				WayNodeIndices.Append( ResolvedNodeIndices.GetData() + FirstResolvedIndex, Way.NodeCount );
 			}
-			else if( !FCString::Stricmp( CurrentWayTagKey, TEXT( "height" ) ) )
+			continue;
+		}
+
+		int32 ResolvedIndex = FirstResolvedIndex;
+		while( ResolvedIndex < LastResolvedIndex )
+		{
+			// Skip over missing nodes, then find the end of the run of nodes that are present
+			while( ResolvedIndex < LastResolvedIndex && ResolvedNodeIndices[ ResolvedIndex ] == INDEX_NONE )
 			{
-				// Check to see if there is a space character in the height value.  For now, we're looking
-				// for straight-up floating point values.
-				if( !FString( AttributeValue ).Contains( TEXT( " " ) ) )
-				{
-					// Okay, no space character.  So this has got to be a floating point number.  The OSM
-					// spec says that the height values are in meters.
-					CurrentWayInfo->Height = FPlatformString::Atod( AttributeValue );
-				}
-				else
-				{
-					// Looks like the height value contains units of some sort.
-					// @todo: Add support for interpreting unit strings and converting the values
-				}
+				++ResolvedIndex;
 			}
-			else if (!FCString::Stricmp(CurrentWayTagKey, TEXT("building:levels")))
+			const int32 RunStart = ResolvedIndex;
+			while( ResolvedIndex < LastResolvedIndex && ResolvedNodeIndices[ ResolvedIndex ] != INDEX_NONE )
 			{
-				CurrentWayInfo->BuildingLevels = FPlatformString::Atoi(AttributeValue);
+				++ResolvedIndex;
 			}
-			else if( !FCString::Stricmp( CurrentWayTagKey, TEXT( "oneway" ) ) )
+
+			// A single node isn't much of a road.  Ways that are entirely present only have one run, so they come out
+			// exactly as they went in.
+			const int32 RunLength = ResolvedIndex - RunStart;
+			if( RunLength > 1 )
 			{
-				if( !FCString::Stricmp( AttributeValue, TEXT( "yes" ) ) )
-				{
-					CurrentWayInfo->bIsOneWay = true;
-				}
-				else
-				{
-					CurrentWayInfo->bIsOneWay = false;
-				}
+				FOSMWayInfo& NewWay = ResolvedWays.Add_GetRef( Way );
+				NewWay.FirstNodeIndex = WayNodeIndices.Num();
+				NewWay.NodeCount = RunLength;
+				WayNodeIndices.Append( ResolvedNodeIndices.GetData() + RunStart, RunLength );
 			}
 		}
 	}
+	Ways = MoveTemp( ResolvedWays );
 
-	return true;
-}
-
-
-bool FOSMFile::ProcessClose( const TCHAR* Element )
-{
-	if( ParsingState == ParsingState::Node )
-	{
-		NodeMap.Add( CurrentNodeID, CurrentNodeInfo );
-		CurrentNodeID = 0;
-		CurrentNodeInfo = nullptr;
-				
-		ParsingState = ParsingState::Root;
-	}
-	else if( ParsingState == ParsingState::Way )
+	// Link nodes back to the ways that reference them.  We count the references to each node first, so that
+	// all of the refs can be stored in a single array, grouped by node and in the same order the ways were parsed.
+	NodeWayRefOffsets.Reset();
+	NodeWayRefOffsets.SetNumZeroed( NodeIDs.Num() + 1 );
+	for( const int32 NodeIndex : WayNodeIndices )
 	{
-		Ways.Add( CurrentWayInfo );
-		CurrentWayInfo = nullptr;
-				
-		ParsingState = ParsingState::Root;
+		++NodeWayRefOffsets[ NodeIndex + 1 ];
 	}
-	else if( ParsingState == ParsingState::Way_NodeRef )
+	for( int32 NodeIndex = 0; NodeIndex < NodeIDs.Num(); ++NodeIndex )
 	{
-		ParsingState = ParsingState::Way;
+		NodeWayRefOffsets[ NodeIndex + 1 ] += NodeWayRefOffsets[ NodeIndex ];
 	}
-	else if( ParsingState == ParsingState::Way_Tag )
+
+	TArray<int32> NextWayRefs( NodeWayRefOffsets.GetData(), NodeIDs.Num() );
+	NodeWayRefs.SetNumUninitialized( WayNodeIndices.Num() );
+	for( int32 WayIndex = 0; WayIndex < Ways.Num(); ++WayIndex )
 	{
-		CurrentWayTagKey = TEXT( "" );
-		ParsingState = ParsingState::Way;
+		const FOSMWayInfo& Way = Ways[ WayIndex ];
+		for( int32 WayNodeIndex = 0; WayNodeIndex < Way.NodeCount; ++WayNodeIndex )
+		{
+			FOSMWayRef& NewWayRef = NodeWayRefs[ NextWayRefs[ WayNodeIndices[ Way.FirstNodeIndex + WayNodeIndex ] ]++ ];
+			NewWayRef.WayIndex = WayIndex;
+			NewWayRef.NodeIndex = WayNodeIndex;
+		}
 	}
-
-	return true;
 }
+
+#undef LOCTEXT_NAMESPACE
@@ -1,172 +1,197 @@
 #pragma once
-#include "FastXml.h"
+#include "CoreMinimal.h"
+#include "OSMClipRegion.h"
+#include "OSMNodeIdResolver.h"
+#include "OSMNodeIdSet.h"
+#include "OSMTagClassifier.h"
+#include "OSMXmlReader.h"
+
+class FOSMNodeSpill;
 
 /** OpenStreetMap file loader */
-class FOSMFile : public IFastXmlCallback
+class FOSMFile
 {
 	
 public:
 	
-	/** Default constructor for FOSMFile */
-	FOSMFile();
+	/** Creates a file loader that reads the file as described by the specified settings */
+	FOSMFile( const FStreetMapImportSettings& ImportSettings );
 
 	/** Destructor for FOSMFile */
 	virtual ~FOSMFile();
 
-	/** Loads the map from an OpenStreetMap XML file.  Note that in the case of the file path containing the XML data, the string must be mutable for us to parse it quickly. */
-	bool LoadOpenStreetMapFile( FString& OSMFilePath, const bool bIsFilePathActuallyTextBuffer, class FFeedbackContext* FeedbackContext );
+	/** Quickly scans the contents of an OpenStreetMap XML file for its element counts and bounds, in parallel.  For
+	    gzip-compressed files, only the start of the file is decompressed, to find its bounds. */
+	static void ScanOpenStreetMapFile( const TArrayView64<const uint8> Buffer, FOSMXmlSummary& OutSummary );
 
+	/** Loads the map from the contents of an OpenStreetMap XML file.  The buffer is tokenized in place, so it must stay valid until loading has finished.
+	    Large files are split at top-level element boundaries and the chunks are tokenized in parallel.  The summary from
+	    ScanOpenStreetMapFile is used to size our arrays up front, and provides the map's bounds if the file has them.
+	    Gzip-compressed files are decompressed on another thread while we parse them, a window at a time.
+	    Safe to call from any thread.  ProgressCallback receives the fraction loaded so far, and can return false to cancel. */
+	bool LoadOpenStreetMapFile( const TArrayView64<const uint8> Buffer, const FOSMXmlSummary& Summary, TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage );
 
-	struct FOSMWayInfo;
-		
-	/** Types of ways */
-	enum class EOSMWayType
-	{
-		///
-		/// ROADS
-		///
-		
-		/** A restricted access major divided highway, normally with 2 or more running lanes plus emergency hard shoulder. Equivalent to the Freeway, Autobahn, etc. */
-		Motorway,
+	/** Loads the map from the contents of an OpenStreetMap PBF (Protocolbuffer Binary Format) file.  Blocks in the file are decoded in parallel.
+	    Safe to call from any thread.  ProgressCallback receives the fraction loaded so far, and can return false to cancel. */
+	bool LoadOpenStreetMapPBFFile( const TArrayView64<const uint8> Buffer, TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage );
 
-		/** The link roads (sliproads/ramps) leading to/from a motorway from/to a motorway or lower class highway. Normally with the same motorway restrictions. */
-		Motorway_Link,
 
-		/** The most important roads in a country's system that aren't motorways. (Need not necessarily be a divided highway.) */
-		Trunk,
+	/** A string stored in one of our string pools */
+	struct FOSMStringRef
+	{
+		// Index of the first character in the pool
+		int32 Offset = 0;
 
-		/** The link roads (sliproads/ramps) leading to/from a trunk road from/to a trunk road or lower class highway. */
-		Trunk_Link,
+		// Number of characters
+		int32 Length = 0;
+	};
 
-		/** The next most important roads in a country's system. (Often link larger towns.) */
-		Primary,
 
-		/** The link roads (sliproads/ramps) leading to/from a primary road from/to a primary road or lower class highway. */
-		Primary_Link,
+	struct FOSMWayRef
+	{
+		// Index of the way that we're referencing at this node
+		int32 WayIndex;
+			
+		// Index of the node in the way's list of nodes
+		int32 NodeIndex;
+	};
+		
+		
+	/** A way.  This is plain data, so that millions of them can be stored contiguously.  Strings and node references
+	    are stored in pools owned by the file (or batch) the way belongs to. */
+	struct FOSMWayInfo
+	{
+		// OpenStreetMap ID of the way.  Roads that were cut into pieces share the ID of the way they came from.
+		int64 ID;
 
-		/** The next most important roads in a country's system. (Often link smaller towns and villages.) */
-		Secondary,
+		FOSMStringRef Name;
+		FOSMStringRef Ref;
 
-		/** The link roads (sliproads/ramps) leading to/from a secondary road from/to a secondary road or lower class highway. */
-		Secondary_Link,
+		// Range of the way's nodes in the WayNodeIndices pool (or the WayNodeIDs pool, while loading)
+		int32 FirstNodeIndex;
+		int32 NodeCount;
 
-		/** The next most important roads in a country's system. */
-		Tertiary,
+		// Index of the tag rule that decided what this way becomes.  Only ways with a rule that keeps them are stored.
+		int32 TagRuleIndex;
 
-		/** The link roads (sliproads/ramps) leading to/from a tertiary road from/to a tertiary road or lower class highway. */
-		Tertiary_Link,
+		double Height;
+		int32 BuildingLevels;
 
-		/** Roads which are primarily lined with and serve as an access to housing. */
-		Residential,
+		// If true, way is only traversable in the order its nodes are listed
+		uint8 bIsOneWay : 1;
+	};
 
-		/** For access roads to, or within an industrial estate, camp site, business park, car park etc. */
-		Service,
+	/** Decides what is read during a pass over the file, and what is kept */
+	struct FOSMReadOptions
+	{
+		FOSMReadOptions( const FOSMTagClassifier& InTagClassifier, const FOSMClipRegion& InClipRegion )
+			: TagClassifier( InTagClassifier ),
+			  ClipRegion( InClipRegion )
+		{
+		}
 
-		/** The least most important through roads in a country's system, i.e. minor roads of a lower classification than tertiary, but which serve a purpose other than access to properties. */
-		Unclassified,
+		/** Returns true if the specified node should be kept */
+		bool ShouldKeepNode( const int64 NodeID, const double Latitude, const double Longitude ) const
+		{
+			return bReadNodes && ClipRegion.Contains( Latitude, Longitude ) && ( NodeFilter == nullptr || NodeFilter->Contains( NodeID ) );
+		}
 
+		// Classifies the tags on each way
+		const FOSMTagClassifier& TagClassifier;
 
-		///
-		/// NON-ROADS
-		///
-		
-		/** Residential streets where pedestrians have legal priority over cars, speeds are kept very low and where children are allowed to play on the street. */
-		Living_Street,
+		// Nodes outside of this region are thrown away
+		const FOSMClipRegion& ClipRegion;
 
-		/** For roads used mainly/exclusively for pedestrians in shopping and some residential areas which may allow access by motorised vehicles only for very limited periods of the day. */
-		Pedestrian,
+		// Whether nodes are read in this pass
+		bool bReadNodes = true;
 
-		/** Roads for agricultural or forestry uses etc, often rough with unpaved/unsealed surfaces, that can be used only by off-road vehicles (4WD, tractors, ATVs, etc.) */
-		Track,
+		// Whether ways are read in this pass
+		bool bReadWays = true;
 
-		/** A busway where the vehicle guided by the way (though not a railway) and is not suitable for other traffic. */
-		Bus_Guideway,
+		// If set, only nodes in this set are kept
+		const FOSMNodeIdSet* NodeFilter = nullptr;
+	};
 
-		/** A course or track for (motor) racing */
-		Raceway,
+	/** Nodes and ways decoded from an independent part of the source file (on any thread), waiting to be merged into the map in file order */
+	struct FOSMBatch
+	{
+		// Node IDs, with coordinates stored in the matching elements of the latitude and longitude arrays
+		TArray<int64> NodeIDs;
+		TArray<double> NodeLatitudes;
+		TArray<double> NodeLongitudes;
 
-		/** A road where the mapper is unable to ascertain the classification from the information available. */
-		Road,
+		// Ways.  Their node ranges index into the WayNodeIDs array, and their strings into the StringPool.
+		TArray<FOSMWayInfo> Ways;
 
+		// IDs of the nodes referenced by all ways, in order
+		TArray<int64> WayNodeIDs;
 
-		///
-		/// PATHS
-		///
-		
-		/** For designated footpaths; i.e., mainly/exclusively for pedestrians. This includes walking tracks and gravel paths. */
-		Footway,
+		// Characters of all way names and refs
+		TArray<TCHAR> StringPool;
 
-		/** For designated cycleways. */
-		Cycleway,
+		/** Removes the most recently added node again, if the options say it shouldn't be kept */
+		void FinishNode( const FOSMReadOptions& Options );
 
-		/** Paths normally used by horses */
-		Bridleway,
+		/** Starts a new way with default settings */
+		FOSMWayInfo& AddWay();
 
-		/** For flights of steps (stairs) on footways. */
-		Steps,
+		/** Finishes the most recently added way.  Ways that none of the tag rules keep are removed again, along with
+		    their strings and node references, so they never take up memory. */
+		void FinishWay( const FOSMTagClassifier& TagClassifier );
 
-		/** A non-specific path. */
-		Path,
+		/** Adds a node reference to the end of the most recently added way */
+		void AddWayNodeID( const int64 NodeID )
+		{
+			WayNodeIDs.Add( NodeID );
+			++Ways.Last().NodeCount;
+		}
 
+		/** Updates a way using a tag ('k' and 'v' pair) from the OpenStreetMap file.  Tags from XML files still have their
+		    character entities in them, while tags from PBF files are plain UTF-8 and must be taken as they are. */
+		void ApplyWayTag( const FOSMTagClassifier& TagClassifier, FOSMWayInfo& Way, const FAnsiStringView Key, const FAnsiStringView Value, const bool bIsXmlEscaped );
 
-		///
-		/// LIFECYCLE
-		///
-		
-		/** For planned roads, use with proposed=* and also proposed=* with a value of the proposed highway value. */
-		Proposed,
+	private:
 
-		/** For roads under construction. */
-		Construction,
+		// Size of the string pool when the current way was started
+		int32 WayStringPoolStart = 0;
+	};
 
+	/** Adds everything in the batch to the map.  Batches must be merged in file order, so that the map comes out the same no matter how the file was split up. */
+	void MergeBatch( FOSMBatch& Batch );
 
-		///
-		/// BUILDINGS
-		///
+	/** Returns the indices of the nodes along the specified way */
+	TArrayView<const int32> GetWayNodeIndices( const FOSMWayInfo& Way ) const
+	{
+		return TArrayView<const int32>( WayNodeIndices.GetData() + Way.FirstNodeIndex, Way.NodeCount );
+	}
 
-		/** Default type of building.  A general catch-all. */
-		Building,
+	/** Returns the ways that pass through the specified node */
+	TArrayView<const FOSMWayRef> GetNodeWayRefs( const int32 NodeIndex ) const
+	{
+		return TArrayView<const FOSMWayRef>( NodeWayRefs.GetData() + NodeWayRefOffsets[ NodeIndex ], NodeWayRefOffsets[ NodeIndex + 1 ] - NodeWayRefOffsets[ NodeIndex ] );
+	}
 
+	/** Returns a string from the string pool */
+	FString GetString( const FOSMStringRef& String ) const
+	{
+		return FString( String.Length, StringPool.GetData() + String.Offset );
+	}
 
-		///
-		/// UNSUPPORTED
-		/// 
-		
-		/** Currently unrecognized type */
-		Other,
-	};
+	// Tag rules, compiled from the import settings
+	const FOSMTagClassifier TagClassifier;
 
+	// Area of the map to import
+	const FOSMClipRegion ClipRegion;
 
-	struct FOSMWayRef
-	{
-		// Way that we're referencing at this node
-		FOSMWayInfo* Way;
-			
-		// Index of the node in the way's array of nodes
-		int32 NodeIndex;
-	};
-		
-		
-	struct FOSMNodeInfo
-	{
-		double Latitude;
-		double Longitude;
-		TArray<FOSMWayRef> WayRefs;
-	};
-		
-		
-	struct FOSMWayInfo
-	{
-		FString Name;
-		FString Ref;
-		TArray<FOSMNodeInfo*> Nodes;
-		EOSMWayType WayType;
-		double Height;
-		int32 BuildingLevels;
+	// Whether we read the file twice, so that we only keep the nodes the ways we keep reference
+	const bool bOnlyKeepReferencedNodes;
 
-		// If true, way is only traversable in the order the nodes are listed in the Nodes list
-		uint8 bIsOneWay : 1;
-	};
+	// Whether nodes are spilled to disk while the file is read, and joined with the ways afterwards
+	const bool bOutOfCoreNodes;
+
+	// How many bytes of nodes are held in memory at once while importing out of core.  The ways' node references
+	// aren't included.
+	const int64 OutOfCoreNodeMemoryBudget;
 
 	// Minimum latitude/longitude bounds
 	double MinLatitude = MAX_dbl;
@@ -174,51 +199,75 @@ public:
 	double MaxLatitude = -MAX_dbl;
 	double MaxLongitude = -MAX_dbl;
 
+	// Whether the bounds above came from the file itself, rather than from the nodes we kept
+	bool bHasBoundsFromFile = false;
+
 	// Average Latitude (roughly the center of the map)
 	double AverageLatitude = 0.0;
 	double AverageLongitude = 0.0;
-		
+
+	// Every node we've parsed is stored at the same index in each of these arrays
+	TArray<int64> NodeIDs;
+	TArray<double> NodeLatitudes;
+	TArray<double> NodeLongitudes;
+
 	// All ways we've parsed
-	TArray<FOSMWayInfo*> Ways;
+	TArray<FOSMWayInfo> Ways;
+
+	// Indices of the nodes along all ways.  Each way owns a contiguous range of this array.
+	TArray<int32> WayNodeIndices;
+
+	// IDs of the nodes along all ways, as they were listed in the file.  Only used while loading.  Once all nodes
+	// are known, the IDs are resolved into WayNodeIndices in one go.
+	TArray<int64> WayNodeIDs;
+
+	// Characters of all way names and refs
+	TArray<TCHAR> StringPool;
+
+	// For each node, the offset of its first entry in NodeWayRefs.  Has one extra element at the end, so that
+	// the refs for a node always end at the next node's offset.  Built once loading has finished.
+	TArray<int32> NodeWayRefOffsets;
+
+	// References from nodes back to the ways that pass through them, grouped by node
+	TArray<FOSMWayRef> NodeWayRefs;
 		
-	// Maps node IDs to info about each node
-	TMap<int64, FOSMNodeInfo*> NodeMap;
+	// Maps node IDs to indices in the node arrays
+	FOSMNodeIdResolver NodeIdResolver;
+
+	// While importing out of core, the nodes that have been read so far
+	TUniquePtr<FOSMNodeSpill> NodeSpill;
 
 protected:
 
-	// IFastXmlCallback overrides
-	virtual bool ProcessXmlDeclaration( const TCHAR* ElementData, int32 XmlFileLineNumber ) override;
-	virtual bool ProcessComment( const TCHAR* Comment ) override;
-	virtual bool ProcessElement( const TCHAR* ElementName, const TCHAR* ElementData, int32 XmlFileLineNumber ) override;
-	virtual bool ProcessAttribute( const TCHAR* AttributeName, const TCHAR* AttributeValue ) override;
-	virtual bool ProcessClose( const TCHAR* Element ) override;
+	/** Tokenizes an XML file once, merging everything the options ask for.  Progress is reported as a fraction of this pass. */
+	bool ReadXmlPass( const TArrayView64<const uint8> Buffer, const FOSMReadOptions& Options, TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage, int64& OutErrorLineNumber );
 
-	
-protected:
-	
-	enum class ParsingState
-	{
-		Root,
-		Node,
-		Way,
-		Way_NodeRef,
-		Way_Tag
-	};
-		
-	// Current state of parser
-	ParsingState ParsingState;
-		
-	// ID of node that is currently being parsed
-	int64 CurrentNodeID;
-		
-	// Node that is currently being parsed
-	FOSMNodeInfo* CurrentNodeInfo;
-		
-	// Way that is currently being parsed
-	FOSMWayInfo* CurrentWayInfo;
-		
-	// Current way's tag key string
-	const TCHAR* CurrentWayTagKey;
+	/** Same as ReadXmlPass, but for a gzip-compressed file.  The file is parsed in windows as it's decompressed.  Imports
+	    that take two passes decompress the file again for the second one, rather than keeping the decompressed file around. */
+	bool ReadCompressedXmlPass( const TArrayView64<const uint8> CompressedBuffer, const FOSMReadOptions& Options, TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage, int64& OutErrorLineNumber );
+
+	/** Tokenizes the specified chunks of an XML buffer in parallel, then merges them in order.  On failure, the line
+	    number is relative to the start of the buffer. */
+	bool ReadXmlChunks( const TArrayView64<const uint8> Buffer, const TArrayView<const int64> ChunkOffsets, const FOSMReadOptions& Options, FText& OutErrorMessage, int64& OutErrorLineNumber );
+
+	/** Decodes a PBF file once, merging everything the options ask for.  Progress is reported as a fraction of this pass. */
+	bool ReadPbfPass( const TArrayView64<const uint8> Buffer, const FOSMReadOptions& Options, TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage );
+
+	/** Builds the set of nodes referenced by the ways we've read so far, and makes room for that many nodes */
+	void BuildReferencedNodeSet( FOSMNodeIdSet& OutNodeSet );
+
+	/** Called after all batches have been merged.  Computes the average location, resolves the node IDs referenced
+	    by ways, cuts ways where their nodes are missing and links nodes back to their ways. */
+	void FinishLoading();
+
+	/** Called instead of FinishLoading when importing out of core.  Sorts the node IDs referenced by ways, then reads
+	    the spilled nodes back in ID order and resolves the references in the same sweep, keeping only the nodes that
+	    are referenced.  ProgressCallback receives the fraction of the nodes read back so far, and can return false to cancel. */
+	bool FinishLoadingFromSpill( TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage );
+
+	/** Compacts the resolved node indices of every way into WayNodeIndices, cutting ways where their nodes are
+	    missing, then links nodes back to their ways */
+	void FinishWays( const TArrayView<const int32> ResolvedNodeIndices );
 };
 
 
@@ -0,0 +1,201 @@
+#include "OSMGzipStream.h"
+#include "Async/Async.h"
+#include "HAL/Event.h"
+#include "Misc/ScopeLock.h"
+
+THIRD_PARTY_INCLUDES_START
+#include "zlib.h"
+THIRD_PARTY_INCLUDES_END
+
+#define LOCTEXT_NAMESPACE "StreetMapImporting"
+
+namespace OSMGzipStream
+{
+	/** Returns true if data is nothing but zeros.  Some tools pad gzip files out to a block size with zeros after
+	    the last member, which gzip itself ignores. */
+	static bool IsZeroPadding( const TArrayView64<const uint8> Data )
+	{
+		for( const uint8 Byte : Data )
+		{
+			if( Byte != 0 )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+FOSMGzipStream::FOSMGzipStream( const TArrayView64<const uint8> InCompressedData, const int64 InWindowSize, const int32 InMaxQueuedWindows )
+	: CompressedData( InCompressedData ),
+	  WindowSize( InWindowSize ),
+	  MaxQueuedWindows( FMath::Max( InMaxQueuedWindows, 1 ) ),
+	  bFinished( false ),
+	  WindowQueuedEvent( FPlatformProcess::GetSynchEventFromPool( false ) ),
+	  WindowTakenEvent( FPlatformProcess::GetSynchEventFromPool( false ) ),
+	  bStopRequested( false ),
+	  CompressedBytesRead( 0 )
+{
+	// Decompression runs on a thread of its own rather than the task graph, which the parser keeps busy
+	Future = Async( EAsyncExecution::Thread, [this]() { Decompress(); } );
+}
+
+
+FOSMGzipStream::~FOSMGzipStream()
+{
+	bStopRequested = true;
+	WindowTakenEvent->Trigger();
+	Future.Wait();
+
+	FPlatformProcess::ReturnSynchEventToPool( WindowQueuedEvent );
+	FPlatformProcess::ReturnSynchEventToPool( WindowTakenEvent );
+}
+
+
+bool FOSMGzipStream::ReadWindow( TArray64<uint8>& OutWindow, FText& OutErrorMessage )
+{
+	for( ;; )
+	{
+		{
+			FScopeLock Lock( &QueueLock );
+			if( QueuedWindows.Num() > 0 )
+			{
+				OutWindow = MoveTemp( QueuedWindows[ 0 ] );
+				QueuedWindows.RemoveAt( 0 );
+				WindowTakenEvent->Trigger();
+				return true;
+			}
+
+			if( bFinished )
+			{
+				OutWindow.Reset();
+				OutErrorMessage = ErrorMessage;
+				return ErrorMessage.IsEmpty();
+			}
+		}
+
+		WindowQueuedEvent->Wait();
+	}
+}
+
+
+void FOSMGzipStream::Decompress()
+{
+	z_stream Stream;
+	FMemory::Memzero( Stream );
+
+	// Adding 16 to the window bits tells zlib to expect a gzip header and trailer, rather than a raw zlib stream
+	if( inflateInit2( &Stream, 16 + MAX_WBITS ) != Z_OK )
+	{
+		Finish( LOCTEXT( "GzipStream_InitFailed", "Unable to start decompressing the file" ) );
+		return;
+	}
+
+	// zlib counts bytes with 32-bit integers, so huge files (and windows) are handled a piece at a time
+	const int64 MaxBytesPerCall = 1024 * 1024 * 1024;
+	int64 InputOffset = 0;
+
+	FText DecompressErrorMessage;
+	bool bAtEnd = false;
+	while( !bAtEnd && !bStopRequested && DecompressErrorMessage.IsEmpty() )
+	{
+		TArray64<uint8> Window;
+		Window.SetNumUninitialized( WindowSize );
+		int64 WindowBytes = 0;
+		while( WindowBytes < WindowSize && !bAtEnd && DecompressErrorMessage.IsEmpty() )
+		{
+			if( Stream.avail_in == 0 && InputOffset < CompressedData.Num() )
+			{
+				const int64 InputSize = FMath::Min( CompressedData.Num() - InputOffset, MaxBytesPerCall );
+				Stream.next_in = const_cast<Bytef*>( CompressedData.GetData() + InputOffset );
+				Stream.avail_in = uInt( InputSize );
+				InputOffset += InputSize;
+			}
+
+			Stream.next_out = Window.GetData() + WindowBytes;
+			Stream.avail_out = uInt( FMath::Min( WindowSize - WindowBytes, MaxBytesPerCall ) );
+			const uInt OutputSize = Stream.avail_out;
+
+			const int Result = inflate( &Stream, Z_NO_FLUSH );
+			WindowBytes += OutputSize - Stream.avail_out;
+			CompressedBytesRead = InputOffset - Stream.avail_in;
+
+			const bool bInputExhausted = Stream.avail_in == 0 && InputOffset == CompressedData.Num();
+			if( Result == Z_STREAM_END )
+			{
+				// Files made by concatenating gzip files (which some tools do to compress in parallel) have several
+				// members, one after the other.  Zeros after the last member are padding, not another member.
+				const int64 MemberEndOffset = InputOffset - Stream.avail_in;
+				if( bInputExhausted || OSMGzipStream::IsZeroPadding( CompressedData.Slice( MemberEndOffset, CompressedData.Num() - MemberEndOffset ) ) )
+				{
+					CompressedBytesRead = CompressedData.Num();
+					bAtEnd = true;
+				}
+				else
+				{
+					inflateReset( &Stream );
+				}
+			}
+			else if( Result == Z_BUF_ERROR && bInputExhausted )
+			{
+				DecompressErrorMessage = LOCTEXT( "GzipStream_Truncated", "The compressed file ends unexpectedly" );
+			}
+			else if( Result != Z_OK && Result != Z_BUF_ERROR )
+			{
+				DecompressErrorMessage = FText::Format( LOCTEXT( "GzipStream_Damaged", "The compressed file is damaged ({0})" ), FText::FromString( ANSI_TO_TCHAR( Stream.msg != nullptr ? Stream.msg : "unknown error" ) ) );
+			}
+		}
+
+		if( WindowBytes > 0 )
+		{
+			const bool bAllowShrinking = false;
+			Window.SetNum( WindowBytes, bAllowShrinking );
+			if( !QueueWindow( MoveTemp( Window ) ) )
+			{
+				break;
+			}
+		}
+	}
+
+	inflateEnd( &Stream );
+	Finish( DecompressErrorMessage );
+}
+
+
+bool FOSMGzipStream::QueueWindow( TArray64<uint8>&& Window )
+{
+	for( ;; )
+	{
+		if( bStopRequested )
+		{
+			return false;
+		}
+
+		{
+			FScopeLock Lock( &QueueLock );
+			if( QueuedWindows.Num() < MaxQueuedWindows )
+			{
+				QueuedWindows.Add( MoveTemp( Window ) );
+				break;
+			}
+		}
+
+		WindowTakenEvent->Wait();
+	}
+
+	WindowQueuedEvent->Trigger();
+	return true;
+}
+
+
+void FOSMGzipStream::Finish( const FText& InErrorMessage )
+{
+	{
+		FScopeLock Lock( &QueueLock );
+		bFinished = true;
+		ErrorMessage = InErrorMessage;
+	}
+	WindowQueuedEvent->Trigger();
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,88 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "HAL/CriticalSection.h"
+#include <atomic>
+
+/** Decompresses a gzip-compressed OpenStreetMap file (.osm.gz) in fixed-size windows.  A thread of its own decompresses
+    ahead of whoever is reading, so decompression overlaps with parsing, and only a few windows are ever held in memory.
+    The decompressed file as a whole is never stored anywhere. */
+class FOSMGzipStream
+{
+
+public:
+
+	/** Returns true if the data starts with a gzip header */
+	static bool IsGzipData( const TArrayView64<const uint8> Data )
+	{
+		return Data.Num() >= 2 && Data[ 0 ] == 0x1f && Data[ 1 ] == 0x8b;
+	}
+
+	/**
+	 * Starts decompressing
+	 *
+	 * @param	InCompressedData		The compressed file.  Must stay valid until this stream is destroyed.
+	 * @param	InWindowSize			Size of each window of decompressed data, except for the last one
+	 * @param	InMaxQueuedWindows		How many windows may be decompressed ahead of the reader
+	 */
+	FOSMGzipStream( const TArrayView64<const uint8> InCompressedData, const int64 InWindowSize, const int32 InMaxQueuedWindows );
+
+	/** Destructor for FOSMGzipStream.  Stops decompressing, if we haven't finished yet. */
+	~FOSMGzipStream();
+
+	/** Waits for the next window of decompressed data.  OutWindow is left empty once everything has been read.  Returns
+	    false if the compressed data is damaged. */
+	bool ReadWindow( TArray64<uint8>& OutWindow, FText& OutErrorMessage );
+
+	/** Returns how much of the compressed data has been decompressed so far, from 0 to 1 */
+	float GetProgress() const
+	{
+		return float( double( CompressedBytesRead.load() ) / double( FMath::Max<int64>( CompressedData.Num(), 1 ) ) );
+	}
+
+
+private:
+
+	// Non-copyable
+	FOSMGzipStream( const FOSMGzipStream& ) = delete;
+	FOSMGzipStream& operator=( const FOSMGzipStream& ) = delete;
+
+	/** Decompresses everything, one window at a time.  Runs on its own thread. */
+	void Decompress();
+
+	/** Hands a window to the reader, waiting for room if too many are queued up.  Returns false if we should stop. */
+	bool QueueWindow( TArray64<uint8>&& Window );
+
+	/** Lets the reader know that there won't be any more windows */
+	void Finish( const FText& InErrorMessage );
+
+	// The compressed file
+	const TArrayView64<const uint8> CompressedData;
+
+	// Size of each window, and how many can be waiting for the reader
+	const int64 WindowSize;
+	const int32 MaxQueuedWindows;
+
+	// Protects everything below that the reader and the decompression thread share
+	FCriticalSection QueueLock;
+
+	// Windows waiting for the reader, oldest first
+	TArray<TArray64<uint8>> QueuedWindows;
+
+	// Set once the decompression thread is done, along with what went wrong (if anything)
+	bool bFinished;
+	FText ErrorMessage;
+
+	// Triggered when a window is queued, and when one is taken
+	FEvent* WindowQueuedEvent;
+	FEvent* WindowTakenEvent;
+
+	// Set when the reader goes away before we're done
+	std::atomic<bool> bStopRequested;
+
+	// Compressed bytes decompressed so far
+	std::atomic<int64> CompressedBytesRead;
+
+	// Completes when the decompression thread is done
+	TFuture<void> Future;
+};
@@ -0,0 +1,222 @@
+#include "OSMNodeIdResolver.h"
+#include "Async/ParallelFor.h"
+
+namespace OSMNodeIdResolver
+{
+	// Number of interpolation steps we'll take before falling back to a binary search.  Interpolation converges
+	// very quickly on evenly distributed IDs, but can degrade badly on clustered ones.
+	static const int32 MaxInterpolationSteps = 4;
+
+	// Number of lookups each task performs in FindAll
+	static const int32 LookupsPerTask = 64 * 1024;
+
+	/** Maps a signed ID to an unsigned key with the same ordering, so that negative IDs (used by editors for
+	    objects that haven't been uploaded yet) sort before positive ones */
+	static inline uint64 ToRadixKey( const int64 NodeID )
+	{
+		return uint64( NodeID ) ^ ( uint64( 1 ) << 63 );
+	}
+
+	/** Stable LSD radix sort of IDs, carrying their original indices along with them */
+	static void RadixSort( const TArrayView<const int64> NodeIDs, TArray<int64>& OutSortedIDs, TArray<int32>& OutSortedIndices )
+	{
+		const int32 Count = NodeIDs.Num();
+		const int32 RadixBits = 16;
+		const int32 RadixSize = 1 << RadixBits;
+		const int32 PassCount = 64 / RadixBits;
+
+		TArray<uint64> Keys;
+		TArray<int32> Indices;
+		Keys.SetNumUninitialized( Count );
+		Indices.SetNumUninitialized( Count );
+		for( int32 Index = 0; Index < Count; ++Index )
+		{
+			Keys[ Index ] = ToRadixKey( NodeIDs[ Index ] );
+			Indices[ Index ] = Index;
+		}
+
+		TArray<uint64> ScratchKeys;
+		TArray<int32> ScratchIndices;
+		ScratchKeys.SetNumUninitialized( Count );
+		ScratchIndices.SetNumUninitialized( Count );
+
+		TArray<int32> Offsets;
+		Offsets.SetNumUninitialized( RadixSize );
+		for( int32 Pass = 0; Pass < PassCount; ++Pass )
+		{
+			const int32 Shift = Pass * RadixBits;
+
+			FMemory::Memzero( Offsets.GetData(), RadixSize * sizeof( int32 ) );
+			for( const uint64 Key : Keys )
+			{
+				++Offsets[ ( Key >> Shift ) & ( RadixSize - 1 ) ];
+			}
+
+			// Node IDs rarely use all 64 bits, so the upper passes are usually no-ops that we can skip
+			if( Offsets[ ( Keys[ 0 ] >> Shift ) & ( RadixSize - 1 ) ] == Count )
+			{
+				continue;
+			}
+
+			int32 Total = 0;
+			for( int32& Offset : Offsets )
+			{
+				const int32 BucketCount = Offset;
+				Offset = Total;
+				Total += BucketCount;
+			}
+
+			for( int32 Index = 0; Index < Count; ++Index )
+			{
+				const int32 Destination = Offsets[ ( Keys[ Index ] >> Shift ) & ( RadixSize - 1 ) ]++;
+				ScratchKeys[ Destination ] = Keys[ Index ];
+				ScratchIndices[ Destination ] = Indices[ Index ];
+			}
+
+			Swap( Keys, ScratchKeys );
+			Swap( Indices, ScratchIndices );
+		}
+
+		OutSortedIDs.SetNumUninitialized( Count );
+		for( int32 Index = 0; Index < Count; ++Index )
+		{
+			OutSortedIDs[ Index ] = NodeIDs[ Indices[ Index ] ];
+		}
+		OutSortedIndices = MoveTemp( Indices );
+	}
+}
+
+
+void FOSMNodeIdResolver::Build( const TArrayView<const int64> NodeIDs )
+{
+	using namespace OSMNodeIdResolver;
+
+	Reset();
+
+	bool bIsSorted = true;
+	for( int32 Index = 1; Index < NodeIDs.Num(); ++Index )
+	{
+		// Duplicates count as unsorted, so that the stable sort can put the last one at the end of its run
+		if( NodeIDs[ Index ] <= NodeIDs[ Index - 1 ] )
+		{
+			bIsSorted = false;
+			break;
+		}
+	}
+
+	if( bIsSorted )
+	{
+		IDs = NodeIDs;
+	}
+	else
+	{
+		RadixSort( NodeIDs, SortedIDs, SortedIndices );
+		IDs = SortedIDs;
+	}
+}
+
+
+void FOSMNodeIdResolver::Sort( const TArrayView<const int64> NodeIDs, TArray<int64>& OutSortedIDs, TArray<int32>& OutSortedIndices )
+{
+	if( NodeIDs.Num() == 0 )
+	{
+		OutSortedIDs.Reset();
+		OutSortedIndices.Reset();
+		return;
+	}
+
+	OSMNodeIdResolver::RadixSort( NodeIDs, OutSortedIDs, OutSortedIndices );
+}
+
+
+void FOSMNodeIdResolver::Reset()
+{
+	IDs = TArrayView<const int64>();
+	SortedIDs.Empty();
+	SortedIndices.Empty();
+}
+
+
+int32 FOSMNodeIdResolver::Find( const int64 NodeID ) const
+{
+	using namespace OSMNodeIdResolver;
+
+	int32 Low = 0;
+	int32 High = IDs.Num() - 1;
+	if( High < 0 || NodeID < IDs[ Low ] || NodeID > IDs[ High ] )
+	{
+		return INDEX_NONE;
+	}
+
+	// Interpolation search first.  Sorted OSM IDs are usually dense enough that this lands on or very near the
+	// node straight away.
+	for( int32 Step = 0; Step < MaxInterpolationSteps && Low < High && IDs[ Low ] != IDs[ High ]; ++Step )
+	{
+		const double Fraction = double( NodeID - IDs[ Low ] ) / double( IDs[ High ] - IDs[ Low ] );
+		const int32 Probe = Low + FMath::Clamp( int32( Fraction * double( High - Low ) ), 0, High - Low );
+		const int64 ProbeID = IDs[ Probe ];
+		if( ProbeID < NodeID )
+		{
+			Low = Probe + 1;
+		}
+		else if( ProbeID > NodeID )
+		{
+			High = Probe - 1;
+		}
+		else
+		{
+			Low = High = Probe;
+		}
+
+		if( Low > High || NodeID < IDs[ Low ] || NodeID > IDs[ High ] )
+		{
+			return INDEX_NONE;
+		}
+	}
+
+	// Then binary search for the last element that isn't greater than the ID
+	while( Low < High )
+	{
+		const int32 Middle = Low + ( High - Low + 1 ) / 2;
+		if( IDs[ Middle ] > NodeID )
+		{
+			High = Middle - 1;
+		}
+		else
+		{
+			Low = Middle;
+		}
+	}
+
+	// Interpolation may have landed on any element of a run of duplicates.  The last one wins.
+	while( Low + 1 < IDs.Num() && IDs[ Low + 1 ] == NodeID )
+	{
+		++Low;
+	}
+
+	if( IDs[ Low ] != NodeID )
+	{
+		return INDEX_NONE;
+	}
+
+	return SortedIndices.Num() > 0 ? SortedIndices[ Low ] : Low;
+}
+
+
+void FOSMNodeIdResolver::FindAll( const TArrayView<const int64> NodeIDs, TArrayView<int32> OutIndices ) const
+{
+	using namespace OSMNodeIdResolver;
+
+	check( NodeIDs.Num() == OutIndices.Num() );
+
+	const int32 TaskCount = FMath::DivideAndRoundUp( NodeIDs.Num(), LookupsPerTask );
+	ParallelFor( TaskCount, [this, NodeIDs, OutIndices]( const int32 TaskIndex ) mutable
+	{
+		const int32 First = TaskIndex * LookupsPerTask;
+		const int32 Last = FMath::Min( First + LookupsPerTask, NodeIDs.Num() );
+		for( int32 Index = First; Index < Last; ++Index )
+		{
+			OutIndices[ Index ] = Find( NodeIDs[ Index ] );
+		}
+	} );
+}
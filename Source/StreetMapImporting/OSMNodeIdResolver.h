@@ -0,0 +1,47 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/** Maps OpenStreetMap node IDs to the indices the nodes were stored at.  OSM extracts almost always list nodes in
+    ascending ID order, in which case we search the IDs where they are.  Otherwise we radix sort a copy of them once.
+    Either way a lookup is a search over a dense array rather than a probe into a huge hash table. */
+class FOSMNodeIdResolver
+{
+
+public:
+
+	/** Builds the resolver.  When the IDs are already sorted, they are referenced rather than copied, so the array
+	    must outlive the resolver and must not be changed until Build is called again. */
+	void Build( const TArrayView<const int64> NodeIDs );
+
+	/** Releases all memory */
+	void Reset();
+
+	/** Returns the index of the node with the specified ID, or INDEX_NONE if there isn't one.  If the same ID was
+	    listed more than once, the last index wins. */
+	int32 Find( const int64 NodeID ) const;
+
+	/** Looks up many IDs at once, on all available cores.  OutIndices must be the same size as NodeIDs. */
+	void FindAll( const TArrayView<const int64> NodeIDs, TArrayView<int32> OutIndices ) const;
+
+	/** Sorts IDs into ascending order, along with the index each one had in NodeIDs.  The sort is stable, so the
+	    indices of equal IDs stay in ascending order too. */
+	static void Sort( const TArrayView<const int64> NodeIDs, TArray<int64>& OutSortedIDs, TArray<int32>& OutSortedIndices );
+
+	/** Returns true if the IDs we were built from were already in ascending order */
+	bool WasSorted() const
+	{
+		return SortedIndices.Num() == 0;
+	}
+
+
+private:
+
+	// Sorted node IDs.  Points either at the caller's array or at our own SortedIDs copy.
+	TArrayView<const int64> IDs;
+
+	// Copy of the IDs in ascending order.  Only used when the IDs we were given weren't sorted.
+	TArray<int64> SortedIDs;
+
+	// For each element of SortedIDs, the index the ID had in the original array.  Empty if the IDs were already sorted.
+	TArray<int32> SortedIndices;
+};
@@ -0,0 +1,106 @@
+#include "OSMNodeIdSet.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+
+namespace OSMNodeIdSet
+{
+	// Each block covers this many bits worth of IDs
+	static const int32 BlockBits = 16;
+
+	// Number of 64-bit words in a block's bitmap
+	static const int32 BitmapWordCount = ( 1 << BlockBits ) / 64;
+
+	// Blocks with more IDs than this are smaller as a bitmap than as a list of 16-bit offsets
+	static const int32 MaxSparseBlockCount = BitmapWordCount * 4;
+}
+
+
+void FOSMNodeIdSet::Build( const TArrayView<const int64> NodeIDs )
+{
+	using namespace OSMNodeIdSet;
+
+	BlockKeys.Reset();
+	Blocks.Reset();
+	Offsets.Reset();
+	Bitmaps.Reset();
+	IDCount = 0;
+
+	TArray<int64> SortedIDs( NodeIDs.GetData(), NodeIDs.Num() );
+	Algo::Sort( SortedIDs );
+
+	int32 Index = 0;
+	while( Index < SortedIDs.Num() )
+	{
+		// Find the end of this block's run of IDs, counting unique IDs as we go
+		const int64 BlockKey = SortedIDs[ Index ] >> BlockBits;
+		int32 BlockEnd = Index;
+		int32 UniqueCount = 0;
+		while( BlockEnd < SortedIDs.Num() && ( SortedIDs[ BlockEnd ] >> BlockBits ) == BlockKey )
+		{
+			if( BlockEnd == Index || SortedIDs[ BlockEnd ] != SortedIDs[ BlockEnd - 1 ] )
+			{
+				++UniqueCount;
+			}
+			++BlockEnd;
+		}
+
+		FBlock& NewBlock = Blocks.AddDefaulted_GetRef();
+		NewBlock.Count = UniqueCount;
+		NewBlock.bIsBitmap = UniqueCount > MaxSparseBlockCount;
+		BlockKeys.Add( BlockKey );
+
+		const int64 LowMask = ( int64( 1 ) << BlockBits ) - 1;
+		if( NewBlock.bIsBitmap )
+		{
+			NewBlock.FirstIndex = Bitmaps.Num();
+			Bitmaps.AddZeroed( BitmapWordCount );
+			uint64* Words = Bitmaps.GetData() + NewBlock.FirstIndex;
+			for( int32 IDIndex = Index; IDIndex < BlockEnd; ++IDIndex )
+			{
+				const int32 Low = int32( SortedIDs[ IDIndex ] & LowMask );
+				Words[ Low >> 6 ] |= uint64( 1 ) << ( Low & 63 );
+			}
+		}
+		else
+		{
+			NewBlock.FirstIndex = Offsets.Num();
+			for( int32 IDIndex = Index; IDIndex < BlockEnd; ++IDIndex )
+			{
+				if( IDIndex == Index || SortedIDs[ IDIndex ] != SortedIDs[ IDIndex - 1 ] )
+				{
+					Offsets.Add( uint16( SortedIDs[ IDIndex ] & LowMask ) );
+				}
+			}
+		}
+
+		IDCount += UniqueCount;
+		Index = BlockEnd;
+	}
+
+	BlockKeys.Shrink();
+	Blocks.Shrink();
+	Offsets.Shrink();
+	Bitmaps.Shrink();
+}
+
+
+bool FOSMNodeIdSet::Contains( const int64 NodeID ) const
+{
+	using namespace OSMNodeIdSet;
+
+	const int32 BlockIndex = Algo::BinarySearch( BlockKeys, NodeID >> BlockBits );
+	if( BlockIndex == INDEX_NONE )
+	{
+		return false;
+	}
+
+	const FBlock& Block = Blocks[ BlockIndex ];
+	const int32 Low = int32( NodeID & ( ( int64( 1 ) << BlockBits ) - 1 ) );
+	if( Block.bIsBitmap )
+	{
+		return ( Bitmaps[ Block.FirstIndex + ( Low >> 6 ) ] & ( uint64( 1 ) << ( Low & 63 ) ) ) != 0;
+	}
+
+	const TArrayView<const uint16> BlockOffsets( Offsets.GetData() + Block.FirstIndex, Block.Count );
+	return Algo::BinarySearch( BlockOffsets, uint16( Low ) ) != INDEX_NONE;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/** Compact, read-only set of OpenStreetMap node IDs, used to decide which nodes are worth keeping while importing.
+
+    IDs are grouped by their upper bits into blocks of 65536.  Blocks with only a few IDs store them as a sorted
+    list of 16-bit offsets, and crowded blocks store a 65536-bit bitmap instead, so the set never uses much more
+    than two bytes per ID no matter how the IDs are spread out. */
+class FOSMNodeIdSet
+{
+
+public:
+
+	/** Builds the set from the specified IDs, which may be in any order and may contain duplicates */
+	void Build( const TArrayView<const int64> NodeIDs );
+
+	/** Returns true if the specified ID is in the set.  Safe to call from any thread. */
+	bool Contains( const int64 NodeID ) const;
+
+	/** Returns the number of unique IDs in the set */
+	int64 Num() const
+	{
+		return IDCount;
+	}
+
+	/** Returns the number of bytes used by the set */
+	SIZE_T GetAllocatedSize() const
+	{
+		return BlockKeys.GetAllocatedSize() + Blocks.GetAllocatedSize() + Offsets.GetAllocatedSize() + Bitmaps.GetAllocatedSize();
+	}
+
+
+private:
+
+	struct FBlock
+	{
+		// Index of the block's first element in either the Offsets or the Bitmaps array
+		int32 FirstIndex;
+
+		// Number of IDs in the block
+		int32 Count;
+
+		// Whether the block is stored as a bitmap, as opposed to a list of offsets
+		bool bIsBitmap;
+	};
+
+	// Upper bits of the IDs in each block, sorted
+	TArray<int64> BlockKeys;
+
+	// Blocks, in the same order as BlockKeys
+	TArray<FBlock> Blocks;
+
+	// Sorted lower bits of the IDs in each sparse block
+	TArray<uint16> Offsets;
+
+	// Bits for each dense block
+	TArray<uint64> Bitmaps;
+
+	// Number of unique IDs in the set
+	int64 IDCount = 0;
+};
@@ -0,0 +1,246 @@
+#include "OSMNodeSpill.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+#define LOCTEXT_NAMESPACE "StreetMapImporting"
+
+namespace OSMNodeSpill
+{
+	// Fewest nodes we'll buffer, however small the memory budget is
+	static const int32 MinBufferCapacity = 64 * 1024;
+
+	// Fewest nodes we'll read from a run at a time, however many runs share the memory budget
+	static const int32 MinReadCapacity = 4 * 1024;
+
+	/** Returns the directory that run files are written to */
+	static FString GetSpillDirectory()
+	{
+		return FPaths::Combine( FPaths::ProjectIntermediateDir(), TEXT( "StreetMap" ) );
+	}
+}
+
+
+FOSMNodeSpill::FOSMNodeSpill( const int64 MemoryBudget )
+	: BufferCapacity( int32( FMath::Clamp<int64>( MemoryBudget / sizeof( FNode ), OSMNodeSpill::MinBufferCapacity, MAX_int32 ) ) )
+{
+}
+
+
+FOSMNodeSpill::~FOSMNodeSpill()
+{
+	RunWriter.Reset();
+	for( const FRun& Run : Runs )
+	{
+		IFileManager::Get().Delete( *Run.FilePath, false, false, true );
+	}
+}
+
+
+void FOSMNodeSpill::Add( const TArrayView<const int64> NodeIDs, const TArrayView<const double> Latitudes, const TArrayView<const double> Longitudes )
+{
+	check( NodeIDs.Num() == Latitudes.Num() && NodeIDs.Num() == Longitudes.Num() );
+
+	for( int32 Index = 0; Index < NodeIDs.Num(); ++Index )
+	{
+		if( Buffer.Num() == BufferCapacity )
+		{
+			FlushBuffer();
+		}
+
+		// Only allocate as much of the budget as we actually use
+		if( Buffer.Max() == 0 )
+		{
+			Buffer.Reserve( FMath::Min( BufferCapacity, FMath::Max( NodeIDs.Num(), OSMNodeSpill::MinBufferCapacity ) ) );
+		}
+
+		FNode& Node = Buffer.AddUninitialized_GetRef();
+		Node.ID = NodeIDs[ Index ];
+		Node.Latitude = Latitudes[ Index ];
+		Node.Longitude = Longitudes[ Index ];
+	}
+
+	NodeCount += NodeIDs.Num();
+}
+
+
+void FOSMNodeSpill::FlushBuffer()
+{
+	if( Buffer.Num() == 0 || !FailedFilePath.IsEmpty() )
+	{
+		Buffer.Reset();
+		return;
+	}
+
+	// The sort is stable, so that nodes with the same ID stay in the order they were added
+	bool bIsSorted = true;
+	for( int32 Index = 1; bIsSorted && Index < Buffer.Num(); ++Index )
+	{
+		bIsSorted = Buffer[ Index - 1 ].ID <= Buffer[ Index ].ID;
+	}
+	if( !bIsSorted )
+	{
+		Buffer.StableSort( []( const FNode& A, const FNode& B ) { return A.ID < B.ID; } );
+	}
+
+	// Start a new run unless this buffer picks up where the current one left off
+	if( RunWriter.IsValid() && Buffer[ 0 ].ID < LastWrittenID )
+	{
+		RunWriter.Reset();
+	}
+
+	if( !RunWriter.IsValid() )
+	{
+		FRun& Run = Runs.AddDefaulted_GetRef();
+		Run.FilePath = FPaths::CreateTempFilename( *OSMNodeSpill::GetSpillDirectory(), TEXT( "Nodes" ), TEXT( ".tmp" ) );
+		RunWriter.Reset( IFileManager::Get().CreateFileWriter( *Run.FilePath ) );
+		if( !RunWriter.IsValid() )
+		{
+			FailedFilePath = Run.FilePath;
+			Buffer.Reset();
+			return;
+		}
+	}
+
+	RunWriter->Serialize( Buffer.GetData(), Buffer.Num() * sizeof( FNode ) );
+	if( RunWriter->IsError() )
+	{
+		FailedFilePath = Runs.Last().FilePath;
+	}
+
+	Runs.Last().NodeCount += Buffer.Num();
+	LastWrittenID = Buffer.Last().ID;
+	Buffer.Reset();
+}
+
+
+bool FOSMNodeSpill::Finish( FText& OutErrorMessage )
+{
+	FlushBuffer();
+	Buffer.Empty();
+
+	// Closing the writer flushes whatever it still had buffered
+	if( RunWriter.IsValid() && !RunWriter->Close() && FailedFilePath.IsEmpty() )
+	{
+		FailedFilePath = Runs.Last().FilePath;
+	}
+	RunWriter.Reset();
+
+	if( !FailedFilePath.IsEmpty() )
+	{
+		OutErrorMessage = FText::Format( LOCTEXT( "OSMNodeSpill_WriteFailed", "Couldn't write nodes to the temporary file '{0}'.  Is the disk full?" ), FText::FromString( FailedFilePath ) );
+		return false;
+	}
+
+	return true;
+}
+
+
+bool FOSMNodeSpill::Read( TFunctionRef<bool( const int64 NodeID, const double Latitude, const double Longitude )> Visitor, FText& OutErrorMessage ) const
+{
+	using namespace OSMNodeSpill;
+
+	check( !RunWriter.IsValid() );
+
+	// Each run gets an equal share of the memory budget to read into
+	struct FRunCursor
+	{
+		TUniquePtr<FArchive> Reader;
+		TArray<FNode> Nodes;
+		int32 NextIndex = 0;
+		int64 UnreadCount = 0;
+	};
+
+	const int32 ReadCapacity = FMath::Max( BufferCapacity / FMath::Max( Runs.Num(), 1 ), MinReadCapacity );
+	TArray<FRunCursor> Cursors;
+	Cursors.SetNum( Runs.Num() );
+
+	// Reads the next part of a run into its cursor.  Returns false if the run couldn't be read.
+	auto Refill = [&]( const int32 RunIndex ) -> bool
+	{
+		FRunCursor& Cursor = Cursors[ RunIndex ];
+		const int32 ReadCount = int32( FMath::Min<int64>( ReadCapacity, Cursor.UnreadCount ) );
+		const bool bAllowShrinking = false;
+		Cursor.Nodes.SetNumUninitialized( ReadCount, bAllowShrinking );
+		Cursor.Reader->Serialize( Cursor.Nodes.GetData(), ReadCount * sizeof( FNode ) );
+		Cursor.NextIndex = 0;
+		Cursor.UnreadCount -= ReadCount;
+		return !Cursor.Reader->IsError();
+	};
+
+	auto ReadFailed = [&]( const int32 RunIndex )
+	{
+		OutErrorMessage = FText::Format( LOCTEXT( "OSMNodeSpill_ReadFailed", "Couldn't read nodes back from the temporary file '{0}'" ), FText::FromString( Runs[ RunIndex ].FilePath ) );
+		return false;
+	};
+
+	// The runs are merged by keeping the index of each run that still has nodes in a heap, ordered by the ID of its
+	// next node.  Ties go to the earlier run, so that nodes with the same ID come out in the order they were added.
+	TArray<int32> RunHeap;
+	for( int32 RunIndex = 0; RunIndex < Runs.Num(); ++RunIndex )
+	{
+		FRunCursor& Cursor = Cursors[ RunIndex ];
+		Cursor.UnreadCount = Runs[ RunIndex ].NodeCount;
+		if( Cursor.UnreadCount > 0 )
+		{
+			Cursor.Reader.Reset( IFileManager::Get().CreateFileReader( *Runs[ RunIndex ].FilePath ) );
+			if( !Cursor.Reader.IsValid() || !Refill( RunIndex ) )
+			{
+				return ReadFailed( RunIndex );
+			}
+			RunHeap.Add( RunIndex );
+		}
+	}
+
+	auto IsNextNodeLess = [&Cursors]( const int32 A, const int32 B )
+	{
+		const int64 AID = Cursors[ A ].Nodes[ Cursors[ A ].NextIndex ].ID;
+		const int64 BID = Cursors[ B ].Nodes[ Cursors[ B ].NextIndex ].ID;
+		return AID != BID ? AID < BID : A < B;
+	};
+	RunHeap.Heapify( IsNextNodeLess );
+
+	while( RunHeap.Num() > 0 )
+	{
+		int32 RunIndex;
+		const bool bAllowShrinking = false;
+		RunHeap.HeapPop( RunIndex, IsNextNodeLess, bAllowShrinking );
+
+		// Carry on with the same run for as long as it has the lowest IDs.  Sorted files only have one run, so
+		// they never touch the heap after this.
+		FRunCursor& Cursor = Cursors[ RunIndex ];
+		const int64 NextRunID = RunHeap.Num() > 0 ? Cursors[ RunHeap.HeapTop() ].Nodes[ Cursors[ RunHeap.HeapTop() ].NextIndex ].ID : MAX_int64;
+		for( ;; )
+		{
+			const FNode& Node = Cursor.Nodes[ Cursor.NextIndex++ ];
+			if( !Visitor( Node.ID, Node.Latitude, Node.Longitude ) )
+			{
+				return false;
+			}
+
+			if( Cursor.NextIndex == Cursor.Nodes.Num() )
+			{
+				if( Cursor.UnreadCount == 0 )
+				{
+					Cursor.Reader.Reset();
+					Cursor.Nodes.Empty();
+					break;
+				}
+				if( !Refill( RunIndex ) )
+				{
+					return ReadFailed( RunIndex );
+				}
+			}
+
+			const int64 NextID = Cursor.Nodes[ Cursor.NextIndex ].ID;
+			if( RunHeap.Num() > 0 && ( NextID > NextRunID || ( NextID == NextRunID && RunIndex > RunHeap.HeapTop() ) ) )
+			{
+				RunHeap.HeapPush( RunIndex, IsNextNodeLess );
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,81 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/** Keeps node coordinates in temporary files on disk rather than in memory, for extracts with more nodes than fit in
+    memory.  Nodes are collected in a buffer no bigger than the memory budget, and whenever it fills up, it's sorted by
+    ID and written out as a run.  OSM files list their nodes in ascending ID order, so the buffer is normally already
+    sorted and just carries on the run before it, and the whole file ends up as a single run.  Reading the nodes back
+    merges the runs, so they always come out in ascending ID order, a buffer at a time. */
+class FOSMNodeSpill
+{
+
+public:
+
+	/** Creates an empty spill.  MemoryBudget is roughly how many bytes of nodes are held in memory at once. */
+	explicit FOSMNodeSpill( const int64 MemoryBudget );
+
+	/** Destructor for FOSMNodeSpill.  Deletes the run files. */
+	~FOSMNodeSpill();
+
+	/** Adds nodes, with their coordinates at the same index in each array.  Write errors are reported by Finish. */
+	void Add( const TArrayView<const int64> NodeIDs, const TArrayView<const double> Latitudes, const TArrayView<const double> Longitudes );
+
+	/** Writes out whatever is still buffered, and closes the last run.  Returns false if any of the nodes couldn't be written. */
+	bool Finish( FText& OutErrorMessage );
+
+	/** Visits every node in ascending ID order.  Nodes with the same ID are visited in the order they were added.  The
+	    visitor can return false to stop early.  Returns false if a run couldn't be read, or the visitor stopped. */
+	bool Read( TFunctionRef<bool( const int64 NodeID, const double Latitude, const double Longitude )> Visitor, FText& OutErrorMessage ) const;
+
+	/** Returns the number of nodes that were added */
+	int64 Num() const
+	{
+		return NodeCount;
+	}
+
+
+private:
+
+	// Non-copyable
+	FOSMNodeSpill( const FOSMNodeSpill& ) = delete;
+	FOSMNodeSpill& operator=( const FOSMNodeSpill& ) = delete;
+
+	/** Sorts the buffer and writes it to the end of the current run, or to a new run if it doesn't follow on from it */
+	void FlushBuffer();
+
+	/** A node, as it's stored in the run files */
+	struct FNode
+	{
+		int64 ID;
+		double Latitude;
+		double Longitude;
+	};
+
+	/** A file of nodes in ascending ID order */
+	struct FRun
+	{
+		FString FilePath;
+		int64 NodeCount = 0;
+	};
+
+	// Number of nodes that fit in the memory budget
+	const int32 BufferCapacity;
+
+	// Nodes that haven't been written yet
+	TArray<FNode> Buffer;
+
+	// Every run we've started, in the order they were written
+	TArray<FRun> Runs;
+
+	// Writer for the last run, while it can still be carried on
+	TUniquePtr<FArchive> RunWriter;
+
+	// ID of the last node written to the current run
+	int64 LastWrittenID = 0;
+
+	// Number of nodes added so far
+	int64 NodeCount = 0;
+
+	// Run file that couldn't be created or written, if any
+	FString FailedFilePath;
+};
@@ -0,0 +1,699 @@
+#include "OSMPbfReader.h"
+#include "Async/ParallelFor.h"
+#include "Misc/Compression.h"
+
+#define LOCTEXT_NAMESPACE "StreetMapImporting"
+
+namespace OSMPbfReader
+{
+	// Limits from the PBF specification.  Anything larger than this means the file is corrupt.
+	static const uint32 MaxBlobHeaderSize = 64 * 1024;
+	static const uint32 MaxBlobSize = 32 * 1024 * 1024;
+
+	/** Protocol buffer wire types */
+	enum EWireType : uint32
+	{
+		Varint = 0,
+		Fixed64 = 1,
+		LengthDelimited = 2,
+		Fixed32 = 5,
+	};
+
+	/** Range of bytes inside the source file (or inside a decompressed blob) */
+	struct FSpan
+	{
+		const uint8* Begin = nullptr;
+		const uint8* End = nullptr;
+	};
+
+	/** Minimal reader for protocol buffer messages.  Sets bHasError and stops returning data if the message is malformed. */
+	struct FProtobufReader
+	{
+		const uint8* Cursor;
+		const uint8* End;
+		bool bHasError;
+
+		explicit FProtobufReader( const FSpan Span )
+			: Cursor( Span.Begin ),
+			  End( Span.End ),
+			  bHasError( false )
+		{
+		}
+
+		/** Returns true if there is more data to read */
+		bool HasMore() const
+		{
+			return Cursor < End && !bHasError;
+		}
+
+		/** Reads the key for the next field.  Returns false at the end of the message. */
+		bool NextField( uint32& OutFieldNumber, uint32& OutWireType )
+		{
+			if( !HasMore() )
+			{
+				return false;
+			}
+			const uint64 Key = ReadVarint();
+			OutFieldNumber = (uint32)( Key >> 3 );
+			OutWireType = (uint32)( Key & 0x7 );
+			return !bHasError;
+		}
+
+		uint64 ReadVarint()
+		{
+			uint64 Result = 0;
+			for( int32 Shift = 0; Shift < 64 && Cursor < End; Shift += 7 )
+			{
+				const uint8 Byte = *Cursor++;
+				Result |= uint64( Byte & 0x7F ) << Shift;
+				if( ( Byte & 0x80 ) == 0 )
+				{
+					return Result;
+				}
+			}
+			bHasError = true;
+			return 0;
+		}
+
+		/** Reads a zigzag-encoded (sint32/sint64) varint */
+		int64 ReadSignedVarint()
+		{
+			const uint64 Value = ReadVarint();
+			return (int64)( Value >> 1 ) ^ -(int64)( Value & 1 );
+		}
+
+		/** Reads a length-delimited field (bytes, strings, embedded messages and packed arrays) */
+		FSpan ReadBytes()
+		{
+			FSpan Span;
+			const uint64 Length = ReadVarint();
+			if( !bHasError && Length <= uint64( End - Cursor ) )
+			{
+				Span.Begin = Cursor;
+				Span.End = Cursor + Length;
+				Cursor += Length;
+			}
+			else
+			{
+				bHasError = true;
+			}
+			return Span;
+		}
+
+		/** Skips over a field we aren't interested in */
+		void SkipField( const uint32 WireType )
+		{
+			switch( WireType )
+			{
+				case EWireType::Varint:
+					ReadVarint();
+					break;
+
+				case EWireType::Fixed64:
+					Skip( 8 );
+					break;
+
+				case EWireType::LengthDelimited:
+					ReadBytes();
+					break;
+
+				case EWireType::Fixed32:
+					Skip( 4 );
+					break;
+
+				default:
+					// Groups are deprecated and never used by the PBF format
+					bHasError = true;
+					break;
+			}
+		}
+
+		void Skip( const int64 ByteCount )
+		{
+			if( ByteCount <= End - Cursor )
+			{
+				Cursor += ByteCount;
+			}
+			else
+			{
+				bHasError = true;
+			}
+		}
+	};
+
+
+	static FAnsiStringView ToStringView( const FSpan Span )
+	{
+		return FAnsiStringView( reinterpret_cast<const ANSICHAR*>( Span.Begin ), int32( Span.End - Span.Begin ) );
+	}
+
+
+	/** Extracts the (possibly compressed) data from a Blob message */
+	static bool DecodeBlob( const FSpan Blob, TArray<uint8>& DecompressionBuffer, FSpan& OutData, FString& OutError )
+	{
+		FSpan RawData;
+		FSpan ZlibData;
+		int32 RawSize = 0;
+		bool bHasRawData = false;
+		bool bHasZlibData = false;
+
+		FProtobufReader Reader( Blob );
+		uint32 FieldNumber, WireType;
+		while( Reader.NextField( FieldNumber, WireType ) )
+		{
+			if( FieldNumber == 1 && WireType == EWireType::LengthDelimited )
+			{
+				RawData = Reader.ReadBytes();
+				bHasRawData = true;
+			}
+			else if( FieldNumber == 2 && WireType == EWireType::Varint )
+			{
+				RawSize = (int32)Reader.ReadVarint();
+			}
+			else if( FieldNumber == 3 && WireType == EWireType::LengthDelimited )
+			{
+				ZlibData = Reader.ReadBytes();
+				bHasZlibData = true;
+			}
+			else if( FieldNumber >= 4 && FieldNumber <= 7 )
+			{
+				// LZMA, bzip2, LZ4 and Zstandard blobs are all optional in the specification
+				OutError = TEXT( "Unsupported blob compression.  Only uncompressed and zlib compressed blobs are supported." );
+				return false;
+			}
+			else
+			{
+				Reader.SkipField( WireType );
+			}
+		}
+
+		if( Reader.bHasError )
+		{
+			OutError = TEXT( "Malformed blob" );
+			return false;
+		}
+
+		if( bHasRawData )
+		{
+			OutData = RawData;
+			return true;
+		}
+
+		if( bHasZlibData )
+		{
+			if( RawSize <= 0 || RawSize > (int32)MaxBlobSize )
+			{
+				OutError = TEXT( "Invalid uncompressed blob size" );
+				return false;
+			}
+
+			DecompressionBuffer.SetNumUninitialized( RawSize, false );
+			if( !FCompression::UncompressMemory( NAME_Zlib, DecompressionBuffer.GetData(), RawSize, ZlibData.Begin, int32( ZlibData.End - ZlibData.Begin ) ) )
+			{
+				OutError = TEXT( "Failed to decompress zlib blob" );
+				return false;
+			}
+
+			OutData.Begin = DecompressionBuffer.GetData();
+			OutData.End = OutData.Begin + RawSize;
+			return true;
+		}
+
+		// Empty blob
+		OutData = FSpan();
+		return true;
+	}
+
+
+	/** Checks that we understand everything the file's header block says we need to support */
+	static bool DecodeHeaderBlock( const FSpan HeaderBlock, FString& OutError )
+	{
+		FProtobufReader Reader( HeaderBlock );
+		uint32 FieldNumber, WireType;
+		while( Reader.NextField( FieldNumber, WireType ) )
+		{
+			if( FieldNumber == 4 && WireType == EWireType::LengthDelimited )
+			{
+				const FAnsiStringView RequiredFeature = ToStringView( Reader.ReadBytes() );
+				if( !RequiredFeature.Equals( ANSITEXTVIEW( "OsmSchema-V0.6" ) ) &&
+					!RequiredFeature.Equals( ANSITEXTVIEW( "DenseNodes" ) ) )
+				{
+					OutError = FString::Printf( TEXT( "Unsupported required feature '%s'" ), *FString( RequiredFeature ) );
+					return false;
+				}
+			}
+			else
+			{
+				Reader.SkipField( WireType );
+			}
+		}
+
+		if( Reader.bHasError )
+		{
+			OutError = TEXT( "Malformed header block" );
+			return false;
+		}
+
+		return true;
+	}
+
+
+	/** Coordinate encoding parameters for a single primitive block */
+	struct FCoordinateEncoding
+	{
+		int64 Granularity = 100;
+		int64 LatitudeOffset = 0;
+		int64 LongitudeOffset = 0;
+
+		inline double DecodeLatitude( const int64 Latitude ) const
+		{
+			return 1e-9 * double( LatitudeOffset + Granularity * Latitude );
+		}
+
+		inline double DecodeLongitude( const int64 Longitude ) const
+		{
+			return 1e-9 * double( LongitudeOffset + Granularity * Longitude );
+		}
+	};
+
+
+	static void AddNode( const FOSMFile::FOSMReadOptions& Options, FOSMFile::FOSMBatch& Batch, const int64 NodeID, const double Latitude, const double Longitude )
+	{
+		if( !Options.ShouldKeepNode( NodeID, Latitude, Longitude ) )
+		{
+			return;
+		}
+
+		Batch.NodeIDs.Add( NodeID );
+		Batch.NodeLatitudes.Add( Latitude );
+		Batch.NodeLongitudes.Add( Longitude );
+	}
+
+
+	static bool DecodeNode( const FSpan Node, const FCoordinateEncoding& Encoding, const FOSMFile::FOSMReadOptions& Options, FOSMFile::FOSMBatch& Batch )
+	{
+		int64 NodeID = 0;
+		int64 Latitude = 0;
+		int64 Longitude = 0;
+
+		FProtobufReader Reader( Node );
+		uint32 FieldNumber, WireType;
+		while( Reader.NextField( FieldNumber, WireType ) )
+		{
+			if( FieldNumber == 1 && WireType == EWireType::Varint )
+			{
+				NodeID = Reader.ReadSignedVarint();
+			}
+			else if( FieldNumber == 8 && WireType == EWireType::Varint )
+			{
+				Latitude = Reader.ReadSignedVarint();
+			}
+			else if( FieldNumber == 9 && WireType == EWireType::Varint )
+			{
+				Longitude = Reader.ReadSignedVarint();
+			}
+			else
+			{
+				Reader.SkipField( WireType );
+			}
+		}
+
+		AddNode( Options, Batch, NodeID, Encoding.DecodeLatitude( Latitude ), Encoding.DecodeLongitude( Longitude ) );
+		return !Reader.bHasError;
+	}
+
+
+	static bool DecodeDenseNodes( const FSpan DenseNodes, const FCoordinateEncoding& Encoding, const FOSMFile::FOSMReadOptions& Options, FOSMFile::FOSMBatch& Batch )
+	{
+		FSpan PackedIDs;
+		FSpan PackedLatitudes;
+		FSpan PackedLongitudes;
+
+		FProtobufReader Reader( DenseNodes );
+		uint32 FieldNumber, WireType;
+		while( Reader.NextField( FieldNumber, WireType ) )
+		{
+			if( FieldNumber == 1 && WireType == EWireType::LengthDelimited )
+			{
+				PackedIDs = Reader.ReadBytes();
+			}
+			else if( FieldNumber == 8 && WireType == EWireType::LengthDelimited )
+			{
+				PackedLatitudes = Reader.ReadBytes();
+			}
+			else if( FieldNumber == 9 && WireType == EWireType::LengthDelimited )
+			{
+				PackedLongitudes = Reader.ReadBytes();
+			}
+			else
+			{
+				// Node tags (keys_vals) and metadata aren't used by the importer
+				Reader.SkipField( WireType );
+			}
+		}
+
+		if( Reader.bHasError )
+		{
+			return false;
+		}
+
+		// All three arrays are delta encoded, and always have the same number of elements
+		FProtobufReader IDReader( PackedIDs );
+		FProtobufReader LatitudeReader( PackedLatitudes );
+		FProtobufReader LongitudeReader( PackedLongitudes );
+		int64 NodeID = 0;
+		int64 Latitude = 0;
+		int64 Longitude = 0;
+		while( IDReader.HasMore() )
+		{
+			NodeID += IDReader.ReadSignedVarint();
+			Latitude += LatitudeReader.ReadSignedVarint();
+			Longitude += LongitudeReader.ReadSignedVarint();
+
+			AddNode( Options, Batch, NodeID, Encoding.DecodeLatitude( Latitude ), Encoding.DecodeLongitude( Longitude ) );
+		}
+
+		return !IDReader.bHasError && !LatitudeReader.bHasError && !LongitudeReader.bHasError;
+	}
+
+
+	static bool DecodeWay( const FSpan Way, const TArray<FAnsiStringView>& StringTable, const FOSMFile::FOSMReadOptions& Options, FOSMFile::FOSMBatch& Batch )
+	{
+		int64 WayID = 0;
+		FSpan PackedKeys;
+		FSpan PackedValues;
+		FSpan PackedNodeRefs;
+
+		FProtobufReader Reader( Way );
+		uint32 FieldNumber, WireType;
+		while( Reader.NextField( FieldNumber, WireType ) )
+		{
+			if( FieldNumber == 1 && WireType == EWireType::Varint )
+			{
+				WayID = (int64)Reader.ReadVarint();
+			}
+			else if( FieldNumber == 2 && WireType == EWireType::LengthDelimited )
+			{
+				PackedKeys = Reader.ReadBytes();
+			}
+			else if( FieldNumber == 3 && WireType == EWireType::LengthDelimited )
+			{
+				PackedValues = Reader.ReadBytes();
+			}
+			else if( FieldNumber == 8 && WireType == EWireType::LengthDelimited )
+			{
+				PackedNodeRefs = Reader.ReadBytes();
+			}
+			else
+			{
+				Reader.SkipField( WireType );
+			}
+		}
+
+		if( Reader.bHasError )
+		{
+			return false;
+		}
+
+		FOSMFile::FOSMWayInfo& NewWay = Batch.AddWay();
+		NewWay.ID = WayID;
+
+		// Tags are stored as parallel arrays of indices into the block's string table
+		FProtobufReader KeyReader( PackedKeys );
+		FProtobufReader ValueReader( PackedValues );
+		while( KeyReader.HasMore() && ValueReader.HasMore() )
+		{
+			const uint64 KeyIndex = KeyReader.ReadVarint();
+			const uint64 ValueIndex = ValueReader.ReadVarint();
+			if( KeyIndex >= (uint64)StringTable.Num() || ValueIndex >= (uint64)StringTable.Num() )
+			{
+				return false;
+			}
+
+			const bool bIsXmlEscaped = false;
+			Batch.ApplyWayTag( Options.TagClassifier, NewWay, StringTable[ KeyIndex ], StringTable[ ValueIndex ], bIsXmlEscaped );
+		}
+
+		// Node references are delta encoded.  We don't bother decoding them for ways that won't be kept.
+		FProtobufReader NodeRefReader( PackedNodeRefs );
+		if( Options.TagClassifier.ShouldKeep( NewWay.TagRuleIndex ) )
+		{
+			int64 NodeID = 0;
+			while( NodeRefReader.HasMore() )
+			{
+				NodeID += NodeRefReader.ReadSignedVarint();
+				Batch.AddWayNodeID( NodeID );
+			}
+		}
+		Batch.FinishWay( Options.TagClassifier );
+
+		return !KeyReader.bHasError && !ValueReader.bHasError && !NodeRefReader.bHasError;
+	}
+
+
+	static bool DecodePrimitiveBlock( const FSpan PrimitiveBlock, const FOSMFile::FOSMReadOptions& Options, FOSMFile::FOSMBatch& Batch )
+	{
+		TArray<FAnsiStringView> StringTable;
+		TArray<FSpan, TInlineAllocator<4>> PrimitiveGroups;
+		FCoordinateEncoding Encoding;
+
+		// Fields can appear in any order, so gather everything we need before decoding the groups
+		FProtobufReader Reader( PrimitiveBlock );
+		uint32 FieldNumber, WireType;
+		while( Reader.NextField( FieldNumber, WireType ) )
+		{
+			if( FieldNumber == 1 && WireType == EWireType::LengthDelimited )
+			{
+				FProtobufReader StringTableReader( Reader.ReadBytes() );
+				while( StringTableReader.NextField( FieldNumber, WireType ) )
+				{
+					if( FieldNumber == 1 && WireType == EWireType::LengthDelimited )
+					{
+						StringTable.Add( ToStringView( StringTableReader.ReadBytes() ) );
+					}
+					else
+					{
+						StringTableReader.SkipField( WireType );
+					}
+				}
+				if( StringTableReader.bHasError )
+				{
+					return false;
+				}
+			}
+			else if( FieldNumber == 2 && WireType == EWireType::LengthDelimited )
+			{
+				PrimitiveGroups.Add( Reader.ReadBytes() );
+			}
+			else if( FieldNumber == 17 && WireType == EWireType::Varint )
+			{
+				Encoding.Granularity = (int64)Reader.ReadVarint();
+			}
+			else if( FieldNumber == 19 && WireType == EWireType::Varint )
+			{
+				Encoding.LatitudeOffset = (int64)Reader.ReadVarint();
+			}
+			else if( FieldNumber == 20 && WireType == EWireType::Varint )
+			{
+				Encoding.LongitudeOffset = (int64)Reader.ReadVarint();
+			}
+			else
+			{
+				Reader.SkipField( WireType );
+			}
+		}
+
+		if( Reader.bHasError )
+		{
+			return false;
+		}
+
+		for( const FSpan& PrimitiveGroup : PrimitiveGroups )
+		{
+			FProtobufReader GroupReader( PrimitiveGroup );
+			while( GroupReader.NextField( FieldNumber, WireType ) )
+			{
+				bool bDecodedOkay = true;
+				if( FieldNumber == 1 && WireType == EWireType::LengthDelimited && Options.bReadNodes )
+				{
+					bDecodedOkay = DecodeNode( GroupReader.ReadBytes(), Encoding, Options, Batch );
+				}
+				else if( FieldNumber == 2 && WireType == EWireType::LengthDelimited && Options.bReadNodes )
+				{
+					bDecodedOkay = DecodeDenseNodes( GroupReader.ReadBytes(), Encoding, Options, Batch );
+				}
+				else if( FieldNumber == 3 && WireType == EWireType::LengthDelimited && Options.bReadWays )
+				{
+					bDecodedOkay = DecodeWay( GroupReader.ReadBytes(), StringTable, Options, Batch );
+				}
+				else
+				{
+					// Relations and changesets aren't used by the importer, and this pass may not want nodes or ways either
+					GroupReader.SkipField( WireType );
+				}
+
+				if( !bDecodedOkay )
+				{
+					return false;
+				}
+			}
+
+			if( GroupReader.bHasError )
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+
+bool FOSMPbfReader::Parse( const TArrayView64<const uint8> Buffer, const FOSMFile::FOSMReadOptions& Options, TFunctionRef<bool( FOSMFile::FOSMBatch& )> ProcessBatch, TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage )
+{
+	using namespace OSMPbfReader;
+
+	OutErrorMessage = FText::GetEmpty();
+
+	// Walk the blob headers first.  This is cheap, and tells us where all of the independent data blobs are.
+	TArray<FSpan> DataBlobs;
+	{
+		TArray<uint8> DecompressionBuffer;
+		const uint8* Data = Buffer.GetData();
+		int64 Offset = 0;
+		while( Offset < Buffer.Num() )
+		{
+			if( Buffer.Num() - Offset < 4 )
+			{
+				OutErrorMessage = LOCTEXT( "OSMPbfReader_Truncated", "The file is truncated" );
+				return false;
+			}
+
+			// Each blob header is prefixed with its size, in network byte order
+			const uint32 BlobHeaderSize = ( uint32( Data[ Offset ] ) << 24 ) | ( uint32( Data[ Offset + 1 ] ) << 16 ) | ( uint32( Data[ Offset + 2 ] ) << 8 ) | uint32( Data[ Offset + 3 ] );
+			Offset += 4;
+			if( BlobHeaderSize > MaxBlobHeaderSize || BlobHeaderSize > Buffer.Num() - Offset )
+			{
+				OutErrorMessage = LOCTEXT( "OSMPbfReader_BadBlobHeader", "Invalid blob header size" );
+				return false;
+			}
+
+			FAnsiStringView BlobType;
+			uint64 BlobSize = 0;
+			{
+				FSpan BlobHeader;
+				BlobHeader.Begin = Data + Offset;
+				BlobHeader.End = BlobHeader.Begin + BlobHeaderSize;
+
+				FProtobufReader Reader( BlobHeader );
+				uint32 FieldNumber, WireType;
+				while( Reader.NextField( FieldNumber, WireType ) )
+				{
+					if( FieldNumber == 1 && WireType == EWireType::LengthDelimited )
+					{
+						BlobType = ToStringView( Reader.ReadBytes() );
+					}
+					else if( FieldNumber == 3 && WireType == EWireType::Varint )
+					{
+						BlobSize = Reader.ReadVarint();
+					}
+					else
+					{
+						Reader.SkipField( WireType );
+					}
+				}
+
+				if( Reader.bHasError )
+				{
+					OutErrorMessage = LOCTEXT( "OSMPbfReader_MalformedBlobHeader", "Malformed blob header" );
+					return false;
+				}
+			}
+			Offset += BlobHeaderSize;
+
+			if( BlobSize > MaxBlobSize || BlobSize > uint64( Buffer.Num() - Offset ) )
+			{
+				OutErrorMessage = LOCTEXT( "OSMPbfReader_BadBlobSize", "Invalid blob size" );
+				return false;
+			}
+
+			FSpan Blob;
+			Blob.Begin = Data + Offset;
+			Blob.End = Blob.Begin + BlobSize;
+			Offset += BlobSize;
+
+			if( BlobType.Equals( ANSITEXTVIEW( "OSMHeader" ) ) )
+			{
+				FSpan HeaderBlock;
+				FString Error;
+				if( !DecodeBlob( Blob, DecompressionBuffer, HeaderBlock, Error ) || !DecodeHeaderBlock( HeaderBlock, Error ) )
+				{
+					OutErrorMessage = FText::FromString( Error );
+					return false;
+				}
+			}
+			else if( BlobType.Equals( ANSITEXTVIEW( "OSMData" ) ) )
+			{
+				DataBlobs.Add( Blob );
+			}
+			else
+			{
+				// Unknown blob types must be skipped, according to the specification
+			}
+		}
+	}
+
+	// Decode the data blobs in parallel.  We process them in groups so that only a bounded number of decoded
+	// batches are held in memory at once, and hand each group's batches back in file order.
+	const int32 BlobsPerGroup = FMath::Max( 1, FTaskGraphInterface::Get().GetNumWorkerThreads() * 2 );
+
+	TArray<FOSMFile::FOSMBatch> Batches;
+	TArray<FString> BlobErrors;
+	for( int32 FirstBlobIndex = 0; FirstBlobIndex < DataBlobs.Num(); FirstBlobIndex += BlobsPerGroup )
+	{
+		const int32 BlobCount = FMath::Min( BlobsPerGroup, DataBlobs.Num() - FirstBlobIndex );
+
+		Batches.Reset();
+		Batches.SetNum( BlobCount );
+		BlobErrors.Reset();
+		BlobErrors.SetNum( BlobCount );
+
+		ParallelFor( BlobCount, [&DataBlobs, &Options, &Batches, &BlobErrors, FirstBlobIndex]( const int32 GroupBlobIndex )
+		{
+			TArray<uint8> DecompressionBuffer;
+			FSpan PrimitiveBlock;
+			if( DecodeBlob( DataBlobs[ FirstBlobIndex + GroupBlobIndex ], DecompressionBuffer, PrimitiveBlock, BlobErrors[ GroupBlobIndex ] ) )
+			{
+				if( !DecodePrimitiveBlock( PrimitiveBlock, Options, Batches[ GroupBlobIndex ] ) )
+				{
+					BlobErrors[ GroupBlobIndex ] = TEXT( "Malformed primitive block" );
+				}
+			}
+		} );
+
+		for( int32 GroupBlobIndex = 0; GroupBlobIndex < BlobCount; ++GroupBlobIndex )
+		{
+			if( !BlobErrors[ GroupBlobIndex ].IsEmpty() )
+			{
+				OutErrorMessage = FText::Format( LOCTEXT( "OSMPbfReader_BlobError", "Blob {0}: {1}" ), FText::AsNumber( FirstBlobIndex + GroupBlobIndex ), FText::FromString( BlobErrors[ GroupBlobIndex ] ) );
+				return false;
+			}
+
+			if( !ProcessBatch( Batches[ GroupBlobIndex ] ) )
+			{
+				OutErrorMessage = LOCTEXT( "OSMPbfReader_Cancelled", "Decoding was cancelled" );
+				return false;
+			}
+		}
+
+		if( !ProgressCallback( float( FirstBlobIndex + BlobCount ) / float( DataBlobs.Num() ) ) )
+		{
+			OutErrorMessage = LOCTEXT( "OSMPbfReader_Cancelled", "Decoding was cancelled" );
+			return false;
+		}
+	}
+
+	return true;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,25 @@
+#pragma once
+#include "OSMFile.h"
+
+/** Decoder for OpenStreetMap PBF (Protocolbuffer Binary Format) files.  See http://wiki.openstreetmap.org/wiki/PBF_Format
+
+    A PBF file is a sequence of independently compressed blobs, so we decode the blobs in parallel on the task graph
+    and hand the resulting batches back to the caller in file order. */
+class FOSMPbfReader
+{
+
+public:
+
+	/**
+	 * Decodes the specified buffer
+	 *
+	 * @param	Buffer				Contents of a .osm.pbf file
+	 * @param	Options				Decides what is decoded, and which nodes and ways are kept
+	 * @param	ProcessBatch		Called on the calling thread with the nodes and ways from each blob, in file order.  Return false to cancel.
+	 * @param	ProgressCallback	Called on the calling thread with the fraction of the file decoded so far.  Return false to cancel.
+	 * @param	OutErrorMessage		If decoding fails, describes the problem
+	 *
+	 * @return	True if the whole file was decoded successfully
+	 */
+	static bool Parse( const TArrayView64<const uint8> Buffer, const FOSMFile::FOSMReadOptions& Options, TFunctionRef<bool( FOSMFile::FOSMBatch& )> ProcessBatch, TFunctionRef<bool( float )> ProgressCallback, FText& OutErrorMessage );
+};
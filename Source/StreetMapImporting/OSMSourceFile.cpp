@@ -0,0 +1,64 @@
+#include "OSMSourceFile.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+
+FOSMSourceFile::FOSMSourceFile()
+{
+}
+
+
+FOSMSourceFile::~FOSMSourceFile()
+{
+	Close();
+}
+
+
+bool FOSMSourceFile::Open( const FString& FilePath )
+{
+	Close();
+
+	// Try to map the file first.  This lets the operating system page the file in as we tokenize it, and
+	// we never need to hold a second copy of the data in memory.
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	MappedHandle.Reset( PlatformFile.OpenMapped( *FilePath ) );
+	if( MappedHandle.IsValid() )
+	{
+		if( MappedHandle->GetFileSize() == 0 )
+		{
+			// Nothing to map
+			Data = TArrayView64<const uint8>();
+			return true;
+		}
+
+		const bool bPreloadHint = false;
+		MappedRegion.Reset( MappedHandle->MapRegion( 0, MAX_int64, bPreloadHint ) );
+		if( MappedRegion.IsValid() )
+		{
+			Data = TArrayView64<const uint8>( MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize() );
+			return true;
+		}
+
+		MappedHandle.Reset();
+	}
+
+	// Mapping isn't supported on this platform (or for this file), so fall back to loading it all
+	if( FFileHelper::LoadFileToArray( LoadedBytes, *FilePath ) )
+	{
+		Data = TArrayView64<const uint8>( LoadedBytes.GetData(), LoadedBytes.Num() );
+		return true;
+	}
+
+	return false;
+}
+
+
+void FOSMSourceFile::Close()
+{
+	Data = TArrayView64<const uint8>();
+
+	// The region must always be released before the file handle
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+	LoadedBytes.Empty();
+}
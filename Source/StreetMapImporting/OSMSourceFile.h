@@ -0,0 +1,56 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/** Read-only view of an OpenStreetMap source file.  The file is memory-mapped when the platform supports it, so
+    that the importer can tokenize the bytes in place without ever copying the whole file into memory. */
+class FOSMSourceFile
+{
+
+public:
+
+	/** Default constructor for FOSMSourceFile */
+	FOSMSourceFile();
+
+	/** Destructor for FOSMSourceFile.  Unmaps the file. */
+	~FOSMSourceFile();
+
+	/** Opens the specified file for reading.  Returns false if the file couldn't be opened. */
+	bool Open( const FString& FilePath );
+
+	/** Unmaps the file and frees any memory we were holding on to */
+	void Close();
+
+	/** Returns the raw bytes of the file.  The view is only valid while this object is open. */
+	TArrayView64<const uint8> GetData() const
+	{
+		return Data;
+	}
+
+	/** Returns true if the file contents are memory-mapped, as opposed to loaded into memory */
+	bool IsMemoryMapped() const
+	{
+		return MappedRegion.IsValid();
+	}
+
+
+private:
+
+	// Non-copyable
+	FOSMSourceFile( const FOSMSourceFile& ) = delete;
+	FOSMSourceFile& operator=( const FOSMSourceFile& ) = delete;
+
+	// Mapped file handle, if the platform was able to map the file
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+
+	// Region covering the entire mapped file
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	// Fallback storage for when the file couldn't be mapped
+	TArray64<uint8> LoadedBytes;
+
+	// View of the file's bytes, either mapped or loaded
+	TArrayView64<const uint8> Data;
+};
@@ -0,0 +1,197 @@
+#include "OSMTagClassifier.h"
+
+namespace OSMTagClassifier
+{
+	// FNV-1a
+	static const uint32 HashOffsetBasis = 2166136261u;
+	static const uint32 HashPrime = 16777619u;
+
+	// Tags are matched without regard to case, like the importer always has, so "Highway=Primary" still matches a
+	// "highway=primary" rule.  Only ASCII letters are folded, which covers the keys and values that rules are written for.
+	static inline uint8 FoldCase( const ANSICHAR Char )
+	{
+		return ( Char >= 'A' && Char <= 'Z' ) ? uint8( Char - 'A' + 'a' ) : uint8( Char );
+	}
+
+	static inline uint32 HashBytes( uint32 Hash, const FAnsiStringView Bytes )
+	{
+		for( const ANSICHAR Char : Bytes )
+		{
+			Hash = ( Hash ^ FoldCase( Char ) ) * HashPrime;
+		}
+		return Hash;
+	}
+
+	static inline bool EqualsIgnoringCase( const ANSICHAR* A, const ANSICHAR* B, const int32 Length )
+	{
+		for( int32 CharIndex = 0; CharIndex < Length; ++CharIndex )
+		{
+			if( FoldCase( A[ CharIndex ] ) != FoldCase( B[ CharIndex ] ) )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+
+FOSMTagClassifier::FOSMTagClassifier( const FStreetMapImportSettings& ImportSettings )
+	: Rules( ImportSettings.TagRules )
+{
+	// Size the table so that it stays at most half full, counting the keys we always read
+	const int32 MaxEntryCount = ( Rules.Num() * 2 ) + 5;
+	Entries.SetNum( FMath::RoundUpToPowerOfTwo( MaxEntryCount * 2 ) );
+
+	auto AddTagKey = [this]( const FAnsiStringView Key, const EOSMTagKey TagKey )
+	{
+		FindOrAddEntry( Key, nullptr ).TagKey = TagKey;
+	};
+	AddTagKey( ANSITEXTVIEW( "name" ), EOSMTagKey::Name );
+	AddTagKey( ANSITEXTVIEW( "ref" ), EOSMTagKey::Ref );
+	AddTagKey( ANSITEXTVIEW( "height" ), EOSMTagKey::Height );
+	AddTagKey( ANSITEXTVIEW( "building:levels" ), EOSMTagKey::BuildingLevels );
+	AddTagKey( ANSITEXTVIEW( "oneway" ), EOSMTagKey::OneWay );
+
+	for( int32 RuleIndex = 0; RuleIndex < Rules.Num(); ++RuleIndex )
+	{
+		const FStreetMapImportTagRule& Rule = Rules[ RuleIndex ];
+		if( Rule.Key.IsEmpty() )
+		{
+			continue;
+		}
+
+		// Tags in the file are UTF-8, so we compare against UTF-8 copies of the rules
+		const FTCHARToUTF8 Key( *Rule.Key );
+		const FAnsiStringView KeyView( Key.Get(), Key.Length() );
+
+		FEntry& KeyEntry = FindOrAddEntry( KeyView, nullptr );
+		if( Rule.Value.IsEmpty() || Rule.Value == TEXT( "*" ) )
+		{
+			// Rules listed earlier take priority, so we only store the first match
+			if( KeyEntry.RuleIndex == INDEX_NONE )
+			{
+				KeyEntry.RuleIndex = RuleIndex;
+			}
+		}
+		else
+		{
+			KeyEntry.bHasValueRules = true;
+
+			const FTCHARToUTF8 Value( *Rule.Value );
+			const FAnsiStringView ValueView( Value.Get(), Value.Length() );
+			FEntry& ValueEntry = FindOrAddEntry( KeyView, &ValueView );
+			if( ValueEntry.RuleIndex == INDEX_NONE )
+			{
+				ValueEntry.RuleIndex = RuleIndex;
+			}
+		}
+	}
+}
+
+
+FOSMTagClassifier::FTagMatch FOSMTagClassifier::Classify( const FAnsiStringView Key, const FAnsiStringView Value ) const
+{
+	FTagMatch Match;
+
+	// Most tags in a file ("source", "surface", "lanes", ...) aren't in the table at all, and only cost one probe
+	const int32 KeyEntryIndex = FindEntry( Key, nullptr );
+	if( KeyEntryIndex == INDEX_NONE )
+	{
+		return Match;
+	}
+
+	const FEntry& KeyEntry = Entries[ KeyEntryIndex ];
+	Match.Key = KeyEntry.TagKey;
+	Match.RuleIndex = KeyEntry.RuleIndex;
+
+	if( KeyEntry.bHasValueRules )
+	{
+		const int32 ValueEntryIndex = FindEntry( Key, &Value );
+		if( ValueEntryIndex != INDEX_NONE )
+		{
+			const int32 ValueRuleIndex = Entries[ ValueEntryIndex ].RuleIndex;
+			if( Match.RuleIndex == INDEX_NONE || ValueRuleIndex < Match.RuleIndex )
+			{
+				Match.RuleIndex = ValueRuleIndex;
+			}
+		}
+	}
+
+	return Match;
+}
+
+
+uint32 FOSMTagClassifier::HashTag( const FAnsiStringView Key, const FAnsiStringView* Value )
+{
+	using namespace OSMTagClassifier;
+
+	uint32 Hash = HashBytes( HashOffsetBasis, Key );
+	if( Value != nullptr )
+	{
+		// Separate the key from the value, so that "ab"="c" and "a"="bc" don't collide
+		Hash = ( Hash ^ uint8( '=' ) ) * HashPrime;
+		Hash = HashBytes( Hash, *Value );
+	}
+	return Hash;
+}
+
+
+int32 FOSMTagClassifier::FindEntry( const FAnsiStringView Key, const FAnsiStringView* Value ) const
+{
+	using namespace OSMTagClassifier;
+
+	const uint32 Hash = HashTag( Key, Value );
+	const uint32 Mask = uint32( Entries.Num() - 1 );
+	const int32 ValueLength = Value != nullptr ? Value->Len() : -1;
+
+	// Linear probing.  The table is never more than half full, so we always find an empty slot eventually.
+	for( uint32 EntryIndex = Hash & Mask; ; EntryIndex = ( EntryIndex + 1 ) & Mask )
+	{
+		const FEntry& Entry = Entries[ EntryIndex ];
+		if( Entry.KeyLength == -1 )
+		{
+			return INDEX_NONE;
+		}
+
+		if( Entry.Hash == Hash &&
+			Entry.KeyLength == Key.Len() &&
+			Entry.ValueLength == ValueLength &&
+			FMemory::Memcmp( Strings.GetData() + Entry.KeyOffset, Key.GetData(), Key.Len() ) == 0 &&
+			( Value == nullptr || FMemory::Memcmp( Strings.GetData() + Entry.ValueOffset, Value->GetData(), ValueLength ) == 0 ) )
+		{
+			return int32( EntryIndex );
+		}
+	}
+}
+
+
+FOSMTagClassifier::FEntry& FOSMTagClassifier::FindOrAddEntry( const FAnsiStringView Key, const FAnsiStringView* Value )
+{
+	const int32 ExistingEntryIndex = FindEntry( Key, Value );
+	if( ExistingEntryIndex != INDEX_NONE )
+	{
+		return Entries[ ExistingEntryIndex ];
+	}
+
+	const uint32 Hash = HashTag( Key, Value );
+	const uint32 Mask = uint32( Entries.Num() - 1 );
+	uint32 EntryIndex = Hash & Mask;
+	while( Entries[ EntryIndex ].KeyLength != -1 )
+	{
+		EntryIndex = ( EntryIndex + 1 ) & Mask;
+	}
+
+	FEntry& NewEntry = Entries[ EntryIndex ];
+	NewEntry.Hash = Hash;
+	NewEntry.KeyOffset = Strings.Num();
+	NewEntry.KeyLength = Key.Len();
+	Strings.Append( Key.GetData(), Key.Len() );
+	if( Value != nullptr )
+	{
+		NewEntry.ValueOffset = Strings.Num();
+		NewEntry.ValueLength = Value->Len();
+		Strings.Append( Value->GetData(), Value->Len() );
+	}
+	return NewEntry;
+}
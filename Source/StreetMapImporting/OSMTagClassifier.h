@@ -0,0 +1,104 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "StreetMap.h"
+
+/** Tag keys whose values the importer always reads, whatever the tag rules say */
+enum class EOSMTagKey : uint8
+{
+	/** Not a key we read values from */
+	None,
+
+	/** Name of the way */
+	Name,
+
+	/** Reference number of the way (e.g. "I 95"), used when the way doesn't have a name */
+	Ref,
+
+	/** Height of a building, in meters */
+	Height,
+
+	/** Number of floors in a building */
+	BuildingLevels,
+
+	/** Whether a road is one-way */
+	OneWay,
+};
+
+
+/** The import settings' tag rules, compiled into a hash table at the start of an import so that each tag in the
+    file can be classified with one or two probes, straight from the UTF-8 bytes in the source file */
+class FOSMTagClassifier
+{
+
+public:
+
+	/** Result of classifying a single tag */
+	struct FTagMatch
+	{
+		// Which value this tag provides, if any
+		EOSMTagKey Key = EOSMTagKey::None;
+
+		// Index of the first rule matching the tag, or INDEX_NONE
+		int32 RuleIndex = INDEX_NONE;
+	};
+
+	/** Compiles the tag rules from the specified settings */
+	FOSMTagClassifier( const FStreetMapImportSettings& ImportSettings );
+
+	/** Classifies a tag, ignoring the case of its key and value.  Safe to call from any thread. */
+	FTagMatch Classify( const FAnsiStringView Key, const FAnsiStringView Value ) const;
+
+	/** Returns the rule with the specified index */
+	const FStreetMapImportTagRule& GetRule( const int32 RuleIndex ) const
+	{
+		return Rules[ RuleIndex ];
+	}
+
+	/** Returns true if ways matching the specified rule should be imported */
+	bool ShouldKeep( const int32 RuleIndex ) const
+	{
+		return RuleIndex != INDEX_NONE && Rules[ RuleIndex ].bKeep;
+	}
+
+
+private:
+
+	struct FEntry
+	{
+		// Hash of the key (and value, for value entries).  Entries with a KeyLength of -1 are unused.
+		uint32 Hash = 0;
+
+		// Location of the key and value in the string pool.  Key-only entries have a ValueLength of -1.
+		int32 KeyOffset = 0;
+		int32 KeyLength = -1;
+		int32 ValueOffset = 0;
+		int32 ValueLength = -1;
+
+		// Index of the first rule this entry matches.  For key-only entries, this is the first wildcard rule.
+		int32 RuleIndex = INDEX_NONE;
+
+		// For key-only entries, the value this key provides
+		EOSMTagKey TagKey = EOSMTagKey::None;
+
+		// For key-only entries, whether there are any rules that match specific values of the key
+		bool bHasValueRules = false;
+	};
+
+	/** Finds an entry.  Pass a null value to find a key-only entry.  Returns INDEX_NONE if there isn't one. */
+	int32 FindEntry( const FAnsiStringView Key, const FAnsiStringView* Value ) const;
+
+	/** Finds or adds an entry */
+	FEntry& FindOrAddEntry( const FAnsiStringView Key, const FAnsiStringView* Value );
+
+	/** Hashes a key, and optionally a value */
+	static uint32 HashTag( const FAnsiStringView Key, const FAnsiStringView* Value );
+
+	// Copy of the rules we were compiled from
+	TArray<FStreetMapImportTagRule> Rules;
+
+	// Open-addressed hash table of keys and key/value pairs.  Always a power of two in size, and never more than half full.
+	TArray<FEntry> Entries;
+
+	// UTF-8 characters of all keys and values in the table
+	TArray<ANSICHAR> Strings;
+};
@@ -0,0 +1,675 @@
+#include "OSMXmlReader.h"
+#include "Containers/StringConv.h"
+#include <string.h>
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_CPU_X86_FAMILY
+	#include <emmintrin.h>
+	#define OSM_XML_SCAN_SSE2 1
+#else
+	#define OSM_XML_SCAN_SSE2 0
+#endif
+
+#define LOCTEXT_NAMESPACE "StreetMapImporting"
+
+namespace OSMXmlReader
+{
+	// How often we report progress while tokenizing
+	static const int64 ProgressInterval = 1024 * 1024;
+
+	static inline bool IsWhitespace( const ANSICHAR Char )
+	{
+		return Char == ' ' || Char == '\t' || Char == '\n' || Char == '\r';
+	}
+
+	static inline bool IsNameTerminator( const ANSICHAR Char )
+	{
+		return IsWhitespace( Char ) || Char == '>' || Char == '/' || Char == '=';
+	}
+
+	/** Returns a pointer to the first occurrence of Char, or nullptr if there isn't one before End */
+	static inline const ANSICHAR* FindChar( const ANSICHAR* Cursor, const ANSICHAR* End, const ANSICHAR Char )
+	{
+		return static_cast<const ANSICHAR*>( memchr( Cursor, Char, End - Cursor ) );
+	}
+
+	/** Returns a pointer to the first occurrence of the specified string, or nullptr if there isn't one before End */
+	static const ANSICHAR* FindString( const ANSICHAR* Cursor, const ANSICHAR* End, const ANSICHAR* String, const int32 StringLength )
+	{
+		while( ( Cursor = FindChar( Cursor, End, String[ 0 ] ) ) != nullptr )
+		{
+			if( End - Cursor < StringLength )
+			{
+				return nullptr;
+			}
+			if( FMemory::Memcmp( Cursor, String, StringLength ) == 0 )
+			{
+				return Cursor;
+			}
+			++Cursor;
+		}
+		return nullptr;
+	}
+
+	/** Counts the lines up to the specified position.  Only used to report errors. */
+	static int64 ComputeLineNumber( const ANSICHAR* Begin, const ANSICHAR* Position )
+	{
+		int64 LineNumber = 1;
+		while( ( Begin = FindChar( Begin, Position, '\n' ) ) != nullptr )
+		{
+			++LineNumber;
+			++Begin;
+		}
+		return LineNumber;
+	}
+
+	/** Appends a unicode code point to a UTF-8 byte buffer */
+	template<typename AllocatorType>
+	static void AppendUTF8( TArray<ANSICHAR, AllocatorType>& Out, const uint32 CodePoint )
+	{
+		if( CodePoint < 0x80 )
+		{
+			Out.Add( (ANSICHAR)CodePoint );
+		}
+		else if( CodePoint < 0x800 )
+		{
+			Out.Add( (ANSICHAR)( 0xC0 | ( CodePoint >> 6 ) ) );
+			Out.Add( (ANSICHAR)( 0x80 | ( CodePoint & 0x3F ) ) );
+		}
+		else if( CodePoint < 0x10000 )
+		{
+			Out.Add( (ANSICHAR)( 0xE0 | ( CodePoint >> 12 ) ) );
+			Out.Add( (ANSICHAR)( 0x80 | ( ( CodePoint >> 6 ) & 0x3F ) ) );
+			Out.Add( (ANSICHAR)( 0x80 | ( CodePoint & 0x3F ) ) );
+		}
+		else
+		{
+			Out.Add( (ANSICHAR)( 0xF0 | ( CodePoint >> 18 ) ) );
+			Out.Add( (ANSICHAR)( 0x80 | ( ( CodePoint >> 12 ) & 0x3F ) ) );
+			Out.Add( (ANSICHAR)( 0x80 | ( ( CodePoint >> 6 ) & 0x3F ) ) );
+			Out.Add( (ANSICHAR)( 0x80 | ( CodePoint & 0x3F ) ) );
+		}
+	}
+
+	/** Calls the visitor with a pointer to every '<' between Cursor and End, in order.  Tags are only a few dozen bytes
+	    apart in OpenStreetMap files, so calling memchr for each of them would spend most of its time on call overhead. */
+	template<typename VisitorType>
+	static void ForEachTagStart( const ANSICHAR* Cursor, const ANSICHAR* End, VisitorType Visitor )
+	{
+#if OSM_XML_SCAN_SSE2
+		const __m128i TagStartChars = _mm_set1_epi8( '<' );
+		for( ; End - Cursor >= 16; Cursor += 16 )
+		{
+			uint32 Matches = (uint32)_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( Cursor ) ), TagStartChars ) );
+			while( Matches != 0 )
+			{
+				Visitor( Cursor + FMath::CountTrailingZeros( Matches ) );
+				Matches &= Matches - 1;
+			}
+		}
+#endif
+		for( ; Cursor < End; ++Cursor )
+		{
+			if( *Cursor == '<' )
+			{
+				Visitor( Cursor );
+			}
+		}
+	}
+
+	/** Reads the attributes of a <bounds> element */
+	class FBoundsCallback : public IOSMXmlCallback
+	{
+
+	public:
+
+		FBoundsCallback( FOSMXmlSummary& InSummary )
+			: Summary( InSummary )
+		{
+		}
+
+		virtual bool ProcessElement( const FAnsiStringView ElementName ) override
+		{
+			return true;
+		}
+
+		virtual bool ProcessAttribute( const FAnsiStringView AttributeName, const FAnsiStringView AttributeValue ) override
+		{
+			if( AttributeName.Equals( ANSITEXTVIEW( "minlat" ) ) )
+			{
+				Summary.MinLatitude = FOSMXmlReader::ParseDouble( AttributeValue );
+				Summary.bHasBounds = true;
+			}
+			else if( AttributeName.Equals( ANSITEXTVIEW( "maxlat" ) ) )
+			{
+				Summary.MaxLatitude = FOSMXmlReader::ParseDouble( AttributeValue );
+			}
+			else if( AttributeName.Equals( ANSITEXTVIEW( "minlon" ) ) )
+			{
+				Summary.MinLongitude = FOSMXmlReader::ParseDouble( AttributeValue );
+			}
+			else if( AttributeName.Equals( ANSITEXTVIEW( "maxlon" ) ) )
+			{
+				Summary.MaxLongitude = FOSMXmlReader::ParseDouble( AttributeValue );
+			}
+			return true;
+		}
+
+		virtual bool ProcessClose( const FAnsiStringView ElementName ) override
+		{
+			return true;
+		}
+
+
+	private:
+
+		// Summary that receives the bounds
+		FOSMXmlSummary& Summary;
+	};
+}
+
+
+bool FOSMXmlReader::Parse( const TArrayView64<const uint8> Buffer, IOSMXmlCallback& Callback, TFunctionRef<bool( int64 )> ProgressCallback, FText& OutErrorMessage, int64& OutErrorLineNumber )
+{
+	using namespace OSMXmlReader;
+
+	OutErrorMessage = FText::GetEmpty();
+	OutErrorLineNumber = 0;
+
+	const ANSICHAR* Begin = reinterpret_cast<const ANSICHAR*>( Buffer.GetData() );
+	const ANSICHAR* End = Begin + Buffer.Num();
+	const ANSICHAR* Cursor = Begin;
+
+	// Skip the UTF-8 byte order mark, if there is one
+	if( End - Cursor >= 3 && (uint8)Cursor[ 0 ] == 0xEF && (uint8)Cursor[ 1 ] == 0xBB && (uint8)Cursor[ 2 ] == 0xBF )
+	{
+		Cursor += 3;
+	}
+
+	auto Fail = [&]( const FText& Message, const ANSICHAR* Position ) -> bool
+	{
+		OutErrorMessage = Message;
+		OutErrorLineNumber = ComputeLineNumber( Begin, Position );
+		return false;
+	};
+
+	auto Cancel = [&]() -> bool
+	{
+		OutErrorMessage = LOCTEXT( "OSMXmlReader_Cancelled", "Parsing was cancelled" );
+		return false;
+	};
+
+	int64 NextProgressOffset = ProgressInterval;
+
+	while( Cursor < End )
+	{
+		// Jump to the next tag.  Anything in between is character data, which OpenStreetMap doesn't use.
+		Cursor = FindChar( Cursor, End, '<' );
+		if( Cursor == nullptr )
+		{
+			break;
+		}
+
+		const ANSICHAR* TagStart = Cursor;
+		++Cursor;
+		if( Cursor >= End )
+		{
+			return Fail( LOCTEXT( "OSMXmlReader_UnexpectedEnd", "Unexpected end of file" ), TagStart );
+		}
+
+		if( *Cursor == '?' )
+		{
+			// XML declaration or processing instruction.  We don't care about these.
+			Cursor = FindString( Cursor, End, "?>", 2 );
+			if( Cursor == nullptr )
+			{
+				return Fail( LOCTEXT( "OSMXmlReader_UnterminatedDeclaration", "Unterminated XML declaration" ), TagStart );
+			}
+			Cursor += 2;
+		}
+		else if( *Cursor == '!' )
+		{
+			// Comment, CDATA or DOCTYPE.  We don't care about these either.
+			if( End - Cursor >= 3 && Cursor[ 1 ] == '-' && Cursor[ 2 ] == '-' )
+			{
+				Cursor = FindString( Cursor + 3, End, "-->", 3 );
+				if( Cursor == nullptr )
+				{
+					return Fail( LOCTEXT( "OSMXmlReader_UnterminatedComment", "Unterminated comment" ), TagStart );
+				}
+				Cursor += 3;
+			}
+			else if( End - Cursor >= 8 && FMemory::Memcmp( Cursor, "![CDATA[", 8 ) == 0 )
+			{
+				Cursor = FindString( Cursor + 8, End, "]]>", 3 );
+				if( Cursor == nullptr )
+				{
+					return Fail( LOCTEXT( "OSMXmlReader_UnterminatedCData", "Unterminated CDATA section" ), TagStart );
+				}
+				Cursor += 3;
+			}
+			else
+			{
+				Cursor = FindChar( Cursor, End, '>' );
+				if( Cursor == nullptr )
+				{
+					return Fail( LOCTEXT( "OSMXmlReader_UnterminatedTag", "Unterminated tag" ), TagStart );
+				}
+				++Cursor;
+			}
+		}
+		else if( *Cursor == '/' )
+		{
+			// Closing tag
+			++Cursor;
+			const ANSICHAR* NameStart = Cursor;
+			while( Cursor < End && !IsNameTerminator( *Cursor ) )
+			{
+				++Cursor;
+			}
+			const FAnsiStringView ElementName( NameStart, int32( Cursor - NameStart ) );
+
+			Cursor = FindChar( Cursor, End, '>' );
+			if( Cursor == nullptr )
+			{
+				return Fail( LOCTEXT( "OSMXmlReader_UnterminatedTag", "Unterminated tag" ), TagStart );
+			}
+			++Cursor;
+
+			if( !Callback.ProcessClose( ElementName ) )
+			{
+				return Cancel();
+			}
+		}
+		else
+		{
+			// Opening tag
+			const ANSICHAR* NameStart = Cursor;
+			while( Cursor < End && !IsNameTerminator( *Cursor ) )
+			{
+				++Cursor;
+			}
+			const FAnsiStringView ElementName( NameStart, int32( Cursor - NameStart ) );
+			if( ElementName.IsEmpty() )
+			{
+				return Fail( LOCTEXT( "OSMXmlReader_MissingElementName", "Missing element name" ), TagStart );
+			}
+
+			if( !Callback.ProcessElement( ElementName ) )
+			{
+				return Cancel();
+			}
+
+			// Attributes
+			for( ;; )
+			{
+				while( Cursor < End && IsWhitespace( *Cursor ) )
+				{
+					++Cursor;
+				}
+				if( Cursor >= End )
+				{
+					return Fail( LOCTEXT( "OSMXmlReader_UnterminatedTag", "Unterminated tag" ), TagStart );
+				}
+
+				if( *Cursor == '>' )
+				{
+					++Cursor;
+					break;
+				}
+				else if( *Cursor == '/' )
+				{
+					// Self-closing element
+					if( Cursor + 1 >= End || Cursor[ 1 ] != '>' )
+					{
+						return Fail( LOCTEXT( "OSMXmlReader_MalformedTag", "Malformed tag" ), TagStart );
+					}
+					Cursor += 2;
+
+					if( !Callback.ProcessClose( ElementName ) )
+					{
+						return Cancel();
+					}
+					break;
+				}
+
+				const ANSICHAR* AttributeNameStart = Cursor;
+				while( Cursor < End && !IsNameTerminator( *Cursor ) )
+				{
+					++Cursor;
+				}
+				const FAnsiStringView AttributeName( AttributeNameStart, int32( Cursor - AttributeNameStart ) );
+
+				while( Cursor < End && IsWhitespace( *Cursor ) )
+				{
+					++Cursor;
+				}
+				if( Cursor >= End || *Cursor != '=' )
+				{
+					return Fail( LOCTEXT( "OSMXmlReader_MissingEquals", "Expected '=' after attribute name" ), AttributeNameStart );
+				}
+				++Cursor;
+				while( Cursor < End && IsWhitespace( *Cursor ) )
+				{
+					++Cursor;
+				}
+
+				// Values may be delimited with either double or single quotes
+				if( Cursor >= End || ( *Cursor != '"' && *Cursor != '\'' ) )
+				{
+					return Fail( LOCTEXT( "OSMXmlReader_MissingQuote", "Expected quoted attribute value" ), AttributeNameStart );
+				}
+				const ANSICHAR Quote = *Cursor++;
+				const ANSICHAR* ValueStart = Cursor;
+				Cursor = FindChar( Cursor, End, Quote );
+				if( Cursor == nullptr )
+				{
+					return Fail( LOCTEXT( "OSMXmlReader_UnterminatedValue", "Unterminated attribute value" ), AttributeNameStart );
+				}
+				const FAnsiStringView AttributeValue( ValueStart, int32( Cursor - ValueStart ) );
+				++Cursor;
+
+				if( !Callback.ProcessAttribute( AttributeName, AttributeValue ) )
+				{
+					return Cancel();
+				}
+			}
+		}
+
+		if( Cursor - Begin >= NextProgressOffset )
+		{
+			NextProgressOffset = ( Cursor - Begin ) + ProgressInterval;
+			if( !ProgressCallback( Cursor - Begin ) )
+			{
+				return Cancel();
+			}
+		}
+	}
+
+	return true;
+}
+
+
+int64 FOSMXmlReader::FindElementBoundary( const TArrayView64<const uint8> Buffer, const int64 Offset )
+{
+	using namespace OSMXmlReader;
+
+	const ANSICHAR* Begin = reinterpret_cast<const ANSICHAR*>( Buffer.GetData() );
+	const ANSICHAR* End = Begin + Buffer.Num();
+	const ANSICHAR* Cursor = Begin + FMath::Clamp<int64>( Offset, 0, Buffer.Num() );
+
+	auto IsElementStart = [End]( const ANSICHAR* TagStart, const ANSICHAR* Name, const int32 NameLength ) -> bool
+	{
+		return End - TagStart > NameLength + 1 &&
+			FMemory::Memcmp( TagStart + 1, Name, NameLength ) == 0 &&
+			IsNameTerminator( TagStart[ NameLength + 1 ] );
+	};
+
+	while( ( Cursor = FindChar( Cursor, End, '<' ) ) != nullptr )
+	{
+		if( IsElementStart( Cursor, "node", 4 ) || IsElementStart( Cursor, "way", 3 ) || IsElementStart( Cursor, "relation", 8 ) )
+		{
+			return Cursor - Begin;
+		}
+		++Cursor;
+	}
+
+	return Buffer.Num();
+}
+
+
+void FOSMXmlReader::Scan( const TArrayView64<const uint8> Buffer, FOSMXmlSummary& OutSummary )
+{
+	using namespace OSMXmlReader;
+
+	const ANSICHAR* Begin = reinterpret_cast<const ANSICHAR*>( Buffer.GetData() );
+	const ANSICHAR* End = Begin + Buffer.Num();
+
+	auto IsElementStart = [End]( const ANSICHAR* TagStart, const ANSICHAR* Name, const int32 NameLength ) -> bool
+	{
+		return End - TagStart > NameLength + 1 &&
+			FMemory::Memcmp( TagStart + 1, Name, NameLength ) == 0 &&
+			IsNameTerminator( TagStart[ NameLength + 1 ] );
+	};
+
+	ForEachTagStart( Begin, End, [&]( const ANSICHAR* TagStart )
+	{
+		// Ordered by how common each element is.  Closing tags and tags we don't care about fail on their first character.
+		if( End - TagStart < 2 )
+		{
+			return;
+		}
+		const ANSICHAR FirstChar = TagStart[ 1 ];
+		if( FirstChar == 'n' )
+		{
+			if( IsElementStart( TagStart, "nd", 2 ) )
+			{
+				++OutSummary.WayNodeRefCount;
+			}
+			else if( IsElementStart( TagStart, "node", 4 ) )
+			{
+				++OutSummary.NodeCount;
+			}
+		}
+		else if( FirstChar == 'w' && IsElementStart( TagStart, "way", 3 ) )
+		{
+			++OutSummary.WayCount;
+		}
+		else if( FirstChar == 'r' && IsElementStart( TagStart, "relation", 8 ) )
+		{
+			++OutSummary.RelationCount;
+		}
+		else if( FirstChar == 'b' && !OutSummary.bHasBounds && IsElementStart( TagStart, "bounds", 6 ) )
+		{
+			// Bounds are a single element, so we can tokenize just that element to read them
+			const ANSICHAR* TagEnd = FindChar( TagStart, End, '>' );
+			if( TagEnd != nullptr )
+			{
+				const int64 TagOffset = TagStart - Begin;
+				FBoundsCallback BoundsCallback( OutSummary );
+				FText ErrorMessage;
+				int64 ErrorLineNumber;
+				Parse( Buffer.Slice( TagOffset, ( TagEnd + 1 - Begin ) - TagOffset ), BoundsCallback, []( const int64 BytesProcessed ) { return true; }, ErrorMessage, ErrorLineNumber );
+			}
+		}
+	} );
+}
+
+
+void FOSMXmlSummary::Merge( const FOSMXmlSummary& Other )
+{
+	NodeCount += Other.NodeCount;
+	WayCount += Other.WayCount;
+	WayNodeRefCount += Other.WayNodeRefCount;
+	RelationCount += Other.RelationCount;
+
+	if( !bHasBounds && Other.bHasBounds )
+	{
+		bHasBounds = true;
+		MinLatitude = Other.MinLatitude;
+		MaxLatitude = Other.MaxLatitude;
+		MinLongitude = Other.MinLongitude;
+		MaxLongitude = Other.MaxLongitude;
+	}
+}
+
+
+int64 FOSMXmlReader::ComputeLineNumber( const TArrayView64<const uint8> Buffer, const int64 Offset )
+{
+	const ANSICHAR* Begin = reinterpret_cast<const ANSICHAR*>( Buffer.GetData() );
+	return OSMXmlReader::ComputeLineNumber( Begin, Begin + FMath::Clamp<int64>( Offset, 0, Buffer.Num() ) );
+}
+
+
+int64 FOSMXmlReader::ParseInt64( const FAnsiStringView Value )
+{
+	const ANSICHAR* Cursor = Value.GetData();
+	const ANSICHAR* End = Cursor + Value.Len();
+
+	bool bIsNegative = false;
+	if( Cursor < End && ( *Cursor == '-' || *Cursor == '+' ) )
+	{
+		bIsNegative = *Cursor == '-';
+		++Cursor;
+	}
+
+	uint64 Result = 0;
+	while( Cursor < End && *Cursor >= '0' && *Cursor <= '9' )
+	{
+		Result = Result * 10 + ( *Cursor - '0' );
+		++Cursor;
+	}
+
+	return bIsNegative ? -(int64)Result : (int64)Result;
+}
+
+
+double FOSMXmlReader::ParseDouble( const FAnsiStringView Value )
+{
+	// Exactly representable powers of ten.  Multiplying or dividing an exact mantissa by one of these is correctly rounded.
+	static const double PowersOfTen[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	static const uint64 MaxExactMantissa = 1ull << 53;
+
+	const ANSICHAR* Cursor = Value.GetData();
+	const ANSICHAR* End = Cursor + Value.Len();
+
+	bool bIsNegative = false;
+	if( Cursor < End && ( *Cursor == '-' || *Cursor == '+' ) )
+	{
+		bIsNegative = *Cursor == '-';
+		++Cursor;
+	}
+
+	uint64 Mantissa = 0;
+	int32 Exponent = 0;
+	int32 DigitCount = 0;
+	while( Cursor < End && *Cursor >= '0' && *Cursor <= '9' )
+	{
+		Mantissa = Mantissa * 10 + ( *Cursor++ - '0' );
+		++DigitCount;
+	}
+	if( Cursor < End && *Cursor == '.' )
+	{
+		++Cursor;
+		while( Cursor < End && *Cursor >= '0' && *Cursor <= '9' )
+		{
+			Mantissa = Mantissa * 10 + ( *Cursor++ - '0' );
+			++DigitCount;
+			--Exponent;
+		}
+	}
+	if( Cursor < End && ( *Cursor == 'e' || *Cursor == 'E' ) )
+	{
+		++Cursor;
+		Exponent += (int32)ParseInt64( FAnsiStringView( Cursor, int32( End - Cursor ) ) );
+		Cursor = End;
+	}
+
+	// Coordinates in OpenStreetMap files have at most seven decimal places, so we'll nearly always take the fast path
+	if( DigitCount <= 18 && Mantissa <= MaxExactMantissa && Exponent >= -22 && Exponent <= 22 && Cursor == End )
+	{
+		const double Result = Exponent < 0 ? (double)Mantissa / PowersOfTen[ -Exponent ] : (double)Mantissa * PowersOfTen[ Exponent ];
+		return bIsNegative ? -Result : Result;
+	}
+
+	// Slow path for anything unusual
+	ANSICHAR Terminated[ 64 ];
+	const int32 CopyLength = FMath::Min( Value.Len(), (int32)UE_ARRAY_COUNT( Terminated ) - 1 );
+	FMemory::Memcpy( Terminated, Value.GetData(), CopyLength );
+	Terminated[ CopyLength ] = 0;
+	return FCStringAnsi::Atod( Terminated );
+}
+
+
+FString FOSMXmlReader::ToString( const FAnsiStringView Value )
+{
+	TArray<TCHAR> Chars;
+	AppendString( Value, Chars );
+	return FString( Chars.Num(), Chars.GetData() );
+}
+
+
+void FOSMXmlReader::AppendString( const FAnsiStringView Value, TArray<TCHAR>& Out )
+{
+	using namespace OSMXmlReader;
+
+	TArray<ANSICHAR, TInlineAllocator<256>> Unescaped;
+	Unescaped.Reserve( Value.Len() );
+
+	const ANSICHAR* Cursor = Value.GetData();
+	const ANSICHAR* End = Cursor + Value.Len();
+	while( Cursor < End )
+	{
+		if( *Cursor == '&' )
+		{
+			const ANSICHAR* EntityEnd = FindChar( Cursor, End, ';' );
+			if( EntityEnd != nullptr )
+			{
+				const FAnsiStringView Entity( Cursor + 1, int32( EntityEnd - Cursor - 1 ) );
+				bool bDecoded = true;
+				if( Entity.Equals( ANSITEXTVIEW( "amp" ) ) )
+				{
+					Unescaped.Add( '&' );
+				}
+				else if( Entity.Equals( ANSITEXTVIEW( "lt" ) ) )
+				{
+					Unescaped.Add( '<' );
+				}
+				else if( Entity.Equals( ANSITEXTVIEW( "gt" ) ) )
+				{
+					Unescaped.Add( '>' );
+				}
+				else if( Entity.Equals( ANSITEXTVIEW( "quot" ) ) )
+				{
+					Unescaped.Add( '"' );
+				}
+				else if( Entity.Equals( ANSITEXTVIEW( "apos" ) ) )
+				{
+					Unescaped.Add( '\'' );
+				}
+				else if( Entity.Len() > 1 && Entity[ 0 ] == '#' )
+				{
+					// Numeric character reference, either decimal or hexadecimal
+					uint32 CodePoint = 0;
+					if( Entity[ 1 ] == 'x' || Entity[ 1 ] == 'X' )
+					{
+						for( int32 CharIndex = 2; CharIndex < Entity.Len(); ++CharIndex )
+						{
+							const ANSICHAR Char = Entity[ CharIndex ];
+							const uint32 Digit =
+								( Char >= '0' && Char <= '9' ) ? ( Char - '0' ) :
+								( Char >= 'a' && Char <= 'f' ) ? ( Char - 'a' + 10 ) :
+								( Char >= 'A' && Char <= 'F' ) ? ( Char - 'A' + 10 ) : 0;
+							CodePoint = CodePoint * 16 + Digit;
+						}
+					}
+					else
+					{
+						CodePoint = (uint32)ParseInt64( Entity.RightChop( 1 ) );
+					}
+					AppendUTF8( Unescaped, CodePoint );
+				}
+				else
+				{
+					bDecoded = false;
+				}
+
+				if( bDecoded )
+				{
+					Cursor = EntityEnd + 1;
+					continue;
+				}
+			}
+		}
+
+		Unescaped.Add( *Cursor++ );
+	}
+
+	const FUTF8ToTCHAR Converted( Unescaped.GetData(), Unescaped.Num() );
+	Out.Append( Converted.Get(), Converted.Length() );
+}
+
+#undef LOCTEXT_NAMESPACE
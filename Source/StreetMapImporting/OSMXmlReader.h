@@ -0,0 +1,93 @@
+#pragma once
+#include "CoreMinimal.h"
+
+/** Receives the elements and attributes found by FOSMXmlReader, in document order.  All string views point directly
+    into the source buffer and are only valid for the duration of the call. */
+class IOSMXmlCallback
+{
+
+public:
+
+	virtual ~IOSMXmlCallback()
+	{
+	}
+
+	/** Called when an element is opened.  Return false to stop parsing. */
+	virtual bool ProcessElement( const FAnsiStringView ElementName ) = 0;
+
+	/** Called for each attribute on the most recently opened element.  The value is still XML-escaped.  Return false to stop parsing. */
+	virtual bool ProcessAttribute( const FAnsiStringView AttributeName, const FAnsiStringView AttributeValue ) = 0;
+
+	/** Called when an element is closed, including self-closing elements.  Return false to stop parsing. */
+	virtual bool ProcessClose( const FAnsiStringView ElementName ) = 0;
+};
+
+
+/** What a quick scan of (part of) an OpenStreetMap XML file found.  Used to size arrays before the file is parsed, and
+    to show a summary of the file before importing it. */
+struct FOSMXmlSummary
+{
+	/** Number of each kind of element */
+	int64 NodeCount = 0;
+	int64 WayCount = 0;
+	int64 WayNodeRefCount = 0;
+	int64 RelationCount = 0;
+
+	/** True if the file is compressed.  Its elements can't be counted without decompressing all of it, so only the bounds are known. */
+	bool bIsCompressed = false;
+
+	/** Bounds from the file's <bounds> element, if it has one */
+	bool bHasBounds = false;
+	double MinLatitude = 0.0;
+	double MaxLatitude = 0.0;
+	double MinLongitude = 0.0;
+	double MaxLongitude = 0.0;
+
+	/** Adds the results from a scan of another part of the same file */
+	void Merge( const FOSMXmlSummary& Other );
+};
+
+
+/** Minimal, zero-copy XML tokenizer for OpenStreetMap files.  Works directly on the UTF-8 bytes of the file (which will
+    usually be memory-mapped), so we never need to widen or copy the source data. */
+class FOSMXmlReader
+{
+
+public:
+
+	/**
+	 * Tokenizes the specified buffer, sending every element and attribute to the callback
+	 *
+	 * @param	Buffer				UTF-8 XML data
+	 * @param	Callback			Receives the elements and attributes
+	 * @param	ProgressCallback	Called periodically with the number of bytes processed so far.  Return false to cancel.
+	 * @param	OutErrorMessage		If parsing fails, describes the problem
+	 * @param	OutErrorLineNumber	If parsing fails, the line the problem was found on
+	 *
+	 * @return	True if the whole buffer was parsed successfully
+	 */
+	static bool Parse( const TArrayView64<const uint8> Buffer, IOSMXmlCallback& Callback, TFunctionRef<bool( int64 )> ProgressCallback, FText& OutErrorMessage, int64& OutErrorLineNumber );
+
+	/** Counts the elements in the buffer and reads the <bounds> element, without tokenizing anything else.  This only
+	    looks at the bytes following each '<', which it finds 16 bytes at a time where the CPU allows. */
+	static void Scan( const TArrayView64<const uint8> Buffer, FOSMXmlSummary& OutSummary );
+
+	/** Finds the start of the next top-level OpenStreetMap element ("node", "way" or "relation") at or after the specified offset.
+	    Returns the size of the buffer if there isn't one.  The file can be split at these offsets into chunks that parse independently. */
+	static int64 FindElementBoundary( const TArrayView64<const uint8> Buffer, const int64 Offset );
+
+	/** Counts the lines before the specified offset.  Only intended for error reporting. */
+	static int64 ComputeLineNumber( const TArrayView64<const uint8> Buffer, const int64 Offset );
+
+	/** Parses an integer attribute value */
+	static int64 ParseInt64( const FAnsiStringView Value );
+
+	/** Parses a floating point attribute value */
+	static double ParseDouble( const FAnsiStringView Value );
+
+	/** Converts an attribute value to a string, decoding UTF-8 and any XML character entities */
+	static FString ToString( const FAnsiStringView Value );
+
+	/** Same as ToString, but appends the characters to an existing array instead of allocating a new string */
+	static void AppendString( const FAnsiStringView Value, TArray<TCHAR>& Out );
+};
@@ -2,6 +2,15 @@
 #include "StreetMap.h"
 #include "AssetRegistry/AssetData.h"
 #include "EditorFramework/AssetImportData.h"
+#include "OSMSourceFile.h"
+#include "StreetMapChangeApplier.h"
+#include "DesktopPlatformModule.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Misc/MessageDialog.h"
+#include "ScopedTransaction.h"
+#include "ToolMenuSection.h"
+#include "Widgets/Notifications/SNotificationList.h"
 
 #define LOCTEXT_NAMESPACE "StreetMapImporting"
 
@@ -60,4 +69,98 @@ void FStreetMapAssetTypeActions::GetResolvedSourceFilePaths(const TArray<UObject
 	}
 }
 
+
+bool FStreetMapAssetTypeActions::HasActions( const TArray<UObject*>& InObjects ) const
+{
+	return true;
+}
+
+
+void FStreetMapAssetTypeActions::GetActions( const TArray<UObject*>& InObjects, FToolMenuSection& Section )
+{
+	TArray<TWeakObjectPtr<UStreetMap>> StreetMaps = GetTypedWeakObjectPtrs<UStreetMap>( InObjects );
+
+	Section.AddMenuEntry(
+		"StreetMap_ApplyChangeFile",
+		LOCTEXT( "StreetMap_ApplyChangeFile", "Apply OSM Change File..." ),
+		LOCTEXT( "StreetMap_ApplyChangeFileTooltip", "Updates the street map with the changes in an OpenStreetMap change file (.osc), without importing everything again." ),
+		FSlateIcon(),
+		FUIAction( FExecuteAction::CreateSP( this, &FStreetMapAssetTypeActions::ExecuteApplyChangeFile, StreetMaps ) ) );
+}
+
+
+void FStreetMapAssetTypeActions::ExecuteApplyChangeFile( TArray<TWeakObjectPtr<UStreetMap>> StreetMaps )
+{
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if( DesktopPlatform == nullptr )
+	{
+		return;
+	}
+
+	TArray<FString> Filenames;
+	const bool bChoseFile = DesktopPlatform->OpenFileDialog(
+		FSlateApplication::Get().FindBestParentWindowHandleForDialogs( nullptr ),
+		LOCTEXT( "ApplyChangeFile_DialogTitle", "Choose an OpenStreetMap change file" ).ToString(),
+		FString(),
+		FString(),
+		TEXT( "OpenStreetMap change file (*.osc)|*.osc" ),
+		EFileDialogFlags::None,
+		Filenames );
+	if( !bChoseFile || Filenames.Num() == 0 )
+	{
+		return;
+	}
+
+	const FString& Filename = Filenames[ 0 ];
+	const FText CleanFilename = FText::FromString( FPaths::GetCleanFilename( Filename ) );
+
+	FOSMSourceFile ChangeFile;
+	if( !ChangeFile.Open( Filename ) )
+	{
+		FMessageDialog::Open( EAppMsgType::Ok, FText::Format( LOCTEXT( "ApplyChangeFile_OpenFailed", "Unable to open {0}" ), CleanFilename ) );
+		return;
+	}
+
+	for( const TWeakObjectPtr<UStreetMap>& WeakStreetMap : StreetMaps )
+	{
+		UStreetMap* StreetMap = WeakStreetMap.Get();
+		if( StreetMap == nullptr )
+		{
+			continue;
+		}
+
+		FScopedTransaction Transaction( LOCTEXT( "ApplyChangeFile_Transaction", "Apply OSM Change File" ) );
+
+		FStreetMapChangeStats Stats;
+		FText ErrorMessage;
+		if( !FStreetMapChangeApplier::Apply( StreetMap, ChangeFile.GetData(), Stats, ErrorMessage ) )
+		{
+			Transaction.Cancel();
+			FMessageDialog::Open( EAppMsgType::Ok, FText::Format( LOCTEXT( "ApplyChangeFile_Failed", "Unable to apply {0} to {1}: {2}" ), CleanFilename, FText::FromString( StreetMap->GetName() ), ErrorMessage ) );
+			continue;
+		}
+
+		StreetMap->PostEditChange();
+		StreetMap->MarkPackageDirty();
+
+		if( Stats.MissingNodeRefs > 0 )
+		{
+			GWarn->Logf( ELogVerbosity::Warning, TEXT( "%i node references in '%s' couldn't be found in %s, so the ways using them were cut.  Reimport the street map for an exact result." ),
+				Stats.MissingNodeRefs, *Filename, *StreetMap->GetName() );
+		}
+
+		FNotificationInfo Info( FText::Format(
+			LOCTEXT( "ApplyChangeFile_Succeeded", "Applied {0} to {1}: {2} roads and {3} buildings removed, {4} roads and {5} buildings added, {6} points moved" ),
+			CleanFilename,
+			FText::FromString( StreetMap->GetName() ),
+			FText::AsNumber( Stats.RoadsRemoved ),
+			FText::AsNumber( Stats.BuildingsRemoved ),
+			FText::AsNumber( Stats.RoadsAdded ),
+			FText::AsNumber( Stats.BuildingsAdded ),
+			FText::AsNumber( Stats.PointsMoved ) ) );
+		Info.ExpireDuration = 5.0f;
+		FSlateNotificationManager::Get().AddNotification( Info );
+	}
+}
+
 #undef LOCTEXT_NAMESPACE
@@ -1,6 +1,8 @@
 #pragma once
 #include "AssetTypeActions_Base.h"
 
+class UStreetMap;
+
 class FStreetMapAssetTypeActions : public FAssetTypeActions_Base
 {
 public:
@@ -14,4 +16,11 @@ public:
 	virtual FText GetAssetDescription(const FAssetData& AssetData) const override;
 	virtual bool IsImportedAsset() const override;
 	virtual void GetResolvedSourceFilePaths( const TArray<UObject*>& TypeAssets, TArray<FString>& OutSourceFilePaths ) const override;
+	virtual bool HasActions( const TArray<UObject*>& InObjects ) const override;
+	virtual void GetActions( const TArray<UObject*>& InObjects, struct FToolMenuSection& Section ) override;
+
+private:
+
+	/** Asks for an OpenStreetMap change file, and applies it to the specified street maps */
+	void ExecuteApplyChangeFile( TArray<TWeakObjectPtr<UStreetMap>> StreetMaps );
 };
@@ -0,0 +1,546 @@
+#include "StreetMapChangeApplier.h"
+#include "OSMChangeFile.h"
+#include "StreetMap.h"
+#include "StreetMapAssetImportData.h"
+#include "StreetMapFactory.h"
+#include "StreetMapWayConverter.h"
+
+#define LOCTEXT_NAMESPACE "StreetMapImporting"
+
+namespace StreetMapChangeApplier
+{
+	/** How a road or building is affected by a change file */
+	enum class EElementChange : uint8
+	{
+		// Nothing about it changed
+		Unchanged,
+
+		// Some of its nodes moved, but it's otherwise the same
+		Moved,
+
+		// Its way was modified or deleted, so it has to go.  If the way is still around, its new version is added again.
+		Replaced,
+
+		// Some of its nodes were deleted, so it has to be cut apart (roads) or removed (buildings)
+		LostNodes
+	};
+
+
+	/** Calls the function for each run of consecutive points that are present and at least MinRunLength long */
+	static void ForEachPresentRun( const TArrayView<const bool> IsPresent, const int32 MinRunLength, TFunctionRef<void( int32 RunStart, int32 RunLength )> Function )
+	{
+		int32 PointIndex = 0;
+		while( PointIndex < IsPresent.Num() )
+		{
+			// Skip over missing points, then find the end of the run of points that are present
+			while( PointIndex < IsPresent.Num() && !IsPresent[ PointIndex ] )
+			{
+				++PointIndex;
+			}
+			const int32 RunStart = PointIndex;
+			while( PointIndex < IsPresent.Num() && IsPresent[ PointIndex ] )
+			{
+				++PointIndex;
+			}
+
+			if( PointIndex - RunStart >= MinRunLength )
+			{
+				Function( RunStart, PointIndex - RunStart );
+			}
+		}
+	}
+}
+
+
+bool FStreetMapChangeApplier::Apply( UStreetMap* StreetMap, const TArrayView64<const uint8> Buffer, FStreetMapChangeStats& OutStats, FText& OutErrorMessage )
+{
+	using namespace StreetMapChangeApplier;
+
+	const double StartTime = FPlatformTime::Seconds();
+	OutStats = FStreetMapChangeStats();
+
+	// Ways can move from one tile to another, which would mean moving them between assets, so tiled street maps are
+	// reimported instead
+	if( StreetMap->IsTile() || StreetMap->Tiles.Num() > 0 )
+	{
+		OutErrorMessage = LOCTEXT( "ApplyChanges_Tiled", "Change files can't be applied to street maps that were split into tiles.  Reimport the street map instead." );
+		return false;
+	}
+
+	FStreetMapOSMSource& OSMSource = StreetMap->OSMSource;
+	if( !OSMSource.IsValid() || !StreetMap->GetProjection().IsValid() )
+	{
+		OutErrorMessage = LOCTEXT( "ApplyChanges_NoSource", "This street map doesn't know which OpenStreetMap ways and nodes it was built from.  Reimport it once, then try again." );
+		return false;
+	}
+
+	// Roads and nodes are patched where they are, in the buffers they share.  Only the parts of the buffers that belong
+	// to roads and nodes that change are rewritten, and the street map is bound to them again at the end.
+	TArray<FStreetMapRoad>& Roads = StreetMap->Roads;
+	TArray<FStreetMapNode>& Nodes = StreetMap->Nodes;
+	TArray<FVector2D>& RoadPoints = StreetMap->RoadPoints;
+	TArray<int32>& RoadNodeIndices = StreetMap->RoadNodeIndices;
+	TArray<FStreetMapRoadRef>& NodeRoadRefs = StreetMap->NodeRoadRefs;
+	TArray<FStreetMapBuilding>& Buildings = StreetMap->Buildings;
+
+	// Find where each road's and building's nodes start in the list of point node IDs.  Road points come first,
+	// followed by building points.
+	TArray<int64> PointNodeIDs;
+	OSMSource.GetPointNodeIDs( PointNodeIDs );
+
+	// Roads and nodes are only ever moved down their buffers when they're compacted below, so they have to be packed
+	// one after another, the way imports pack them
+	bool bIsPackedInOrder = RoadPoints.Num() == RoadNodeIndices.Num();
+	int32 PointCount = 0;
+	TArray<int32> RoadPointOffsets;
+	RoadPointOffsets.SetNumUninitialized( Roads.Num() + 1 );
+	for( int32 RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex )
+	{
+		bIsPackedInOrder &= Roads[ RoadIndex ].FirstPointIndex == PointCount;
+		RoadPointOffsets[ RoadIndex ] = PointCount;
+		PointCount += Roads[ RoadIndex ].PointCount;
+	}
+	RoadPointOffsets.Last() = PointCount;
+	bIsPackedInOrder &= RoadPoints.Num() == PointCount;
+
+	int32 RoadRefCount = 0;
+	for( const FStreetMapNode& Node : Nodes )
+	{
+		bIsPackedInOrder &= Node.FirstRoadRefIndex == RoadRefCount;
+		RoadRefCount += Node.RoadRefCount;
+	}
+	bIsPackedInOrder &= NodeRoadRefs.Num() == RoadRefCount;
+
+	TArray<int32> BuildingPointOffsets;
+	BuildingPointOffsets.SetNumUninitialized( Buildings.Num() + 1 );
+	for( int32 BuildingIndex = 0; BuildingIndex < Buildings.Num(); ++BuildingIndex )
+	{
+		BuildingPointOffsets[ BuildingIndex ] = PointCount;
+		PointCount += Buildings[ BuildingIndex ].BuildingPoints.Num();
+	}
+	BuildingPointOffsets.Last() = PointCount;
+
+	if( !bIsPackedInOrder || OSMSource.RoadWayIDs.Num() != Roads.Num() || OSMSource.BuildingWayIDs.Num() != Buildings.Num() || PointNodeIDs.Num() != PointCount )
+	{
+		OutErrorMessage = LOCTEXT( "ApplyChanges_SourceMismatch", "This street map's roads and buildings no longer match the OpenStreetMap data they were built from.  Reimport it, then try again." );
+		return false;
+	}
+
+	FOSMChangeFile ChangeFile( StreetMap->ImportSettings );
+	if( !ChangeFile.LoadOpenStreetMapChangeFile( Buffer, /* Out */ OutErrorMessage ) )
+	{
+		return false;
+	}
+
+	// Project the nodes that moved into map space, the same way the import did
+	const FStreetMapProjection& Projection = StreetMap->GetProjection();
+	TMap<int64, FVector2D> MovedNodePositions;
+	for( const TPair<int64, FOSMChangeFile::FOSMChangedNode>& ChangedNode : ChangeFile.ChangedNodes )
+	{
+		if( !ChangedNode.Value.bIsDeleted )
+		{
+			MovedNodePositions.Add( ChangedNode.Key, Projection.GeoToWorld( ChangedNode.Value.Latitude, ChangedNode.Value.Longitude ) );
+		}
+	}
+
+	// Find the ways we'll be adding, in file order.  Their nodes that didn't change aren't in the change file, so
+	// we'll have to find those in the street map.
+	TArray<const FOSMFile::FOSMWayInfo*> NewWays;
+	TSet<int64> NeededNodeIDs;
+	for( int32 WayIndex = 0; WayIndex < ChangeFile.Batch.Ways.Num(); ++WayIndex )
+	{
+		const FOSMFile::FOSMWayInfo& Way = ChangeFile.Batch.Ways[ WayIndex ];
+		const int32* LatestWayIndex = ChangeFile.LatestWayIndices.Find( Way.ID );
+		if( LatestWayIndex != nullptr && *LatestWayIndex == WayIndex )
+		{
+			NewWays.Add( &Way );
+			for( const int64 NodeID : ChangeFile.GetWayNodeIDs( Way ) )
+			{
+				if( !ChangeFile.ChangedNodes.Contains( NodeID ) )
+				{
+					NeededNodeIDs.Add( NodeID );
+				}
+			}
+		}
+	}
+
+	StreetMap->Modify();
+
+	// Moves the points of a road or building whose nodes moved, and works out what else needs to happen to it.  Also
+	// picks up the positions of any unchanged nodes that the new ways need.
+	TMap<int64, FVector2D> KnownNodePositions;
+	auto UpdatePoints = [&]( const int64 WayID, const TArrayView<FVector2D> Points, const int32 FirstPointIndex, TArray<bool>& OutIsPresent )
+	{
+		const bool bIsReplaced = ChangeFile.ChangedWayIDs.Contains( WayID );
+		EElementChange Change = bIsReplaced ? EElementChange::Replaced : EElementChange::Unchanged;
+		OutIsPresent.Init( true, Points.Num() );
+		for( int32 PointIndex = 0; PointIndex < Points.Num(); ++PointIndex )
+		{
+			const int64 NodeID = PointNodeIDs[ FirstPointIndex + PointIndex ];
+			if( NeededNodeIDs.Contains( NodeID ) )
+			{
+				KnownNodePositions.Add( NodeID, Points[ PointIndex ] );
+			}
+
+			const FOSMChangeFile::FOSMChangedNode* ChangedNode = bIsReplaced ? nullptr : ChangeFile.ChangedNodes.Find( NodeID );
+			if( ChangedNode == nullptr )
+			{
+				continue;
+			}
+
+			if( ChangedNode->bIsDeleted )
+			{
+				OutIsPresent[ PointIndex ] = false;
+				Change = EElementChange::LostNodes;
+			}
+			else
+			{
+				Points[ PointIndex ] = MovedNodePositions.FindChecked( NodeID );
+				++OutStats.PointsMoved;
+				if( Change == EElementChange::Unchanged )
+				{
+					Change = EElementChange::Moved;
+				}
+			}
+		}
+		return Change;
+	};
+
+	// Go through the roads we have.  Roads that lost nodes are cut into pieces wherever the nodes are missing, just
+	// like the import does.  Intersections can only change at the nodes of roads that are removed or added.
+	TArray<bool> IsPresent;
+	TArray<bool> KeepRoad;
+	KeepRoad.Init( true, Roads.Num() );
+	TArray<FStreetMapImportRoad> AddedRoads;
+	TArray<int64> AddedRoadWayIDs;
+	TArray<int64> AddedRoadNodeIDs;
+	TSet<int64> AffectedNodeIDs;
+	for( int32 RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex )
+	{
+		FStreetMapRoad& Road = Roads[ RoadIndex ];
+		const TArrayView<FVector2D> Points = MakeArrayView( RoadPoints ).Slice( Road.FirstPointIndex, Road.PointCount );
+		const int64 WayID = OSMSource.RoadWayIDs[ RoadIndex ];
+		const int32 FirstPointIndex = RoadPointOffsets[ RoadIndex ];
+		const EElementChange Change = UpdatePoints( WayID, Points, FirstPointIndex, IsPresent );
+		if( Change == EElementChange::Moved )
+		{
+			FStreetMapWayConverter::ComputeBounds( Points, Road.BoundsMin, Road.BoundsMax );
+		}
+		else if( Change != EElementChange::Unchanged )
+		{
+			KeepRoad[ RoadIndex ] = false;
+			++OutStats.RoadsRemoved;
+			for( int32 PointIndex = 0; PointIndex < Points.Num(); ++PointIndex )
+			{
+				AffectedNodeIDs.Add( PointNodeIDs[ FirstPointIndex + PointIndex ] );
+			}
+
+			if( Change == EElementChange::LostNodes )
+			{
+				ForEachPresentRun( IsPresent, 2, [&]( const int32 RunStart, const int32 RunLength )
+				{
+					FStreetMapImportRoad& Piece = AddedRoads.AddDefaulted_GetRef();
+					Piece.RoadName = Road.RoadName;
+					Piece.RoadType = Road.RoadType;
+					Piece.bIsOneWay = Road.IsOneWay();
+					Piece.RoadPoints.Append( Points.GetData() + RunStart, RunLength );
+					Piece.NodeIndices.Init( INDEX_NONE, RunLength );
+					FStreetMapWayConverter::ComputeBounds( Piece.RoadPoints, Piece.BoundsMin, Piece.BoundsMax );
+
+					AddedRoadWayIDs.Add( WayID );
+					AddedRoadNodeIDs.Append( PointNodeIDs.GetData() + FirstPointIndex + RunStart, RunLength );
+				} );
+			}
+		}
+	}
+
+	// Buildings with missing nodes are removed, as their outline would be wrong
+	TArray<bool> KeepBuilding;
+	KeepBuilding.Init( true, Buildings.Num() );
+	for( int32 BuildingIndex = 0; BuildingIndex < Buildings.Num(); ++BuildingIndex )
+	{
+		FStreetMapBuilding& Building = Buildings[ BuildingIndex ];
+		const EElementChange Change = UpdatePoints( OSMSource.BuildingWayIDs[ BuildingIndex ], Building.BuildingPoints, BuildingPointOffsets[ BuildingIndex ], IsPresent );
+		if( Change == EElementChange::Moved )
+		{
+			FStreetMapWayConverter::ComputeBounds( Building.BuildingPoints, Building.BoundsMin, Building.BoundsMax );
+		}
+		else if( Change != EElementChange::Unchanged )
+		{
+			KeepBuilding[ BuildingIndex ] = false;
+			++OutStats.BuildingsRemoved;
+		}
+	}
+
+	// Build the roads and buildings for the ways that were created or modified.  Nodes that are neither in the change
+	// file nor in the street map are treated like nodes that are missing from an import.
+	TArray<FStreetMapBuilding> AddedBuildings;
+	TArray<int64> AddedBuildingWayIDs;
+	TArray<int64> AddedBuildingNodeIDs;
+	TArray<FVector2D> WayPoints;
+	for( const FOSMFile::FOSMWayInfo* Way : NewWays )
+	{
+		const TArrayView<const int64> WayNodeIDs = ChangeFile.GetWayNodeIDs( *Way );
+		WayPoints.SetNumUninitialized( WayNodeIDs.Num() );
+		IsPresent.Init( true, WayNodeIDs.Num() );
+		bool bHasAllNodes = true;
+		for( int32 PointIndex = 0; PointIndex < WayNodeIDs.Num(); ++PointIndex )
+		{
+			const FVector2D* Position = MovedNodePositions.Find( WayNodeIDs[ PointIndex ] );
+			if( Position == nullptr )
+			{
+				Position = KnownNodePositions.Find( WayNodeIDs[ PointIndex ] );
+			}
+
+			if( Position != nullptr )
+			{
+				WayPoints[ PointIndex ] = *Position;
+			}
+			else
+			{
+				IsPresent[ PointIndex ] = false;
+				bHasAllNodes = false;
+				++OutStats.MissingNodeRefs;
+			}
+		}
+
+		FString Name = ChangeFile.GetString( Way->Name );
+		if( Name.IsEmpty() )
+		{
+			Name = ChangeFile.GetString( Way->Ref );
+		}
+
+		if( ChangeFile.TagClassifier.GetRule( Way->TagRuleIndex ).bIsBuilding )
+		{
+			if( bHasAllNodes && WayNodeIDs.Num() > 2 )
+			{
+				FStreetMapBuilding& NewBuilding = AddedBuildings.AddDefaulted_GetRef();
+				FStreetMapWayConverter::FillBuilding( *Way, MoveTemp( Name ), TArray<FVector2D>( WayPoints ), NewBuilding );
+
+				// The building may have lost its closing point, so only take as many nodes as it has points
+				AddedBuildingWayIDs.Add( Way->ID );
+				AddedBuildingNodeIDs.Append( WayNodeIDs.GetData(), NewBuilding.BuildingPoints.Num() );
+			}
+		}
+		else
+		{
+			ForEachPresentRun( IsPresent, 2, [&]( const int32 RunStart, const int32 RunLength )
+			{
+				FStreetMapImportRoad& NewRoad = AddedRoads.AddDefaulted_GetRef();
+				FStreetMapWayConverter::FillRoad( ChangeFile.TagClassifier, *Way, FString( Name ), TArray<FVector2D>( WayPoints.GetData() + RunStart, RunLength ), NewRoad );
+
+				AddedRoadWayIDs.Add( Way->ID );
+				AddedRoadNodeIDs.Append( WayNodeIDs.GetData() + RunStart, RunLength );
+				for( int32 PointIndex = RunStart; PointIndex < RunStart + RunLength; ++PointIndex )
+				{
+					AffectedNodeIDs.Add( WayNodeIDs[ PointIndex ] );
+				}
+			} );
+		}
+	}
+	OutStats.RoadsAdded = AddedRoads.Num();
+	OutStats.BuildingsAdded = AddedBuildings.Num();
+
+	// Compact the roads we kept, moving their points down over the ones that were removed.  Roads before the first one
+	// that was removed stay where they are.
+	TArray<int64> NewRoadWayIDs;
+	TArray<int64> NewPointNodeIDs;
+	NewPointNodeIDs.Reserve( PointNodeIDs.Num() + AddedRoadNodeIDs.Num() + AddedBuildingNodeIDs.Num() );
+	TArray<int32> RoadRemap;
+	RoadRemap.Init( INDEX_NONE, Roads.Num() );
+	int32 KeptRoadCount = 0;
+	int32 KeptPointCount = 0;
+	for( int32 RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex )
+	{
+		if( KeepRoad[ RoadIndex ] )
+		{
+			NewRoadWayIDs.Add( OSMSource.RoadWayIDs[ RoadIndex ] );
+			NewPointNodeIDs.Append( PointNodeIDs.GetData() + RoadPointOffsets[ RoadIndex ], RoadPointOffsets[ RoadIndex + 1 ] - RoadPointOffsets[ RoadIndex ] );
+
+			FStreetMapRoad& Road = Roads[ RoadIndex ];
+			if( Road.FirstPointIndex != KeptPointCount )
+			{
+				FMemory::Memmove( RoadPoints.GetData() + KeptPointCount, RoadPoints.GetData() + Road.FirstPointIndex, Road.PointCount * sizeof( FVector2D ) );
+				FMemory::Memmove( RoadNodeIndices.GetData() + KeptPointCount, RoadNodeIndices.GetData() + Road.FirstPointIndex, Road.PointCount * sizeof( int32 ) );
+				Road.FirstPointIndex = KeptPointCount;
+			}
+			KeptPointCount += Road.PointCount;
+
+			RoadRemap[ RoadIndex ] = KeptRoadCount;
+			if( KeptRoadCount != RoadIndex )
+			{
+				Roads[ KeptRoadCount ] = MoveTemp( Road );
+			}
+			++KeptRoadCount;
+		}
+	}
+	Roads.SetNum( KeptRoadCount );
+	RoadPoints.SetNum( KeptPointCount );
+	RoadNodeIndices.SetNum( KeptPointCount );
+
+	// Nodes only change where roads were removed or added.  Every other node is kept, with its road refs moved down
+	// over the ones that were removed and pointing at the compacted roads.
+	TArray<int32> NodeRemap;
+	NodeRemap.Init( INDEX_NONE, Nodes.Num() );
+	int32 KeptNodeCount = 0;
+	int32 KeptRoadRefCount = 0;
+	for( int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex )
+	{
+		FStreetMapNode& Node = Nodes[ NodeIndex ];
+		if( Node.RoadRefCount == 0 )
+		{
+			continue;
+		}
+
+		const FStreetMapRoadRef& FirstRoadRef = NodeRoadRefs[ Node.FirstRoadRefIndex ];
+		const int64 NodeID = PointNodeIDs[ RoadPointOffsets[ FirstRoadRef.RoadIndex ] + FirstRoadRef.RoadPointIndex ];
+		if( AffectedNodeIDs.Contains( NodeID ) )
+		{
+			continue;
+		}
+
+		// Removed roads only have affected nodes, so everything this node touches is still here
+		for( int32 RoadRefIndex = 0; RoadRefIndex < Node.RoadRefCount; ++RoadRefIndex )
+		{
+			FStreetMapRoadRef RoadRef = NodeRoadRefs[ Node.FirstRoadRefIndex + RoadRefIndex ];
+			RoadRef.RoadIndex = RoadRemap[ RoadRef.RoadIndex ];
+			check( RoadRef.RoadIndex != INDEX_NONE );
+			NodeRoadRefs[ KeptRoadRefCount + RoadRefIndex ] = RoadRef;
+		}
+		Node.FirstRoadRefIndex = KeptRoadRefCount;
+		KeptRoadRefCount += Node.RoadRefCount;
+
+		NodeRemap[ NodeIndex ] = KeptNodeCount;
+		if( KeptNodeCount != NodeIndex )
+		{
+			Nodes[ KeptNodeCount ] = MoveTemp( Node );
+		}
+		++KeptNodeCount;
+	}
+	const bool bRemovedAnyNodes = KeptNodeCount != Nodes.Num();
+	Nodes.SetNum( KeptNodeCount );
+	NodeRoadRefs.SetNum( KeptRoadRefCount );
+
+	if( bRemovedAnyNodes )
+	{
+		for( int32& NodeIndex : RoadNodeIndices )
+		{
+			if( NodeIndex != INDEX_NONE )
+			{
+				NodeIndex = NodeRemap[ NodeIndex ];
+			}
+		}
+	}
+
+	// The new roads go after the ones we kept
+	Roads.Reserve( Roads.Num() + AddedRoads.Num() );
+	for( FStreetMapImportRoad& AddedRoad : AddedRoads )
+	{
+		FStreetMapWayConverter::PackRoad( AddedRoad, Roads.AddDefaulted_GetRef(), RoadPoints, RoadNodeIndices );
+	}
+	AddedRoads.Empty();
+	NewRoadWayIDs.Append( AddedRoadWayIDs );
+	NewPointNodeIDs.Append( AddedRoadNodeIDs );
+
+	// Work out the affected nodes again, the same way the import does: nodes that connect more than one road, or that
+	// are at the beginning or end of a road, are kept.  Refs are gathered in road order, as they would be on import.
+	TMap<int64, TArray<FStreetMapRoadRef>> AffectedNodeRoadRefs;
+	int32 RoadPointNodeIndex = 0;
+	for( int32 RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex )
+	{
+		for( int32 PointIndex = 0; PointIndex < Roads[ RoadIndex ].PointCount; ++PointIndex )
+		{
+			const int64 NodeID = NewPointNodeIDs[ RoadPointNodeIndex++ ];
+			if( AffectedNodeIDs.Contains( NodeID ) )
+			{
+				FStreetMapRoadRef& RoadRef = AffectedNodeRoadRefs.FindOrAdd( NodeID ).AddDefaulted_GetRef();
+				RoadRef.RoadIndex = RoadIndex;
+				RoadRef.RoadPointIndex = PointIndex;
+			}
+		}
+	}
+
+	for( TPair<int64, TArray<FStreetMapRoadRef>>& AffectedNode : AffectedNodeRoadRefs )
+	{
+		bool bIsAtEndOfRoad = false;
+		for( const FStreetMapRoadRef& RoadRef : AffectedNode.Value )
+		{
+			bIsAtEndOfRoad |= RoadRef.RoadPointIndex == 0 || RoadRef.RoadPointIndex == ( Roads[ RoadRef.RoadIndex ].PointCount - 1 );
+		}
+
+		if( AffectedNode.Value.Num() > 1 || bIsAtEndOfRoad )
+		{
+			const int32 NewNodeIndex = Nodes.Num();
+			for( const FStreetMapRoadRef& RoadRef : AffectedNode.Value )
+			{
+				RoadNodeIndices[ Roads[ RoadRef.RoadIndex ].FirstPointIndex + RoadRef.RoadPointIndex ] = NewNodeIndex;
+			}
+
+			FStreetMapNode& NewNode = Nodes.AddDefaulted_GetRef();
+			NewNode.FirstRoadRefIndex = NodeRoadRefs.Num();
+			NewNode.RoadRefCount = AffectedNode.Value.Num();
+			NodeRoadRefs.Append( AffectedNode.Value );
+		}
+	}
+
+	// Compact the buildings we kept, then add the new ones after them
+	TArray<int64> NewBuildingWayIDs;
+	int32 KeptBuildingCount = 0;
+	for( int32 BuildingIndex = 0; BuildingIndex < Buildings.Num(); ++BuildingIndex )
+	{
+		if( KeepBuilding[ BuildingIndex ] )
+		{
+			NewBuildingWayIDs.Add( OSMSource.BuildingWayIDs[ BuildingIndex ] );
+			NewPointNodeIDs.Append( PointNodeIDs.GetData() + BuildingPointOffsets[ BuildingIndex ], BuildingPointOffsets[ BuildingIndex + 1 ] - BuildingPointOffsets[ BuildingIndex ] );
+
+			if( KeptBuildingCount != BuildingIndex )
+			{
+				Buildings[ KeptBuildingCount ] = MoveTemp( Buildings[ BuildingIndex ] );
+			}
+			++KeptBuildingCount;
+		}
+	}
+	Buildings.SetNum( KeptBuildingCount );
+	Buildings.Append( MoveTemp( AddedBuildings ) );
+	NewBuildingWayIDs.Append( AddedBuildingWayIDs );
+	NewPointNodeIDs.Append( AddedBuildingNodeIDs );
+
+	OSMSource.RoadWayIDs = MoveTemp( NewRoadWayIDs );
+	OSMSource.BuildingWayIDs = MoveTemp( NewBuildingWayIDs );
+	OSMSource.SetPointNodeIDs( NewPointNodeIDs );
+
+	// Every road and building already has its own bounds, so the map's bounds are quick to work out again
+	StreetMap->BoundsMin = FVector2D( TNumericLimits<float>::Max(), TNumericLimits<float>::Max() );
+	StreetMap->BoundsMax = FVector2D( TNumericLimits<float>::Lowest(), TNumericLimits<float>::Lowest() );
+	auto AddToBounds = [StreetMap]( const FVector2D BoundsMin, const FVector2D BoundsMax )
+	{
+		StreetMap->BoundsMin.X = FMath::Min( StreetMap->BoundsMin.X, BoundsMin.X );
+		StreetMap->BoundsMin.Y = FMath::Min( StreetMap->BoundsMin.Y, BoundsMin.Y );
+		StreetMap->BoundsMax.X = FMath::Max( StreetMap->BoundsMax.X, BoundsMax.X );
+		StreetMap->BoundsMax.Y = FMath::Max( StreetMap->BoundsMax.Y, BoundsMax.Y );
+	};
+	for( const FStreetMapRoad& Road : Roads )
+	{
+		AddToBounds( Road.BoundsMin, Road.BoundsMax );
+	}
+	for( const FStreetMapBuilding& Building : Buildings )
+	{
+		AddToBounds( Building.BoundsMin, Building.BoundsMax );
+	}
+
+	// The roads' distances and the connections between nodes are worked out from the patched buffers
+	verify( StreetMap->BindRoadsAndNodes() );
+	StreetMap->RebuildSpatialIndex();
+
+	// The street map no longer matches its source file, so a reimport from that file must not be skipped
+	if( UStreetMapAssetImportData* ImportData = Cast<UStreetMapAssetImportData>( StreetMap->AssetImportData ) )
+	{
+		ImportData->Modify();
+		ImportData->SourceFileSize = -1;
+	}
+
+	OutStats.Seconds = FPlatformTime::Seconds() - StartTime;
+	return true;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,50 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class UStreetMap;
+
+/** What happened when a change file was applied to a street map */
+struct FStreetMapChangeStats
+{
+	/** Roads and buildings that were taken out, including old versions of ways that were modified */
+	int32 RoadsRemoved = 0;
+	int32 BuildingsRemoved = 0;
+
+	/** Roads and buildings that were put in, including new versions of ways that were modified */
+	int32 RoadsAdded = 0;
+	int32 BuildingsAdded = 0;
+
+	/** Road and building points that moved because their node was modified */
+	int32 PointsMoved = 0;
+
+	/** Node references that couldn't be resolved, because the node is neither in the change file nor in the street map */
+	int32 MissingNodeRefs = 0;
+
+	/** How long it took */
+	double Seconds = 0.0;
+};
+
+
+/** Applies OpenStreetMap change files (.osc) to street maps, so that keeping a large street map up to date doesn't
+    need a full reimport.  Only the roads and buildings whose ways or nodes changed are rebuilt, and only the
+    intersection nodes that touch those roads are recomputed.  Roads and nodes are patched in the street map's own
+    buffers rather than copied out and packed again. */
+class FStreetMapChangeApplier
+{
+
+public:
+
+	/**
+	 * Applies a change file to a street map.  The street map must have been imported with the OpenStreetMap IDs of its
+	 * roads and buildings (see FStreetMapOSMSource), and the changes must follow on from the data it was imported from.
+	 * The street map is left alone if anything goes wrong.  Call PostEditChange() on the street map afterwards.
+	 *
+	 * @param	StreetMap			The street map to update
+	 * @param	Buffer				Contents of the change file
+	 * @param	OutStats			What changed
+	 * @param	OutErrorMessage		If the changes couldn't be applied, describes why
+	 *
+	 * @return	True if the changes were applied
+	 */
+	static bool Apply( UStreetMap* StreetMap, const TArrayView64<const uint8> Buffer, FStreetMapChangeStats& OutStats, FText& OutErrorMessage );
+};
@@ -1,6 +1,5 @@
 #include "StreetMapComponentDetails.h"
 #include "AssetToolsModule.h"
-#include "RawMesh.h"
 #include "PropertyEditorModule.h"
 #include "DetailLayoutBuilder.h"
 #include "DetailCategoryBuilder.h"
@@ -13,6 +12,7 @@
 #include "Framework/Notifications/NotificationManager.h"
 #include "Misc/AssertionMacros.h"
 #include "StreetMapComponent.h"
+#include "StreetMapStaticMeshBuilder.h"
 
 #define LOCTEXT_NAMESPACE "StreetMapComponentDetails"
 
@@ -218,96 +218,11 @@ FReply FStreetMapComponentDetails::OnCreateStaticMeshAssetClicked()
 				MeshName = *Name;
 			}
 
-			// Raw mesh data we are filling in
-			FRawMesh RawMesh;
-			// Materials to apply to new mesh
-			TArray<UMaterialInterface*> MeshMaterials = SelectedStreetMapComponent->GetMaterials();
-
-			
-			const TArray<FStreetMapVertex > RawMeshVertices = SelectedStreetMapComponent->GetRawMeshVertices();
-			const TArray< uint32 > RawMeshIndices = SelectedStreetMapComponent->GetRawMeshIndices();
-
-
-			// Copy verts
-			for (int32 VertIndex = 0; VertIndex < RawMeshVertices.Num();VertIndex++)
-			{
-				RawMesh.VertexPositions.Add(RawMeshVertices[VertIndex].Position);
-			}
-
-			// Copy 'wedge' info
-			int32 NumIndices = RawMeshIndices.Num();
-			for (int32 IndexIdx = 0; IndexIdx < NumIndices; IndexIdx++)
-			{
-				int32 VertexIndex = RawMeshIndices[IndexIdx];
-
-				RawMesh.WedgeIndices.Add(VertexIndex);
-
-				const FStreetMapVertex& StreetMapVertex = RawMeshVertices[VertexIndex];
-
-				FVector3f TangentX = StreetMapVertex.TangentX;
-				FVector3f TangentZ = StreetMapVertex.TangentZ;
-				FVector3f TangentY = (TangentX ^ TangentZ).GetSafeNormal();
-
-				RawMesh.WedgeTangentX.Add(TangentX);
-				RawMesh.WedgeTangentY.Add(TangentY);
-				RawMesh.WedgeTangentZ.Add(TangentZ);
-
-				RawMesh.WedgeTexCoords[0].Add(StreetMapVertex.TextureCoordinate);
-				RawMesh.WedgeColors.Add(StreetMapVertex.Color);
-			}
-
-			// copy face info
-			int32 NumTris = NumIndices / 3;
-			for (int32 TriIdx = 0; TriIdx < NumTris; TriIdx++)
-			{
-				RawMesh.FaceMaterialIndices.Add(0);
-				RawMesh.FaceSmoothingMasks.Add(0); // Assume this is ignored as bRecomputeNormals is false
-			}
+			UStaticMesh* StaticMesh = FStreetMapStaticMeshBuilder::CreateStaticMesh(SelectedStreetMapComponent, UserPackageName, MeshName);
 
 			// If we got some valid data.
-			if (RawMesh.VertexPositions.Num() > 3 && RawMesh.WedgeIndices.Num() > 3)
+			if (StaticMesh != nullptr)
 			{
-				// Then find/create it.
-				UPackage* Package = CreatePackage(*UserPackageName);
-				check(Package);
-
-				// Create StaticMesh object
-				UStaticMesh* StaticMesh = NewObject<UStaticMesh>(Package, MeshName, RF_Public | RF_Standalone);
-				StaticMesh->InitResources();
-
-				StaticMesh->SetLightingGuid(FGuid::NewGuid());
-
-				// Add source to new StaticMesh
-				FStaticMeshSourceModel* SrcModel = &StaticMesh->AddSourceModel();
-				SrcModel->BuildSettings.bRecomputeNormals = false;
-				SrcModel->BuildSettings.bRecomputeTangents = false;
-				SrcModel->BuildSettings.bRemoveDegenerates = false;
-				SrcModel->BuildSettings.bUseHighPrecisionTangentBasis = false;
-				SrcModel->BuildSettings.bUseFullPrecisionUVs = false;
-				SrcModel->BuildSettings.bGenerateLightmapUVs = true;
-				SrcModel->BuildSettings.SrcLightmapIndex = 0;
-				SrcModel->BuildSettings.DstLightmapIndex = 1;
-				SrcModel->RawMeshBulkData->SaveRawMesh(RawMesh);
-
-				// Copy materials to new mesh
-				for (UMaterialInterface* Material : MeshMaterials)
-				{
-					StaticMesh->GetStaticMaterials().Add(FStaticMaterial(Material));
-				}
-
-				// Set the Imported version before calling the build
-				StaticMesh->ImportVersion = EImportStaticMeshVersion::LastVersion;
-
-				// Build mesh from source
-				StaticMesh->Build(/** bSilent =*/ false);
-				StaticMesh->PostEditChange();
-
-				StaticMesh->MarkPackageDirty();
-
-				// Notify asset registry of new asset
-				FAssetRegistryModule::AssetCreated(StaticMesh);
-
-
 				// Display notification so users can quickly access the mesh
 				if (GIsEditor)
 				{
@@ -1,13 +1,24 @@
 #include "StreetMapFactory.h"
 #include "EditorFramework/AssetImportData.h"
 #include "OSMFile.h"
+#include "OSMSourceFile.h"
+#include "OSMXmlReader.h"
+#include "StreetMapImportTask.h"
+#include "StreetMapTiler.h"
+#include "StreetMapWayConverter.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
 #include "StreetMap.h"
+#include "StreetMapAssetImportData.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Misc/App.h"
+#include "Misc/MessageDialog.h"
+#include "Misc/PackageName.h"
+#include "Misc/ScopeExit.h"
+#include "Misc/ScopedSlowTask.h"
+#include <atomic>
 
-// Latitude/longitude scale factor
-//			- https://en.wikipedia.org/wiki/Equator#Exact_length
-static const double EarthCircumference = 40075036.0;
-const double UStreetMapFactory::LatitudeLongitudeScale = EarthCircumference / 360.0; // meters per degree
-
+#define LOCTEXT_NAMESPACE "StreetMapImporting"
 
 UStreetMapFactory::UStreetMapFactory(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -15,28 +26,45 @@ UStreetMapFactory::UStreetMapFactory(const FObjectInitializer& ObjectInitializer
 	SupportedClass = UStreetMap::StaticClass();
 
 	Formats.Add( TEXT( "osm;OpenStreetMap XML" ) );
+	Formats.Add( TEXT( "pbf;OpenStreetMap PBF" ) );
+	Formats.Add( TEXT( "gz;OpenStreetMap XML (gzip compressed)" ) );
 	bCreateNew = false;
 	bEditorImport = true;
 	bEditAfterNew = false;
-	bText = true;
+
+	// We read the source file ourselves (see FactoryCreateFile), so that we can map it instead of loading it as text
+	bText = false;
+
+	bShowImportPreview = true;
 }
 
 
-UObject* UStreetMapFactory::FactoryCreateText( UClass* Class, UObject* Parent, FName Name, EObjectFlags Flags, UObject* Context, const TCHAR* Type, const TCHAR*& Buffer, const TCHAR* BufferEnd, FFeedbackContext* Warn )
+UObject* UStreetMapFactory::FactoryCreateFile( UClass* Class, UObject* Parent, FName Name, EObjectFlags Flags, const FString& Filename, const TCHAR* Parms, FFeedbackContext* Warn, bool& bOutOperationCanceled )
 {
-	UStreetMap* StreetMap = NewObject<UStreetMap>( Parent, Name, Flags | RF_Transactional );
+	TUniquePtr<FOSMSourceFile> SourceFile;
+	bool bIsPBF = false;
+	FOSMXmlSummary XmlSummary;
+	if( !OpenSourceFile( Filename, SourceFile, bIsPBF, XmlSummary, Warn ) )
+	{
+		return nullptr;
+	}
 
-	StreetMap->AssetImportData->Update( this->GetCurrentFilename() );
+	const bool bIsAutomated = IsAutomatedImport() || FApp::IsUnattended();
+	// We don't know what's in compressed files until we've decompressed them, so there's nothing to preview
+	if( !bIsPBF && !XmlSummary.bIsCompressed && bShowImportPreview && !bIsAutomated && !ShowImportPreview( Filename, XmlSummary ) )
+	{
+		bOutOperationCanceled = true;
+		return nullptr;
+	}
 
-	// @todo: Performance: This will copy the entire text buffer into an FString.  We need to do this
-	//        because the FFastXml parser is expecting a buffer that it can mutate as it parses.
-	const int32 CharacterCount = BufferEnd - Buffer;
-	FString MutableTextBuffer( CharacterCount, Buffer );
+	UStreetMap* StreetMap = CreateStreetMap( Parent, Name, Flags, Filename, ImportSettings );
 
-	const bool bIsFilePathActuallyTextBuffer = true;
-	const bool bLoadedOkay = LoadFromOpenStreetMapXMLFile( StreetMap, MutableTextBuffer, bIsFilePathActuallyTextBuffer, Warn );
+	// Big files can take minutes to import, so when there's a user waiting we build the street map in the background
+	// and let them carry on working
+	const bool bImportInBackground = !bIsAutomated && GIsEditor && !IsRunningCommandlet();
+	const bool bImportedOkay = ImportStreetMap( StreetMap, Filename, MoveTemp( SourceFile ), bIsPBF, XmlSummary, bImportInBackground, Warn, bOutOperationCanceled );
 
-	if( !bLoadedOkay )
+	if( !bImportedOkay )
 	{
 		StreetMap->MarkAsGarbage();
 		StreetMap = nullptr;
@@ -46,384 +74,500 @@ UObject* UStreetMapFactory::FactoryCreateText( UClass* Class, UObject* Parent, F
 }
 
 
-bool UStreetMapFactory::LoadFromOpenStreetMapXMLFile( UStreetMap* StreetMap, FString& OSMFilePath, const bool bIsFilePathActuallyTextBuffer, FFeedbackContext* FeedbackContext )
+UStreetMap* UStreetMapFactory::CreateStreetMap( UObject* Parent, const FName Name, const EObjectFlags Flags, const FString& Filename, const FStreetMapImportSettings& Settings )
 {
-	// OSM data is stored in meters.  This is the scale factor to convert those units into UE4's native units (cm)
-	// Keep in mind that if this is changed, UStreetMapComponent sizes for roads may need to be updated too!
-	// @todo: We should make this scale factor customizable as an import option
-	const double OSMToCentimetersScaleFactor = 100.0;
+	UStreetMap* StreetMap = NewObject<UStreetMap>( Parent, Name, Flags | RF_Transactional );
 
+	// The file's hash is filled in once the import is done, when we've already read the whole file anyway
+	StreetMap->AssetImportData->UpdateFilenameOnly( Filename );
+	StreetMap->ImportSettings = Settings;
 
-	// Converts latitude to meters
-	auto ConvertLatitudeToMeters = []( const double Latitude ) -> double
+	return StreetMap;
+}
+
+
+bool UStreetMapFactory::OpenSourceFile( const FString& Filename, TUniquePtr<FOSMSourceFile>& OutSourceFile, bool& bOutIsPBF, FOSMXmlSummary& OutXmlSummary, FFeedbackContext* Warn )
+{
+	// Map the file rather than loading it.  The XML is tokenized in place, so peak memory use during import
+	// depends on how much data we keep, not on the size of the file.
+	OutSourceFile = MakeUnique<FOSMSourceFile>();
+	if( !OutSourceFile->Open( Filename ) )
 	{
-		return -Latitude * LatitudeLongitudeScale;
-	};
+		Warn->Logf( ELogVerbosity::Error, TEXT( "Unable to open OpenStreetMap file '%s'" ), *Filename );
+		OutSourceFile.Reset();
+		return false;
+	}
 
-	// Converts longitude to meters
-	auto ConvertLongitudeToMeters = []( const double Longitude, const double Latitude ) -> double
+	// Count what's in XML files before we start.  This only takes a moment, and lets us size everything up front.
+	// Compressed XML files are recognized by their contents, and only report their bounds.  PBF files aren't scanned,
+	// because their elements can't be counted without decompressing every blob.
+	bOutIsPBF = IsPBFFile( Filename );
+	if( !bOutIsPBF )
 	{
-		return Longitude * LatitudeLongitudeScale * FMath::Cos( FMath::DegreesToRadians( Latitude ) );
-	};
+		FOSMFile::ScanOpenStreetMapFile( OutSourceFile->GetData(), OutXmlSummary );
+	}
+
+	return true;
+}
+
+
+bool UStreetMapFactory::ImportStreetMap( UStreetMap* StreetMap, const FString& Filename, TUniquePtr<FOSMSourceFile> SourceFile, const bool bIsPBF, const FOSMXmlSummary& XmlSummary, const bool bImportInBackground, FFeedbackContext* Warn, bool& bOutOperationCanceled )
+{
+	// The task owns the source file from here on
+	if( bImportInBackground )
+	{
+		FStreetMapImportTask::Start( StreetMap, StreetMap->ImportSettings, Filename, MoveTemp( SourceFile ), bIsPBF, XmlSummary );
+		return true;
+	}
 
-	// Converts latitude and longitude to X/Y coordinates, relative to some other latitude/longitude
-	auto ConvertLatLongToMetersRelative = [ConvertLatitudeToMeters, ConvertLongitudeToMeters]( 
-		const double Latitude, 
-		const double Longitude, 
-		const double RelativeToLatitude, 
-		const double RelativeToLongitude ) -> FVector2D
-	{
-		// Applies Sanson-Flamsteed (sinusoidal) Projection (see http://www.progonos.com/furuti/MapProj/Normal/CartHow/HowSanson/howSanson.html)
-		return FVector2d(
-			ConvertLongitudeToMeters( Longitude, Latitude ) - ConvertLongitudeToMeters( RelativeToLongitude, Latitude ),
-			ConvertLatitudeToMeters( Latitude ) - ConvertLatitudeToMeters( RelativeToLatitude ) );
+	FScopedSlowTask SlowTask( 1.0f, FText::Format( LOCTEXT( "ImportingStreetMap", "Importing {0}" ), FText::FromString( FPaths::GetCleanFilename( Filename ) ) ), true, *Warn );
+	SlowTask.MakeDialog( true );
+
+	// The slow task can only be updated from the thread that created it.  BuildStreetMap only reports progress
+	// between its parallel phases, so that's always us.
+	float ReportedProgress = 0.0f;
+	auto ReportProgress = [&SlowTask, &ReportedProgress]( const float Progress ) -> bool
+	{
+		SlowTask.EnterProgressFrame( Progress - ReportedProgress );
+		ReportedProgress = Progress;
+		return !SlowTask.ShouldCancel();
 	};
 
-	// Adds a road to the street map using the OpenStreetMap data, flattening the road's coordinates into our map's space
-	auto AddRoadForWay = [ConvertLatLongToMetersRelative, OSMToCentimetersScaleFactor]( 
-		const FOSMFile& OSMFile, 
-		UStreetMap& StreetMapRef, 
-		const FOSMFile::FOSMWayInfo& OSMWay, 
-		int32& OutRoadIndex ) -> bool
+	FStreetMapImportResult Result;
+	FText ErrorMessage;
+	if( !BuildStreetMap( StreetMap->ImportSettings, SourceFile->GetData(), bIsPBF, XmlSummary, ReportProgress, Result, ErrorMessage ) )
 	{
-		EStreetMapRoadType RoadType = EStreetMapRoadType::Other;
-		switch( OSMWay.WayType )
+		if( SlowTask.ShouldCancel() )
 		{
-			case FOSMFile::EOSMWayType::Motorway:
-			case FOSMFile::EOSMWayType::Motorway_Link:
-			case FOSMFile::EOSMWayType::Trunk:
-			case FOSMFile::EOSMWayType::Trunk_Link:
-			case FOSMFile::EOSMWayType::Primary:
-			case FOSMFile::EOSMWayType::Primary_Link:
-				RoadType = EStreetMapRoadType::Highway;
-				break;
-
-			case FOSMFile::EOSMWayType::Secondary:
-			case FOSMFile::EOSMWayType::Secondary_Link:
-			case FOSMFile::EOSMWayType::Tertiary:
-			case FOSMFile::EOSMWayType::Tertiary_Link:
-				RoadType = EStreetMapRoadType::MajorRoad;
-				break;
-
-			case FOSMFile::EOSMWayType::Residential:
-			case FOSMFile::EOSMWayType::Service:
-			case FOSMFile::EOSMWayType::Unclassified:
-			case FOSMFile::EOSMWayType::Road:	// @todo: Consider excluding "Road" from our data set, as it could be a highway that wasn't properly tagged in OSM yet
-				RoadType = EStreetMapRoadType::Street;
-				break;
-
-			default:
-				RoadType = EStreetMapRoadType::Other;
+			bOutOperationCanceled = true;
 		}
-
-		if( RoadType != EStreetMapRoadType::Other )
+		else
 		{
-			// Require at least two points!
-			if( OSMWay.Nodes.Num() > 1 )
-			{
-				// Create a road for this way
-				OutRoadIndex = StreetMapRef.Roads.Num();
-				FStreetMapRoad& NewRoad = *new( StreetMapRef.Roads )FStreetMapRoad();
-
-				FVector2D BoundsMin( TNumericLimits<float>::Max(), TNumericLimits<float>::Max() );
-				FVector2D BoundsMax( TNumericLimits<float>::Lowest(), TNumericLimits<float>::Lowest() );
+			Warn->Logf( ELogVerbosity::Error, TEXT( "Unable to import OpenStreetMap file '%s': %s" ), *Filename, *ErrorMessage.ToString() );
+		}
+		return false;
+	}
 
-				NewRoad.RoadPoints.AddUninitialized( OSMWay.Nodes.Num() );
-				int32 CurRoadPoint = 0;
+	ApplyImportResult( StreetMap, Filename, Result );
+	return true;
+}
 
-				// Set defaults for each node index on this road.  INDEX_NONE means the node is not valid, which may be the case
-				// for nodes that we filter out entirely.  This will be filled in by valid indices to nodes later on.
-				NewRoad.NodeIndices.AddUninitialized( OSMWay.Nodes.Num() );
-				for( int32& NodeIndex : NewRoad.NodeIndices )
-				{
-					NodeIndex = INDEX_NONE;
-				}
 
+void UStreetMapFactory::ApplyImportResult( UStreetMap* StreetMap, const FString& Filename, FStreetMapImportResult& Result )
+{
+	check( IsInGameThread() );
+
+	StreetMap->Modify();
+
+	StreetMap->SetBuildings( MoveTemp( Result.Buildings ) );
+	FStreetMapWayConverter::SetRoadsAndNodes( Result.PackedRoadsAndNodes, *StreetMap );
+	StreetMap->RebuildSpatialIndex();
+	StreetMap->BoundsMin = Result.BoundsMin;
+	StreetMap->BoundsMax = Result.BoundsMax;
+	StreetMap->Projection = Result.Projection;
+	StreetMap->OSMSource = MoveTemp( Result.OSMSource );
+	ApplyImportTiles( StreetMap, Result.Tiles );
+
+	// Street maps imported before we kept track of the source file's size still have plain import data
+	UStreetMapAssetImportData* ImportData = Cast<UStreetMapAssetImportData>( StreetMap->AssetImportData );
+	if( ImportData == nullptr )
+	{
+		ImportData = NewObject<UStreetMapAssetImportData>( StreetMap, NAME_None, RF_Transactional );
+		StreetMap->AssetImportData = ImportData;
+	}
+	ImportData->Update( Filename, Result.SourceFileHash.IsValid() ? &Result.SourceFileHash : nullptr );
+	ImportData->SourceFileSize = Result.SourceFileSize;
+	ImportData->ImportSettingsHash = Result.ImportSettingsHash;
 
-				for( const FOSMFile::FOSMNodeInfo* OSMNodePtr : OSMWay.Nodes )
-				{
-					const FOSMFile::FOSMNodeInfo& OSMNode = *OSMNodePtr;
-
-					// Transform all points relative to the center of the latitude/longitude bounds, so that
-					// we get as much precision as possible.
-					const double RelativeToLatitude = OSMFile.AverageLatitude;
-					const double RelativeToLongitude = OSMFile.AverageLongitude;
-					const FVector2D NodePos = ConvertLatLongToMetersRelative(
-						OSMNode.Latitude,
-						OSMNode.Longitude,
-						RelativeToLatitude,
-						RelativeToLongitude ) * OSMToCentimetersScaleFactor;
-
-					// Update bounding box
-					{
-						if( NodePos.X < BoundsMin.X )
-						{
-							BoundsMin.X = NodePos.X;
-						}
-						if( NodePos.Y < BoundsMin.Y )
-						{
-							BoundsMin.Y = NodePos.Y;
-						}
-						if( NodePos.X > BoundsMax.X )
-						{
-							BoundsMax.X = NodePos.X;
-						}
-						if( NodePos.Y > BoundsMax.Y )
-						{
-							BoundsMax.Y = NodePos.Y;
-						}
-					}
-
-					// Fill in the points
-					NewRoad.RoadPoints[ CurRoadPoint++ ] = NodePos;
-				}
+	StreetMap->PostEditChange();
+}
 
 
-				NewRoad.RoadName = OSMWay.Name;
-				if( NewRoad.RoadName.IsEmpty() )
-				{
-					NewRoad.RoadName = OSMWay.Ref;
-				}
-				NewRoad.RoadType = RoadType;
-				NewRoad.BoundsMin = BoundsMin;
-				NewRoad.BoundsMax = BoundsMax;
+void UStreetMapFactory::ApplyImportTiles( UStreetMap* StreetMap, TArray<FStreetMapImportTile>& ImportTiles )
+{
+	const FString PackagePath = FPackageName::GetLongPackagePath( StreetMap->GetOutermost()->GetName() );
 
-				NewRoad.bIsOneWay = OSMWay.bIsOneWay;
+	const TArray<FStreetMapTile> PreviousTiles = MoveTemp( StreetMap->Tiles );
+	StreetMap->Tiles.Reset( ImportTiles.Num() );
+	for( FStreetMapImportTile& ImportTile : ImportTiles )
+	{
+		// Reimports fill in the tiles that are already there, so that references to them keep working
+		const FString TileName = GetTileName( StreetMap->GetName(), ImportTile.Coordinates );
+		const FString TilePackageName = PackagePath / TileName;
+		UStreetMap* TileStreetMap = LoadObject<UStreetMap>( nullptr, *( TilePackageName + TEXT( "." ) + TileName ), nullptr, LOAD_NoWarn | LOAD_Quiet );
+		const bool bIsNewTile = TileStreetMap == nullptr;
+		if( bIsNewTile )
+		{
+			UPackage* TilePackage = CreatePackage( *TilePackageName );
+			TilePackage->FullyLoad();
+			TileStreetMap = NewObject<UStreetMap>( TilePackage, FName( *TileName ), RF_Public | RF_Standalone | RF_Transactional );
+		}
 
-				StreetMapRef.BoundsMin.X = FMath::Min( StreetMapRef.BoundsMin.X, BoundsMin.X );
-				StreetMapRef.BoundsMin.Y = FMath::Min( StreetMapRef.BoundsMin.Y, BoundsMin.Y );
-				StreetMapRef.BoundsMax.X = FMath::Max( StreetMapRef.BoundsMax.X, BoundsMax.X );
-				StreetMapRef.BoundsMax.Y = FMath::Max( StreetMapRef.BoundsMax.Y, BoundsMax.Y );
+		TileStreetMap->Modify();
+		TileStreetMap->SetBuildings( MoveTemp( ImportTile.Buildings ) );
+		FStreetMapWayConverter::SetRoadsAndNodes( ImportTile.PackedRoadsAndNodes, *TileStreetMap );
+		TileStreetMap->RebuildSpatialIndex();
+		TileStreetMap->BoundsMin = ImportTile.BoundsMin;
+		TileStreetMap->BoundsMax = ImportTile.BoundsMax;
+		TileStreetMap->TiledStreetMap = StreetMap;
+		TileStreetMap->TileCoordinates = ImportTile.Coordinates;
+		TileStreetMap->TileOrigin = ImportTile.Origin;
+		TileStreetMap->TileLinks = MoveTemp( ImportTile.Links );
+		TileStreetMap->Projection = StreetMap->Projection;
+		TileStreetMap->Projection.Offset = ImportTile.Origin;
+		TileStreetMap->ImportSettings = StreetMap->ImportSettings;
+		TileStreetMap->OSMSource = FStreetMapOSMSource();
+
+		if( bIsNewTile )
+		{
+			FAssetRegistryModule::AssetCreated( TileStreetMap );
+		}
+		TileStreetMap->PostEditChange();
+		TileStreetMap->MarkPackageDirty();
+
+		FStreetMapTile& Tile = StreetMap->Tiles.AddDefaulted_GetRef();
+		Tile.Coordinates = ImportTile.Coordinates;
+		Tile.StreetMap = TileStreetMap;
+		Tile.BoundsMin = ImportTile.BoundsMin + ImportTile.Origin;
+		Tile.BoundsMax = ImportTile.BoundsMax + ImportTile.Origin;
+	}
 
-				return true;
-			}
-			else
-			{
-				// NOTE: Skipped adding road for way because it has less than 2 points
-				// @todo: Log this for the user as an import warning
-			}
+	// Tiles that nothing lands in anymore are left alone, as something else might still be using them
+	for( const FStreetMapTile& PreviousTile : PreviousTiles )
+	{
+		if( StreetMap->FindTile( PreviousTile.Coordinates ) == nullptr )
+		{
+			GWarn->Logf( ELogVerbosity::Warning, TEXT( "Street map tile '%s' is no longer part of '%s', and can be deleted" ), *PreviousTile.StreetMap.ToString(), *StreetMap->GetPathName() );
 		}
+	}
+}
 
-		return false;
-	};
 
+FString UStreetMapFactory::GetTileName( const FString& StreetMapName, const FIntPoint TileCoordinates )
+{
+	return FString::Printf( TEXT( "%s_Tile_%i_%i" ), *StreetMapName, TileCoordinates.X, TileCoordinates.Y );
+}
 
-	// Adds a building to the street map using the OpenStreetMap data, flattening the road's coordinates into our map's space
-	auto AddBuildingForWay = [ConvertLatLongToMetersRelative, OSMToCentimetersScaleFactor]( 
-		const FOSMFile& OSMFile, 
-		UStreetMap& StreetMapRef, 
-		const FOSMFile::FOSMWayInfo& OSMWay ) -> bool
-	{
-		if( OSMWay.WayType == FOSMFile::EOSMWayType::Building )
-		{
-			// Require at least three points so that we don't have degenerate polygon!
-			if( OSMWay.Nodes.Num() > 2 )
-			{
-				// Create a building for this way
-				FStreetMapBuilding& NewBuilding = *new( StreetMapRef.Buildings )FStreetMapBuilding();
 
-				FVector2D BoundsMin( TNumericLimits<float>::Max(), TNumericLimits<float>::Max() );
-				FVector2D BoundsMax( TNumericLimits<float>::Lowest(), TNumericLimits<float>::Lowest() );
+uint32 UStreetMapFactory::HashImportSettings( const FStreetMapImportSettings& Settings )
+{
+	// Bump this whenever the importer changes what it builds from the same file and settings, so that reimports
+	// don't skip files that would come out differently
+	const uint32 ImporterVersion = 2;
 
-				NewBuilding.BuildingPoints.AddUninitialized( OSMWay.Nodes.Num() );
-				int32 CurBuildingPoint = 0;
+	FString SettingsText;
+	FStreetMapImportSettings::StaticStruct()->ExportText( SettingsText, &Settings, nullptr, nullptr, PPF_None, nullptr );
+	return HashCombine( ImporterVersion, FCrc::StrCrc32( *SettingsText ) );
+}
 
-				for( const FOSMFile::FOSMNodeInfo* OSMNodePtr : OSMWay.Nodes )
-				{
-					const FOSMFile::FOSMNodeInfo& OSMNode = *OSMNodePtr;
-
-					// Transform all points relative to the center of the latitude/longitude bounds, so that
-					// we get as much precision as possible.
-					const double RelativeToLatitude = OSMFile.AverageLatitude;
-					const double RelativeToLongitude = OSMFile.AverageLongitude;
-					const FVector2d NodePos = ConvertLatLongToMetersRelative(
-						OSMNode.Latitude,
-						OSMNode.Longitude,
-						RelativeToLatitude,
-						RelativeToLongitude ) * OSMToCentimetersScaleFactor;
-
-					// Update bounding box
-					{
-						if( NodePos.X < BoundsMin.X )
-						{
-							BoundsMin.X = NodePos.X;
-						}
-						if( NodePos.Y < BoundsMin.Y )
-						{
-							BoundsMin.Y = NodePos.Y;
-						}
-						if( NodePos.X > BoundsMax.X )
-						{
-							BoundsMax.X = NodePos.X;
-						}
-						if( NodePos.Y > BoundsMax.Y )
-						{
-							BoundsMax.Y = NodePos.Y;
-						}
-					}
-
-					// Fill in the points
-					NewBuilding.BuildingPoints[ CurBuildingPoint++ ] = NodePos;
-				}
 
-				// Make sure the building ended up with a closed polygon, then remove the final (redundant) point
-				const bool bIsClosed = NewBuilding.BuildingPoints[ 0 ].Equals( NewBuilding.BuildingPoints[ NewBuilding.BuildingPoints.Num() - 1 ], KINDA_SMALL_NUMBER );
-				if( bIsClosed )
-				{
-					// Remove the final redundant point
-					NewBuilding.BuildingPoints.Pop();
-				}
-				else
-				{
-					// Wasn't expecting to have an unclosed shape.  Our tolerances might be off, or the data was malformed.
-					// Either way, it shouldn't be a problem as we'll close the shape ourselves below.
-					// @todo: Log this for the user as an import warning
-				}
+bool UStreetMapFactory::IsPBFFile( const FString& Filename )
+{
+	// Usually named ".osm.pbf", so we only look at the last extension
+	return FPaths::GetExtension( Filename ).Equals( TEXT( "pbf" ), ESearchCase::IgnoreCase );
+}
 
-				NewBuilding.BuildingName = OSMWay.Name;
-				if( NewBuilding.BuildingName.IsEmpty() )
-				{
-					NewBuilding.BuildingName = OSMWay.Ref;
-				}
 
-				NewBuilding.Height = OSMWay.Height * OSMToCentimetersScaleFactor;
-				NewBuilding.BuildingLevels = OSMWay.BuildingLevels;
+bool UStreetMapFactory::ShowImportPreview( const FString& Filename, const FOSMXmlSummary& XmlSummary )
+{
+	FText BoundsText = LOCTEXT( "ImportPreview_NoBounds", "The file doesn't specify its bounds." );
+	if( XmlSummary.bHasBounds )
+	{
+		FNumberFormattingOptions CoordinateFormat;
+		CoordinateFormat.MinimumFractionalDigits = 5;
+		CoordinateFormat.MaximumFractionalDigits = 5;
+		BoundsText = FText::Format(
+			LOCTEXT( "ImportPreview_Bounds", "Latitude {0} to {1}, longitude {2} to {3}." ),
+			FText::AsNumber( XmlSummary.MinLatitude, &CoordinateFormat ),
+			FText::AsNumber( XmlSummary.MaxLatitude, &CoordinateFormat ),
+			FText::AsNumber( XmlSummary.MinLongitude, &CoordinateFormat ),
+			FText::AsNumber( XmlSummary.MaxLongitude, &CoordinateFormat ) );
+	}
+
+	const FText Message = FText::Format(
+		LOCTEXT( "ImportPreview_Message", "{0} contains {1} nodes, {2} ways ({3} way nodes) and {4} relations.\n{5}\n\nImport it?" ),
+		FText::FromString( FPaths::GetCleanFilename( Filename ) ),
+		FText::AsNumber( XmlSummary.NodeCount ),
+		FText::AsNumber( XmlSummary.WayCount ),
+		FText::AsNumber( XmlSummary.WayNodeRefCount ),
+		FText::AsNumber( XmlSummary.RelationCount ),
+		BoundsText );
+	const FText Title = LOCTEXT( "ImportPreview_Title", "Import OpenStreetMap File" );
+
+	return FMessageDialog::Open( EAppMsgType::OkCancel, Message, Title ) == EAppReturnType::Ok;
+}
 
-				NewBuilding.BoundsMin = BoundsMin;
-				NewBuilding.BoundsMax = BoundsMax;
 
-				StreetMapRef.BoundsMin.X = FMath::Min( StreetMapRef.BoundsMin.X, BoundsMin.X );
-				StreetMapRef.BoundsMin.Y = FMath::Min( StreetMapRef.BoundsMin.Y, BoundsMin.Y );
-				StreetMapRef.BoundsMax.X = FMath::Max( StreetMapRef.BoundsMax.X, BoundsMax.X );
-				StreetMapRef.BoundsMax.Y = FMath::Max( StreetMapRef.BoundsMax.Y, BoundsMax.Y );
+bool UStreetMapFactory::BuildStreetMap( const FStreetMapImportSettings& Settings, const TArrayView64<const uint8> Buffer, const bool bIsPBF, const FOSMXmlSummary& XmlSummary, TFunctionRef<bool( float )> ProgressCallback, FStreetMapImportResult& OutResult, FText& OutErrorMessage )
+{
+	// Gathers the projected points of a way, and its name.  Ways without a name use their reference instead
+	// (e.g. "I 40".)
+	auto GetWayPoints = []( const FOSMFile& OSMFile, const TArray<FVector2D>& OSMNodePositions, const FOSMFile::FOSMWayInfo& OSMWay, TArray<FVector2D>& OutPoints )
+	{
+		const TArrayView<const int32> OSMWayNodeIndices = OSMFile.GetWayNodeIndices( OSMWay );
+		OutPoints.SetNumUninitialized( OSMWayNodeIndices.Num() );
+		for( int32 PointIndex = 0; PointIndex < OSMWayNodeIndices.Num(); ++PointIndex )
+		{
+			OutPoints[ PointIndex ] = OSMNodePositions[ OSMWayNodeIndices[ PointIndex ] ];
+		}
+	};
+	auto GetWayName = []( const FOSMFile& OSMFile, const FOSMFile::FOSMWayInfo& OSMWay )
+	{
+		FString Name = OSMFile.GetString( OSMWay.Name );
+		return Name.IsEmpty() ? OSMFile.GetString( OSMWay.Ref ) : Name;
+	};
 
-				return true;
-			}
-			else
+
+	// Loading the file is most of the work.  Building the street map from it takes the rest of the progress bar.
+	const float LoadProgressFraction = 0.8f;
+	auto ReportLoadProgress = [&ProgressCallback, LoadProgressFraction]( const float LoadProgress )
+	{
+		return ProgressCallback( LoadProgress * LoadProgressFraction );
+	};
+	auto ReportBuildProgress = [&ProgressCallback, &OutErrorMessage, LoadProgressFraction]( const float BuildProgress )
+	{
+		if( !ProgressCallback( LoadProgressFraction + BuildProgress * ( 1.0f - LoadProgressFraction ) ) )
+		{
+			OutErrorMessage = LOCTEXT( "BuildStreetMap_Cancelled", "The import was cancelled" );
+			return false;
+		}
+		return true;
+	};
+
+	// Hash the file while we parse it, so that reimports can tell whether it changed.  The hash is serial, but
+	// it's much quicker than parsing and we have the whole file in memory anyway.  A failed or cancelled import has
+	// no use for the hash, so the task checks between blocks whether to give up, rather than hashing gigabytes that
+	// we'll throw away.  We still wait for it to stop, because it's reading the caller's buffer.
+	OutResult.SourceFileSize = Buffer.Num();
+	OutResult.ImportSettingsHash = HashImportSettings( Settings );
+	std::atomic<bool> bStopHashing( false );
+	TFuture<FMD5Hash> SourceFileHash = Async( EAsyncExecution::TaskGraph, [Buffer, &bStopHashing]()
+	{
+		FMD5 MD5;
+		const int64 BytesPerUpdate = 4 * 1024 * 1024;
+		for( int64 Offset = 0; Offset < Buffer.Num(); Offset += BytesPerUpdate )
+		{
+			if( bStopHashing )
 			{
-				// NOTE: Skipped adding building for way because it has less than 3 points
-				// @todo: Log this for the user as an import warning
+				return FMD5Hash();
 			}
+			MD5.Update( Buffer.GetData() + Offset, FMath::Min( BytesPerUpdate, Buffer.Num() - Offset ) );
 		}
 
-		return false;
+		FMD5Hash Hash;
+		Hash.Set( MD5 );
+		return Hash;
+	} );
+	bool bSucceeded = false;
+	ON_SCOPE_EXIT
+	{
+		bStopHashing = !bSucceeded;
+		const FMD5Hash Hash = SourceFileHash.Get();
+		if( bSucceeded )
+		{
+			OutResult.SourceFileHash = Hash;
+		}
 	};
 
-
-	// Load up the OSM file.  It's in XML format.
-	FOSMFile OSMFile;
-	if( !OSMFile.LoadOpenStreetMapFile( OSMFilePath, bIsFilePathActuallyTextBuffer, FeedbackContext ) )
+	// Load up the OSM file.  It's either in XML format or PBF format.
+	FOSMFile OSMFile( Settings );
+	const bool bLoadedOSMFile = bIsPBF ? 
+		OSMFile.LoadOpenStreetMapPBFFile( Buffer, ReportLoadProgress, /* Out */ OutErrorMessage ) :
+		OSMFile.LoadOpenStreetMapFile( Buffer, XmlSummary, ReportLoadProgress, /* Out */ OutErrorMessage );
+	if( !bLoadedOSMFile )
 	{
-		// Loading failed.  The actual error message will be sent to the FeedbackContext's log.
 		return false;
 	}
 
-	// @todo: The loaded OSMFile stores data in double precision, but our runtime representation (UStreetMap)
-	//        truncates everything to single precision, after transposing coordinates to be relative to the
-	//        center of the map's 2D bounds.  Large maps will suffer from floating point precision issues.
-	//        To solve this we'd need to either store everything in double precision, or store map elements
-	//        in integral grid cells with coordinates relative to their cell.  Of course, there will be many
-	//        other considerations for handling huge maps (loading, rendering, collision, etc.)
-
-	// Maps OSMWayInfos to the RoadIndex we created for that way
-	TMap< const FOSMFile::FOSMWayInfo*, int32 > OSMWayToRoadIndexMap;
-
-	StreetMap->BoundsMin = FVector2D( TNumericLimits<float>::Max(), TNumericLimits<float>::Max() );
-	StreetMap->BoundsMax = FVector2D( TNumericLimits<float>::Lowest(), TNumericLimits<float>::Lowest() );
+	// Project every node into map space once, up front, rather than once for each way that uses it.  Points are
+	// relative to the center of the map, so that we get as much precision as possible.
+	FStreetMapProjection& Projection = OutResult.Projection;
+	Projection.Type = Settings.Projection;
+	Projection.OriginLatitude = OSMFile.AverageLatitude;
+	Projection.OriginLongitude = OSMFile.AverageLongitude;
+	Projection.UnitsPerMeter = FStreetMapWayConverter::OSMToCentimetersScaleFactor;
+	TArray<FVector2D> OSMNodePositions;
+	OSMNodePositions.SetNumUninitialized( OSMFile.NodeIDs.Num() );
+	Projection.GeoToWorld( OSMFile.NodeLatitudes, OSMFile.NodeLongitudes, OSMNodePositions );
+	if( !ReportBuildProgress( 0.25f ) )
+	{
+		return false;
+	}
 
-	for( const FOSMFile::FOSMWayInfo* OSMWay : OSMFile.Ways )
+	// Decide what each way becomes, and where it goes.  Roads need at least two points, and buildings need at least
+	// three so that we don't end up with degenerate polygons.  Handing out the indices up front lets us fill in every
+	// road and building in parallel, and they still come out in the same order as the ways did.
+	// @todo: Log skipped ways for the user as an import warning
+	TArray<int32> OSMWayToRoadIndex;
+	TArray<int32> OSMWayToBuildingIndex;
+	OSMWayToRoadIndex.Init( INDEX_NONE, OSMFile.Ways.Num() );
+	OSMWayToBuildingIndex.Init( INDEX_NONE, OSMFile.Ways.Num() );
+	int32 RoadCount = 0;
+	int32 BuildingCount = 0;
+	for( int32 OSMWayIndex = 0; OSMWayIndex < OSMFile.Ways.Num(); ++OSMWayIndex )
 	{
+		const FOSMFile::FOSMWayInfo& OSMWay = OSMFile.Ways[ OSMWayIndex ];
+
 		// Handle buildings differently than roads
-		if( OSMWay->WayType == FOSMFile::EOSMWayType::Building )
+		if( OSMFile.TagClassifier.GetRule( OSMWay.TagRuleIndex ).bIsBuilding )
 		{
-			if( AddBuildingForWay( OSMFile, *StreetMap, *OSMWay ) )
+			if( OSMWay.NodeCount > 2 )
 			{
-				// ...
+				OSMWayToBuildingIndex[ OSMWayIndex ] = BuildingCount++;
 			}
 		}
-		else
+		else if( OSMWay.NodeCount > 1 )
 		{
-			int32 RoadIndex = INDEX_NONE;
-			if( AddRoadForWay( OSMFile, *StreetMap, *OSMWay, RoadIndex ) )
-			{
-				OSMWayToRoadIndexMap.Add( OSMWay, RoadIndex );
-			}
+			OSMWayToRoadIndex[ OSMWayIndex ] = RoadCount++;
 		}
 	}
 
-	for( const auto& NodeMapHashPair : OSMFile.NodeMap )
+	OutResult.Roads.SetNum( RoadCount );
+	OutResult.Buildings.SetNum( BuildingCount );
+	ParallelFor( OSMFile.Ways.Num(), [&]( const int32 OSMWayIndex )
 	{
-		const FOSMFile::FOSMNodeInfo& OSMNode = *NodeMapHashPair.Value;
-
-		// Any ways touching this node?
-		if( OSMNode.WayRefs.Num() > 0 )
+		const FOSMFile::FOSMWayInfo& OSMWay = OSMFile.Ways[ OSMWayIndex ];
+		if( OSMWayToRoadIndex[ OSMWayIndex ] != INDEX_NONE )
+		{
+			TArray<FVector2D> Points;
+			GetWayPoints( OSMFile, OSMNodePositions, OSMWay, Points );
+			FStreetMapWayConverter::FillRoad( OSMFile.TagClassifier, OSMWay, GetWayName( OSMFile, OSMWay ), MoveTemp( Points ), OutResult.Roads[ OSMWayToRoadIndex[ OSMWayIndex ] ] );
+		}
+		else if( OSMWayToBuildingIndex[ OSMWayIndex ] != INDEX_NONE )
 		{
-			FStreetMapNode NewNode;
+			TArray<FVector2D> Points;
+			GetWayPoints( OSMFile, OSMNodePositions, OSMWay, Points );
+			FStreetMapWayConverter::FillBuilding( OSMWay, GetWayName( OSMFile, OSMWay ), MoveTemp( Points ), OutResult.Buildings[ OSMWayToBuildingIndex[ OSMWayIndex ] ] );
+		}
+	} );
 
-			for( const FOSMFile::FOSMWayRef& OSMWayRef : OSMNode.WayRefs )
-			{
-				const int32* FoundRoundIndexPtr = OSMWayToRoadIndexMap.Find( OSMWayRef.Way );
-				if( FoundRoundIndexPtr != nullptr )
-				{
-					const int32 FoundRoadIndex = *FoundRoundIndexPtr;
+	OutResult.BoundsMin = FVector2D( TNumericLimits<float>::Max(), TNumericLimits<float>::Max() );
+	OutResult.BoundsMax = FVector2D( TNumericLimits<float>::Lowest(), TNumericLimits<float>::Lowest() );
+	auto AddToBounds = [&OutResult]( const FVector2D BoundsMin, const FVector2D BoundsMax )
+	{
+		OutResult.BoundsMin.X = FMath::Min( OutResult.BoundsMin.X, BoundsMin.X );
+		OutResult.BoundsMin.Y = FMath::Min( OutResult.BoundsMin.Y, BoundsMin.Y );
+		OutResult.BoundsMax.X = FMath::Max( OutResult.BoundsMax.X, BoundsMax.X );
+		OutResult.BoundsMax.Y = FMath::Max( OutResult.BoundsMax.Y, BoundsMax.Y );
+	};
+	for( const FStreetMapImportRoad& Road : OutResult.Roads )
+	{
+		AddToBounds( Road.BoundsMin, Road.BoundsMax );
+	}
+	for( const FStreetMapBuilding& Building : OutResult.Buildings )
+	{
+		AddToBounds( Building.BoundsMin, Building.BoundsMax );
+	}
 
-					FStreetMapRoadRef RoadRef;
-					RoadRef.RoadIndex = FoundRoadIndex;
+	// Remember which ways and nodes everything came from, so that change files can be applied to the street map later
+	{
+		FStreetMapOSMSource& OSMSource = OutResult.OSMSource;
+		OSMSource.bIsValid = true;
 
-					const int32 RoadPointIndex = OSMWayRef.NodeIndex;
-					RoadRef.RoadPointIndex = RoadPointIndex;
-					NewNode.RoadRefs.Add( RoadRef );
-				}
-				else
+		OSMSource.RoadWayIDs.SetNumUninitialized( RoadCount );
+		OSMSource.BuildingWayIDs.SetNumUninitialized( BuildingCount );
+		TArray<int64> PointNodeIDs;
+		for( int32 OSMWayIndex = 0; OSMWayIndex < OSMFile.Ways.Num(); ++OSMWayIndex )
+		{
+			const int32 RoadIndex = OSMWayToRoadIndex[ OSMWayIndex ];
+			if( RoadIndex != INDEX_NONE )
+			{
+				OSMSource.RoadWayIDs[ RoadIndex ] = OSMFile.Ways[ OSMWayIndex ].ID;
+				for( const int32 OSMNodeIndex : OSMFile.GetWayNodeIndices( OSMFile.Ways[ OSMWayIndex ] ) )
 				{
-					// Skipped ref because we didn't keep this road in our data set							
+					PointNodeIDs.Add( OSMFile.NodeIDs[ OSMNodeIndex ] );
 				}
 			}
-
-			// Only store nodes that are attached to at least one road.  We must have at least a connection to a single
-			// road, otherwise we've filtered this node's road out and there's no point in wasting memory on the node itself.
-			if( NewNode.RoadRefs.Num() > 0 )
+		}
+		for( int32 OSMWayIndex = 0; OSMWayIndex < OSMFile.Ways.Num(); ++OSMWayIndex )
+		{
+			const int32 BuildingIndex = OSMWayToBuildingIndex[ OSMWayIndex ];
+			if( BuildingIndex != INDEX_NONE )
 			{
-				// Most nodes from OpenStreetMap will only be touching a single road.  These nodes usually make up the points
-				// along the length of the road, even for roads with no intersections except at the beginning and end.  We
-				// don't need to store these points unless they are at the ends of the road.  Keeping the points at the
-				// beginning and end of the road is useful when calculating navigation data, but the other nodes can go!
-				// In the road's NodeIndices array, any nodes we filter out here will simply have an INDEX_NONE value in that
-				// array, and we'll only store the positions of the road at these points in the road's RoadPoints array.
-
-				const FStreetMapRoadRef& FirstRoadRef = NewNode.RoadRefs[ 0 ];
-				const FStreetMapRoad& FirstRoad = StreetMap->Roads[ FirstRoadRef.RoadIndex ];
-
-				if( NewNode.RoadRefs.Num() > 1 ||					// Does the node connect to more than one road?
-					FirstRoadRef.RoadPointIndex == 0 ||				// Does the node connect to the beginning of the road?
-					FirstRoadRef.RoadPointIndex == ( FirstRoad.NodeIndices.Num() - 1 ) )	// Does the node connect to the end of the road?
+				// Buildings may have lost their closing point, so only take as many nodes as they have points
+				OSMSource.BuildingWayIDs[ BuildingIndex ] = OSMFile.Ways[ OSMWayIndex ].ID;
+				const TArrayView<const int32> OSMWayNodeIndices = OSMFile.GetWayNodeIndices( OSMFile.Ways[ OSMWayIndex ] );
+				for( int32 PointIndex = 0; PointIndex < OutResult.Buildings[ BuildingIndex ].BuildingPoints.Num(); ++PointIndex )
 				{
-					const int32 NewNodeIndex = StreetMap->Nodes.Num();
-					StreetMap->Nodes.Add( NewNode );
-
-					// Update the roads that are overlapping this node
-					for( const FStreetMapRoadRef& RoadRef : NewNode.RoadRefs )
-					{
-						FStreetMapRoad& Road = StreetMap->Roads[ RoadRef.RoadIndex ];
-						check( Road.NodeIndices[ RoadRef.RoadPointIndex ] == INDEX_NONE );
-						Road.NodeIndices[ RoadRef.RoadPointIndex ] = NewNodeIndex;
-					}
-				}
-				else
-				{
-					// Node has only one road that is references, and it wasn't the beginning or end of the road, so filter it out!
+					PointNodeIDs.Add( OSMFile.NodeIDs[ OSMWayNodeIndices[ PointIndex ] ] );
 				}
 			}
-			else
+		}
+		OSMSource.SetPointNodeIDs( PointNodeIDs );
+	}
+
+	if( !ReportBuildProgress( 0.75f ) )
+	{
+		return false;
+	}
+
+	// Most nodes from OpenStreetMap will only be touching a single road.  These nodes usually make up the points
+	// along the length of the road, even for roads with no intersections except at the beginning and end.  We
+	// don't need to store these points unless they are at the ends of the road.  Keeping the points at the
+	// beginning and end of the road is useful when calculating navigation data, but the other nodes can go!
+	// In the road's NodeIndices array, any nodes we filter out here will simply have an INDEX_NONE value in that
+	// array, and we'll only store the positions of the road at these points in the road's RoadPoints array.
+	//
+	// We flag the nodes we keep in parallel, then hand out their indices in the order of the OSM nodes, so the
+	// result doesn't depend on how the work was scheduled.
+	TArray<int32> OSMNodeToNodeIndex;
+	OSMNodeToNodeIndex.SetNumUninitialized( OSMFile.NodeIDs.Num() );
+	ParallelFor( OSMFile.NodeIDs.Num(), [&]( const int32 OSMNodeIndex )
+	{
+		int32 RoadRefCount = 0;
+		bool bIsAtEndOfRoad = false;
+		for( const FOSMFile::FOSMWayRef& OSMWayRef : OSMFile.GetNodeWayRefs( OSMNodeIndex ) )
+		{
+			// Refs to ways we didn't keep as roads are skipped
+			const int32 FoundRoadIndex = OSMWayToRoadIndex[ OSMWayRef.WayIndex ];
+			if( FoundRoadIndex != INDEX_NONE )
 			{
-				// Node doesn't reference any roads that we kept, or the data was malformed.  Filter it out.
+				++RoadRefCount;
+				bIsAtEndOfRoad |= OSMWayRef.NodeIndex == 0 || OSMWayRef.NodeIndex == ( OutResult.Roads[ FoundRoadIndex ].NodeIndices.Num() - 1 );
 			}
 		}
+
+		// Keep nodes that connect more than one road, or that are at the beginning or end of a road.  For now we
+		// just flag them, and they get their indices below.
+		OSMNodeToNodeIndex[ OSMNodeIndex ] = ( RoadRefCount > 1 || bIsAtEndOfRoad ) ? 1 : 0;
+	} );
+
+	int32 NodeCount = 0;
+	for( int32& NodeIndex : OSMNodeToNodeIndex )
+	{
+		NodeIndex = NodeIndex != 0 ? NodeCount++ : INDEX_NONE;
 	}
 
+	OutResult.Nodes.SetNum( NodeCount );
+	ParallelFor( OSMFile.NodeIDs.Num(), [&]( const int32 OSMNodeIndex )
+	{
+		const int32 NewNodeIndex = OSMNodeToNodeIndex[ OSMNodeIndex ];
+		if( NewNodeIndex == INDEX_NONE )
+		{
+			return;
+		}
+
+		FStreetMapImportNode& NewNode = OutResult.Nodes[ NewNodeIndex ];
+		for( const FOSMFile::FOSMWayRef& OSMWayRef : OSMFile.GetNodeWayRefs( OSMNodeIndex ) )
+		{
+			const int32 FoundRoadIndex = OSMWayToRoadIndex[ OSMWayRef.WayIndex ];
+			if( FoundRoadIndex != INDEX_NONE )
+			{
+				FStreetMapRoadRef& RoadRef = NewNode.RoadRefs.AddDefaulted_GetRef();
+				RoadRef.RoadIndex = FoundRoadIndex;
+				RoadRef.RoadPointIndex = OSMWayRef.NodeIndex;
+
+				// Each road point belongs to exactly one OSM node, so no other task writes to this element
+				FStreetMapImportRoad& Road = OutResult.Roads[ FoundRoadIndex ];
+				check( Road.NodeIndices[ RoadRef.RoadPointIndex ] == INDEX_NONE );
+				Road.NodeIndices[ RoadRef.RoadPointIndex ] = NewNodeIndex;
+			}
+		}
+	} );
+
 	// Validation test: Make sure that all roads have at least two nodes referencing them, one at the beginning and
 	// one at the end.
-	for( const FStreetMapRoad& Road : StreetMap->Roads )
+	for( const FStreetMapImportRoad& Road : OutResult.Roads )
 	{
 		const bool bHasNodeAtBeginning = Road.NodeIndices[ 0 ] != INDEX_NONE;
 		const bool bHasNodeAtEnd = Road.NodeIndices[ Road.NodeIndices.Num() - 1 ] != INDEX_NONE;
@@ -432,7 +576,25 @@ bool UStreetMapFactory::LoadFromOpenStreetMapXMLFile( UStreetMap* StreetMap, FSt
 		ensure( bHasNodeAtBeginning && bHasNodeAtEnd );
 	}
 
-	return true;
-}
+	if( Settings.TileSize > 0.0f )
+	{
+		FStreetMapTiler::SplitIntoTiles( OutResult, Settings.TileSize * FStreetMapWayConverter::OSMToCentimetersScaleFactor );
 
+		// Each tile already knows its coordinates, which is all that reimports need to match tiles up again.  Change
+		// files aren't applied to tiled street maps, so the OpenStreetMap source of the whole map isn't kept.
+		OutResult.OSMSource = FStreetMapOSMSource();
+	}
+
+	// Pack the roads and nodes here rather than when they're moved into the street map, which is done on the game thread
+	ParallelFor( OutResult.Tiles.Num(), [&]( const int32 TileIndex )
+	{
+		FStreetMapImportTile& Tile = OutResult.Tiles[ TileIndex ];
+		FStreetMapWayConverter::PackRoadsAndNodes( Tile.Roads, Tile.Nodes, Tile.PackedRoadsAndNodes );
+	} );
+	FStreetMapWayConverter::PackRoadsAndNodes( OutResult.Roads, OutResult.Nodes, OutResult.PackedRoadsAndNodes );
+
+	bSucceeded = ReportBuildProgress( 1.0f );
+	return bSucceeded;
+}
 
+#undef LOCTEXT_NAMESPACE
@@ -1,7 +1,94 @@
 #pragma once
 #include "Factories/Factory.h"
+#include "StreetMap.h"
+#include "Misc/SecureHash.h"
 #include "StreetMapFactory.generated.h"
 
+class FOSMSourceFile;
+struct FOSMXmlSummary;
+
+/** A road that is being imported.  Unlike the roads of a street map, it owns its points and node indices, so that it
+    can be built on its own.  See FStreetMapWayConverter::PackRoadsAndNodes(). */
+struct FStreetMapImportRoad
+{
+	FString RoadName;
+	TEnumAsByte<EStreetMapRoadType> RoadType = EStreetMapRoadType::Street;
+	TArray<int32> NodeIndices;
+	TArray<FVector2D> RoadPoints;
+	FVector2D BoundsMin = FVector2D::ZeroVector;
+	FVector2D BoundsMax = FVector2D::ZeroVector;
+	bool bIsOneWay = false;
+};
+
+
+/** A node that is being imported, which owns its road refs */
+struct FStreetMapImportNode
+{
+	TArray<FStreetMapRoadRef> RoadRefs;
+};
+
+
+/** Roads and nodes packed into the buffers that a street map's roads and nodes share, ready to be handed to
+    UStreetMap::SetRoadsAndNodes().  Packing is done on the import's own thread, so that all the game thread has to do
+    is move the buffers in. */
+struct FStreetMapPackedRoadsAndNodes
+{
+	TArray<FStreetMapRoad> Roads;
+	TArray<FStreetMapNode> Nodes;
+	TArray<FVector2D> RoadPoints;
+	TArray<int32> RoadNodeIndices;
+	TArray<FStreetMapRoadRef> NodeRoadRefs;
+};
+
+
+/** One tile of a street map that is being split into tiles.  Points are relative to the middle of the tile. */
+struct FStreetMapImportTile
+{
+	FIntPoint Coordinates = FIntPoint::ZeroValue;
+	FVector2D Origin = FVector2D::ZeroVector;
+
+	TArray<FStreetMapImportRoad> Roads;
+	TArray<FStreetMapImportNode> Nodes;
+	TArray<FStreetMapBuilding> Buildings;
+	FVector2D BoundsMin = FVector2D::ZeroVector;
+	FVector2D BoundsMax = FVector2D::ZeroVector;
+
+	/** The roads and nodes, packed once the import is done with them.  Roads and Nodes are empty after that. */
+	FStreetMapPackedRoadsAndNodes PackedRoadsAndNodes;
+
+	/** Nodes that are shared with neighboring tiles */
+	TArray<FStreetMapTileLink> Links;
+};
+
+
+/** Roads, nodes and buildings built from an OpenStreetMap file, waiting to be moved into a street map asset */
+struct FStreetMapImportResult
+{
+	TArray<FStreetMapImportRoad> Roads;
+	TArray<FStreetMapImportNode> Nodes;
+	TArray<FStreetMapBuilding> Buildings;
+	FVector2D BoundsMin = FVector2D::ZeroVector;
+	FVector2D BoundsMax = FVector2D::ZeroVector;
+
+	/** The roads and nodes, packed once the import is done with them.  Roads and Nodes are empty after that. */
+	FStreetMapPackedRoadsAndNodes PackedRoadsAndNodes;
+
+	/** What the street map was built from, so that reimports can tell whether anything changed */
+	int64 SourceFileSize = -1;
+	FMD5Hash SourceFileHash;
+	uint32 ImportSettingsHash = 0;
+
+	/** How latitudes and longitudes were flattened into map space */
+	FStreetMapProjection Projection;
+
+	/** Which ways and nodes the roads and buildings came from, so that change files can be applied later */
+	FStreetMapOSMSource OSMSource;
+
+	/** If the street map is split into tiles, the tiles.  Roads, nodes and buildings are all in the tiles then. */
+	TArray<FStreetMapImportTile> Tiles;
+};
+
+
 /**
  * Import factory object for OpenStreetMap assets
  */
@@ -15,15 +102,53 @@ public:
 	/** UStreetMapFactory constructor */
 	UStreetMapFactory( const class FObjectInitializer& ObjectInitializer );
 
+	/** Settings used for the next import.  These are stored in the new asset, so that reimports use them too. */
+	UPROPERTY( EditAnywhere, Category=ImportSettings )
+	FStreetMapImportSettings ImportSettings;
+
+	/** Opens an OpenStreetMap file for importing, and scans XML files to find out what's in them.  Returns false if the file couldn't be opened. */
+	static bool OpenSourceFile( const FString& Filename, TUniquePtr<FOSMSourceFile>& OutSourceFile, bool& bOutIsPBF, FOSMXmlSummary& OutXmlSummary, FFeedbackContext* Warn );
+
+	/** Builds a street map from the contents of an OpenStreetMap XML or PBF file.  The buffer is decoded in place (no copies are made.)
+	    For XML files, the summary from scanning the file is used to size arrays up front.  Safe to call from any thread.
+	    ProgressCallback receives the fraction done so far, and can return false to cancel. */
+	static bool BuildStreetMap( const FStreetMapImportSettings& Settings, const TArrayView64<const uint8> Buffer, const bool bIsPBF, const FOSMXmlSummary& XmlSummary, TFunctionRef<bool( float )> ProgressCallback, FStreetMapImportResult& OutResult, FText& OutErrorMessage );
+
+	/** Creates a new, empty street map asset for an OpenStreetMap file, remembering where it came from and the settings to import it with */
+	static UStreetMap* CreateStreetMap( UObject* Parent, const FName Name, const EObjectFlags Flags, const FString& Filename, const FStreetMapImportSettings& Settings );
+
+	/** Replaces the roads, nodes and buildings of the street map with the ones we built, and remembers the file they
+	    were built from.  If the street map was split into tiles, the tiles are saved as street maps next to it (reusing
+	    any that are already there), and the street map lists them.  Must be called on the game thread. */
+	static void ApplyImportResult( UStreetMap* StreetMap, const FString& Filename, FStreetMapImportResult& Result );
+
+	/** Returns the asset name of one tile of a street map that is split into tiles */
+	static FString GetTileName( const FString& StreetMapName, const FIntPoint TileCoordinates );
+
+	/** Returns a hash of everything besides the source file that affects what an import builds */
+	static uint32 HashImportSettings( const FStreetMapImportSettings& Settings );
+
 protected:
 
+	/** Whether to show a summary of the file and ask the user to confirm before importing.  Never shown for automated imports. */
+	bool bShowImportPreview;
+
 	// UFactory overrides
-	virtual UObject* FactoryCreateText( UClass* Class, UObject* Parent, FName Name, EObjectFlags Flags, UObject* Context, const TCHAR* Type, const TCHAR*& Buffer, const TCHAR* BufferEnd, FFeedbackContext* Warn ) override;
+	virtual UObject* FactoryCreateFile( UClass* Class, UObject* Parent, FName Name, EObjectFlags Flags, const FString& Filename, const TCHAR* Parms, FFeedbackContext* Warn, bool& bOutOperationCanceled ) override;
+
+	/** Imports an opened OpenStreetMap file into the street map.  Background imports are built on background tasks, which
+	    fill in the street map, dirty its package and report how it went when they finish.  Otherwise the street map is
+	    built right away, behind a progress dialog.  The street map keeps what it had until the import succeeds.  Returns
+	    false if an immediate import failed or was cancelled. */
+	static bool ImportStreetMap( UStreetMap* StreetMap, const FString& Filename, TUniquePtr<FOSMSourceFile> SourceFile, const bool bIsPBF, const FOSMXmlSummary& XmlSummary, const bool bImportInBackground, FFeedbackContext* Warn, bool& bOutOperationCanceled );
+
+	/** Shows what's in an OpenStreetMap XML file before importing it.  Returns false if the user cancelled the import. */
+	static bool ShowImportPreview( const FString& Filename, const FOSMXmlSummary& XmlSummary );
 
-	/** Loads the street map from an OpenStreetMap XML file.  Note that in the case of the file path containing the XML data, the string must be mutable for us to parse it quickly. */
-	bool LoadFromOpenStreetMapXMLFile( class UStreetMap* StreetMap, FString& OSMFilePath, const bool bIsFilePathActuallyTextBuffer, class FFeedbackContext* FeedbackContext );
+	/** Fills in the street maps for the tiles of an import, and lists them in the street map they were split from */
+	static void ApplyImportTiles( UStreetMap* StreetMap, TArray<FStreetMapImportTile>& ImportTiles );
 
-	/** Static: Latitude/longitude scale factor */
-	static const double LatitudeLongitudeScale;
+	/** Returns true if the file name has the extension of an OpenStreetMap PBF file */
+	static bool IsPBFFile( const FString& Filename );
 };
 
@@ -0,0 +1,477 @@
+#include "StreetMapImportCommandlet.h"
+#include "StreetMapFactory.h"
+#include "StreetMapComponent.h"
+#include "StreetMapStaticMeshBuilder.h"
+#include "OSMSourceFile.h"
+#include "OSMXmlReader.h"
+#include "Async/Async.h"
+#include "Containers/Queue.h"
+#include "Engine/StaticMesh.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Dom/JsonObject.h"
+#include "JsonObjectConverter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+#include "UObject/StrongObjectPtr.h"
+#include "Misc/FeedbackContext.h"
+#include <atomic>
+
+DEFINE_LOG_CATEGORY_STATIC( LogStreetMapImportCommandlet, Log, All );
+
+namespace StreetMapImportCommandlet
+{
+	/** One file to import, and how it went */
+	struct FImportJob
+	{
+		// From the manifest
+		FString SourceFilename;
+		FString PackageName;
+		FString MeshPackageName;
+		FStreetMapImportSettings Settings;
+
+		// Filled in by the worker that builds the street map
+		FStreetMapImportResult Result;
+		FText ErrorMessage;
+		bool bSucceeded = false;
+		int64 SourceBytes = 0;
+		int64 ResultBytes = 0;
+		int32 RoadCount = 0;
+		int32 NodeCount = 0;
+		int32 BuildingCount = 0;
+		double ScanSeconds = 0.0;
+		double BuildSeconds = 0.0;
+
+		// Filled in on the game thread, once the street map is built
+		double SaveSeconds = 0.0;
+		double MeshSeconds = 0.0;
+		uint64 UsedPhysicalBytes = 0;
+	};
+
+
+	/** Returns roughly how much memory some packed roads and nodes, and some buildings take up */
+	static int64 GetAllocatedSize( const FStreetMapPackedRoadsAndNodes& Packed, const TArray<FStreetMapBuilding>& Buildings )
+	{
+		int64 AllocatedSize = Packed.Roads.GetAllocatedSize() + Packed.Nodes.GetAllocatedSize() + Buildings.GetAllocatedSize() +
+			Packed.RoadPoints.GetAllocatedSize() + Packed.RoadNodeIndices.GetAllocatedSize() + Packed.NodeRoadRefs.GetAllocatedSize();
+		for( const FStreetMapRoad& Road : Packed.Roads )
+		{
+			AllocatedSize += Road.RoadName.GetAllocatedSize();
+		}
+		for( const FStreetMapBuilding& Building : Buildings )
+		{
+			AllocatedSize += Building.BuildingPoints.GetAllocatedSize() + Building.BuildingName.GetAllocatedSize();
+		}
+		return AllocatedSize;
+	}
+
+
+	/** Returns roughly how much memory the street map we built takes up, including all of its tiles */
+	static int64 GetResultAllocatedSize( const FStreetMapImportResult& Result )
+	{
+		int64 AllocatedSize = GetAllocatedSize( Result.PackedRoadsAndNodes, Result.Buildings ) + Result.Tiles.GetAllocatedSize();
+		for( const FStreetMapImportTile& Tile : Result.Tiles )
+		{
+			AllocatedSize += GetAllocatedSize( Tile.PackedRoadsAndNodes, Tile.Buildings ) + Tile.Links.GetAllocatedSize();
+		}
+		return AllocatedSize;
+	}
+
+
+	/** Reads the manifest.  Returns false if it couldn't be read, or doesn't describe any jobs. */
+	static bool ReadManifest( const FString& ManifestFilename, TArray<FImportJob>& OutJobs, FString& OutMeshTemplatePath )
+	{
+		FString ManifestText;
+		if( !FFileHelper::LoadFileToString( ManifestText, *ManifestFilename ) )
+		{
+			UE_LOG( LogStreetMapImportCommandlet, Error, TEXT( "Unable to read manifest '%s'" ), *ManifestFilename );
+			return false;
+		}
+
+		TSharedPtr<FJsonObject> Manifest;
+		if( !FJsonSerializer::Deserialize( TJsonReaderFactory<>::Create( ManifestText ), Manifest ) || !Manifest.IsValid() )
+		{
+			UE_LOG( LogStreetMapImportCommandlet, Error, TEXT( "Manifest '%s' isn't valid JSON" ), *ManifestFilename );
+			return false;
+		}
+
+		FStreetMapImportSettings DefaultSettings;
+		const TSharedPtr<FJsonObject>* DefaultSettingsObject = nullptr;
+		if( Manifest->TryGetObjectField( TEXT( "Settings" ), DefaultSettingsObject ) &&
+			!FJsonObjectConverter::JsonObjectToUStruct( DefaultSettingsObject->ToSharedRef(), &DefaultSettings ) )
+		{
+			UE_LOG( LogStreetMapImportCommandlet, Error, TEXT( "Manifest '%s' has invalid default settings" ), *ManifestFilename );
+			return false;
+		}
+
+		Manifest->TryGetStringField( TEXT( "MeshTemplate" ), OutMeshTemplatePath );
+
+		const TArray<TSharedPtr<FJsonValue>>* JobValues = nullptr;
+		if( !Manifest->TryGetArrayField( TEXT( "Jobs" ), JobValues ) || JobValues->Num() == 0 )
+		{
+			UE_LOG( LogStreetMapImportCommandlet, Error, TEXT( "Manifest '%s' doesn't list any jobs" ), *ManifestFilename );
+			return false;
+		}
+
+		for( int32 JobIndex = 0; JobIndex < JobValues->Num(); ++JobIndex )
+		{
+			const TSharedPtr<FJsonObject> JobObject = ( *JobValues )[ JobIndex ]->AsObject();
+
+			FImportJob& Job = OutJobs.AddDefaulted_GetRef();
+			Job.Settings = DefaultSettings;
+			if( !JobObject.IsValid() ||
+				!JobObject->TryGetStringField( TEXT( "Source" ), Job.SourceFilename ) ||
+				!JobObject->TryGetStringField( TEXT( "Package" ), Job.PackageName ) ||
+				!FPackageName::IsValidLongPackageName( Job.PackageName ) )
+			{
+				UE_LOG( LogStreetMapImportCommandlet, Error, TEXT( "Job %i needs a Source file and a valid long Package name" ), JobIndex );
+				return false;
+			}
+
+			if( JobObject->TryGetStringField( TEXT( "MeshPackage" ), Job.MeshPackageName ) && !FPackageName::IsValidLongPackageName( Job.MeshPackageName ) )
+			{
+				UE_LOG( LogStreetMapImportCommandlet, Error, TEXT( "Job %i has an invalid MeshPackage name '%s'" ), JobIndex, *Job.MeshPackageName );
+				return false;
+			}
+
+			// Job settings only override what they specify
+			const TSharedPtr<FJsonObject>* JobSettingsObject = nullptr;
+			if( JobObject->TryGetObjectField( TEXT( "Settings" ), JobSettingsObject ) &&
+				!FJsonObjectConverter::JsonObjectToUStruct( JobSettingsObject->ToSharedRef(), &Job.Settings ) )
+			{
+				UE_LOG( LogStreetMapImportCommandlet, Error, TEXT( "Job %i has invalid settings" ), JobIndex );
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+
+	/** Where the factory reports problems while a worker is building a street map.  GWarn belongs to the game thread,
+	    so each job gets one of these instead, which only passes messages on to the log. */
+	class FWorkerFeedbackContext : public FFeedbackContext
+	{
+
+	public:
+
+		// FOutputDevice overrides
+		virtual void Serialize( const TCHAR* V, ELogVerbosity::Type Verbosity, const FName& Category ) override
+		{
+			GLog->Serialize( V, Verbosity, Category );
+		}
+
+		virtual bool CanBeUsedOnAnyThread() const override
+		{
+			return true;
+		}
+	};
+
+
+	/** Opens the job's source file and builds its street map.  Runs on a worker thread. */
+	static void BuildJob( FImportJob& Job )
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		TUniquePtr<FOSMSourceFile> SourceFile;
+		bool bIsPBF = false;
+		FOSMXmlSummary XmlSummary;
+		FWorkerFeedbackContext Warn;
+		if( !UStreetMapFactory::OpenSourceFile( Job.SourceFilename, SourceFile, bIsPBF, XmlSummary, &Warn ) )
+		{
+			Job.ErrorMessage = NSLOCTEXT( "StreetMapImporting", "ImportCommandlet_OpenFailed", "Unable to open the source file" );
+			return;
+		}
+		Job.SourceBytes = SourceFile->GetData().Num();
+
+		const double ScanEndTime = FPlatformTime::Seconds();
+		Job.ScanSeconds = ScanEndTime - StartTime;
+
+		Job.bSucceeded = UStreetMapFactory::BuildStreetMap(
+			Job.Settings,
+			SourceFile->GetData(),
+			bIsPBF,
+			XmlSummary,
+			[]( const float Progress ) { return true; },
+			/* Out */ Job.Result,
+			/* Out */ Job.ErrorMessage );
+		Job.BuildSeconds = FPlatformTime::Seconds() - ScanEndTime;
+
+		Job.ResultBytes = GetResultAllocatedSize( Job.Result );
+		Job.RoadCount = Job.Result.PackedRoadsAndNodes.Roads.Num();
+		Job.NodeCount = Job.Result.PackedRoadsAndNodes.Nodes.Num();
+		Job.BuildingCount = Job.Result.Buildings.Num();
+		for( const FStreetMapImportTile& Tile : Job.Result.Tiles )
+		{
+			Job.RoadCount += Tile.PackedRoadsAndNodes.Roads.Num();
+			Job.NodeCount += Tile.PackedRoadsAndNodes.Nodes.Num();
+			Job.BuildingCount += Tile.Buildings.Num();
+		}
+	}
+
+
+	/** Saves an asset's package to disk.  Returns false if it couldn't be saved. */
+	static bool SaveAsset( UObject* Asset )
+	{
+		UPackage* Package = Asset->GetPackage();
+		const FString PackageFilename = FPackageName::LongPackageNameToFilename( Package->GetName(), FPackageName::GetAssetPackageExtension() );
+
+		FSavePackageArgs SaveArgs;
+		SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+		SaveArgs.Error = GWarn;
+		return UPackage::SavePackage( Package, Asset, *PackageFilename, SaveArgs );
+	}
+
+
+	/** Moves the street map we built into a new asset, builds its mesh if asked to, and saves everything.  Street maps
+	    that are split into tiles get one mesh per tile, named after the tile.  Runs on the game thread. */
+	static void FinishJob( FImportJob& Job, UStreetMapComponent* MeshTemplate )
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		UPackage* Package = CreatePackage( *Job.PackageName );
+		Package->FullyLoad();
+
+		const FName AssetName( *FPackageName::GetLongPackageAssetName( Job.PackageName ) );
+		UStreetMap* StreetMap = UStreetMapFactory::CreateStreetMap( Package, AssetName, RF_Public | RF_Standalone, Job.SourceFilename, Job.Settings );
+		UStreetMapFactory::ApplyImportResult( StreetMap, Job.SourceFilename, Job.Result );
+		FAssetRegistryModule::AssetCreated( StreetMap );
+
+		// The tiles were created along with the street map, so they're all loaded
+		TArray<UStreetMap*> TileStreetMaps;
+		for( const FStreetMapTile& Tile : StreetMap->GetTiles() )
+		{
+			TileStreetMaps.Add( Tile.StreetMap.Get() );
+		}
+
+		if( !SaveAsset( StreetMap ) )
+		{
+			Job.bSucceeded = false;
+			Job.ErrorMessage = FText::Format( NSLOCTEXT( "StreetMapImporting", "ImportCommandlet_SaveFailed", "Unable to save {0}" ), FText::FromString( Job.PackageName ) );
+		}
+		for( UStreetMap* TileStreetMap : TileStreetMaps )
+		{
+			if( Job.bSucceeded && !SaveAsset( TileStreetMap ) )
+			{
+				Job.bSucceeded = false;
+				Job.ErrorMessage = FText::Format( NSLOCTEXT( "StreetMapImporting", "ImportCommandlet_SaveFailed", "Unable to save {0}" ), FText::FromString( TileStreetMap->GetPackage()->GetName() ) );
+			}
+		}
+
+		const double MeshStartTime = FPlatformTime::Seconds();
+		Job.SaveSeconds = MeshStartTime - StartTime;
+
+		TArray<UStaticMesh*> StaticMeshes;
+		auto BuildMesh = [&Job, &StaticMeshes, MeshTemplate]( UStreetMap* MeshStreetMap, const FString& MeshPackageName )
+		{
+			UStreetMapComponent* StreetMapComponent = NewObject<UStreetMapComponent>( GetTransientPackage(), NAME_None, RF_Transient, MeshTemplate );
+			StreetMapComponent->SetStreetMap( MeshStreetMap, /* bClearPreviousMeshIfAny = */ true, /* bRebuildMesh = */ true );
+
+			const FName MeshName( *FPackageName::GetLongPackageAssetName( MeshPackageName ) );
+			UStaticMesh* StaticMesh = FStreetMapStaticMeshBuilder::CreateStaticMesh( StreetMapComponent, MeshPackageName, MeshName );
+			if( StaticMesh == nullptr || !SaveAsset( StaticMesh ) )
+			{
+				Job.bSucceeded = false;
+				Job.ErrorMessage = FText::Format( NSLOCTEXT( "StreetMapImporting", "ImportCommandlet_MeshFailed", "Unable to build and save the mesh in {0}" ), FText::FromString( MeshPackageName ) );
+			}
+			if( StaticMesh != nullptr )
+			{
+				StaticMeshes.Add( StaticMesh );
+			}
+			StreetMapComponent->MarkAsGarbage();
+		};
+
+		if( Job.bSucceeded && !Job.MeshPackageName.IsEmpty() )
+		{
+			if( TileStreetMaps.Num() == 0 )
+			{
+				BuildMesh( StreetMap, Job.MeshPackageName );
+			}
+			for( int32 TileIndex = 0; TileIndex < TileStreetMaps.Num() && Job.bSucceeded; ++TileIndex )
+			{
+				BuildMesh( TileStreetMaps[ TileIndex ], UStreetMapFactory::GetTileName( Job.MeshPackageName, TileStreetMaps[ TileIndex ]->GetTileCoordinates() ) );
+			}
+		}
+
+		Job.MeshSeconds = FPlatformTime::Seconds() - MeshStartTime;
+
+		// Everything is on disk now, so let the assets go.  Otherwise memory use would grow with the number of files.
+		StreetMap->ClearFlags( RF_Standalone );
+		for( UStreetMap* TileStreetMap : TileStreetMaps )
+		{
+			TileStreetMap->ClearFlags( RF_Standalone );
+		}
+		for( UStaticMesh* StaticMesh : StaticMeshes )
+		{
+			StaticMesh->ClearFlags( RF_Standalone );
+		}
+		CollectGarbage( GARBAGE_COLLECTION_KEEPFLAGS );
+
+		Job.UsedPhysicalBytes = FPlatformMemory::GetStats().UsedPhysical;
+	}
+
+
+	/** Writes what happened to each job as JSON */
+	static bool WriteResults( const FString& ResultsFilename, const TArray<FImportJob>& Jobs, const int32 WorkerCount, const double TotalSeconds )
+	{
+		FString ResultsText;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create( &ResultsText );
+		Writer->WriteObjectStart();
+		Writer->WriteValue( TEXT( "Workers" ), WorkerCount );
+		Writer->WriteValue( TEXT( "TotalSeconds" ), TotalSeconds );
+		Writer->WriteValue( TEXT( "PeakUsedPhysicalBytes" ), static_cast<int64>( FPlatformMemory::GetStats().PeakUsedPhysical ) );
+
+		Writer->WriteArrayStart( TEXT( "Jobs" ) );
+		for( const FImportJob& Job : Jobs )
+		{
+			Writer->WriteObjectStart();
+			Writer->WriteValue( TEXT( "Source" ), Job.SourceFilename );
+			Writer->WriteValue( TEXT( "Package" ), Job.PackageName );
+			Writer->WriteValue( TEXT( "Succeeded" ), Job.bSucceeded );
+			if( !Job.bSucceeded )
+			{
+				Writer->WriteValue( TEXT( "Error" ), Job.ErrorMessage.ToString() );
+			}
+			Writer->WriteValue( TEXT( "SourceBytes" ), Job.SourceBytes );
+			Writer->WriteValue( TEXT( "ScanSeconds" ), Job.ScanSeconds );
+			Writer->WriteValue( TEXT( "BuildSeconds" ), Job.BuildSeconds );
+			Writer->WriteValue( TEXT( "SaveSeconds" ), Job.SaveSeconds );
+			Writer->WriteValue( TEXT( "MeshSeconds" ), Job.MeshSeconds );
+			Writer->WriteValue( TEXT( "Roads" ), Job.RoadCount );
+			Writer->WriteValue( TEXT( "Nodes" ), Job.NodeCount );
+			Writer->WriteValue( TEXT( "Buildings" ), Job.BuildingCount );
+			Writer->WriteValue( TEXT( "ResultBytes" ), Job.ResultBytes );
+			Writer->WriteValue( TEXT( "UsedPhysicalBytesAfter" ), static_cast<int64>( Job.UsedPhysicalBytes ) );
+			Writer->WriteObjectEnd();
+		}
+		Writer->WriteArrayEnd();
+
+		Writer->WriteObjectEnd();
+		Writer->Close();
+
+		return FFileHelper::SaveStringToFile( ResultsText, *ResultsFilename );
+	}
+}
+
+
+UStreetMapImportCommandlet::UStreetMapImportCommandlet( const FObjectInitializer& ObjectInitializer )
+	: Super( ObjectInitializer )
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+int32 UStreetMapImportCommandlet::Main( const FString& Params )
+{
+	using namespace StreetMapImportCommandlet;
+
+	FString ManifestFilename;
+	if( !FParse::Value( *Params, TEXT( "Manifest=" ), ManifestFilename ) )
+	{
+		UE_LOG( LogStreetMapImportCommandlet, Error, TEXT( "Usage: -run=StreetMapImport -Manifest=<Manifest.json> [-Results=<Results.json>] [-Workers=<Count>]" ) );
+		return 1;
+	}
+
+	FString ResultsFilename = FPaths::Combine( FPaths::ProjectSavedDir(), TEXT( "StreetMapImportResults.json" ) );
+	FParse::Value( *Params, TEXT( "Results=" ), ResultsFilename );
+
+	// Every import already spreads its own work across the task graph, so we only need a few at once to keep the
+	// cores busy through the serial parts (reading, merging and saving.)  More than that just costs memory.
+	int32 WorkerCount = FMath::Clamp( FPlatformMisc::NumberOfCores() / 4, 1, 4 );
+	FParse::Value( *Params, TEXT( "Workers=" ), WorkerCount );
+	WorkerCount = FMath::Max( WorkerCount, 1 );
+
+	TArray<FImportJob> Jobs;
+	FString MeshTemplatePath;
+	if( !ReadManifest( ManifestFilename, Jobs, MeshTemplatePath ) )
+	{
+		return 1;
+	}
+
+	// The template has to outlive the garbage collection after every job
+	TStrongObjectPtr<UStreetMapComponent> MeshTemplate;
+	if( !MeshTemplatePath.IsEmpty() )
+	{
+		MeshTemplate.Reset( LoadObject<UStreetMapComponent>( nullptr, *MeshTemplatePath ) );
+		if( !MeshTemplate.IsValid() )
+		{
+			UE_LOG( LogStreetMapImportCommandlet, Error, TEXT( "Unable to load street map component template '%s'" ), *MeshTemplatePath );
+			return 1;
+		}
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	UE_LOG( LogStreetMapImportCommandlet, Display, TEXT( "Importing %i files with %i workers" ), Jobs.Num(), FMath::Min( WorkerCount, Jobs.Num() ) );
+
+	// Workers build street maps until there are no jobs left.  Creating and saving the assets has to happen on the
+	// game thread, so workers hand each finished job back to us through a queue.
+	std::atomic<int32> NextJobIndex( 0 );
+	TQueue<int32, EQueueMode::Mpsc> BuiltJobs;
+	TArray<TFuture<void>> Workers;
+	for( int32 WorkerIndex = 0; WorkerIndex < FMath::Min( WorkerCount, Jobs.Num() ); ++WorkerIndex )
+	{
+		Workers.Add( Async( EAsyncExecution::Thread, [&Jobs, &NextJobIndex, &BuiltJobs]()
+		{
+			for( int32 JobIndex = NextJobIndex++; JobIndex < Jobs.Num(); JobIndex = NextJobIndex++ )
+			{
+				BuildJob( Jobs[ JobIndex ] );
+				BuiltJobs.Enqueue( JobIndex );
+			}
+		} ) );
+	}
+
+	int32 FinishedJobCount = 0;
+	int32 FailedJobCount = 0;
+	while( FinishedJobCount < Jobs.Num() )
+	{
+		int32 JobIndex = INDEX_NONE;
+		if( !BuiltJobs.Dequeue( JobIndex ) )
+		{
+			FPlatformProcess::Sleep( 0.01f );
+			continue;
+		}
+
+		FImportJob& Job = Jobs[ JobIndex ];
+		if( Job.bSucceeded )
+		{
+			FinishJob( Job, MeshTemplate.Get() );
+		}
+		Job.Result = FStreetMapImportResult();
+
+		++FinishedJobCount;
+		if( Job.bSucceeded )
+		{
+			UE_LOG( LogStreetMapImportCommandlet, Display, TEXT( "[%i/%i] Imported '%s' into %s in %.2f seconds" ),
+				FinishedJobCount, Jobs.Num(), *Job.SourceFilename, *Job.PackageName, Job.ScanSeconds + Job.BuildSeconds + Job.SaveSeconds + Job.MeshSeconds );
+		}
+		else
+		{
+			++FailedJobCount;
+			UE_LOG( LogStreetMapImportCommandlet, Error, TEXT( "[%i/%i] Unable to import '%s': %s" ),
+				FinishedJobCount, Jobs.Num(), *Job.SourceFilename, *Job.ErrorMessage.ToString() );
+		}
+	}
+
+	for( TFuture<void>& Worker : Workers )
+	{
+		Worker.Wait();
+	}
+
+	const double TotalSeconds = FPlatformTime::Seconds() - StartTime;
+	if( !WriteResults( ResultsFilename, Jobs, WorkerCount, TotalSeconds ) )
+	{
+		UE_LOG( LogStreetMapImportCommandlet, Error, TEXT( "Unable to write results to '%s'" ), *ResultsFilename );
+		return 1;
+	}
+
+	UE_LOG( LogStreetMapImportCommandlet, Display, TEXT( "Imported %i of %i files in %.2f seconds.  Results are in '%s'" ),
+		Jobs.Num() - FailedJobCount, Jobs.Num(), TotalSeconds, *ResultsFilename );
+
+	return FailedJobCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "Commandlets/Commandlet.h"
+#include "StreetMapImportCommandlet.generated.h"
+
+/**
+ * Imports a batch of OpenStreetMap files without any user interaction, several at a time.  Usage:
+ *
+ *   UnrealEditor-Cmd MyProject.uproject -run=StreetMapImport -Manifest=<Manifest.json> [-Results=<Results.json>] [-Workers=<Count>]
+ *
+ * The manifest lists the files to import and the packages to save them in.  Import settings use the property names
+ * of FStreetMapImportSettings; settings on a job override the manifest's default settings.  Jobs with a MeshPackage
+ * also get a static mesh, built by a copy of the MeshTemplate street map component (or a default one.)  Jobs with a
+ * TileSize setting save each tile next to the Package, and get one mesh for each tile next to the MeshPackage.
+ *
+ *   {
+ *     "Settings": { "bOnlyKeepReferencedNodes": true },
+ *     "MeshTemplate": "/Game/Maps/BP_City.Default__BP_City_C:StreetMapComponent",
+ *     "Jobs":
+ *     [
+ *       { "Source": "D:/Extracts/Raleigh.osm.pbf", "Package": "/Game/Maps/Raleigh", "MeshPackage": "/Game/Maps/Raleigh_Mesh" },
+ *       { "Source": "D:/Extracts/Brooklyn.osm", "Package": "/Game/Maps/Brooklyn", "Settings": { "bOnlyKeepReferencedNodes": false } }
+ *     ]
+ *   }
+ *
+ * Timings and memory use for each file are written to the results file as JSON.  Returns non-zero if any job failed.
+ */
+UCLASS()
+class UStreetMapImportCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	/** UStreetMapImportCommandlet constructor */
+	UStreetMapImportCommandlet( const class FObjectInitializer& ObjectInitializer );
+
+	// UCommandlet overrides
+	virtual int32 Main( const FString& Params ) override;
+};
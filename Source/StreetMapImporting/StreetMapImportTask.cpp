@@ -0,0 +1,189 @@
+#include "StreetMapImportTask.h"
+#include "OSMSourceFile.h"
+#include "Async/Async.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Widgets/Notifications/SNotificationList.h"
+
+#define LOCTEXT_NAMESPACE "StreetMapImporting"
+
+TArray<TSharedRef<FStreetMapImportTask>> FStreetMapImportTask::RunningTasks;
+
+
+FStreetMapImportTask::FStreetMapImportTask( UStreetMap* InStreetMap, const FStreetMapImportSettings& InImportSettings, const FString& InFilename, TUniquePtr<FOSMSourceFile> InSourceFile, const bool bInIsPBF, const FOSMXmlSummary& InXmlSummary )
+	: StreetMap( InStreetMap ),
+	  ImportSettings( InImportSettings ),
+	  Filename( InFilename ),
+	  SourceFile( MoveTemp( InSourceFile ) ),
+	  bIsPBF( bInIsPBF ),
+	  XmlSummary( InXmlSummary ),
+	  Progress( 0.0f ),
+	  bCancelRequested( false ),
+	  bSucceeded( false )
+{
+}
+
+
+FStreetMapImportTask::~FStreetMapImportTask()
+{
+	if( TickerHandle.IsValid() )
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker( TickerHandle );
+	}
+}
+
+
+void FStreetMapImportTask::Start( UStreetMap* StreetMap, const FStreetMapImportSettings& ImportSettings, const FString& Filename, TUniquePtr<FOSMSourceFile> SourceFile, const bool bIsPBF, const FOSMXmlSummary& XmlSummary )
+{
+	check( IsInGameThread() );
+
+	TSharedRef<FStreetMapImportTask> Task = MakeShareable( new FStreetMapImportTask( StreetMap, ImportSettings, Filename, MoveTemp( SourceFile ), bIsPBF, XmlSummary ) );
+	RunningTasks.Add( Task );
+
+	FNotificationInfo Info( Task->GetProgressText() );
+	Info.bFireAndForget = false;
+	Info.bUseThrobber = true;
+	Info.FadeOutDuration = 1.0f;
+	Info.ExpireDuration = 3.0f;
+	Info.ButtonDetails.Add( FNotificationButtonInfo(
+		LOCTEXT( "ImportTask_Cancel", "Cancel" ),
+		LOCTEXT( "ImportTask_CancelTooltip", "Stop importing this file.  The street map keeps what it had before." ),
+		FSimpleDelegate::CreateSP( Task, &FStreetMapImportTask::Cancel ),
+		SNotificationItem::CS_Pending ) );
+	Task->Notification = FSlateNotificationManager::Get().AddNotification( Info );
+	if( TSharedPtr<SNotificationItem> NotificationItem = Task->Notification.Pin() )
+	{
+		NotificationItem->SetCompletionState( SNotificationItem::CS_Pending );
+	}
+
+	Task->TickerHandle = FTSTicker::GetCoreTicker().AddTicker( FTickerDelegate::CreateSP( Task, &FStreetMapImportTask::Tick ), 0.1f );
+
+	// RunningTasks keeps the task alive until Finish() runs, and that waits for the future, so the background thread
+	// can safely use a raw pointer
+	FStreetMapImportTask* TaskPtr = &Task.Get();
+	Task->Future = Async( EAsyncExecution::ThreadPool, [TaskPtr]() { TaskPtr->Run(); } );
+}
+
+
+void FStreetMapImportTask::CancelAll()
+{
+	check( IsInGameThread() );
+
+	for( const TSharedRef<FStreetMapImportTask>& Task : RunningTasks )
+	{
+		Task->bCancelRequested = true;
+	}
+	for( const TSharedRef<FStreetMapImportTask>& Task : RunningTasks )
+	{
+		Task->Future.Wait();
+		if( TSharedPtr<SNotificationItem> NotificationItem = Task->Notification.Pin() )
+		{
+			NotificationItem->ExpireAndFadeout();
+		}
+	}
+	RunningTasks.Reset();
+}
+
+
+void FStreetMapImportTask::Run()
+{
+	auto ReportProgress = [this]( const float NewProgress ) -> bool
+	{
+		Progress = NewProgress;
+		return !bCancelRequested;
+	};
+
+	bSucceeded = UStreetMapFactory::BuildStreetMap( ImportSettings, SourceFile->GetData(), bIsPBF, XmlSummary, ReportProgress, /* Out */ Result, /* Out */ ErrorMessage );
+
+	// We don't need the file anymore, so unmap it right away rather than waiting for the game thread
+	SourceFile.Reset();
+}
+
+
+bool FStreetMapImportTask::Tick( float DeltaTime )
+{
+	if( !Future.IsReady() )
+	{
+		if( TSharedPtr<SNotificationItem> NotificationItem = Notification.Pin() )
+		{
+			NotificationItem->SetText( GetProgressText() );
+		}
+		return true;
+	}
+
+	TickerHandle.Reset();
+	Finish();
+	return false;
+}
+
+
+void FStreetMapImportTask::Finish()
+{
+	check( IsInGameThread() );
+
+	// Keep ourselves alive until we're done, now that we're no longer running
+	TSharedRef<FStreetMapImportTask> Self = AsShared();
+	RunningTasks.Remove( Self );
+
+	const FText CleanFilename = FText::FromString( FPaths::GetCleanFilename( Filename ) );
+
+	FText ResultText;
+	SNotificationItem::ECompletionState ResultState = SNotificationItem::CS_Fail;
+	UStreetMap* StreetMapToFill = StreetMap.Get();
+	if( bCancelRequested )
+	{
+		ResultText = FText::Format( LOCTEXT( "ImportTask_Cancelled", "Cancelled importing {0}" ), CleanFilename );
+		ResultState = SNotificationItem::CS_None;
+	}
+	else if( !bSucceeded )
+	{
+		ResultText = FText::Format( LOCTEXT( "ImportTask_Failed", "Unable to import {0}: {1}" ), CleanFilename, ErrorMessage );
+		GWarn->Logf( ELogVerbosity::Error, TEXT( "Unable to import OpenStreetMap file '%s': %s" ), *Filename, *ErrorMessage.ToString() );
+	}
+	else if( StreetMapToFill == nullptr )
+	{
+		// The asset was deleted while we were importing it
+		ResultText = FText::Format( LOCTEXT( "ImportTask_Deleted", "Discarded {0}, because its street map was deleted" ), CleanFilename );
+	}
+	else
+	{
+		UStreetMapFactory::ApplyImportResult( StreetMapToFill, Filename, Result );
+		StreetMapToFill->MarkPackageDirty();
+
+		ResultText = FText::Format( LOCTEXT( "ImportTask_Succeeded", "Imported {0}" ), CleanFilename );
+		ResultState = SNotificationItem::CS_Success;
+	}
+
+	if( TSharedPtr<SNotificationItem> NotificationItem = Notification.Pin() )
+	{
+		NotificationItem->SetText( ResultText );
+		NotificationItem->SetCompletionState( ResultState );
+		NotificationItem->ExpireAndFadeout();
+	}
+}
+
+
+void FStreetMapImportTask::Cancel()
+{
+	bCancelRequested = true;
+
+	if( TSharedPtr<SNotificationItem> NotificationItem = Notification.Pin() )
+	{
+		NotificationItem->SetText( GetProgressText() );
+	}
+}
+
+
+FText FStreetMapImportTask::GetProgressText() const
+{
+	if( bCancelRequested )
+	{
+		return FText::Format( LOCTEXT( "ImportTask_Cancelling", "Cancelling import of {0}..." ), FText::FromString( FPaths::GetCleanFilename( Filename ) ) );
+	}
+
+	return FText::Format(
+		LOCTEXT( "ImportTask_Progress", "Importing {0}... {1}" ),
+		FText::FromString( FPaths::GetCleanFilename( Filename ) ),
+		FText::AsPercent( Progress.load() ) );
+}
+
+#undef LOCTEXT_NAMESPACE
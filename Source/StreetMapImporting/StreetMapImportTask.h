@@ -0,0 +1,97 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Containers/Ticker.h"
+#include "StreetMap.h"
+#include "StreetMapFactory.h"
+#include "OSMXmlReader.h"
+#include <atomic>
+
+class FOSMSourceFile;
+class SNotificationItem;
+
+/** Builds a street map on background tasks while the editor keeps running.  A notification shows how far along the
+    import is and lets the user cancel it.  When the import finishes, the new roads, nodes and buildings are moved into
+    the street map on the game thread; until then (and if the import fails or is cancelled) the street map is left alone. */
+class FStreetMapImportTask : public TSharedFromThis<FStreetMapImportTask>
+{
+
+public:
+
+	/**
+	 * Starts importing an OpenStreetMap file into a street map in the background
+	 *
+	 * @param	StreetMap		The street map to fill in
+	 * @param	ImportSettings	The settings to import with.  These are copied before we start.
+	 * @param	Filename		The file being imported, for display
+	 * @param	SourceFile		The opened file.  The task owns it until the import is done.
+	 * @param	bIsPBF			True if the file is in PBF format rather than XML
+	 * @param	XmlSummary		What we found when scanning the file, for XML files
+	 */
+	static void Start( UStreetMap* StreetMap, const FStreetMapImportSettings& ImportSettings, const FString& Filename, TUniquePtr<FOSMSourceFile> SourceFile, const bool bIsPBF, const FOSMXmlSummary& XmlSummary );
+
+	/** Cancels every import that's still running, and waits for them to stop.  Called when the module shuts down. */
+	static void CancelAll();
+
+	/** Destructor for FStreetMapImportTask */
+	~FStreetMapImportTask();
+
+
+private:
+
+	/** Private constructor.  Use Start() instead. */
+	FStreetMapImportTask( UStreetMap* InStreetMap, const FStreetMapImportSettings& InImportSettings, const FString& InFilename, TUniquePtr<FOSMSourceFile> InSourceFile, const bool bInIsPBF, const FOSMXmlSummary& InXmlSummary );
+
+	/** Builds the street map.  Runs on a background thread. */
+	void Run();
+
+	/** Updates the notification, and finishes up once the background work is done.  Returns false when we're done ticking. */
+	bool Tick( float DeltaTime );
+
+	/** Moves the result into the street map and reports how it went.  Runs on the game thread. */
+	void Finish();
+
+	/** Called when the user clicks the notification's cancel button */
+	void Cancel();
+
+	/** Returns the text to show in the notification while importing */
+	FText GetProgressText() const;
+
+
+private:
+
+	/** Imports that haven't finished yet.  Keeps each task alive until its background work is done. */
+	static TArray<TSharedRef<FStreetMapImportTask>> RunningTasks;
+
+	/** The street map we're importing into.  It's fine if it goes away while we're busy. */
+	TWeakObjectPtr<UStreetMap> StreetMap;
+
+	/** The settings to import with, copied so that the background thread never touches the street map */
+	FStreetMapImportSettings ImportSettings;
+
+	/** The file being imported */
+	FString Filename;
+	TUniquePtr<FOSMSourceFile> SourceFile;
+	bool bIsPBF;
+	FOSMXmlSummary XmlSummary;
+
+	/** How far along the import is, from 0 to 1.  Written by the background thread. */
+	std::atomic<float> Progress;
+
+	/** Set when the user asks us to stop.  Read by the background thread. */
+	std::atomic<bool> bCancelRequested;
+
+	/** Completes when the background work is done */
+	TFuture<void> Future;
+
+	/** What the background work produced.  Only touched by the game thread once Future is ready. */
+	FStreetMapImportResult Result;
+	FText ErrorMessage;
+	bool bSucceeded;
+
+	/** Progress notification, if notifications are available */
+	TWeakPtr<SNotificationItem> Notification;
+
+	/** Ticks us on the game thread while we're running */
+	FTSTicker::FDelegateHandle TickerHandle;
+};
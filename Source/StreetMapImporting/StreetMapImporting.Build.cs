@@ -11,7 +11,6 @@ namespace UnrealBuildTool.Rules
                     "CoreUObject",
                     "Engine",
                     "UnrealEd",
-                    "XmlParser",
                     "AssetTools",
                     "Projects",
                     "Slate",
@@ -23,9 +22,16 @@ namespace UnrealBuildTool.Rules
                     "RawMesh",
                     "AssetTools",
                     "AssetRegistry",
+                    "Json",
+                    "JsonUtilities",
+                    "DesktopPlatform",
+                    "ToolMenus",
                     "StreetMapRuntime"
                 }
             );
+
+            // Compressed OpenStreetMap XML files are decompressed with zlib
+            AddEngineThirdPartyPrivateStaticDependencies(Target, "zlib");
         }
     }
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Modules/ModuleManager.h"
 #include "StreetMapStyle.h"
 #include "StreetMapComponentDetails.h"
+#include "StreetMapImportTask.h"
 
 class FStreetMapImportingModule : public IModuleInterface
 {
@@ -40,6 +41,9 @@ void FStreetMapImportingModule::StartupModule()
 
 void FStreetMapImportingModule::ShutdownModule()
 {
+	// Stop any imports that are still running in the background
+	FStreetMapImportTask::CancelAll();
+
 	// Unregister all the asset types that we registered
 	if( FModuleManager::Get().IsModuleLoaded( "AssetTools" ) )
 	{
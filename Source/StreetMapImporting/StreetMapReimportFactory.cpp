@@ -1,17 +1,22 @@
 #include "StreetMapReimportFactory.h"
 #include "StreetMap.h"
-#include "EditorFramework/AssetImportData.h"
+#include "StreetMapAssetImportData.h"
+#include "OSMSourceFile.h"
+#include "OSMXmlReader.h"
 
 UStreetMapReimportFactory::UStreetMapReimportFactory(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
+	// The user already chose this file when it was first imported
+	bShowImportPreview = false;
 }
 
 
 bool UStreetMapReimportFactory::CanReimport( UObject* Obj, TArray<FString>& OutFilenames )
 {
+	// Tiles are reimported along with the street map they were split from
 	UStreetMap* StreetMap = Cast<UStreetMap>( Obj );
-	if( StreetMap != nullptr )
+	if( StreetMap != nullptr && !StreetMap->IsTile() )
 	{
 		OutFilenames.Add( StreetMap->AssetImportData->GetFirstFilename() );
 		return true;
@@ -24,7 +29,15 @@ void UStreetMapReimportFactory::SetReimportPaths( UObject* Obj, const TArray<FSt
 {
 	UStreetMap* StreetMap = CastChecked<UStreetMap>( Obj );
 	StreetMap->Modify();
-	StreetMap->AssetImportData->Update( NewReimportPaths[0] );
+
+	// Nothing we know about the old file says anything about the new one, so forget its size and hash.  Otherwise
+	// a new file that happened to be the same size would look up to date, because Update takes its timestamp.
+	FMD5Hash NoHash;
+	StreetMap->AssetImportData->Update( NewReimportPaths[0], &NoHash );
+	if( UStreetMapAssetImportData* ImportData = Cast<UStreetMapAssetImportData>( StreetMap->AssetImportData ) )
+	{
+		ImportData->SourceFileSize = -1;
+	}
 }
 
 
@@ -41,14 +54,37 @@ EReimportResult::Type UStreetMapReimportFactory::Reimport( UObject* Obj )
 		return EReimportResult::Failed;
 	}
 
-	if( UFactory::StaticImportObject( StreetMap->GetClass(), StreetMap->GetOuter(), *StreetMap->GetName(), RF_Public|RF_Standalone, *Filename, nullptr, this ) )
+	// Automated reimports often touch many maps whose sources haven't changed, and importing a big file again
+	// takes a while, so skip the ones that would come out the same
+	if( IsUpToDate( StreetMap, Filename ) )
+	{
+		GWarn->Logf( ELogVerbosity::Display, TEXT( "Skipped reimporting '%s', because neither the file nor the import settings have changed" ), *Filename );
+		return EReimportResult::Succeeded;
+	}
+
+	// Reimport with the same settings the map was originally imported with
+	ImportSettings = StreetMap->ImportSettings;
+
+	TUniquePtr<FOSMSourceFile> SourceFile;
+	bool bIsPBF = false;
+	FOSMXmlSummary XmlSummary;
+	if( !OpenSourceFile( Filename, SourceFile, bIsPBF, XmlSummary, GWarn ) )
+	{
+		return EReimportResult::Failed;
+	}
+
+	// Import straight into the existing street map, so that it keeps its current contents until the new ones are ready.
+	// The reimport manager wants to know how the reimport went as soon as we return, so we never import in the
+	// background here; the progress dialog still lets the user cancel.
+	bool bCancelled = false;
+	if( ImportStreetMap( StreetMap, Filename, MoveTemp( SourceFile ), bIsPBF, XmlSummary, /* bImportInBackground */ false, GWarn, bCancelled ) )
 	{
 		// Mark the package dirty after the successful import
 		StreetMap->MarkPackageDirty();
 		return EReimportResult::Succeeded;
 	}
 
-	return EReimportResult::Failed;
+	return bCancelled ? EReimportResult::Cancelled : EReimportResult::Failed;
 }
 
 
@@ -56,3 +92,34 @@ int32 UStreetMapReimportFactory::GetPriority() const
 {
 	return 0;
 }
+
+
+bool UStreetMapReimportFactory::IsUpToDate( const UStreetMap* StreetMap, const FString& Filename ) const
+{
+	// Street maps imported before we kept track of these don't have our import data
+	const UStreetMapAssetImportData* ImportData = Cast<UStreetMapAssetImportData>( StreetMap->AssetImportData );
+	if( ImportData == nullptr || ImportData->SourceFileSize < 0 || ImportData->GetSourceFileCount() != 1 )
+	{
+		return false;
+	}
+
+	if( ImportData->ImportSettingsHash != HashImportSettings( StreetMap->ImportSettings ) )
+	{
+		return false;
+	}
+
+	const FAssetImportInfo::FSourceFile& SourceFile = ImportData->GetSourceData().SourceFiles[ 0 ];
+	if( IFileManager::Get().FileSize( *Filename ) != ImportData->SourceFileSize )
+	{
+		return false;
+	}
+
+	// Same size and timestamp is good enough for us.  Otherwise the file may just have been copied or touched, so
+	// we check its contents.
+	if( IFileManager::Get().GetTimeStamp( *Filename ) == SourceFile.Timestamp )
+	{
+		return true;
+	}
+
+	return SourceFile.FileHash.IsValid() && FMD5Hash::HashFile( *Filename ) == SourceFile.FileHash;
+}
@@ -24,5 +24,9 @@ protected:
 	virtual EReimportResult::Type Reimport( UObject* Obj ) override;
 	virtual int32 GetPriority() const override;
 
+	/** Returns true if the street map was built from this exact file, with the settings it has now, so reimporting
+	    it wouldn't change anything.  Checks the file's size and timestamp first, and only hashes it if they disagree. */
+	bool IsUpToDate( const UStreetMap* StreetMap, const FString& Filename ) const;
+
 };
 
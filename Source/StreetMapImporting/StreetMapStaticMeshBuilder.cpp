@@ -0,0 +1,105 @@
+#include "StreetMapStaticMeshBuilder.h"
+#include "StreetMapComponent.h"
+#include "RawMesh.h"
+#include "Engine/StaticMesh.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+
+
+UStaticMesh* FStreetMapStaticMeshBuilder::CreateStaticMesh( UStreetMapComponent* StreetMapComponent, const FString& PackageName, const FName MeshName )
+{
+	check( StreetMapComponent != nullptr );
+
+	// Raw mesh data we are filling in
+	FRawMesh RawMesh;
+
+	// Materials to apply to new mesh
+	const TArray<UMaterialInterface*> MeshMaterials = StreetMapComponent->GetMaterials();
+
+	const TArray<FStreetMapVertex> RawMeshVertices = StreetMapComponent->GetRawMeshVertices();
+	const TArray<uint32> RawMeshIndices = StreetMapComponent->GetRawMeshIndices();
+
+	// Copy verts
+	RawMesh.VertexPositions.Reserve( RawMeshVertices.Num() );
+	for( const FStreetMapVertex& StreetMapVertex : RawMeshVertices )
+	{
+		RawMesh.VertexPositions.Add( StreetMapVertex.Position );
+	}
+
+	// Copy 'wedge' info
+	const int32 NumIndices = RawMeshIndices.Num();
+	for( int32 IndexIdx = 0; IndexIdx < NumIndices; ++IndexIdx )
+	{
+		const int32 VertexIndex = RawMeshIndices[ IndexIdx ];
+
+		RawMesh.WedgeIndices.Add( VertexIndex );
+
+		const FStreetMapVertex& StreetMapVertex = RawMeshVertices[ VertexIndex ];
+
+		const FVector3f TangentX = StreetMapVertex.TangentX;
+		const FVector3f TangentZ = StreetMapVertex.TangentZ;
+		const FVector3f TangentY = ( TangentX ^ TangentZ ).GetSafeNormal();
+
+		RawMesh.WedgeTangentX.Add( TangentX );
+		RawMesh.WedgeTangentY.Add( TangentY );
+		RawMesh.WedgeTangentZ.Add( TangentZ );
+
+		RawMesh.WedgeTexCoords[ 0 ].Add( StreetMapVertex.TextureCoordinate );
+		RawMesh.WedgeColors.Add( StreetMapVertex.Color );
+	}
+
+	// Copy face info
+	const int32 NumTris = NumIndices / 3;
+	for( int32 TriIdx = 0; TriIdx < NumTris; ++TriIdx )
+	{
+		RawMesh.FaceMaterialIndices.Add( 0 );
+		RawMesh.FaceSmoothingMasks.Add( 0 ); // Assume this is ignored as bRecomputeNormals is false
+	}
+
+	// Make sure we got some valid data
+	if( RawMesh.VertexPositions.Num() <= 3 || RawMesh.WedgeIndices.Num() <= 3 )
+	{
+		return nullptr;
+	}
+
+	// Then find/create it.
+	UPackage* Package = CreatePackage( *PackageName );
+	check( Package );
+
+	// Create StaticMesh object
+	UStaticMesh* StaticMesh = NewObject<UStaticMesh>( Package, MeshName, RF_Public | RF_Standalone );
+	StaticMesh->InitResources();
+
+	StaticMesh->SetLightingGuid( FGuid::NewGuid() );
+
+	// Add source to new StaticMesh
+	FStaticMeshSourceModel* SrcModel = &StaticMesh->AddSourceModel();
+	SrcModel->BuildSettings.bRecomputeNormals = false;
+	SrcModel->BuildSettings.bRecomputeTangents = false;
+	SrcModel->BuildSettings.bRemoveDegenerates = false;
+	SrcModel->BuildSettings.bUseHighPrecisionTangentBasis = false;
+	SrcModel->BuildSettings.bUseFullPrecisionUVs = false;
+	SrcModel->BuildSettings.bGenerateLightmapUVs = true;
+	SrcModel->BuildSettings.SrcLightmapIndex = 0;
+	SrcModel->BuildSettings.DstLightmapIndex = 1;
+	SrcModel->RawMeshBulkData->SaveRawMesh( RawMesh );
+
+	// Copy materials to new mesh
+	for( UMaterialInterface* Material : MeshMaterials )
+	{
+		StaticMesh->GetStaticMaterials().Add( FStaticMaterial( Material ) );
+	}
+
+	// Set the Imported version before calling the build
+	StaticMesh->ImportVersion = EImportStaticMeshVersion::LastVersion;
+
+	// Build mesh from source
+	StaticMesh->Build( /* bSilent = */ false );
+	StaticMesh->PostEditChange();
+
+	StaticMesh->MarkPackageDirty();
+
+	// Notify asset registry of new asset
+	FAssetRegistryModule::AssetCreated( StaticMesh );
+
+	return StaticMesh;
+}
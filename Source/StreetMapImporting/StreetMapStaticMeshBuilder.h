@@ -0,0 +1,23 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class UStaticMesh;
+class UStreetMapComponent;
+
+/** Bakes the mesh that a street map component built into a static mesh asset */
+class FStreetMapStaticMeshBuilder
+{
+
+public:
+
+	/**
+	 * Creates a static mesh asset from the component's cached mesh, using the component's materials
+	 *
+	 * @param	StreetMapComponent	The component whose mesh we're baking.  Its mesh must already be built.
+	 * @param	PackageName			Long name of the package to create the static mesh in
+	 * @param	MeshName			Name of the new static mesh asset
+	 *
+	 * @return	The new static mesh, or nullptr if the component doesn't have enough of a mesh to bake
+	 */
+	static UStaticMesh* CreateStaticMesh( UStreetMapComponent* StreetMapComponent, const FString& PackageName, const FName MeshName );
+};
@@ -0,0 +1,172 @@
+#include "StreetMapTiler.h"
+#include "StreetMapFactory.h"
+#include "StreetMapWayConverter.h"
+
+
+void FStreetMapTiler::SplitIntoTiles( FStreetMapImportResult& Result, const double TileSize )
+{
+	check( TileSize > 0.0 );
+
+	auto GetTileCoordinates = [TileSize]( const FVector2D Point )
+	{
+		return FIntPoint( FMath::FloorToInt( Point.X / TileSize ), FMath::FloorToInt( Point.Y / TileSize ) );
+	};
+
+	// Nodes are found by a key that is the same in every tile: the node's index in the whole map, or for road points
+	// that only became nodes because a tile edge cut the road there, a negative number unique to that road point
+	TMap<FIntPoint, int32> TileIndices;
+	TArray<TMap<int64, int32>> TileNodeIndices;
+	TMap<int64, TArray<TPair<int32, int32>, TInlineAllocator<1>>> NodeKeyToTileNodes;
+
+	auto FindOrAddTile = [&]( const FIntPoint Coordinates ) -> int32
+	{
+		if( const int32* FoundTileIndex = TileIndices.Find( Coordinates ) )
+		{
+			return *FoundTileIndex;
+		}
+
+		const int32 TileIndex = Result.Tiles.Num();
+		FStreetMapImportTile& Tile = Result.Tiles.AddDefaulted_GetRef();
+		Tile.Coordinates = Coordinates;
+		Tile.Origin = FVector2D( ( Coordinates.X + 0.5 ) * TileSize, ( Coordinates.Y + 0.5 ) * TileSize );
+		TileNodeIndices.AddDefaulted();
+		TileIndices.Add( Coordinates, TileIndex );
+		return TileIndex;
+	};
+
+	auto AddRoadPiece = [&]( const FStreetMapImportRoad& Road, const int32 FirstPointIndex, const int32 LastPointIndex, const int32 TileIndex, const int64 RoadPointKeyBase )
+	{
+		FStreetMapImportTile& Tile = Result.Tiles[ TileIndex ];
+		const int32 TileRoadIndex = Tile.Roads.Num();
+		FStreetMapImportRoad& TileRoad = Tile.Roads.AddDefaulted_GetRef();
+		TileRoad.RoadName = Road.RoadName;
+		TileRoad.RoadType = Road.RoadType;
+		TileRoad.bIsOneWay = Road.bIsOneWay;
+
+		const int32 PointCount = LastPointIndex - FirstPointIndex + 1;
+		TileRoad.RoadPoints.SetNumUninitialized( PointCount );
+		TileRoad.NodeIndices.Init( INDEX_NONE, PointCount );
+		for( int32 PointIndex = 0; PointIndex < PointCount; ++PointIndex )
+		{
+			const int32 RoadPointIndex = FirstPointIndex + PointIndex;
+			TileRoad.RoadPoints[ PointIndex ] = Road.RoadPoints[ RoadPointIndex ] - Tile.Origin;
+
+			// Points that were nodes stay nodes, and so do the ends of every piece, so that roads still begin and end at a node
+			int64 NodeKey = Road.NodeIndices[ RoadPointIndex ];
+			if( NodeKey == INDEX_NONE )
+			{
+				if( PointIndex != 0 && PointIndex != PointCount - 1 )
+				{
+					continue;
+				}
+				NodeKey = -( RoadPointKeyBase + RoadPointIndex + 1 );
+			}
+
+			int32 TileNodeIndex = INDEX_NONE;
+			if( const int32* FoundTileNodeIndex = TileNodeIndices[ TileIndex ].Find( NodeKey ) )
+			{
+				TileNodeIndex = *FoundTileNodeIndex;
+			}
+			else
+			{
+				TileNodeIndex = Tile.Nodes.AddDefaulted();
+				TileNodeIndices[ TileIndex ].Add( NodeKey, TileNodeIndex );
+				NodeKeyToTileNodes.FindOrAdd( NodeKey ).Emplace( TileIndex, TileNodeIndex );
+			}
+
+			FStreetMapRoadRef& RoadRef = Tile.Nodes[ TileNodeIndex ].RoadRefs.AddDefaulted_GetRef();
+			RoadRef.RoadIndex = TileRoadIndex;
+			RoadRef.RoadPointIndex = PointIndex;
+			TileRoad.NodeIndices[ PointIndex ] = TileNodeIndex;
+		}
+
+		FStreetMapWayConverter::ComputeBounds( TileRoad.RoadPoints, TileRoad.BoundsMin, TileRoad.BoundsMax );
+	};
+
+	// Cut each road into one piece for every run of points in the same tile
+	int64 RoadPointKeyBase = 0;
+	for( const FStreetMapImportRoad& Road : Result.Roads )
+	{
+		const int32 LastPointIndex = Road.RoadPoints.Num() - 1;
+		int32 PieceFirstPointIndex = 0;
+		FIntPoint PieceTileCoordinates = GetTileCoordinates( Road.RoadPoints[ 0 ] );
+		for( int32 PointIndex = 1; PointIndex <= LastPointIndex; ++PointIndex )
+		{
+			const FIntPoint PointTileCoordinates = GetTileCoordinates( Road.RoadPoints[ PointIndex ] );
+			if( PointTileCoordinates != PieceTileCoordinates )
+			{
+				AddRoadPiece( Road, PieceFirstPointIndex, PointIndex, FindOrAddTile( PieceTileCoordinates ), RoadPointKeyBase );
+				PieceFirstPointIndex = PointIndex;
+				PieceTileCoordinates = PointTileCoordinates;
+			}
+		}
+
+		// If only the last point is in a new tile, the previous piece already reaches it
+		if( PieceFirstPointIndex < LastPointIndex )
+		{
+			AddRoadPiece( Road, PieceFirstPointIndex, LastPointIndex, FindOrAddTile( PieceTileCoordinates ), RoadPointKeyBase );
+		}
+
+		RoadPointKeyBase += Road.RoadPoints.Num();
+	}
+
+	for( FStreetMapBuilding& Building : Result.Buildings )
+	{
+		const int32 TileIndex = FindOrAddTile( GetTileCoordinates( ( Building.BoundsMin + Building.BoundsMax ) * 0.5 ) );
+		FStreetMapImportTile& Tile = Result.Tiles[ TileIndex ];
+		for( FVector2D& Point : Building.BuildingPoints )
+		{
+			Point -= Tile.Origin;
+		}
+		Building.BoundsMin -= Tile.Origin;
+		Building.BoundsMax -= Tile.Origin;
+		Tile.Buildings.Add( MoveTemp( Building ) );
+	}
+
+	// Link up every node that ended up in more than one tile
+	for( const auto& NodeKeyAndTileNodes : NodeKeyToTileNodes )
+	{
+		for( const TPair<int32, int32>& TileNode : NodeKeyAndTileNodes.Value )
+		{
+			for( const TPair<int32, int32>& NeighborTileNode : NodeKeyAndTileNodes.Value )
+			{
+				if( NeighborTileNode.Key != TileNode.Key )
+				{
+					FStreetMapTileLink& Link = Result.Tiles[ TileNode.Key ].Links.AddDefaulted_GetRef();
+					Link.NodeIndex = TileNode.Value;
+					Link.NeighborTileCoordinates = Result.Tiles[ NeighborTileNode.Key ].Coordinates;
+					Link.NeighborNodeIndex = NeighborTileNode.Value;
+				}
+			}
+		}
+	}
+
+	for( FStreetMapImportTile& Tile : Result.Tiles )
+	{
+		Tile.BoundsMin = FVector2D( TNumericLimits<float>::Max(), TNumericLimits<float>::Max() );
+		Tile.BoundsMax = FVector2D( TNumericLimits<float>::Lowest(), TNumericLimits<float>::Lowest() );
+		auto AddToBounds = [&Tile]( const FVector2D BoundsMin, const FVector2D BoundsMax )
+		{
+			Tile.BoundsMin = FVector2D::Min( Tile.BoundsMin, BoundsMin );
+			Tile.BoundsMax = FVector2D::Max( Tile.BoundsMax, BoundsMax );
+		};
+		for( const FStreetMapImportRoad& Road : Tile.Roads )
+		{
+			AddToBounds( Road.BoundsMin, Road.BoundsMax );
+		}
+		for( const FStreetMapBuilding& Building : Tile.Buildings )
+		{
+			AddToBounds( Building.BoundsMin, Building.BoundsMax );
+		}
+	}
+
+	// List the tiles row by row, so that they don't depend on which order the roads and buildings were in
+	Result.Tiles.Sort( []( const FStreetMapImportTile& A, const FStreetMapImportTile& B )
+	{
+		return A.Coordinates.Y != B.Coordinates.Y ? A.Coordinates.Y < B.Coordinates.Y : A.Coordinates.X < B.Coordinates.X;
+	} );
+
+	Result.Roads.Empty();
+	Result.Nodes.Empty();
+	Result.Buildings.Empty();
+}
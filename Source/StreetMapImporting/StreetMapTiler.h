@@ -0,0 +1,25 @@
+#pragma once
+#include "CoreMinimal.h"
+
+struct FStreetMapImportResult;
+
+/** Splits a street map into a grid of square tiles, so that a big map can be loaded a piece at a time */
+class FStreetMapTiler
+{
+
+public:
+
+	/**
+	 * Moves the roads, nodes and buildings of an import into tiles.  The grid starts at the middle of the map, and each
+	 * tile's points are made relative to the middle of the tile.
+	 *
+	 * Roads are cut where they cross from one tile into the next.  The piece in the first tile carries on to the first
+	 * point in the next tile, so that the segment crossing the edge isn't lost, and the two pieces meet at a node that
+	 * both tiles have.  Those shared nodes are linked up in each tile's Links.  Buildings go in the tile that the middle
+	 * of their bounds is in.
+	 *
+	 * @param	Result		The import to split.  Its roads, nodes and buildings end up in its tiles.
+	 * @param	TileSize	Width of each tile, in map units
+	 */
+	static void SplitIntoTiles( FStreetMapImportResult& Result, const double TileSize );
+};
@@ -0,0 +1,129 @@
+#include "StreetMapWayConverter.h"
+#include "StreetMapFactory.h"
+
+const double FStreetMapWayConverter::OSMToCentimetersScaleFactor = 100.0;
+
+
+void FStreetMapWayConverter::FillRoad( const FOSMTagClassifier& TagClassifier, const FOSMFile::FOSMWayInfo& Way, FString&& Name, TArray<FVector2D>&& Points, FStreetMapImportRoad& OutRoad )
+{
+	OutRoad.RoadPoints = MoveTemp( Points );
+
+	// Set defaults for each node index on this road.  INDEX_NONE means the node is not valid, which may be the case
+	// for nodes that we filter out entirely.  This will be filled in by valid indices to nodes later on.
+	OutRoad.NodeIndices.Init( INDEX_NONE, OutRoad.RoadPoints.Num() );
+
+	OutRoad.RoadName = MoveTemp( Name );
+	OutRoad.RoadType = TagClassifier.GetRule( Way.TagRuleIndex ).RoadType;
+	ComputeBounds( OutRoad.RoadPoints, OutRoad.BoundsMin, OutRoad.BoundsMax );
+
+	OutRoad.bIsOneWay = Way.bIsOneWay;
+}
+
+
+void FStreetMapWayConverter::FillBuilding( const FOSMFile::FOSMWayInfo& Way, FString&& Name, TArray<FVector2D>&& Points, FStreetMapBuilding& OutBuilding )
+{
+	OutBuilding.BuildingPoints = MoveTemp( Points );
+
+	// Make sure the building ended up with a closed polygon, then remove the final (redundant) point
+	const bool bIsClosed = OutBuilding.BuildingPoints[ 0 ].Equals( OutBuilding.BuildingPoints.Last(), KINDA_SMALL_NUMBER );
+	if( bIsClosed )
+	{
+		// Remove the final redundant point
+		OutBuilding.BuildingPoints.Pop();
+	}
+	else
+	{
+		// Wasn't expecting to have an unclosed shape.  Our tolerances might be off, or the data was malformed.
+		// Either way, it shouldn't be a problem as we'll close the shape ourselves below.
+		// @todo: Log this for the user as an import warning
+	}
+
+	OutBuilding.BuildingName = MoveTemp( Name );
+
+	OutBuilding.Height = Way.Height * OSMToCentimetersScaleFactor;
+	OutBuilding.BuildingLevels = Way.BuildingLevels;
+
+	ComputeBounds( OutBuilding.BuildingPoints, OutBuilding.BoundsMin, OutBuilding.BoundsMax );
+}
+
+
+void FStreetMapWayConverter::PackRoadsAndNodes( TArray<FStreetMapImportRoad>& Roads, TArray<FStreetMapImportNode>& Nodes, FStreetMapPackedRoadsAndNodes& OutPacked )
+{
+	int32 TotalPointCount = 0;
+	for( const FStreetMapImportRoad& Road : Roads )
+	{
+		TotalPointCount += Road.RoadPoints.Num();
+	}
+
+	TArray<FStreetMapRoad>& PackedRoads = OutPacked.Roads;
+	TArray<FVector2D>& RoadPoints = OutPacked.RoadPoints;
+	TArray<int32>& RoadNodeIndices = OutPacked.RoadNodeIndices;
+	PackedRoads.Reset();
+	RoadPoints.Reset();
+	RoadNodeIndices.Reset();
+	PackedRoads.SetNum( Roads.Num() );
+	RoadPoints.Reserve( TotalPointCount );
+	RoadNodeIndices.Reserve( TotalPointCount );
+	for( int32 RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex )
+	{
+		PackRoad( Roads[ RoadIndex ], PackedRoads[ RoadIndex ], RoadPoints, RoadNodeIndices );
+	}
+	Roads.Empty();
+
+	int32 TotalRoadRefCount = 0;
+	for( const FStreetMapImportNode& Node : Nodes )
+	{
+		TotalRoadRefCount += Node.RoadRefs.Num();
+	}
+
+	TArray<FStreetMapNode>& PackedNodes = OutPacked.Nodes;
+	TArray<FStreetMapRoadRef>& NodeRoadRefs = OutPacked.NodeRoadRefs;
+	PackedNodes.Reset();
+	NodeRoadRefs.Reset();
+	PackedNodes.SetNum( Nodes.Num() );
+	NodeRoadRefs.Reserve( TotalRoadRefCount );
+	for( int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex )
+	{
+		PackedNodes[ NodeIndex ].FirstRoadRefIndex = NodeRoadRefs.Num();
+		PackedNodes[ NodeIndex ].RoadRefCount = Nodes[ NodeIndex ].RoadRefs.Num();
+		NodeRoadRefs.Append( Nodes[ NodeIndex ].RoadRefs );
+	}
+	Nodes.Empty();
+}
+
+
+void FStreetMapWayConverter::SetRoadsAndNodes( FStreetMapPackedRoadsAndNodes& Packed, UStreetMap& OutStreetMap )
+{
+	verify( OutStreetMap.SetRoadsAndNodes( MoveTemp( Packed.Roads ), MoveTemp( Packed.Nodes ), MoveTemp( Packed.RoadPoints ), MoveTemp( Packed.RoadNodeIndices ), MoveTemp( Packed.NodeRoadRefs ) ) );
+}
+
+
+void FStreetMapWayConverter::PackRoad( FStreetMapImportRoad& Road, FStreetMapRoad& OutPackedRoad, TArray<FVector2D>& RoadPoints, TArray<int32>& RoadNodeIndices )
+{
+	check( Road.NodeIndices.Num() == Road.RoadPoints.Num() );
+
+	OutPackedRoad.RoadName = MoveTemp( Road.RoadName );
+	OutPackedRoad.RoadType = Road.RoadType;
+	OutPackedRoad.FirstPointIndex = RoadPoints.Num();
+	OutPackedRoad.PointCount = Road.RoadPoints.Num();
+	OutPackedRoad.BoundsMin = Road.BoundsMin;
+	OutPackedRoad.BoundsMax = Road.BoundsMax;
+	OutPackedRoad.bIsOneWay = Road.bIsOneWay;
+
+	RoadPoints.Append( Road.RoadPoints );
+	RoadNodeIndices.Append( Road.NodeIndices );
+}
+
+
+void FStreetMapWayConverter::ComputeBounds( const TArrayView<const FVector2D> Points, FVector2D& OutBoundsMin, FVector2D& OutBoundsMax )
+{
+	OutBoundsMin = FVector2D( TNumericLimits<float>::Max(), TNumericLimits<float>::Max() );
+	OutBoundsMax = FVector2D( TNumericLimits<float>::Lowest(), TNumericLimits<float>::Lowest() );
+	for( const FVector2D& Point : Points )
+	{
+		OutBoundsMin.X = FMath::Min( OutBoundsMin.X, Point.X );
+		OutBoundsMin.Y = FMath::Min( OutBoundsMin.Y, Point.Y );
+		OutBoundsMax.X = FMath::Max( OutBoundsMax.X, Point.X );
+		OutBoundsMax.Y = FMath::Max( OutBoundsMax.Y, Point.Y );
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "OSMFile.h"
+#include "StreetMap.h"
+
+struct FStreetMapImportRoad;
+struct FStreetMapImportNode;
+struct FStreetMapPackedRoadsAndNodes;
+
+/** Turns OpenStreetMap ways into the roads and buildings of a street map.  Only the road or building being filled in
+    is touched, so roads and buildings can be filled in on any thread. */
+class FStreetMapWayConverter
+{
+
+public:
+
+	/** OSM data is stored in meters.  This is the scale factor to convert those units into UE's native units (cm.)
+	    Keep in mind that if this is changed, UStreetMapComponent sizes for roads may need to be updated too!
+	    @todo: We should make this scale factor customizable as an import option */
+	static const double OSMToCentimetersScaleFactor;
+
+	/**
+	 * Fills in a road from a way
+	 *
+	 * @param	TagClassifier	Tag rules the way was classified with
+	 * @param	Way				The way
+	 * @param	Name			Name of the road
+	 * @param	Points			The way's points, already projected into map space
+	 * @param	OutRoad			The road to fill in.  All of its nodes are left unset (INDEX_NONE.)
+	 */
+	static void FillRoad( const FOSMTagClassifier& TagClassifier, const FOSMFile::FOSMWayInfo& Way, FString&& Name, TArray<FVector2D>&& Points, FStreetMapImportRoad& OutRoad );
+
+	/**
+	 * Fills in a building from a way
+	 *
+	 * @param	Way				The way
+	 * @param	Name			Name of the building
+	 * @param	Points			The way's points, already projected into map space.  If the outline is closed, the
+	 *							final (redundant) point is removed.
+	 * @param	OutBuilding		The building to fill in
+	 */
+	static void FillBuilding( const FOSMFile::FOSMWayInfo& Way, FString&& Name, TArray<FVector2D>&& Points, FStreetMapBuilding& OutBuilding );
+
+	/** Packs imported roads and nodes, putting their points, node indices and road refs into the buffers that a street
+	    map's roads and nodes share.  Doesn't touch any street map, so it can be done on any thread.  The imported
+	    roads and nodes are emptied. */
+	static void PackRoadsAndNodes( TArray<FStreetMapImportRoad>& Roads, TArray<FStreetMapImportNode>& Nodes, FStreetMapPackedRoadsAndNodes& OutPacked );
+
+	/** Replaces the roads and nodes of a street map with packed ones, which are moved into it */
+	static void SetRoadsAndNodes( FStreetMapPackedRoadsAndNodes& Packed, UStreetMap& OutStreetMap );
+
+	/** Packs one imported road, adding its points and node indices to the end of the buffers.  The road's name is moved
+	    into the packed road. */
+	static void PackRoad( FStreetMapImportRoad& Road, FStreetMapRoad& OutPackedRoad, TArray<FVector2D>& RoadPoints, TArray<int32>& RoadNodeIndices );
+
+	/** Computes the bounding box of some points */
+	static void ComputeBounds( const TArrayView<const FVector2D> Points, FVector2D& OutBoundsMin, FVector2D& OutBoundsMax );
+};
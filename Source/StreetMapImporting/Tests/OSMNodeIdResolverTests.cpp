@@ -0,0 +1,248 @@
+#include "OSMNodeIdResolver.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace OSMNodeIdResolverTests
+{
+	// Number of nodes in the benchmark, about what a large country extract has
+	static const int32 BenchmarkNodeCount = 20 * 1000 * 1000;
+
+	// Number of node references the benchmark resolves.  Ways reference each node about twice on average.
+	static const int32 BenchmarkReferenceCount = 40 * 1000 * 1000;
+
+	/** Makes ascending node IDs with small gaps between them, the way OSM extracts list them */
+	static void MakeAscendingIDs( FRandomStream& Random, const int32 Count, TArray<int64>& OutIDs )
+	{
+		OutIDs.SetNumUninitialized( Count );
+		int64 NodeID = 1000000000;
+		for( int32 Index = 0; Index < Count; ++Index )
+		{
+			NodeID += 1 + Random.RandRange( 0, 3 );
+			OutIDs[ Index ] = NodeID;
+		}
+	}
+
+	/** Builds the map the resolver replaced, where later duplicates overwrite earlier ones */
+	static void MakeReferenceMap( const TArray<int64>& NodeIDs, TMap<int64, int32>& OutMap )
+	{
+		OutMap.Reset();
+		OutMap.Reserve( NodeIDs.Num() );
+		for( int32 Index = 0; Index < NodeIDs.Num(); ++Index )
+		{
+			OutMap.Add( NodeIDs[ Index ], Index );
+		}
+	}
+
+	/** Checks that the resolver agrees with a map for every ID in a list, both one at a time and all at once */
+	static bool CheckAgainstMap( FAutomationTestBase& Test, const FString& What, const FOSMNodeIdResolver& Resolver, const TMap<int64, int32>& Map, const TArray<int64>& LookupIDs )
+	{
+		TArray<int32> FoundIndices;
+		FoundIndices.SetNumUninitialized( LookupIDs.Num() );
+		Resolver.FindAll( LookupIDs, FoundIndices );
+
+		for( int32 LookupIndex = 0; LookupIndex < LookupIDs.Num(); ++LookupIndex )
+		{
+			const int32* ExpectedIndex = Map.Find( LookupIDs[ LookupIndex ] );
+			const int32 Expected = ExpectedIndex != nullptr ? *ExpectedIndex : INDEX_NONE;
+			const int32 Found = Resolver.Find( LookupIDs[ LookupIndex ] );
+			if( Found != Expected || FoundIndices[ LookupIndex ] != Expected )
+			{
+				Test.AddError( FString::Printf( TEXT( "%s: ID %lld resolved to %d (%d from FindAll), expected %d" ), *What, LookupIDs[ LookupIndex ], Found, FoundIndices[ LookupIndex ], Expected ) );
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST( FOSMNodeIdResolverTest, "StreetMap.Importing.NodeIdResolver", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter )
+
+bool FOSMNodeIdResolverTest::RunTest( const FString& Parameters )
+{
+	using namespace OSMNodeIdResolverTests;
+
+	FOSMNodeIdResolver Resolver;
+
+	// Nothing to find in an empty resolver
+	Resolver.Build( TArrayView<const int64>() );
+	TestEqual( TEXT( "Empty resolver" ), Resolver.Find( 1 ), INDEX_NONE );
+
+	// Sorted IDs are searched in place.  IDs below, above and between the ones that are there aren't found.
+	{
+		const TArray<int64> NodeIDs = { -7, -3, 2, 5, 6, 40, 41, 1000 };
+		Resolver.Build( NodeIDs );
+		TestTrue( TEXT( "Sorted IDs are searched in place" ), Resolver.WasSorted() );
+		for( int32 Index = 0; Index < NodeIDs.Num(); ++Index )
+		{
+			TestEqual( FString::Printf( TEXT( "Sorted ID %lld" ), NodeIDs[ Index ] ), Resolver.Find( NodeIDs[ Index ] ), Index );
+		}
+		for( const int64 MissingID : { MIN_int64, int64( -8 ), int64( -5 ), int64( 0 ), int64( 3 ), int64( 39 ), int64( 999 ), int64( 1001 ), MAX_int64 } )
+		{
+			TestEqual( FString::Printf( TEXT( "Missing ID %lld" ), MissingID ), Resolver.Find( MissingID ), INDEX_NONE );
+		}
+	}
+
+	// Duplicates make the resolver sort a copy, and the last of each duplicate wins, like it did with a map
+	{
+		const TArray<int64> NodeIDs = { 5, 9, 5, 1, 9, 9, 3 };
+		Resolver.Build( NodeIDs );
+		TestFalse( TEXT( "Duplicate IDs are sorted" ), Resolver.WasSorted() );
+		TestEqual( TEXT( "Last duplicate of 5" ), Resolver.Find( 5 ), 2 );
+		TestEqual( TEXT( "Last duplicate of 9" ), Resolver.Find( 9 ), 5 );
+		TestEqual( TEXT( "Unduplicated 1" ), Resolver.Find( 1 ), 3 );
+		TestEqual( TEXT( "Unduplicated 3" ), Resolver.Find( 3 ), 6 );
+		TestEqual( TEXT( "Missing ID between duplicates" ), Resolver.Find( 7 ), INDEX_NONE );
+		TestEqual( TEXT( "Missing ID past duplicates" ), Resolver.Find( 10 ), INDEX_NONE );
+	}
+
+	// A single ID listed many times, where interpolation has no range to work with
+	{
+		const TArray<int64> NodeIDs = { 4, 4, 4, 4 };
+		Resolver.Build( NodeIDs );
+		TestEqual( TEXT( "Run of one ID" ), Resolver.Find( 4 ), 3 );
+		TestEqual( TEXT( "Missing ID next to a run" ), Resolver.Find( 5 ), INDEX_NONE );
+	}
+
+	// Compare against a map on bigger inputs, sorted and shuffled, clustered and spread out, with duplicates and
+	// with lookups of IDs that aren't there
+	FRandomStream Random( 0x05A3 );
+	for( int32 Round = 0; Round < 4; ++Round )
+	{
+		TArray<int64> NodeIDs;
+		MakeAscendingIDs( Random, 100 * 1000, NodeIDs );
+		if( Round >= 1 )
+		{
+			// Clusters of IDs far apart, which throws interpolation off
+			for( int32 Index = NodeIDs.Num() / 2; Index < NodeIDs.Num(); ++Index )
+			{
+				NodeIDs[ Index ] += int64( 1 ) << 40;
+			}
+		}
+		if( Round >= 2 )
+		{
+			for( int32 Index = NodeIDs.Num() - 1; Index > 0; --Index )
+			{
+				NodeIDs.Swap( Index, Random.RandRange( 0, Index ) );
+			}
+		}
+		if( Round >= 3 )
+		{
+			for( int32 Duplicate = 0; Duplicate < 1000; ++Duplicate )
+			{
+				NodeIDs[ Random.RandRange( 0, NodeIDs.Num() - 1 ) ] = NodeIDs[ Random.RandRange( 0, NodeIDs.Num() - 1 ) ];
+			}
+		}
+
+		TArray<int64> LookupIDs;
+		for( int32 Lookup = 0; Lookup < 50 * 1000; ++Lookup )
+		{
+			const int64 NodeID = NodeIDs[ Random.RandRange( 0, NodeIDs.Num() - 1 ) ];
+			LookupIDs.Add( NodeID );
+			LookupIDs.Add( NodeID + 1 );
+			LookupIDs.Add( -NodeID );
+		}
+
+		TMap<int64, int32> Map;
+		MakeReferenceMap( NodeIDs, Map );
+		Resolver.Build( NodeIDs );
+		if( !CheckAgainstMap( *this, FString::Printf( TEXT( "Round %d" ), Round ), Resolver, Map, LookupIDs ) )
+		{
+			break;
+		}
+	}
+
+	// Sort must be stable, so equal IDs keep their indices in ascending order
+	{
+		const TArray<int64> NodeIDs = { 3, 1, 3, 2, 1 };
+		TArray<int64> SortedIDs;
+		TArray<int32> SortedIndices;
+		FOSMNodeIdResolver::Sort( NodeIDs, SortedIDs, SortedIndices );
+		TestTrue( TEXT( "Sorted IDs" ), SortedIDs == TArray<int64>( { 1, 1, 2, 3, 3 } ) );
+		TestTrue( TEXT( "Sorted indices" ), SortedIndices == TArray<int32>( { 1, 4, 3, 0, 2 } ) );
+	}
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST( FOSMNodeIdResolverBenchmark, "StreetMap.Importing.NodeIdResolver.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter )
+
+bool FOSMNodeIdResolverBenchmark::RunTest( const FString& Parameters )
+{
+	using namespace OSMNodeIdResolverTests;
+
+	FRandomStream Random( 0x05B3 );
+	TArray<int64> NodeIDs;
+	MakeAscendingIDs( Random, BenchmarkNodeCount, NodeIDs );
+
+	// Ways mostly reference nodes that were listed near each other, so most references walk through the nodes in
+	// order, and the rest go anywhere
+	TArray<int64> ReferenceIDs;
+	ReferenceIDs.SetNumUninitialized( BenchmarkReferenceCount );
+	for( int32 ReferenceIndex = 0; ReferenceIndex < BenchmarkReferenceCount; ++ReferenceIndex )
+	{
+		const int32 NodeIndex = ( ReferenceIndex % 8 ) == 0 ?
+			Random.RandRange( 0, BenchmarkNodeCount - 1 ) :
+			FMath::Min( ReferenceIndex / 2 + Random.RandRange( 0, 16 ), BenchmarkNodeCount - 1 );
+		ReferenceIDs[ ReferenceIndex ] = NodeIDs[ NodeIndex ];
+	}
+
+	TArray<int32> MapIndices;
+	MapIndices.SetNumUninitialized( BenchmarkReferenceCount );
+	double MapBuildSeconds, MapLookupSeconds;
+	{
+		double StartTime = FPlatformTime::Seconds();
+		TMap<int64, int32> Map;
+		MakeReferenceMap( NodeIDs, Map );
+		MapBuildSeconds = FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		for( int32 ReferenceIndex = 0; ReferenceIndex < BenchmarkReferenceCount; ++ReferenceIndex )
+		{
+			MapIndices[ ReferenceIndex ] = Map.FindRef( ReferenceIDs[ ReferenceIndex ] );
+		}
+		MapLookupSeconds = FPlatformTime::Seconds() - StartTime;
+	}
+
+	TArray<int32> ResolverIndices;
+	ResolverIndices.SetNumUninitialized( BenchmarkReferenceCount );
+	FOSMNodeIdResolver Resolver;
+	double StartTime = FPlatformTime::Seconds();
+	Resolver.Build( NodeIDs );
+	const double ResolverBuildSeconds = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	for( int32 ReferenceIndex = 0; ReferenceIndex < BenchmarkReferenceCount; ++ReferenceIndex )
+	{
+		ResolverIndices[ ReferenceIndex ] = Resolver.Find( ReferenceIDs[ ReferenceIndex ] );
+	}
+	const double ResolverLookupSeconds = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	Resolver.FindAll( ReferenceIDs, ResolverIndices );
+	const double ResolverFindAllSeconds = FPlatformTime::Seconds() - StartTime;
+
+	TestTrue( TEXT( "Resolver and map agree" ), ResolverIndices == MapIndices );
+
+	// Shuffled IDs make the resolver sort a copy first
+	for( int32 Index = NodeIDs.Num() - 1; Index > 0; --Index )
+	{
+		NodeIDs.Swap( Index, Random.RandRange( 0, Index ) );
+	}
+	StartTime = FPlatformTime::Seconds();
+	Resolver.Build( NodeIDs );
+	const double ShuffledBuildSeconds = FPlatformTime::Seconds() - StartTime;
+
+	AddInfo( FString::Printf( TEXT( "%d nodes, %d references" ), BenchmarkNodeCount, BenchmarkReferenceCount ) );
+	AddInfo( FString::Printf( TEXT( "TMap: build %.3fs, lookups %.3fs" ), MapBuildSeconds, MapLookupSeconds ) );
+	AddInfo( FString::Printf( TEXT( "Resolver (sorted IDs): build %.3fs, lookups %.3fs on one thread, %.3fs with FindAll" ), ResolverBuildSeconds, ResolverLookupSeconds, ResolverFindAllSeconds ) );
+	AddInfo( FString::Printf( TEXT( "Resolver (shuffled IDs): build %.3fs" ), ShuffledBuildSeconds ) );
+
+	return true;
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS
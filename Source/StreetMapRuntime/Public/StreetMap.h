@@ -1,5 +1,8 @@
 #pragma once
 #include "Math/MathFwd.h"
+#include "Algo/BinarySearch.h"
+#include "StreetMapProjection.h"
+#include "StreetMapSpatialIndex.h"
 #include "StreetMap.generated.h"
 
 USTRUCT(BlueprintType)
@@ -133,6 +136,125 @@ enum EStreetMapRoadType
 };
 
 
+/** Decides what OpenStreetMap ways with a certain tag become when a street map is imported */
+USTRUCT( BlueprintType )
+struct STREETMAPRUNTIME_API FStreetMapImportTagRule
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Tag key to match, e.g. "highway" */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	FString Key;
+
+	/** Tag value to match, e.g. "residential".  Use "*" to match any value. */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	FString Value;
+
+	/** Whether ways matching this rule are imported at all.  Ways that aren't kept are discarded while the file is being parsed. */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	uint32 bKeep : 1;
+
+	/** If true, matching ways are imported as buildings instead of roads */
+	UPROPERTY( Category=StreetMap, EditAnywhere, meta=( EditCondition="bKeep" ) )
+	uint32 bIsBuilding : 1;
+
+	/** Type of road that matching ways become */
+	UPROPERTY( Category=StreetMap, EditAnywhere, meta=( EditCondition="bKeep" ) )
+	TEnumAsByte<EStreetMapRoadType> RoadType;
+
+	FStreetMapImportTagRule()
+		: bKeep( true ),
+		  bIsBuilding( false ),
+		  RoadType( EStreetMapRoadType::Other )
+	{
+	}
+
+	FStreetMapImportTagRule( const TCHAR* InKey, const TCHAR* InValue, const bool bInKeep, const bool bInIsBuilding, const EStreetMapRoadType InRoadType )
+		: Key( InKey ),
+		  Value( InValue ),
+		  bKeep( bInKeep ),
+		  bIsBuilding( bInIsBuilding ),
+		  RoadType( InRoadType )
+	{
+	}
+};
+
+
+/** Settings used when importing a street map from an OpenStreetMap file */
+USTRUCT( BlueprintType )
+struct STREETMAPRUNTIME_API FStreetMapImportSettings
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Rules that classify ways by their tags.  When a way matches more than one rule, the rule that is listed first
+		wins.  Ways that don't match any rule aren't imported.  See http://wiki.openstreetmap.org/wiki/Map_Features */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	TArray<FStreetMapImportTagRule> TagRules;
+
+	/** How latitudes and longitudes are flattened onto the map.  Big maps should use Transverse Mercator, which keeps
+		shapes and distances true much further from the middle of the map. */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	EStreetMapProjectionType Projection;
+
+	/** If true, the file is read twice.  The first pass finds the ways we want to keep, and the second only keeps the
+		nodes those ways reference.  This takes longer, but memory use is bounded by the size of the street map rather
+		than the size of the file, which matters for huge extracts. */
+	UPROPERTY( Category=StreetMap, EditAnywhere, AdvancedDisplay )
+	uint32 bOnlyKeepReferencedNodes : 1;
+
+	/** If true, nodes are written to temporary files as the file is read, rather than kept in memory, and are matched up
+		with the ways that reference them in a single sweep once the file has been read.  Country-sized extracts have far
+		more nodes than fit in memory, and this keeps what they take up within the memory budget, in exchange for a few
+		gigabytes of disk space while importing.  The file is only read once, and only nodes that ways reference are kept. */
+	UPROPERTY( Category=StreetMap, EditAnywhere, AdvancedDisplay )
+	uint32 bOutOfCoreNodes : 1;
+
+	/** Roughly how much memory nodes may take up while importing with Out Of Core Nodes, in megabytes.  Only nodes
+		count against this.  The ways' node references are still sorted in memory once the file has been read, which
+		takes about 24 bytes for each one, and the ways and the street map itself need memory of their own too. */
+	UPROPERTY( Category=StreetMap, EditAnywhere, AdvancedDisplay, meta=(EditCondition="bOutOfCoreNodes", ClampMin="16", Units="Megabytes") )
+	int32 OutOfCoreNodeMemoryBudget;
+
+	/** If true, only the part of the map inside the clip bounds (and the clip polygon, if there is one) is imported.
+		Nodes outside of it are thrown away while the file is parsed, roads are cut where they leave it, and buildings
+		that aren't entirely inside it are skipped. */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	uint32 bClipToBounds : 1;
+
+	/** Southern edge of the area to import, in degrees latitude */
+	UPROPERTY( Category=StreetMap, EditAnywhere, meta=(EditCondition="bClipToBounds", ClampMin="-90", ClampMax="90") )
+	double ClipMinLatitude;
+
+	/** Northern edge of the area to import, in degrees latitude */
+	UPROPERTY( Category=StreetMap, EditAnywhere, meta=(EditCondition="bClipToBounds", ClampMin="-90", ClampMax="90") )
+	double ClipMaxLatitude;
+
+	/** Western edge of the area to import, in degrees longitude */
+	UPROPERTY( Category=StreetMap, EditAnywhere, meta=(EditCondition="bClipToBounds", ClampMin="-180", ClampMax="180") )
+	double ClipMinLongitude;
+
+	/** Eastern edge of the area to import, in degrees longitude */
+	UPROPERTY( Category=StreetMap, EditAnywhere, meta=(EditCondition="bClipToBounds", ClampMin="-180", ClampMax="180") )
+	double ClipMaxLongitude;
+
+	/** Optional outline of the area to import, with longitude in X and latitude in Y.  When it has at least three
+		points, only what is inside both the polygon and the clip bounds is imported. */
+	UPROPERTY( Category=StreetMap, EditAnywhere, meta=(EditCondition="bClipToBounds") )
+	TArray<FVector2D> ClipPolygon;
+
+	/** If greater than zero, the street map is split into square tiles this many meters across, and each tile is saved
+		as a street map of its own next to the imported one.  The imported street map then only lists its tiles, so that
+		just the tiles in view need to be loaded.  The grid is aligned to the middle of the map, and each tile's points
+		are relative to the middle of the tile.  Meshes are built at single precision, which starts to show about a
+		hundred kilometers from the middle of a street map, so bigger regions should be tiled. */
+	UPROPERTY( Category=StreetMap, EditAnywhere, AdvancedDisplay, meta=(ClampMin="0", Units="Meters") )
+	float TileSize;
+
+	/** Sets up the default rules, which import roads that cars can drive on, and all buildings */
+	FStreetMapImportSettings();
+};
+
+
 /** A road */
 USTRUCT( BlueprintType )
 struct STREETMAPRUNTIME_API FStreetMapRoad
@@ -147,13 +269,14 @@ struct STREETMAPRUNTIME_API FStreetMapRoad
 	UPROPERTY( Category=StreetMap, EditAnywhere )
 	TEnumAsByte<EStreetMapRoadType> RoadType;
 	
-	/** Nodes along this road, one at each point in the RoadPoints list */
-	UPROPERTY( Category=StreetMap, EditAnywhere )
-	TArray<int32> NodeIndices;
+	/** Where this road's points (and node indices) start in the street map's buffers.  The road doesn't hold on to
+	    the buffers itself, so copies of it can't outlive them; see GetRoadPoints() and the others below. */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere )
+	int32 FirstPointIndex;
 
-	/** List of all of the points on this road, one for each node in the NodeIndices list */
-	UPROPERTY( Category=StreetMap, EditAnywhere )
-	TArray<FVector2D> RoadPoints;
+	/** Number of points (and node indices) on this road */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere )
+	int32 PointCount;
 	
 	// @todo: Performance: Bounding information could be computed at load time if we want to avoid the memory cost of storing it
 
@@ -170,9 +293,19 @@ struct STREETMAPRUNTIME_API FStreetMapRoad
 	uint8 bIsOneWay : 1;
 
 
-	/** Returns this node's index */
+	/** Returns this road's index.  Only works on the street map's own roads, not copies of them. */
 	inline int32 GetRoadIndex( const class UStreetMap& StreetMap ) const;
 
+	/** Gets all of the points on this road, which are its part of the street map's point buffer */
+	inline TArrayView<const FVector2D> GetRoadPoints( const class UStreetMap& StreetMap ) const;
+
+	/** Gets the node at each of this road's points (or INDEX_NONE where there's no node) */
+	inline TArrayView<const int32> GetNodeIndices( const class UStreetMap& StreetMap ) const;
+
+	/** Gets the distance along this road to each of its points, from the first one.  The street map works these out
+	    whenever its roads are loaded or replaced, so that positions along the road can be found without walking it. */
+	inline TArrayView<const float> GetPointDistances( const class UStreetMap& StreetMap ) const;
+
 	/** Gets the node for the specified point, or the node that came before that if the specified point doesn't have a node */
 	inline const struct FStreetMapNode& GetNodeAtPointIndexOrEarlier( const class UStreetMap& StreetMap, const int32 PointIndex, int32& OutNodeAtPointIndex ) const;
 
@@ -185,7 +318,7 @@ struct STREETMAPRUNTIME_API FStreetMapRoad
 	/** Computes the distance along the road between two points on the road.  Be careful!  The same node can appear on a road twice. */
 	float ComputeDistanceBetweenNodesOnRoad( const class UStreetMap& StreetMap, const int32 NodePointIndexA, const int32 NodePointIndexB ) const;
 
-	/** Given a position along the road, finds the nodes that come earlier and later on that road */
+	/** Given a position along the road, finds the nodes that come earlier and later on that road.  Positions past the end of the road are treated as being at its last point. */
 	void FindEarlierAndLaterNodesForPositionAlongRoad( const class UStreetMap& StreetMap, const float PositionAlongRoad, const FStreetMapNode*& OutEarlierNode, float& OutEarlierNodePositionAlongRoad, const FStreetMapNode*& OutLaterNode, float& OutLaterNodePositionAlongRoad ) const;
 
 	/** Given a node that exists at a point index on this road, finds the nodes that are immediately earlier and later to it (adjacent.)  Will set a nullptr if there are no earlier or later nodes */
@@ -198,7 +331,7 @@ struct STREETMAPRUNTIME_API FStreetMapRoad
 	/** Given a node that exists on this road, computes the position along this road of that node */
 	float FindPositionAlongRoadForNode( const class UStreetMap& StreetMap, const int32 PointIndexForNode ) const;
 
-	/** Computes the location of a point along this road, given a distance along this road from the road's beginning */
+	/** Computes the location of a point along this road, given a distance along this road from the road's beginning.  Positions past the end of the road give its last point. */
 	FVector2D MakeLocationAlongRoad( const class UStreetMap& StreetMap, const float PositionAlongRoad ) const;
 
 	/** @return True if this is a one way road */
@@ -210,13 +343,23 @@ struct STREETMAPRUNTIME_API FStreetMapRoad
 	FStreetMapRoad() :
 		RoadName(),
 		RoadType(EStreetMapRoadType::Street),
-		NodeIndices(),
-		RoadPoints(),
+		FirstPointIndex(0),
+		PointCount(0),
 		BoundsMin(FVector2D::ZeroVector),
 		BoundsMax(FVector2D::ZeroVector),
 		bIsOneWay(0)
 	{
 	}
+
+#if WITH_EDITORONLY_DATA
+	/** Node indices of street maps saved before roads shared their buffers.  Only used while those are loaded. */
+	UPROPERTY()
+	TArray<int32> NodeIndices_DEPRECATED;
+
+	/** Points of street maps saved before roads shared their buffers.  Only used while those are loaded. */
+	UPROPERTY()
+	TArray<FVector2D> RoadPoints_DEPRECATED;
+#endif
 };
 
 
@@ -234,6 +377,12 @@ struct STREETMAPRUNTIME_API FStreetMapRoadRef
 	/** Index of the point along road where this node exists */
 	UPROPERTY( Category=StreetMap, EditAnywhere )
 	int32 RoadPointIndex = INDEX_NONE;
+
+	/** Serializer for road refs, so that they can be saved in bulk */
+	friend FArchive& operator<<( FArchive& Ar, FStreetMapRoadRef& RoadRef )
+	{
+		return Ar << RoadRef.RoadIndex << RoadRef.RoadPointIndex;
+	}
 };
 
 
@@ -243,14 +392,27 @@ struct STREETMAPRUNTIME_API FStreetMapNode
 {
 	GENERATED_USTRUCT_BODY()
 	
-	/** All of the roads that intersect this node.  We have references to each of these roads, as well as the point along each
-	    road where this node exists */
-	UPROPERTY( Category=StreetMap, EditAnywhere )
-	TArray<FStreetMapRoadRef> RoadRefs;
+	/** Where this node's road refs start in the street map's road ref buffer (see GetRoadRefs()) */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere )
+	int32 FirstRoadRefIndex = 0;
 
-	/** Returns this node's index */
+	/** Number of road refs this node has */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere )
+	int32 RoadRefCount = 0;
+
+#if WITH_EDITORONLY_DATA
+	/** Road refs of street maps saved before nodes shared a buffer.  Only used while those are loaded. */
+	UPROPERTY()
+	TArray<FStreetMapRoadRef> RoadRefs_DEPRECATED;
+#endif
+
+	/** Returns this node's index.  Only works on the street map's own nodes, not copies of them. */
 	inline int32 GetNodeIndex( const UStreetMap& StreetMap ) const;
 
+	/** Gets all of the roads that intersect this node.  We have references to each of these roads, as well as the point
+	    along each road where this node exists.  These are the node's part of the street map's road ref buffer. */
+	inline TArrayView<const FStreetMapRoadRef> GetRoadRefs( const UStreetMap& StreetMap ) const;
+
 	/** Gets the location of this node */
 	inline FVector2D GetLocation( const UStreetMap& StreetMap ) const;
 
@@ -273,6 +435,30 @@ struct STREETMAPRUNTIME_API FStreetMapNode
 
 	/** Pathfinding: Estimates the 'cost' of the specified connected by index (between 0 and GetConnectionCount() - 1) */
 	inline float GetConnectionCost( const class UStreetMap& StreetMap, const int32 ConnectionIndex, const bool bIsTravelingForward ) const;
+
+	/** Pathfinding: Estimates the 'cost' of traveling some distance along a road.  Connection costs are worked out with this. */
+	static inline float EstimateTravelCost( const FStreetMapRoad& ConnectingRoad, const float DistanceBetweenNodes );
+};
+
+
+/** A connection from a node to the next node along one of its roads, in either direction.  Street maps work these out
+    for every node when they're loaded, so that pathfinding doesn't need to search the roads for neighboring nodes. */
+struct FStreetMapConnection
+{
+	/** Index of the connected node */
+	int32 NodeIndex = INDEX_NONE;
+
+	/** Index of the road that connects the nodes */
+	int32 RoadIndex = INDEX_NONE;
+
+	/** Index of the point along the road where the node we're connecting from is */
+	int32 PointIndexOnRoad = INDEX_NONE;
+
+	/** Index of the point along the road where the connected node is */
+	int32 ConnectedNodePointIndexOnRoad = INDEX_NONE;
+
+	/** Estimated cost of traveling along the road between the nodes (see FStreetMapNode::EstimateTravelCost()) */
+	float Cost = 0.0f;
 };
 
 
@@ -310,6 +496,93 @@ struct STREETMAPRUNTIME_API FStreetMapBuilding
 };
 
 
+/** Remembers which OpenStreetMap ways and nodes each part of a street map was built from, so that changes to the
+    OpenStreetMap data can be applied to the street map without importing everything again.  Editor only. */
+USTRUCT()
+struct STREETMAPRUNTIME_API FStreetMapOSMSource
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Way that each road came from.  Roads that were cut into pieces share the ID of their way. */
+	UPROPERTY()
+	TArray<int64> RoadWayIDs;
+
+	/** Way that each building came from */
+	UPROPERTY()
+	TArray<int64> BuildingWayIDs;
+
+	/** Node at every road point (in road order), followed by the node at every building point (in building order.)
+	    Each ID is stored as the zigzag varint-encoded difference from the previous one, which usually takes two or
+	    three bytes rather than eight, as nodes along a way tend to have similar IDs. */
+	UPROPERTY()
+	TArray<uint8> PointNodeIDs;
+
+	/** False if the street map was imported before we kept track of its sources (and the projection they were
+		imported with, see UStreetMap::GetProjection()) */
+	UPROPERTY()
+	bool bIsValid = false;
+
+
+	/** Returns true if we know where the street map came from */
+	bool IsValid() const
+	{
+		return bIsValid;
+	}
+
+	/** Encodes the node IDs of every road point followed by every building point */
+	void SetPointNodeIDs( const TArrayView<const int64> NodeIDs );
+
+	/** Decodes the node IDs of every road point followed by every building point */
+	void GetPointNodeIDs( TArray<int64>& OutNodeIDs ) const;
+};
+
+
+/** A node that a tile shares with one of its neighbors, because a road carries on from one tile into the other.  Both
+    tiles have a link to the node in the other tile, so roads can be followed across tiles. */
+USTRUCT( BlueprintType )
+struct STREETMAPRUNTIME_API FStreetMapTileLink
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Index of the node in this tile */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	int32 NodeIndex = INDEX_NONE;
+
+	/** Grid coordinates of the neighboring tile */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	FIntPoint NeighborTileCoordinates = FIntPoint::ZeroValue;
+
+	/** Index of the same node in the neighboring tile */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	int32 NeighborNodeIndex = INDEX_NONE;
+};
+
+
+/** One tile of a street map that was split into tiles when it was imported */
+USTRUCT( BlueprintType )
+struct STREETMAPRUNTIME_API FStreetMapTile
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Grid coordinates of the tile.  Tile (0, 0) starts at the middle of the map and extends towards +X and +Y. */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	FIntPoint Coordinates = FIntPoint::ZeroValue;
+
+	/** The tile's street map.  Not loaded until it's needed. */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	TSoftObjectPtr<class UStreetMap> StreetMap;
+
+	/** 2D bounds (min) of the tile's roads and buildings, relative to the middle of the whole map.  Roads that cross into
+		a neighboring tile reach a little way past the tile's edge. */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	FVector2D BoundsMin = FVector2D::ZeroVector;
+
+	/** 2D bounds (max) of the tile's roads and buildings, relative to the middle of the whole map */
+	UPROPERTY( Category=StreetMap, EditAnywhere )
+	FVector2D BoundsMax = FVector2D::ZeroVector;
+};
+
+
 /** A loaded street map */
 UCLASS()
 class STREETMAPRUNTIME_API UStreetMap : public UObject
@@ -322,31 +595,21 @@ public:
 	UStreetMap();
 
 	// UObject overrides
+	virtual void Serialize( FArchive& Ar ) override;
 	virtual void GetAssetRegistryTags( TArray<FAssetRegistryTag>& OutTags ) const override;
 	
-	/** Gets the roads in this street map (read only) */
+	/** Gets the roads in this street map (read only.)  Roads, nodes and buildings are replaced all at once, with
+		SetRoadsAndNodes() and SetBuildings(), so that they always agree with the buffers they share. */
 	const TArray<FStreetMapRoad>& GetRoads() const
 	{
 		return Roads;
 	}
-
-	/** Gets the roads in this street map */
-	TArray<FStreetMapRoad>& GetRoads()
-	{
-		return Roads;
-	}
 	
 	/** Gets the nodes on the map (read only.)  Nodes describe intersections between roads */
 	const TArray<FStreetMapNode>& GetNodes() const
 	{
 		return Nodes;
 	}
-
-	/** Gets the nodes on the map.  Nodes describe intersections between roads */
-	TArray<FStreetMapNode>& GetNodes()
-	{
-		return Nodes;
-	}
 	
 	/** Gets all of the buildings (read only) */
 	const TArray<FStreetMapBuilding>& GetBuildings() const
@@ -354,10 +617,87 @@ public:
 		return Buildings;
 	}
 
-	/** Gets all of the buildings */
-	TArray<FStreetMapBuilding>& GetBuildings()
+	/** Gets the points of a road */
+	TArrayView<const FVector2D> GetRoadPoints( const int32 RoadIndex ) const
 	{
-		return Buildings;
+		return Roads[ RoadIndex ].GetRoadPoints( *this );
+	}
+
+	/** Gets the node at each point of a road (or INDEX_NONE where there's no node) */
+	TArrayView<const int32> GetRoadNodeIndices( const int32 RoadIndex ) const
+	{
+		return Roads[ RoadIndex ].GetNodeIndices( *this );
+	}
+
+	/** Gets the distance along a road to each of its points */
+	TArrayView<const float> GetRoadPointDistances( const int32 RoadIndex ) const
+	{
+		return Roads[ RoadIndex ].GetPointDistances( *this );
+	}
+
+	/** Gets the road refs of a node */
+	TArrayView<const FStreetMapRoadRef> GetNodeRoadRefs( const int32 NodeIndex ) const
+	{
+		return Nodes[ NodeIndex ].GetRoadRefs( *this );
+	}
+
+	/** Gets the points of every road, one road after another.  Each road's points are its part of this. */
+	const TArray<FVector2D>& GetRoadPoints() const
+	{
+		return RoadPoints;
+	}
+
+	/** Gets the node index at every road point, in the same order as GetRoadPoints() */
+	const TArray<int32>& GetRoadNodeIndices() const
+	{
+		return RoadNodeIndices;
+	}
+
+	/** Gets the distance along its road to every road point, in the same order as GetRoadPoints() */
+	const TArray<float>& GetRoadPointDistances() const
+	{
+		return RoadPointDistances;
+	}
+
+	/** Gets the road refs of every node, one node after another.  Each node's road refs are its part of this. */
+	const TArray<FStreetMapRoadRef>& GetNodeRoadRefs() const
+	{
+		return NodeRoadRefs;
+	}
+
+	/** Pathfinding: Gets the connections from a node to the nodes next to it along its roads, numbered the same way as
+		FStreetMapNode::GetConnection().  Connections that would go the wrong way along a one way road are left out. */
+	TArrayView<const FStreetMapConnection> GetConnections( const int32 NodeIndex, const bool bIsTravelingForward ) const
+	{
+		const TArray<int32>& Offsets = bIsTravelingForward ? ForwardConnectionOffsets : BackwardConnectionOffsets;
+		const TArray<FStreetMapConnection>& Connections = bIsTravelingForward ? ForwardConnections : BackwardConnections;
+		return TArrayView<const FStreetMapConnection>( Connections.GetData() + Offsets[ NodeIndex ], Offsets[ NodeIndex + 1 ] - Offsets[ NodeIndex ] );
+	}
+
+	/** Replaces the roads and nodes, along with the buffers they share.  Each road's FirstPointIndex and PointCount say
+		which part of the points and node indices are its own, and each node's FirstRoadRefIndex and RoadRefCount which
+		part of the road refs.  Returns false (and leaves roads and nodes that don't fit their buffers empty) if any
+		of those are out of range.  Call RebuildSpatialIndex() once the buildings are in place too. */
+	bool SetRoadsAndNodes( TArray<FStreetMapRoad>&& InRoads, TArray<FStreetMapNode>&& InNodes, TArray<FVector2D>&& InRoadPoints, TArray<int32>&& InRoadNodeIndices, TArray<FStreetMapRoadRef>&& InNodeRoadRefs );
+
+	/** Replaces the buildings.  Call RebuildSpatialIndex() once the roads and nodes are in place too. */
+	void SetBuildings( TArray<FStreetMapBuilding>&& InBuildings )
+	{
+		Buildings = MoveTemp( InBuildings );
+	}
+
+	/** Builds the spatial index again over the current roads, nodes and buildings.  Call this after replacing them, and
+		not while anything else might be querying the index. */
+	void RebuildSpatialIndex()
+	{
+		SpatialIndex.Build( *this );
+	}
+
+	/** Gets the spatial index over this street map's road segments, nodes and buildings, for finding what's near a
+		location.  Built when the street map is loaded, and by RebuildSpatialIndex(). */
+	const FStreetMapSpatialIndex& GetSpatialIndex() const
+	{
+		return SpatialIndex;
 	}
 
 	/** Gets the bounding box of the map */
@@ -370,6 +710,53 @@ public:
 		return BoundsMax;
 	}
 
+	/** Gets how latitudes and longitudes were flattened onto this street map, for converting between the two */
+	const FStreetMapProjection& GetProjection() const
+	{
+		return Projection;
+	}
+
+	/** If this street map was split into tiles when it was imported, gets the tiles.  The street map itself has no
+		roads or buildings then. */
+	const TArray<FStreetMapTile>& GetTiles() const
+	{
+		return Tiles;
+	}
+
+	/** Finds the tile at some grid coordinates.  Returns nullptr if there's no tile there. */
+	const FStreetMapTile* FindTile( const FIntPoint InTileCoordinates ) const;
+
+	/** Returns true if this street map is one tile of a bigger street map */
+	bool IsTile() const
+	{
+		return !TiledStreetMap.IsNull();
+	}
+
+	/** For tiles, gets the street map that lists all of the tiles */
+	const TSoftObjectPtr<UStreetMap>& GetTiledStreetMap() const
+	{
+		return TiledStreetMap;
+	}
+
+	/** For tiles, gets the grid coordinates of this tile */
+	FIntPoint GetTileCoordinates() const
+	{
+		return TileCoordinates;
+	}
+
+	/** For tiles, gets where the middle of this tile is in the street map it was split from.  The tile's points are
+		relative to this, so it's also where the tile should be placed to line up with its neighbors. */
+	FVector2D GetTileOrigin() const
+	{
+		return TileOrigin;
+	}
+
+	/** For tiles, gets the nodes that are shared with neighboring tiles */
+	const TArray<FStreetMapTileLink>& GetTileLinks() const
+	{
+		return TileLinks;
+	}
+
 
 protected:
 	
@@ -381,6 +768,33 @@ protected:
 	UPROPERTY( Category=StreetMap, VisibleAnywhere )
 	TArray<FStreetMapNode> Nodes;
 
+	/** Points of every road, one road after another.  Saved in bulk rather than as properties. */
+	TArray<FVector2D> RoadPoints;
+
+	/** Node index at every road point (or INDEX_NONE where there's no node), in the same order as RoadPoints */
+	TArray<int32> RoadNodeIndices;
+
+	/** Road refs of every node, one node after another */
+	TArray<FStreetMapRoadRef> NodeRoadRefs;
+
+	/** Distance along its road to every road point, in the same order as RoadPoints.  Never saved. */
+	TArray<float> RoadPointDistances;
+
+	/** Where each node's connections start in ForwardConnections, plus one more for the end of the last node's.  Never saved. */
+	TArray<int32> ForwardConnectionOffsets;
+
+	/** Connections from every node that can be taken while traveling forward, one node after another */
+	TArray<FStreetMapConnection> ForwardConnections;
+
+	/** Where each node's connections start in BackwardConnections, plus one more for the end of the last node's.  Never saved. */
+	TArray<int32> BackwardConnectionOffsets;
+
+	/** Connections from every node that can be taken while traveling backward, one node after another */
+	TArray<FStreetMapConnection> BackwardConnections;
+
+	/** Grid over the road segments, nodes and buildings.  Never saved. */
+	FStreetMapSpatialIndex SpatialIndex;
+
 	/** List of all buildings on the street map */
 	UPROPERTY( Category=StreetMap, VisibleAnywhere)
 	TArray<FStreetMapBuilding> Buildings;
@@ -393,29 +807,110 @@ protected:
 	UPROPERTY( Category=StreetMap, VisibleAnywhere)
 	FVector2D BoundsMax;
 
+	/** How latitudes and longitudes were flattened onto this street map */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere )
+	FStreetMapProjection Projection;
+
+	/** Tiles this street map was split into, if it was imported with a tile size */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere )
+	TArray<FStreetMapTile> Tiles;
+
+	/** For tiles, the street map that lists all of the tiles */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere )
+	TSoftObjectPtr<UStreetMap> TiledStreetMap;
+
+	/** For tiles, grid coordinates of this tile */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere )
+	FIntPoint TileCoordinates;
+
+	/** For tiles, where the middle of this tile is in the street map it was split from */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere )
+	FVector2D TileOrigin;
+
+	/** For tiles, nodes that are shared with neighboring tiles */
+	UPROPERTY( Category=StreetMap, VisibleAnywhere )
+	TArray<FStreetMapTileLink> TileLinks;
+
 #if WITH_EDITORONLY_DATA
 	/** Importing data and options used for this mesh */
 	UPROPERTY( VisibleAnywhere, Instanced, Category=ImportSettings )
 	class UAssetImportData* AssetImportData;
 
+	/** Settings this map was imported with.  These are used again when the map is reimported. */
+	UPROPERTY( EditAnywhere, Category=ImportSettings )
+	FStreetMapImportSettings ImportSettings;
+
+	/** Where the roads and buildings came from in the OpenStreetMap data, for applying changes to it */
+	UPROPERTY()
+	FStreetMapOSMSource OSMSource;
+
+	/** If true, road and building points are saved as whole numbers of Point Quantization Steps from the minimum bounds
+		of their road or building, each stored as a variable length difference from the point before.  Points along a
+		road are usually a few meters apart, so at centimeter steps this takes around a quarter of the space of full
+		precision points. */
+	UPROPERTY( EditAnywhere, Category=StreetMap, AdvancedDisplay )
+	bool bSaveQuantizedPoints = false;
+
+	/** Distance between the positions quantized points can have, in map units (centimeters.)  Points are rounded to the
+		nearest step as they're saved, but the open street map keeps them as they are. */
+	UPROPERTY( EditAnywhere, Category=StreetMap, AdvancedDisplay, meta=(EditCondition="bSaveQuantizedPoints", ClampMin="0.01") )
+	float PointQuantizationStep = 1.0f;
+
 	friend class UStreetMapFactory;
 	friend class UStreetMapReimportFactory;
 	friend class FStreetMapAssetTypeActions;
+	friend class FStreetMapChangeApplier;
 #endif	// WITH_EDITORONLY_DATA
 
+
+private:
+
+	/** Checks that each road and node fits in the buffers they share (emptying the ones that don't), and works out the
+		distances along each road and the connections between nodes.  Returns false if any of them were out of range. */
+	bool BindRoadsAndNodes();
+
+	/** Works out the connections between nodes, in both directions of travel */
+	void BuildConnections();
+
+#if WITH_EDITORONLY_DATA
+	/** Moves the points, node indices and road refs of street maps saved before roads and nodes shared buffers into the buffers */
+	void PackDeprecatedRoadsAndNodes();
+#endif
 };
 
 
 inline int32 FStreetMapRoad::GetRoadIndex( const UStreetMap& StreetMap ) const
 {
-	// Pointer arithmetic based on array start
-	const int32 RoadIndex = this - StreetMap.GetRoads().GetData();
+	// Pointer arithmetic based on array start, so this must be one of the street map's own roads rather than a copy
+	const UPTRINT Offset = UPTRINT( this ) - UPTRINT( StreetMap.GetRoads().GetData() );
+	check( Offset < UPTRINT( StreetMap.GetRoads().Num() ) * sizeof( FStreetMapRoad ) && Offset % sizeof( FStreetMapRoad ) == 0 );
+	const int32 RoadIndex = int32( Offset / sizeof( FStreetMapRoad ) );
 	return RoadIndex;
 }
 
 
+inline TArrayView<const FVector2D> FStreetMapRoad::GetRoadPoints( const UStreetMap& StreetMap ) const
+{
+	// The street map empties its roads that don't fit its buffers, so this only fails for roads from somewhere else
+	return MakeArrayView( StreetMap.GetRoadPoints() ).Slice( FirstPointIndex, PointCount );
+}
+
+
+inline TArrayView<const int32> FStreetMapRoad::GetNodeIndices( const UStreetMap& StreetMap ) const
+{
+	return MakeArrayView( StreetMap.GetRoadNodeIndices() ).Slice( FirstPointIndex, PointCount );
+}
+
+
+inline TArrayView<const float> FStreetMapRoad::GetPointDistances( const UStreetMap& StreetMap ) const
+{
+	return MakeArrayView( StreetMap.GetRoadPointDistances() ).Slice( FirstPointIndex, PointCount );
+}
+
+
 inline const FStreetMapNode& FStreetMapRoad::GetNodeAtPointIndexOrEarlier( const UStreetMap& StreetMap, const int32 PointIndex, int32& OutNodeAtPointIndex ) const
 {
+	const TArrayView<const int32> NodeIndices = GetNodeIndices( StreetMap );
 	const FStreetMapNode* CurrentOrEarlierPointNode = nullptr;
 	for( int32 NodePointIndex = PointIndex; NodePointIndex >= 0; --NodePointIndex )
 	{
@@ -432,8 +927,9 @@ inline const FStreetMapNode& FStreetMapRoad::GetNodeAtPointIndexOrEarlier( const
 
 inline const FStreetMapNode& FStreetMapRoad::GetNodeAtPointIndexOrLater( const UStreetMap& StreetMap, const int32 PointIndex, int32& OutNodeAtPointIndex ) const
 {
+	const TArrayView<const int32> NodeIndices = GetNodeIndices( StreetMap );
 	const FStreetMapNode* NextOrUpcomingNode = nullptr;
-	for( int32 NodePointIndex = PointIndex; NodePointIndex < RoadPoints.Num(); ++NodePointIndex )
+	for( int32 NodePointIndex = PointIndex; NodePointIndex < NodeIndices.Num(); ++NodePointIndex )
 	{
 		if( NodeIndices[ NodePointIndex ] != INDEX_NONE )
 		{
@@ -449,79 +945,58 @@ inline const FStreetMapNode& FStreetMapRoad::GetNodeAtPointIndexOrLater( const U
 
 inline float FStreetMapRoad::ComputeLengthOfRoad( const class UStreetMap& StreetMap ) const
 {
-	// @todo: Performance: We could cache the road's total length at load time to avoid having to compute it,
-	//        or we could save it right into the asset file
-
-	return ComputeDistanceBetweenNodesOnRoad( StreetMap, 0, this->NodeIndices.Num() - 1 );
+	return ComputeDistanceBetweenNodesOnRoad( StreetMap, 0, PointCount - 1 );
 }
 
 
 inline float FStreetMapRoad::ComputeDistanceBetweenNodesOnRoad( const class UStreetMap& StreetMap, const int32 NodePointIndexA, const int32 NodePointIndexB ) const
 {
-	float TotalDistanceSoFar = 0.0f;
-
 	// NOTE: It is very important that we use the actual road point indices here and not nodes directly, because the same node can appear
 	// more than once on a single road!
 
-	// @todo: Performance: We can cache distances between connected nodes rather than computing them every time.  This
-	//        can be computed at load time or at import time (and stored in the asset).  Most of the other functions
-	//        in this class that perform Size() computations could be changed to use cached distances also!
-
+	const TArrayView<const float> PointDistances = GetPointDistances( StreetMap );
 	const int32 SmallerPointIndex = FMath::Max( 0, FMath::Min( NodePointIndexA, NodePointIndexB ) );
-	const int32 LargerPointIndex = FMath::Min( RoadPoints.Num() - 1, FMath::Max( NodePointIndexA, NodePointIndexB ) );
-
-	for( int32 PointIndex = SmallerPointIndex; PointIndex < LargerPointIndex; ++PointIndex )
+	const int32 LargerPointIndex = FMath::Min( PointDistances.Num() - 1, FMath::Max( NodePointIndexA, NodePointIndexB ) );
+	if( SmallerPointIndex >= LargerPointIndex )
 	{
-		const FVector2D PointLocation = RoadPoints[ PointIndex ];
-		const FVector2D NextPointLocation = RoadPoints[ PointIndex + 1 ];
-
-		const float DistanceBetweenPoints = ( NextPointLocation - PointLocation ).Size();
-			
-		TotalDistanceSoFar += DistanceBetweenPoints;
+		return 0.0f;
 	}
-	
-	// @todo: Malformed data can cause this assertion to trigger.  This could be a single road with at least two adjacent nodes
-	//        at the exact same location.  We need to filter this out at load time probably.
-	// check( TotalDistanceSoFar > 0.0f );
 
-	return TotalDistanceSoFar;
+	// @todo: Malformed data can make this zero.  This could be a single road with at least two adjacent nodes
+	//        at the exact same location.  We need to filter this out at load time probably.
+	return PointDistances[ LargerPointIndex ] - PointDistances[ SmallerPointIndex ];
 }
 
 
 inline void FStreetMapRoad::FindEarlierAndLaterNodesForPositionAlongRoad( const class UStreetMap& StreetMap, const float PositionAlongRoad, const FStreetMapNode*& OutEarlierNode, float& OutEarlierNodePositionAlongRoad, const FStreetMapNode*& OutLaterNode, float& OutLaterNodePositionAlongRoad ) const
 {
-	float CurrentPointPositionAlongRoad = 0.0f;
-
+	const TArrayView<const int32> NodeIndices = GetNodeIndices( StreetMap );
+	const TArrayView<const float> PointDistances = GetPointDistances( StreetMap );
 	const FStreetMapNode* EarlierStreetMapNode = nullptr;
 	const FStreetMapNode* LaterStreetMapNode = nullptr;
 
-	const int32 NumPoints = RoadPoints.Num();
-	for( int32 CurrentPointIndex = 0; CurrentPointIndex < NumPoints - 1; ++CurrentPointIndex )
+	// The later node is the first one at or after the position (but never the first point), and the earlier node is
+	// the last one before that.  Positions past the end of the road are treated as being at its last point.
+	const int32 NumPoints = PointDistances.Num();
+	int32 LaterPointIndex = FMath::Min( FMath::Max( Algo::LowerBound( PointDistances, PositionAlongRoad ), 1 ), NumPoints - 1 );
+	while( LaterPointIndex < NumPoints && NodeIndices[ LaterPointIndex ] == INDEX_NONE )
 	{
-		if( this->NodeIndices[ CurrentPointIndex ] != INDEX_NONE )
-		{
-			EarlierStreetMapNode = &StreetMap.GetNodes()[ this->NodeIndices[ CurrentPointIndex ] ];
-			OutEarlierNodePositionAlongRoad = CurrentPointPositionAlongRoad;
-		}
-
-		const int32 NextPointIndex = CurrentPointIndex + 1;
-		const FVector2D CurrentPointLocation = RoadPoints[ CurrentPointIndex ];
-		const FVector2D NextPointLocation = RoadPoints[ NextPointIndex ];
-
-		const float DistanceBetweenPoints = ( NextPointLocation - CurrentPointLocation ).Size();
-		const float NextPointPositionAlongRoad = CurrentPointPositionAlongRoad + DistanceBetweenPoints;
+		++LaterPointIndex;
+	}
+	if( LaterPointIndex < NumPoints )
+	{
+		LaterStreetMapNode = &StreetMap.GetNodes()[ NodeIndices[ LaterPointIndex ] ];
+		OutLaterNodePositionAlongRoad = PointDistances[ LaterPointIndex ];
 
-		if( NextPointPositionAlongRoad >= PositionAlongRoad )
+		for( int32 EarlierPointIndex = LaterPointIndex - 1; EarlierPointIndex >= 0; --EarlierPointIndex )
 		{
-			if( NodeIndices[ NextPointIndex ] != INDEX_NONE )
+			if( NodeIndices[ EarlierPointIndex ] != INDEX_NONE )
 			{
-				LaterStreetMapNode = &StreetMap.GetNodes()[ this->NodeIndices[ NextPointIndex ] ];
-				OutLaterNodePositionAlongRoad = NextPointPositionAlongRoad;
+				EarlierStreetMapNode = &StreetMap.GetNodes()[ NodeIndices[ EarlierPointIndex ] ];
+				OutEarlierNodePositionAlongRoad = PointDistances[ EarlierPointIndex ];
 				break;
 			}
 		}
-			
-		CurrentPointPositionAlongRoad = NextPointPositionAlongRoad;
 	}
 
 	check( EarlierStreetMapNode != nullptr && LaterStreetMapNode != nullptr );
@@ -537,21 +1012,22 @@ inline void FStreetMapRoad::FindEarlierAndLaterNodes( const class UStreetMap& St
 	OutLaterNode = nullptr;
 	OutLaterNodePositionAlongRoad = -1.0f;
 
+	const TArrayView<const int32> NodeIndices = GetNodeIndices( StreetMap );
 	for( int32 EarlierPointIndex = RoadPointIndex - 1; EarlierPointIndex >= 0; --EarlierPointIndex )
 	{
-		if( this->NodeIndices[ EarlierPointIndex ] != INDEX_NONE )
+		if( NodeIndices[ EarlierPointIndex ] != INDEX_NONE )
 		{
-			OutEarlierNode = &StreetMap.GetNodes()[ this->NodeIndices[ EarlierPointIndex ] ];
+			OutEarlierNode = &StreetMap.GetNodes()[ NodeIndices[ EarlierPointIndex ] ];
 			OutEarlierNodePositionAlongRoad = FindPositionAlongRoadForNode( StreetMap, EarlierPointIndex );
 			break;
 		}
 	}
 
-	for( int32 LaterPointIndex = RoadPointIndex + 1; LaterPointIndex < this->RoadPoints.Num(); ++LaterPointIndex )
+	for( int32 LaterPointIndex = RoadPointIndex + 1; LaterPointIndex < NodeIndices.Num(); ++LaterPointIndex )
 	{
-		if( this->NodeIndices[ LaterPointIndex ] != INDEX_NONE )
+		if( NodeIndices[ LaterPointIndex ] != INDEX_NONE )
 		{
-			OutLaterNode = &StreetMap.GetNodes()[ this->NodeIndices[ LaterPointIndex ] ];
+			OutLaterNode = &StreetMap.GetNodes()[ NodeIndices[ LaterPointIndex ] ];
 			OutLaterNodePositionAlongRoad = FindPositionAlongRoadForNode( StreetMap, LaterPointIndex );
 			break;
 		}
@@ -561,65 +1037,53 @@ inline void FStreetMapRoad::FindEarlierAndLaterNodes( const class UStreetMap& St
 
 inline float FStreetMapRoad::FindPositionAlongRoadForNode( const class UStreetMap& StreetMap, const int32 PointIndexForNode ) const
 {
-	float CurrentPointPositionAlongRoad = 0.0f;
-
-	for( int32 CurrentPointIndex = 0; CurrentPointIndex < PointIndexForNode; ++CurrentPointIndex )
+	const TArrayView<const float> PointDistances = GetPointDistances( StreetMap );
+	if( PointIndexForNode <= 0 || PointDistances.Num() == 0 )
 	{
-		const FVector2D CurrentPointLocation = RoadPoints[ CurrentPointIndex ];
-		const FVector2D NextPointLocation = RoadPoints[ CurrentPointIndex + 1 ];
-
-		const float DistanceBetweenPoints = ( NextPointLocation - CurrentPointLocation ).Size();
-		const float NextPointPositionAlongRoad = CurrentPointPositionAlongRoad + DistanceBetweenPoints;
-
-		CurrentPointPositionAlongRoad = NextPointPositionAlongRoad;
+		return 0.0f;
 	}
-
-	return CurrentPointPositionAlongRoad;
+	return PointDistances[ FMath::Min( PointIndexForNode, PointDistances.Num() - 1 ) ];
 }
 
 
 inline FVector2D FStreetMapRoad::MakeLocationAlongRoad( const class UStreetMap& StreetMap, const float PositionAlongRoad ) const
 {
-	FVector2D LocationAlongRoad = FVector2D::ZeroVector;
-	float CurrentPointPositionAlongRoad = 0.0f;
-
-	bool bFoundLocation = false;
-	const int32 NumPoints = RoadPoints.Num();
-	for( int32 CurrentPointIndex = 0; CurrentPointIndex < NumPoints - 1; ++CurrentPointIndex )
-	{
-		const FVector2D CurrentPointLocation = RoadPoints[ CurrentPointIndex ];
-		const FVector2D NextPointLocation = RoadPoints[ CurrentPointIndex + 1 ];
-
-		const float DistanceBetweenPoints = ( NextPointLocation - CurrentPointLocation ).Size();
-		const float NextPointPositionAlongRoad = CurrentPointPositionAlongRoad + DistanceBetweenPoints;
-
-		if( NextPointPositionAlongRoad >= PositionAlongRoad )
-		{
-			const float LerpAlpha = ( PositionAlongRoad - CurrentPointPositionAlongRoad ) / DistanceBetweenPoints;
-			LocationAlongRoad = FMath::Lerp( CurrentPointLocation, NextPointLocation, LerpAlpha );
-			bFoundLocation = true;
-			break;
-		}
-			
-		CurrentPointPositionAlongRoad = NextPointPositionAlongRoad;
-	}
-
-	check( bFoundLocation == true );
-
-	return LocationAlongRoad;
+	// Find the first segment that ends at or after the position.  Positions past the end of the road come out at its
+	// last point.
+	const TArrayView<const FVector2D> RoadPoints = GetRoadPoints( StreetMap );
+	const TArrayView<const float> PointDistances = GetPointDistances( StreetMap );
+	const int32 NextPointIndex = FMath::Min( FMath::Max( Algo::LowerBound( PointDistances, PositionAlongRoad ), 1 ), PointDistances.Num() - 1 );
+	check( NextPointIndex >= 1 );
+
+	const int32 CurrentPointIndex = NextPointIndex - 1;
+	const float DistanceBetweenPoints = PointDistances[ NextPointIndex ] - PointDistances[ CurrentPointIndex ];
+	const float LerpAlpha = FMath::Min( ( PositionAlongRoad - PointDistances[ CurrentPointIndex ] ) / DistanceBetweenPoints, 1.0f );
+	return FMath::Lerp( RoadPoints[ CurrentPointIndex ], RoadPoints[ NextPointIndex ], LerpAlpha );
 }
 
 
 inline int32 FStreetMapNode::GetNodeIndex( const UStreetMap& StreetMap ) const
 {
-	// Pointer arithmetic based on array start
-	const int32 NodeIndex = this - StreetMap.GetNodes().GetData();
+	// Pointer arithmetic based on array start, so this must be one of the street map's own nodes rather than a copy.
+	// The connection functions look up connections by this index, and would read someone else's (or past the end of
+	// the list) otherwise.
+	const UPTRINT Offset = UPTRINT( this ) - UPTRINT( StreetMap.GetNodes().GetData() );
+	check( Offset < UPTRINT( StreetMap.GetNodes().Num() ) * sizeof( FStreetMapNode ) && Offset % sizeof( FStreetMapNode ) == 0 );
+	const int32 NodeIndex = int32( Offset / sizeof( FStreetMapNode ) );
 	return NodeIndex;
 }
 
 
+inline TArrayView<const FStreetMapRoadRef> FStreetMapNode::GetRoadRefs( const UStreetMap& StreetMap ) const
+{
+	// The street map empties its nodes that don't fit its buffer, so this only fails for nodes from somewhere else
+	return MakeArrayView( StreetMap.GetNodeRoadRefs() ).Slice( FirstRoadRefIndex, RoadRefCount );
+}
+
+
 inline bool FStreetMapNode::IsDeadEnd( const UStreetMap& StreetMap ) const
 {
+	const TArrayView<const FStreetMapRoadRef> RoadRefs = GetRoadRefs( StreetMap );
 	if( RoadRefs.Num() == 1 )
 	{
 		// @todo: If this road only connects to dead end roads that oppose the direction, we need to treat this road
@@ -627,7 +1091,7 @@ inline bool FStreetMapNode::IsDeadEnd( const UStreetMap& StreetMap ) const
 
 		const FStreetMapRoadRef& SoleRoadRef = RoadRefs[ 0 ];
 		const FStreetMapRoad& SoleRoad = StreetMap.GetRoads()[ SoleRoadRef.RoadIndex ];
-		if( SoleRoadRef.RoadPointIndex == 0 || SoleRoadRef.RoadPointIndex == ( SoleRoad.NodeIndices.Num() - 1 ) )
+		if( SoleRoadRef.RoadPointIndex == 0 || SoleRoadRef.RoadPointIndex == ( SoleRoad.PointCount - 1 ) )
 		{
 			// The node is attached to only one road, and the node is at the very end of one of the ends of the road
 			return true;
@@ -640,175 +1104,66 @@ inline bool FStreetMapNode::IsDeadEnd( const UStreetMap& StreetMap ) const
 
 inline FVector2D FStreetMapNode::GetLocation( const UStreetMap& StreetMap ) const
 {
-	const FStreetMapRoadRef& MyFirstRoadRef = RoadRefs[ 0 ];
-	const FVector2D Location = StreetMap.GetRoads()[ MyFirstRoadRef.RoadIndex ].RoadPoints[ MyFirstRoadRef.RoadPointIndex ];
+	const FStreetMapRoadRef& MyFirstRoadRef = GetRoadRefs( StreetMap )[ 0 ];
+	const FVector2D Location = StreetMap.GetRoadPoints( MyFirstRoadRef.RoadIndex )[ MyFirstRoadRef.RoadPointIndex ];
 	return Location;
 }
 
 
 inline const FStreetMapRoad& FStreetMapNode::GetShortestCostRoadToNode( UStreetMap& StreetMap, const FStreetMapNode& OtherNode, const bool bIsTravelingForward, int32& OutPointIndexOnRoad ) const
 {
-	const FStreetMapRoad* ConnectingRoad = nullptr;
-
-	float BestConnectionCost = TNumericLimits<float>::Max();
-	int32 BestConnectionIndex = INDEX_NONE;
-	int32 BestConnectionPointIndex = INDEX_NONE;
-
-	const int32 ConnectionCount = GetConnectionCount( StreetMap, bIsTravelingForward );
-	for( int32 ConnectionIndex = 0; ConnectionIndex < ConnectionCount; ++ConnectionIndex )
+	// When the two nodes are connected by more than one road, the first of the cheapest connections wins
+	const int32 OtherNodeIndex = OtherNode.GetNodeIndex( StreetMap );
+	const FStreetMapConnection* BestConnection = nullptr;
+	for( const FStreetMapConnection& Connection : StreetMap.GetConnections( GetNodeIndex( StreetMap ), bIsTravelingForward ) )
 	{
-		int32 MyPointIndexOnRoad;
-		int32 ConnectedNodePointIndexOnRoad;
-
-		const FStreetMapRoad* CurrentConnectingRoad;
-		const FStreetMapNode* ConnectedNode = GetConnection( StreetMap, ConnectionIndex, bIsTravelingForward, /* Out */ &CurrentConnectingRoad, /* Out */ &MyPointIndexOnRoad, /* Out */ &ConnectedNodePointIndexOnRoad );
-		if( ConnectedNode == &OtherNode )
+		if( Connection.NodeIndex == OtherNodeIndex && ( BestConnection == nullptr || Connection.Cost < BestConnection->Cost ) )
 		{
-			if( BestConnectionIndex != INDEX_NONE )
-			{
-				// We evaluate cost lazily, only in the unusual case of the two nodes being connected by multiple roads
-				BestConnectionCost = GetConnectionCost( StreetMap, BestConnectionIndex, bIsTravelingForward );
-				if( GetConnectionCost( StreetMap, ConnectionIndex, bIsTravelingForward ) < BestConnectionCost )
-				{
-					ConnectingRoad = CurrentConnectingRoad;
-					BestConnectionIndex = ConnectionIndex;
-					BestConnectionPointIndex = MyPointIndexOnRoad;
-				}
-			}
-			else
-			{
-				ConnectingRoad = CurrentConnectingRoad;
-				BestConnectionIndex = ConnectionIndex;
-				BestConnectionPointIndex = MyPointIndexOnRoad;
-			}
+			BestConnection = &Connection;
 		}
 	}
 
-	check( ConnectingRoad != nullptr );
-	OutPointIndexOnRoad = BestConnectionPointIndex;
-	return *ConnectingRoad;
+	check( BestConnection != nullptr );
+	OutPointIndexOnRoad = BestConnection->PointIndexOnRoad;
+	return StreetMap.GetRoads()[ BestConnection->RoadIndex ];
 }
 
 inline int32 FStreetMapNode::GetConnectionCount( const UStreetMap& StreetMap, const bool bIsTravelingForward ) const
 {
-	// NOTE: We're iterating here in the exact same order as in the GetConnection() function below!  That's critically important!
-	int32 TotalConnections = 0;
-	for( const FStreetMapRoadRef& RoadRef : RoadRefs )
-	{
-		const FStreetMapRoad& Road = StreetMap.GetRoads()[ RoadRef.RoadIndex ];
-		
-		if( RoadRef.RoadPointIndex > 0 && ( !bIsTravelingForward || !Road.IsOneWay() ) )
-		{
-			// We connect to a node earlier up this road
-			++TotalConnections;
-		}
-
-		if( RoadRef.RoadPointIndex < ( Road.NodeIndices.Num() - 1 ) && ( bIsTravelingForward || !Road.IsOneWay() ) )
-		{
-			// We connect to a node further down this road
-			++TotalConnections;
-		}
-	}
-
-	return TotalConnections;
+	return StreetMap.GetConnections( GetNodeIndex( StreetMap ), bIsTravelingForward ).Num();
 }
 
 
 inline const FStreetMapNode* FStreetMapNode::GetConnection( const UStreetMap& StreetMap, const int32 ConnectionIndex, const bool bIsTravelingForward, const FStreetMapRoad** OutConnectingRoad, int32* OutPointIndexOnRoad, int32* OutConnectedNodePointIndexOnRoad ) const
 {
+	const TArrayView<const FStreetMapConnection> Connections = StreetMap.GetConnections( GetNodeIndex( StreetMap ), bIsTravelingForward );
+	check( Connections.IsValidIndex( ConnectionIndex ) );
+	const FStreetMapConnection& Connection = Connections[ ConnectionIndex ];
+
 	if( OutConnectingRoad != nullptr )
 	{
-		*OutConnectingRoad = nullptr;
+		*OutConnectingRoad = &StreetMap.GetRoads()[ Connection.RoadIndex ];
 	}
-	const FStreetMapNode* ConnectedNode = nullptr;
-
-	// @todo: Performance: We can improve performance by caching additional connectivity information right on
-	//        the node itself.  This function would be a hot spot for any sort of pathfinding computation
-
-	// NOTE: We're iterating here in the exact same order as in the GetConnectionCount() function above!  That's critically important!
-	int32 CurrentConnectionIndex = 0;
-	for( const FStreetMapRoadRef& RoadRef : RoadRefs )
+	if( OutPointIndexOnRoad != nullptr )
 	{
-		const FStreetMapRoad& Road = StreetMap.GetRoads()[ RoadRef.RoadIndex ];
-		
-		// @todo: Performance: We could avoid the "while" loops below by not storing INDEX_NONEs in the NodeIndices array,
-		//        but instead mapping them to points by going through the node itself, then back to a road
-
-		if( RoadRef.RoadPointIndex > 0 && ( !bIsTravelingForward || !Road.IsOneWay() ) )
-		{
-			// We connect to an earlier node up this road
-			if( CurrentConnectionIndex == ConnectionIndex )
-			{
-				int32 EarlierNodeRoadPointIndex = RoadRef.RoadPointIndex - 1;
-				while( Road.NodeIndices[ EarlierNodeRoadPointIndex ] == INDEX_NONE )
-				{
-					--EarlierNodeRoadPointIndex;
-				}
-				const int32 EarlierNodeIndex = Road.NodeIndices[ EarlierNodeRoadPointIndex ];
-
-				const FStreetMapNode& EarlierNode = StreetMap.GetNodes()[ EarlierNodeIndex ];
-				ConnectedNode = &EarlierNode;
-				if( OutConnectingRoad != nullptr )
-				{
-					*OutConnectingRoad = &Road;
-				}
-				if( OutPointIndexOnRoad != nullptr )
-				{
-					*OutPointIndexOnRoad = RoadRef.RoadPointIndex;
-				}
-				if( OutConnectedNodePointIndexOnRoad != nullptr )
-				{
-					*OutConnectedNodePointIndexOnRoad = EarlierNodeRoadPointIndex;
-				}
-
-				// Got it!
-				break;
-			}
-
-			++CurrentConnectionIndex;
-		}
-
-		if( RoadRef.RoadPointIndex < ( Road.NodeIndices.Num() - 1 ) && ( bIsTravelingForward || !Road.IsOneWay() ) )
-		{
-			// We connect to node further down this road
-			if( CurrentConnectionIndex == ConnectionIndex )
-			{
-				int32 LaterNodeRoadPointIndex = RoadRef.RoadPointIndex + 1;
-				while( Road.NodeIndices[ LaterNodeRoadPointIndex ] == INDEX_NONE )
-				{
-					++LaterNodeRoadPointIndex;
-				}
-				const int32 LaterNodeIndex = Road.NodeIndices[ LaterNodeRoadPointIndex ];
-
-				const FStreetMapNode& LaterNode = StreetMap.GetNodes()[ LaterNodeIndex ];
-				ConnectedNode = &LaterNode;
-				if( OutConnectingRoad != nullptr )
-				{
-					*OutConnectingRoad = &Road;
-				}
-				if( OutPointIndexOnRoad != nullptr )
-				{
-					*OutPointIndexOnRoad = RoadRef.RoadPointIndex;
-				}
-				if( OutConnectedNodePointIndexOnRoad != nullptr )
-				{
-					*OutConnectedNodePointIndexOnRoad = LaterNodeRoadPointIndex;
-				}
-
-				// Got it!
-				break;
-			}
-
-			++CurrentConnectionIndex;
-		}
+		*OutPointIndexOnRoad = Connection.PointIndexOnRoad;
+	}
+	if( OutConnectedNodePointIndexOnRoad != nullptr )
+	{
+		*OutConnectedNodePointIndexOnRoad = Connection.ConnectedNodePointIndexOnRoad;
 	}
 
-	check( ConnectedNode != nullptr );
-	return ConnectedNode;
+	return &StreetMap.GetNodes()[ Connection.NodeIndex ];
 }
 
 
 inline float FStreetMapNode::GetConnectionCost( const UStreetMap& StreetMap, const int32 ConnectionIndex, const bool bIsTravelingForward ) const
+{
+	return StreetMap.GetConnections( GetNodeIndex( StreetMap ), bIsTravelingForward )[ ConnectionIndex ].Cost;
+}
+
+
+inline float FStreetMapNode::EstimateTravelCost( const FStreetMapRoad& ConnectingRoad, const float DistanceBetweenNodes )
 {
 	/////////////////////////////////////////////////////////
 	// Tweakables for connection cost estimation
@@ -827,21 +1182,13 @@ inline float FStreetMapNode::GetConnectionCost( const UStreetMap& StreetMap, con
 	//        future we could consider taking into account the cost of different types of turns and
 	//        intersections, lane counts, actual speed limits, etc.
 
-	int32 MyPointIndexOnRoad;
-	int32 ConnectedNodePointIndexOnRoad;
-
-	const FStreetMapRoad* ConnectingRoad = nullptr;
-	const FStreetMapNode& ConnectedNode = *GetConnection( StreetMap, ConnectionIndex, bIsTravelingForward, /* Out */ &ConnectingRoad, /* Out */ &MyPointIndexOnRoad, /* Out */ &ConnectedNodePointIndexOnRoad );
-
-	const float DistanceBetweenNodes = ConnectingRoad->ComputeDistanceBetweenNodesOnRoad( StreetMap, MyPointIndexOnRoad, ConnectedNodePointIndexOnRoad );
-	
 	float TotalCost = DistanceBetweenNodes;
 
 	// Apply some scaling to the cost of traveling between these nodes
 	{
 		float SpeedLimit = 0.0f;
 		float TrafficFactor = 0.0f;
-		switch( ConnectingRoad->RoadType )
+		switch( ConnectingRoad.RoadType )
 		{
 			case EStreetMapRoadType::Highway:
 				SpeedLimit = HighwaySpeed;
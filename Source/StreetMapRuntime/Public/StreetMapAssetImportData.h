@@ -0,0 +1,21 @@
+#pragma once
+#include "EditorFramework/AssetImportData.h"
+#include "StreetMapAssetImportData.generated.h"
+
+/** Import data for street maps.  On top of the source file's timestamp and hash, this remembers enough about the last
+    import for a reimport to tell quickly whether it would change anything. */
+UCLASS()
+class STREETMAPRUNTIME_API UStreetMapAssetImportData : public UAssetImportData
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Size of the source file when it was imported, in bytes.  Negative if unknown. */
+	UPROPERTY()
+	int64 SourceFileSize = -1;
+
+	/** Hash of the import settings (and importer version) the street map was built with */
+	UPROPERTY()
+	uint32 ImportSettingsHash = 0;
+};
@@ -85,6 +85,26 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "StreetMap")
 		void SetStreetMap(UStreetMap* NewStreetMap, bool bClearPreviousMeshIfAny = false, bool bRebuildMesh = false);
 
+	/**
+	 * Converts a latitude and longitude to a location in the world, using the street map's projection and this
+	 * component's transform.  Returns false if there's no street map, or it doesn't know how it was projected.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+		bool GeoToWorld(double Latitude, double Longitude, FVector& OutWorldLocation) const;
+
+	/**
+	 * Converts a location in the world to the latitude and longitude under it, using the street map's projection and
+	 * this component's transform.  Returns false if there's no street map, or it doesn't know how it was projected.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "StreetMap")
+		bool WorldToGeo(const FVector& WorldLocation, double& OutLatitude, double& OutLongitude) const;
+
+	/** Converts many latitudes and longitudes to world locations at once (see GeoToWorld.)  All arrays must be the same size. */
+	bool GeoToWorldBatch(const TArrayView<const double> Latitudes, const TArrayView<const double> Longitudes, TArrayView<FVector> OutWorldLocations) const;
+
+	/** Converts many world locations to latitudes and longitudes at once (see WorldToGeo.)  All arrays must be the same size. */
+	bool WorldToGeoBatch(const TArrayView<const FVector> WorldLocations, TArrayView<double> OutLatitudes, TArrayView<double> OutLongitudes) const;
+
 
 
 	//** Begin Interface_CollisionDataProvider Interface */
@@ -0,0 +1,74 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "StreetMapProjection.generated.h"
+
+/** Ways of flattening latitudes and longitudes onto a street map */
+UENUM( BlueprintType )
+enum class EStreetMapProjectionType : uint8
+{
+	/** Sanson-Flamsteed (sinusoidal) projection.  Cheap, and true to scale along every parallel, but shapes shear the
+	    further east or west they are from the origin. */
+	Sinusoidal,
+
+	/** Transverse Mercator projection of the WGS 84 ellipsoid, with its central meridian through the origin (like a
+	    UTM zone that is centered on the map.)  Shapes and distances stay true for hundreds of kilometers around the
+	    origin, so this is the one to use for big maps. */
+	TransverseMercator,
+
+	/** Spherical (Web) Mercator projection, as used by web map tiles, scaled so that distances are true at the origin's
+	    latitude.  Distances stretch further north or south of the origin. */
+	WebMercator,
+};
+
+
+/**
+ * How a street map's latitudes and longitudes were flattened into map space, so that geographic locations (GPS
+ * readings, for example) can be placed on the map and map locations can be turned back into latitudes and longitudes.
+ * In map space, X points east and Y points south.
+ */
+USTRUCT( BlueprintType )
+struct STREETMAPRUNTIME_API FStreetMapProjection
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Which projection is used */
+	UPROPERTY( Category=StreetMap, EditAnywhere, BlueprintReadOnly )
+	EStreetMapProjectionType Type = EStreetMapProjectionType::Sinusoidal;
+
+	/** Latitude that maps to the origin */
+	UPROPERTY( Category=StreetMap, EditAnywhere, BlueprintReadOnly )
+	double OriginLatitude = 0.0;
+
+	/** Longitude that maps to the origin */
+	UPROPERTY( Category=StreetMap, EditAnywhere, BlueprintReadOnly )
+	double OriginLongitude = 0.0;
+
+	/** Map units per meter.  Zero if the street map was imported before we kept track of its projection. */
+	UPROPERTY( Category=StreetMap, EditAnywhere, BlueprintReadOnly )
+	double UnitsPerMeter = 0.0;
+
+	/** Subtracted from every projected location.  Tiles use this to be relative to their own middle. */
+	UPROPERTY( Category=StreetMap, EditAnywhere, BlueprintReadOnly )
+	FVector2D Offset = FVector2D::ZeroVector;
+
+
+	/** Returns true if we know how the street map was projected */
+	bool IsValid() const
+	{
+		return UnitsPerMeter > 0.0;
+	}
+
+	/** Converts a latitude and longitude (in degrees) to a location in map space */
+	FVector2D GeoToWorld( const double Latitude, const double Longitude ) const;
+
+	/** Converts a location in map space to a latitude and longitude (in degrees) */
+	void WorldToGeo( const FVector2D Location, double& OutLatitude, double& OutLongitude ) const;
+
+	/** Converts many latitudes and longitudes to map space at once.  Big batches are split up across the available
+	    cores, and sinusoidal projections work on a whole vector register of locations at a time.  All arrays must be
+	    the same size. */
+	void GeoToWorld( const TArrayView<const double> Latitudes, const TArrayView<const double> Longitudes, TArrayView<FVector2D> OutLocations ) const;
+
+	/** Converts many locations in map space to latitudes and longitudes at once.  All arrays must be the same size. */
+	void WorldToGeo( const TArrayView<const FVector2D> Locations, TArrayView<double> OutLatitudes, TArrayView<double> OutLongitudes ) const;
+};
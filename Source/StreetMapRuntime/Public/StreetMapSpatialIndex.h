@@ -0,0 +1,116 @@
+#pragma once
+#include "CoreMinimal.h"
+
+class UStreetMap;
+struct FStreetMapRoadRef;
+
+/**
+ * Uniform grid over the road segments, nodes and buildings of a street map, for finding what's near a location without
+ * looking at everything on the map.  Each cell lists what overlaps it, and the lists of every cell are packed one after
+ * another.  Street maps build their index when they're loaded, and again when UStreetMap::RebuildSpatialIndex() is
+ * called after their roads or buildings have been replaced; nothing else changes it.  Queries never change the index
+ * either, so any number of threads can run them at once without locking, as long as nobody is replacing the roads or
+ * buildings at the same time.
+ *
+ * Road segments are given as the road ref of the point they start at, and end at the next point along the road.
+ */
+class STREETMAPRUNTIME_API FStreetMapSpatialIndex
+{
+
+public:
+
+	/** Builds the index over everything in a street map */
+	void Build( const UStreetMap& StreetMap );
+
+	/** Empties the index */
+	void Reset();
+
+	/** Returns true if the index has anything in it */
+	bool IsBuilt() const
+	{
+		return CellCountX > 0;
+	}
+
+	/** Finds the road segments that cross a box */
+	void FindRoadSegmentsInBox( const UStreetMap& StreetMap, const FBox2D& Box, TArray<FStreetMapRoadRef>& OutSegments ) const;
+
+	/** Finds the road segments that come within some distance of a location */
+	void FindRoadSegmentsInRadius( const UStreetMap& StreetMap, const FVector2D Center, const double Radius, TArray<FStreetMapRoadRef>& OutSegments ) const;
+
+	/** Finds the nodes inside a box */
+	void FindNodesInBox( const UStreetMap& StreetMap, const FBox2D& Box, TArray<int32>& OutNodeIndices ) const;
+
+	/** Finds the nodes within some distance of a location */
+	void FindNodesInRadius( const UStreetMap& StreetMap, const FVector2D Center, const double Radius, TArray<int32>& OutNodeIndices ) const;
+
+	/** Finds the buildings whose bounds overlap a box */
+	void FindBuildingsInBox( const UStreetMap& StreetMap, const FBox2D& Box, TArray<int32>& OutBuildingIndices ) const;
+
+	/** Finds the buildings whose footprint comes within some distance of a location (or contains it) */
+	void FindBuildingsInRadius( const UStreetMap& StreetMap, const FVector2D Center, const double Radius, TArray<int32>& OutBuildingIndices ) const;
+
+	/** Finds the road segment nearest to a location, and the point on it that is nearest.  Returns false if there's
+	    no road segment within MaxDistance. */
+	bool FindNearestRoadSegment( const UStreetMap& StreetMap, const FVector2D Location, const double MaxDistance, FStreetMapRoadRef& OutSegment, FVector2D& OutNearestPoint ) const;
+
+	/** Finds up to Count nodes nearest to a location, nearest first, leaving out any further away than MaxDistance */
+	void FindNearestNodes( const UStreetMap& StreetMap, const FVector2D Location, const int32 Count, const double MaxDistance, TArray<int32>& OutNodeIndices ) const;
+
+
+private:
+
+	/** A road segment, listed in every cell its bounds overlap */
+	struct FSegment
+	{
+		int32 RoadIndex;
+		int32 PointIndex;
+	};
+
+	/** Gets the start and end of a road segment.  Returns false if the street map no longer has it. */
+	static bool GetSegmentPoints( const UStreetMap& StreetMap, const FSegment& Segment, FVector2D& OutStart, FVector2D& OutEnd );
+
+	/** Returns the grid coordinates of the cell a location is in, clamped to the grid */
+	FIntPoint GetCell( const FVector2D Location ) const;
+
+	/** Returns the grid coordinates of the first and last (inclusive) cells that a box overlaps, clamped to the grid */
+	FIntRect GetCellRange( const FBox2D& Box ) const;
+
+	/** Returns true if a cell is the one that reports an item overlapping a query box.  Items that are listed in more
+		than one cell are only reported by the cell where the overlap starts, so that each is only found once. */
+	bool IsReportingCell( const FVector2D ItemBoundsMin, const FBox2D& QueryBox, const int32 CellX, const int32 CellY ) const;
+
+	/** Fills in the packed per-cell lists of one kind of item.  ForEachItem is called twice with a visitor, which it
+		must call with the bounds of every item and the item to list. */
+	template<typename ItemType, typename ForEachItemType>
+	void BuildCellLists( ForEachItemType ForEachItem, TArray<int32>& OutOffsets, TArray<ItemType>& OutItems ) const;
+
+	/** Visits the cells around a location a ring at a time, nearest first, for as long as the next ring could still
+		hold something closer than GetMaxDistanceSquared() */
+	template<typename VisitCellType, typename GetMaxDistanceSquaredType>
+	void VisitCellsOutward( const FVector2D Location, VisitCellType VisitCell, GetMaxDistanceSquaredType GetMaxDistanceSquared ) const;
+
+	// Corner of the first cell
+	FVector2D Origin = FVector2D::ZeroVector;
+
+	// Width and height of each cell
+	double CellSize = 0.0;
+
+	// Number of cells across and down the grid
+	int32 CellCountX = 0;
+	int32 CellCountY = 0;
+
+	// Where each cell's road segments start in SegmentCells, plus one more for the end of the last cell's
+	TArray<int32> SegmentCellOffsets;
+	TArray<FSegment> SegmentCells;
+
+	// Where each cell's nodes start in NodeCells, plus one more for the end of the last cell's
+	TArray<int32> NodeCellOffsets;
+	TArray<int32> NodeCells;
+
+	// Where each cell's buildings start in BuildingCells, plus one more for the end of the last cell's
+	TArray<int32> BuildingCellOffsets;
+	TArray<int32> BuildingCells;
+
+	// Location of every node, so that node queries don't need to go through the roads
+	TArray<FVector2D> NodeLocations;
+};
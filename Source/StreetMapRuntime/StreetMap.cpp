@@ -1,14 +1,565 @@
 #include "StreetMap.h"
-#include "EditorFramework/AssetImportData.h"
+#include "StreetMapAssetImportData.h"
+#include "StreetMapCustomVersion.h"
+#include "Serialization/CustomVersion.h"
+#include "Misc/ScopeExit.h"
+
+const FGuid FStreetMapCustomVersion::GUID( 0x5A3C91E2, 0x4B7D4F08, 0x9E26D1C3, 0x7F0B84A5 );
+
+// Register the custom version with core
+FCustomVersionRegistration GRegisterStreetMapCustomVersion( FStreetMapCustomVersion::GUID, FStreetMapCustomVersion::LatestVersion, TEXT( "StreetMapVer" ) );
+
+namespace StreetMap
+{
+	/** Ways that road and building points can be saved */
+	enum class EPointFormat : uint8
+	{
+		// Full precision, in bulk
+		FullPrecision,
+
+		// Whole steps from the minimum bounds of the road or building, as varint-encoded differences
+		Quantized,
+	};
+
+	/** Largest number of steps a quantized point can be from its road's or building's minimum bounds */
+	static const double MaxQuantizedSteps = double( 1ll << 50 );
+
+	/** Number of doubles that fit in a vector register */
+	static const int32 DoublesPerVector = 4;
+
+	/** Appends a signed value as a zigzag-encoded varint, which keeps small values small whatever their sign */
+	static void AppendZigzagVarint( const int64 SignedValue, TArray<uint8>& Bytes )
+	{
+		uint64 Value = ( uint64( SignedValue ) << 1 ) ^ uint64( SignedValue >> 63 );
+		while( Value >= 0x80 )
+		{
+			Bytes.Add( uint8( Value | 0x80 ) );
+			Value >>= 7;
+		}
+		Bytes.Add( uint8( Value ) );
+	}
+
+	/** Reads a zigzag-encoded varint.  Returns false if the bytes run out first. */
+	static bool ReadZigzagVarint( const TArray<uint8>& Bytes, int32& ByteIndex, int64& OutSignedValue )
+	{
+		uint64 Value = 0;
+		for( int32 Shift = 0; Shift < 64 && ByteIndex < Bytes.Num(); Shift += 7 )
+		{
+			const uint8 Byte = Bytes[ ByteIndex++ ];
+			Value |= uint64( Byte & 0x7f ) << Shift;
+			if( ( Byte & 0x80 ) == 0 )
+			{
+				OutSignedValue = int64( Value >> 1 ) ^ -int64( Value & 1 );
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** Appends the points of one road or building as the differences between their whole steps from the minimum bounds */
+	static void EncodeQuantizedPoints( const TArrayView<const FVector2D> Points, const FVector2D BoundsMin, const double Step, TArray<uint8>& Bytes )
+	{
+		int64 PreviousX = 0;
+		int64 PreviousY = 0;
+		for( const FVector2D& Point : Points )
+		{
+			const int64 X = int64( FMath::Clamp( FMath::RoundToDouble( ( Point.X - BoundsMin.X ) / Step ), -MaxQuantizedSteps, MaxQuantizedSteps ) );
+			const int64 Y = int64( FMath::Clamp( FMath::RoundToDouble( ( Point.Y - BoundsMin.Y ) / Step ), -MaxQuantizedSteps, MaxQuantizedSteps ) );
+			AppendZigzagVarint( X - PreviousX, Bytes );
+			AppendZigzagVarint( Y - PreviousY, Bytes );
+			PreviousX = X;
+			PreviousY = Y;
+		}
+	}
+
+	/** Decodes the points of one road or building.  Returns false if the bytes run out first. */
+	static bool DecodeQuantizedPoints( const TArray<uint8>& Bytes, int32& ByteIndex, const FVector2D BoundsMin, const double Step, TArrayView<FVector2D> OutPoints )
+	{
+		static_assert( sizeof( FVector2D ) == 2 * sizeof( double ), "Points are dequantized as a flat list of doubles" );
+
+		// Add up the differences into whole steps first, straight into the points
+		int64 X = 0;
+		int64 Y = 0;
+		for( FVector2D& Point : OutPoints )
+		{
+			int64 DifferenceX;
+			int64 DifferenceY;
+			if( !ReadZigzagVarint( Bytes, ByteIndex, DifferenceX ) || !ReadZigzagVarint( Bytes, ByteIndex, DifferenceY ) )
+			{
+				return false;
+			}
+			X += DifferenceX;
+			Y += DifferenceY;
+			Point = FVector2D( double( X ), double( Y ) );
+		}
+
+		// Then scale and offset the steps, two points to a vector register
+		double* Values = reinterpret_cast<double*>( OutPoints.GetData() );
+		const int32 ValueCount = OutPoints.Num() * 2;
+		const int32 VectorizedValueCount = ValueCount - ValueCount % DoublesPerVector;
+		const VectorRegister4Double Steps = VectorSetFloat1( Step );
+		const VectorRegister4Double Origins = MakeVectorRegisterDouble( BoundsMin.X, BoundsMin.Y, BoundsMin.X, BoundsMin.Y );
+		for( int32 ValueIndex = 0; ValueIndex < VectorizedValueCount; ValueIndex += DoublesPerVector )
+		{
+			VectorStore( VectorMultiplyAdd( VectorLoad( Values + ValueIndex ), Steps, Origins ), Values + ValueIndex );
+		}
+		for( int32 ValueIndex = VectorizedValueCount; ValueIndex < ValueCount; ValueIndex += 2 )
+		{
+			Values[ ValueIndex ] = BoundsMin.X + Values[ ValueIndex ] * Step;
+			Values[ ValueIndex + 1 ] = BoundsMin.Y + Values[ ValueIndex + 1 ] * Step;
+		}
+		return true;
+	}
+}
+
+
+FStreetMapImportSettings::FStreetMapImportSettings()
+	: Projection( EStreetMapProjectionType::Sinusoidal ),
+	  bOnlyKeepReferencedNodes( false ),
+	  bOutOfCoreNodes( false ),
+	  OutOfCoreNodeMemoryBudget( 1024 ),
+	  bClipToBounds( false ),
+	  ClipMinLatitude( -90.0 ),
+	  ClipMaxLatitude( 90.0 ),
+	  ClipMinLongitude( -180.0 ),
+	  ClipMaxLongitude( 180.0 ),
+	  TileSize( 0.0f )
+{
+	const bool bKeep = true;
+	const bool bIsBuilding = true;
+
+	// Motorways, trunk roads and primary roads (including their sliproads) become highways
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "motorway" ), bKeep, !bIsBuilding, EStreetMapRoadType::Highway );
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "motorway_link" ), bKeep, !bIsBuilding, EStreetMapRoadType::Highway );
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "trunk" ), bKeep, !bIsBuilding, EStreetMapRoadType::Highway );
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "trunk_link" ), bKeep, !bIsBuilding, EStreetMapRoadType::Highway );
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "primary" ), bKeep, !bIsBuilding, EStreetMapRoadType::Highway );
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "primary_link" ), bKeep, !bIsBuilding, EStreetMapRoadType::Highway );
+
+	// Secondary and tertiary roads become major roads
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "secondary" ), bKeep, !bIsBuilding, EStreetMapRoadType::MajorRoad );
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "secondary_link" ), bKeep, !bIsBuilding, EStreetMapRoadType::MajorRoad );
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "tertiary" ), bKeep, !bIsBuilding, EStreetMapRoadType::MajorRoad );
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "tertiary_link" ), bKeep, !bIsBuilding, EStreetMapRoadType::MajorRoad );
+
+	// Everything else that cars can drive on becomes a street
+	// @todo: Consider excluding "road" from our data set, as it could be a highway that wasn't properly tagged in OSM yet
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "residential" ), bKeep, !bIsBuilding, EStreetMapRoadType::Street );
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "service" ), bKeep, !bIsBuilding, EStreetMapRoadType::Street );
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "unclassified" ), bKeep, !bIsBuilding, EStreetMapRoadType::Street );
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "road" ), bKeep, !bIsBuilding, EStreetMapRoadType::Street );
+
+	// Any kind of building.  See http://wiki.openstreetmap.org/wiki/Key:building
+	TagRules.Emplace( TEXT( "building" ), TEXT( "*" ), bKeep, bIsBuilding, EStreetMapRoadType::Other );
+
+	// Paths, tracks, lifecycle values and anything we don't recognize are skipped
+	TagRules.Emplace( TEXT( "highway" ), TEXT( "*" ), !bKeep, !bIsBuilding, EStreetMapRoadType::Other );
+}
+
+
+void FStreetMapOSMSource::SetPointNodeIDs( const TArrayView<const int64> NodeIDs )
+{
+	PointNodeIDs.Reset();
+	PointNodeIDs.Reserve( NodeIDs.Num() * 3 );
+
+	int64 PreviousNodeID = 0;
+	for( const int64 NodeID : NodeIDs )
+	{
+		StreetMap::AppendZigzagVarint( NodeID - PreviousNodeID, PointNodeIDs );
+		PreviousNodeID = NodeID;
+	}
+}
+
+
+void FStreetMapOSMSource::GetPointNodeIDs( TArray<int64>& OutNodeIDs ) const
+{
+	OutNodeIDs.Reset();
+
+	int64 PreviousNodeID = 0;
+	uint64 Value = 0;
+	int32 Shift = 0;
+	for( const uint8 Byte : PointNodeIDs )
+	{
+		Value |= uint64( Byte & 0x7f ) << Shift;
+		Shift += 7;
+		if( ( Byte & 0x80 ) == 0 )
+		{
+			const int64 Difference = int64( Value >> 1 ) ^ -int64( Value & 1 );
+			PreviousNodeID += Difference;
+			OutNodeIDs.Add( PreviousNodeID );
+
+			Value = 0;
+			Shift = 0;
+		}
+	}
+}
+
 
 UStreetMap::UStreetMap()
 {
 #if WITH_EDITORONLY_DATA
 	if( !HasAnyFlags( RF_ClassDefaultObject ) )
 	{
-		AssetImportData = NewObject<UAssetImportData>( this, TEXT( "AssetImportData" ) );
+		// Street maps saved before we had our own import data have a plain UAssetImportData named "AssetImportData",
+		// which replaces this one when they're loaded.  A different name keeps the two from colliding.
+		AssetImportData = NewObject<UStreetMapAssetImportData>( this, TEXT( "StreetMapAssetImportData" ) );
+	}
+#endif
+}
+
+
+void UStreetMap::Serialize( FArchive& Ar )
+{
+	using namespace StreetMap;
+
+	Ar.UsingCustomVersion( FStreetMapCustomVersion::GUID );
+
+	// Compact building points are taken out of the buildings while their properties are saved, and saved after them
+	// instead, along with the road points.  Undo and duplication always use full precision.
+	EPointFormat PointFormat = EPointFormat::FullPrecision;
+	double QuantizationStep = 0.0;
+#if WITH_EDITORONLY_DATA
+	if( Ar.IsSaving() && Ar.IsPersistent() && !Ar.IsTransacting() )
+	{
+		if( bSaveQuantizedPoints )
+		{
+			PointFormat = EPointFormat::Quantized;
+			QuantizationStep = FMath::Max( double( PointQuantizationStep ), double( KINDA_SMALL_NUMBER ) );
+		}
 	}
 #endif
+	TArray<TArray<FVector2D>> SavedBuildingPoints;
+	if( PointFormat != EPointFormat::FullPrecision )
+	{
+		SavedBuildingPoints.SetNum( Buildings.Num() );
+		for( int32 BuildingIndex = 0; BuildingIndex < Buildings.Num(); ++BuildingIndex )
+		{
+			SavedBuildingPoints[ BuildingIndex ] = MoveTemp( Buildings[ BuildingIndex ].BuildingPoints );
+		}
+	}
+
+	Super::Serialize( Ar );
+
+	// The spatial index is never saved, so rebuild it once everything else is loaded, however loading ends
+	ON_SCOPE_EXIT
+	{
+		if( Ar.IsLoading() )
+		{
+			if( Ar.IsError() )
+			{
+				SpatialIndex.Reset();
+			}
+			else
+			{
+				SpatialIndex.Build( *this );
+			}
+		}
+	};
+
+	const int32 Version = Ar.CustomVer( FStreetMapCustomVersion::GUID );
+	if( Version < FStreetMapCustomVersion::PackedRoadsAndNodes )
+	{
+#if WITH_EDITORONLY_DATA
+		if( Ar.IsLoading() )
+		{
+			PackDeprecatedRoadsAndNodes();
+		}
+#endif
+		return;
+	}
+
+	// Road points, node indices and road refs are saved in bulk after the properties, which only say which part of
+	// them each road and node has
+	if( Version >= FStreetMapCustomVersion::QuantizedPoints )
+	{
+		Ar << PointFormat;
+		if( PointFormat > EPointFormat::Quantized )
+		{
+			Ar.SetError();
+			return;
+		}
+	}
+
+	RoadNodeIndices.BulkSerialize( Ar );
+	NodeRoadRefs.BulkSerialize( Ar );
+	if( PointFormat == EPointFormat::FullPrecision )
+	{
+		RoadPoints.BulkSerialize( Ar );
+		if( Ar.IsLoading() && !BindRoadsAndNodes() )
+		{
+			Ar.SetError();
+		}
+		return;
+	}
+	if( Ar.IsLoading() )
+	{
+		RoadPoints.SetNumZeroed( RoadNodeIndices.Num() );
+	}
+
+	// Compact road points are decoded straight into the buffer.  The roads are only bound once the points are final, so
+	// that their distances and connections are worked out from the points as they'll be used.
+	auto GetRoadPoints = [this]( const FStreetMapRoad& Road ) -> TArrayView<FVector2D>
+	{
+		const bool bIsInRange = Road.FirstPointIndex >= 0 && Road.PointCount >= 0 && Road.PointCount <= RoadPoints.Num() - Road.FirstPointIndex;
+		return bIsInRange ? TArrayView<FVector2D>( RoadPoints.GetData() + Road.FirstPointIndex, Road.PointCount ) : TArrayView<FVector2D>();
+	};
+
+	int32 BuildingCount = Buildings.Num();
+	Ar << BuildingCount;
+	if( BuildingCount != Buildings.Num() )
+	{
+		Ar.SetError();
+		return;
+	}
+
+	auto GetBuildingPoints = [&]( const int32 BuildingIndex ) -> const TArray<FVector2D>&
+	{
+		return Ar.IsSaving() ? SavedBuildingPoints[ BuildingIndex ] : Buildings[ BuildingIndex ].BuildingPoints;
+	};
+
+	if( PointFormat == EPointFormat::Quantized )
+	{
+		// Every point is encoded into one buffer, so that it's loaded in one go
+		Ar << QuantizationStep;
+		TArray<uint8> PointBytes;
+		if( Ar.IsSaving() )
+		{
+			PointBytes.Reserve( RoadPoints.Num() * 4 );
+			for( const FStreetMapRoad& Road : Roads )
+			{
+				EncodeQuantizedPoints( GetRoadPoints( Road ), Road.BoundsMin, QuantizationStep, PointBytes );
+			}
+			for( int32 BuildingIndex = 0; BuildingIndex < BuildingCount; ++BuildingIndex )
+			{
+				const TArray<FVector2D>& Points = GetBuildingPoints( BuildingIndex );
+				AppendZigzagVarint( Points.Num(), PointBytes );
+				EncodeQuantizedPoints( Points, Buildings[ BuildingIndex ].BoundsMin, QuantizationStep, PointBytes );
+			}
+		}
+
+		PointBytes.BulkSerialize( Ar );
+
+		if( Ar.IsLoading() )
+		{
+			int32 ByteIndex = 0;
+			bool bIsValid = QuantizationStep > 0.0;
+			for( int32 RoadIndex = 0; bIsValid && RoadIndex < Roads.Num(); ++RoadIndex )
+			{
+				const FStreetMapRoad& Road = Roads[ RoadIndex ];
+				bIsValid = DecodeQuantizedPoints( PointBytes, ByteIndex, Road.BoundsMin, QuantizationStep, GetRoadPoints( Road ) );
+			}
+			for( int32 BuildingIndex = 0; bIsValid && BuildingIndex < BuildingCount; ++BuildingIndex )
+			{
+				FStreetMapBuilding& Building = Buildings[ BuildingIndex ];
+				int64 PointCount = 0;
+				bIsValid = ReadZigzagVarint( PointBytes, ByteIndex, PointCount ) && PointCount >= 0 && PointCount <= PointBytes.Num() - ByteIndex;
+				if( bIsValid )
+				{
+					Building.BuildingPoints.SetNumUninitialized( int32( PointCount ) );
+					bIsValid = DecodeQuantizedPoints( PointBytes, ByteIndex, Building.BoundsMin, QuantizationStep, Building.BuildingPoints );
+				}
+			}
+			if( !bIsValid )
+			{
+				Ar.SetError();
+				return;
+			}
+		}
+	}
+
+	// Saving only reads the points, so the street map is left just as it was once the building points are put back
+	if( Ar.IsSaving() )
+	{
+		for( int32 BuildingIndex = 0; BuildingIndex < BuildingCount; ++BuildingIndex )
+		{
+			Buildings[ BuildingIndex ].BuildingPoints = MoveTemp( SavedBuildingPoints[ BuildingIndex ] );
+		}
+	}
+	else if( !BindRoadsAndNodes() )
+	{
+		Ar.SetError();
+	}
+}
+
+
+bool UStreetMap::SetRoadsAndNodes( TArray<FStreetMapRoad>&& InRoads, TArray<FStreetMapNode>&& InNodes, TArray<FVector2D>&& InRoadPoints, TArray<int32>&& InRoadNodeIndices, TArray<FStreetMapRoadRef>&& InNodeRoadRefs )
+{
+	Roads = MoveTemp( InRoads );
+	Nodes = MoveTemp( InNodes );
+	RoadPoints = MoveTemp( InRoadPoints );
+	RoadNodeIndices = MoveTemp( InRoadNodeIndices );
+	NodeRoadRefs = MoveTemp( InNodeRoadRefs );
+	return BindRoadsAndNodes();
+}
+
+
+bool UStreetMap::BindRoadsAndNodes()
+{
+	const bool bBuffersMatch = RoadNodeIndices.Num() == RoadPoints.Num();
+	bool bAllInRange = bBuffersMatch;
+
+	// Distances are only ever worked out here, so points that are moved afterwards need their roads bound again
+	RoadPointDistances.SetNumZeroed( RoadPoints.Num() );
+
+	for( FStreetMapRoad& Road : Roads )
+	{
+		// Roads that don't fit the buffers are emptied, so that their parts of the buffers can always be handed out
+		// without checking them again
+		const bool bIsInRange = bBuffersMatch && Road.FirstPointIndex >= 0 && Road.PointCount >= 0 && Road.PointCount <= RoadPoints.Num() - Road.FirstPointIndex;
+		if( !bIsInRange )
+		{
+			Road.FirstPointIndex = 0;
+			Road.PointCount = 0;
+			bAllInRange = false;
+			continue;
+		}
+
+		// Distances are added up at double precision, so long roads don't drift
+		const FVector2D* Points = RoadPoints.GetData() + Road.FirstPointIndex;
+		float* Distances = RoadPointDistances.GetData() + Road.FirstPointIndex;
+		double Distance = 0.0;
+		if( Road.PointCount > 0 )
+		{
+			Distances[ 0 ] = 0.0f;
+		}
+		for( int32 PointIndex = 1; PointIndex < Road.PointCount; ++PointIndex )
+		{
+			Distance += ( Points[ PointIndex ] - Points[ PointIndex - 1 ] ).Size();
+			Distances[ PointIndex ] = float( Distance );
+		}
+	}
+
+	for( FStreetMapNode& Node : Nodes )
+	{
+		const bool bIsInRange = Node.FirstRoadRefIndex >= 0 && Node.RoadRefCount >= 0 && Node.RoadRefCount <= NodeRoadRefs.Num() - Node.FirstRoadRefIndex;
+		if( !bIsInRange )
+		{
+			Node.FirstRoadRefIndex = 0;
+			Node.RoadRefCount = 0;
+			bAllInRange = false;
+		}
+	}
+
+	BuildConnections();
+
+	return bAllInRange;
+}
+
+
+void UStreetMap::BuildConnections()
+{
+	auto Build = [this]( const bool bIsTravelingForward, TArray<int32>& OutOffsets, TArray<FStreetMapConnection>& OutConnections )
+	{
+		// Adds a connection to the nearest node in one direction along a road, if there is one
+		auto AddConnection = [&]( const int32 RoadIndex, const int32 PointIndexOnRoad, const int32 Direction )
+		{
+			const FStreetMapRoad& Road = Roads[ RoadIndex ];
+			const TArrayView<const int32> NodeIndices = Road.GetNodeIndices( *this );
+			int32 ConnectedNodePointIndexOnRoad = PointIndexOnRoad + Direction;
+			while( NodeIndices.IsValidIndex( ConnectedNodePointIndexOnRoad ) && NodeIndices[ ConnectedNodePointIndexOnRoad ] == INDEX_NONE )
+			{
+				ConnectedNodePointIndexOnRoad += Direction;
+			}
+			if( NodeIndices.IsValidIndex( ConnectedNodePointIndexOnRoad ) && Nodes.IsValidIndex( NodeIndices[ ConnectedNodePointIndexOnRoad ] ) )
+			{
+				FStreetMapConnection& Connection = OutConnections.AddDefaulted_GetRef();
+				Connection.NodeIndex = NodeIndices[ ConnectedNodePointIndexOnRoad ];
+				Connection.RoadIndex = RoadIndex;
+				Connection.PointIndexOnRoad = PointIndexOnRoad;
+				Connection.ConnectedNodePointIndexOnRoad = ConnectedNodePointIndexOnRoad;
+				Connection.Cost = FStreetMapNode::EstimateTravelCost( Road, Road.ComputeDistanceBetweenNodesOnRoad( *this, PointIndexOnRoad, ConnectedNodePointIndexOnRoad ) );
+			}
+		};
+
+		OutOffsets.SetNumUninitialized( Nodes.Num() + 1 );
+		OutConnections.Reset( NodeRoadRefs.Num() * 2 );
+		for( int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex )
+		{
+			OutOffsets[ NodeIndex ] = OutConnections.Num();
+
+			// NOTE: Connections are listed in the order that FStreetMapNode::GetConnection() has always numbered them:
+			//       for each road ref, the earlier node up the road and then the later node down it
+			for( const FStreetMapRoadRef& RoadRef : Nodes[ NodeIndex ].GetRoadRefs( *this ) )
+			{
+				if( !Roads.IsValidIndex( RoadRef.RoadIndex ) || RoadRef.RoadPointIndex < 0 || RoadRef.RoadPointIndex >= Roads[ RoadRef.RoadIndex ].PointCount )
+				{
+					continue;
+				}
+
+				const FStreetMapRoad& Road = Roads[ RoadRef.RoadIndex ];
+				if( RoadRef.RoadPointIndex > 0 && ( !bIsTravelingForward || !Road.IsOneWay() ) )
+				{
+					AddConnection( RoadRef.RoadIndex, RoadRef.RoadPointIndex, -1 );
+				}
+				if( RoadRef.RoadPointIndex < ( Road.PointCount - 1 ) && ( bIsTravelingForward || !Road.IsOneWay() ) )
+				{
+					AddConnection( RoadRef.RoadIndex, RoadRef.RoadPointIndex, 1 );
+				}
+			}
+		}
+		OutOffsets.Last() = OutConnections.Num();
+	};
+
+	const bool bIsTravelingForward = true;
+	Build( bIsTravelingForward, ForwardConnectionOffsets, ForwardConnections );
+	Build( !bIsTravelingForward, BackwardConnectionOffsets, BackwardConnections );
+}
+
+
+#if WITH_EDITORONLY_DATA
+void UStreetMap::PackDeprecatedRoadsAndNodes()
+{
+	int32 TotalPointCount = 0;
+	for( const FStreetMapRoad& Road : Roads )
+	{
+		TotalPointCount += Road.RoadPoints_DEPRECATED.Num();
+	}
+	RoadPoints.Reset( TotalPointCount );
+	RoadNodeIndices.Reset( TotalPointCount );
+
+	for( FStreetMapRoad& Road : Roads )
+	{
+		Road.FirstPointIndex = RoadPoints.Num();
+		Road.PointCount = Road.RoadPoints_DEPRECATED.Num();
+		RoadPoints.Append( Road.RoadPoints_DEPRECATED );
+
+		// Every point should have a node index, but keep the buffers in step even if some don't
+		RoadNodeIndices.Append( Road.NodeIndices_DEPRECATED.GetData(), FMath::Min( Road.NodeIndices_DEPRECATED.Num(), Road.PointCount ) );
+		while( RoadNodeIndices.Num() < RoadPoints.Num() )
+		{
+			RoadNodeIndices.Add( INDEX_NONE );
+		}
+
+		Road.RoadPoints_DEPRECATED.Empty();
+		Road.NodeIndices_DEPRECATED.Empty();
+	}
+
+	int32 TotalRoadRefCount = 0;
+	for( const FStreetMapNode& Node : Nodes )
+	{
+		TotalRoadRefCount += Node.RoadRefs_DEPRECATED.Num();
+	}
+	NodeRoadRefs.Reset( TotalRoadRefCount );
+
+	for( FStreetMapNode& Node : Nodes )
+	{
+		Node.FirstRoadRefIndex = NodeRoadRefs.Num();
+		Node.RoadRefCount = Node.RoadRefs_DEPRECATED.Num();
+		NodeRoadRefs.Append( Node.RoadRefs_DEPRECATED );
+		Node.RoadRefs_DEPRECATED.Empty();
+	}
+
+	BindRoadsAndNodes();
+}
+#endif
+
+
+const FStreetMapTile* UStreetMap::FindTile( const FIntPoint InTileCoordinates ) const
+{
+	return Tiles.FindByPredicate( [InTileCoordinates]( const FStreetMapTile& Tile )
+	{
+		return Tile.Coordinates == InTileCoordinates;
+	} );
 }
 
 
@@ -265,11 +265,12 @@ void UStreetMapComponent::GenerateMesh()
 					break;
 			}
 			
-			for( int32 PointIndex = 0; PointIndex < Road.RoadPoints.Num() - 1; ++PointIndex )
+			const TArrayView<const FVector2D> RoadPoints = Road.GetRoadPoints( *StreetMap );
+			for( int32 PointIndex = 0; PointIndex < RoadPoints.Num() - 1; ++PointIndex )
 			{
 				AddThick2DLine( 
-					FVector2f(Road.RoadPoints[ PointIndex ]),
-					FVector2f(Road.RoadPoints[ PointIndex + 1 ]),
+					FVector2f(RoadPoints[ PointIndex ]),
+					FVector2f(RoadPoints[ PointIndex + 1 ]),
 					RoadZ,
 					RoadThickness,
 					RoadColor,
@@ -618,6 +619,75 @@ void UStreetMapComponent::AddTriangles( const TArray<FVector3f>& Points, const T
 };
 
 
+bool UStreetMapComponent::GeoToWorld(double Latitude, double Longitude, FVector& OutWorldLocation) const
+{
+	if (StreetMap == nullptr || !StreetMap->GetProjection().IsValid())
+	{
+		return false;
+	}
+
+	// Street maps are flat, and built at the component's origin
+	const FVector2D MapLocation = StreetMap->GetProjection().GeoToWorld(Latitude, Longitude);
+	OutWorldLocation = GetComponentTransform().TransformPosition(FVector(MapLocation, 0.0));
+	return true;
+}
+
+
+bool UStreetMapComponent::WorldToGeo(const FVector& WorldLocation, double& OutLatitude, double& OutLongitude) const
+{
+	if (StreetMap == nullptr || !StreetMap->GetProjection().IsValid())
+	{
+		return false;
+	}
+
+	const FVector LocalLocation = GetComponentTransform().InverseTransformPosition(WorldLocation);
+	StreetMap->GetProjection().WorldToGeo(FVector2D(LocalLocation), OutLatitude, OutLongitude);
+	return true;
+}
+
+
+bool UStreetMapComponent::GeoToWorldBatch(const TArrayView<const double> Latitudes, const TArrayView<const double> Longitudes, TArrayView<FVector> OutWorldLocations) const
+{
+	check(Latitudes.Num() == OutWorldLocations.Num());
+	if (StreetMap == nullptr || !StreetMap->GetProjection().IsValid())
+	{
+		return false;
+	}
+
+	TArray<FVector2D> MapLocations;
+	MapLocations.SetNumUninitialized(Latitudes.Num());
+	StreetMap->GetProjection().GeoToWorld(Latitudes, Longitudes, MapLocations);
+
+	const FTransform& ComponentTransform = GetComponentTransform();
+	for (int32 Index = 0; Index < MapLocations.Num(); ++Index)
+	{
+		OutWorldLocations[Index] = ComponentTransform.TransformPosition(FVector(MapLocations[Index], 0.0));
+	}
+	return true;
+}
+
+
+bool UStreetMapComponent::WorldToGeoBatch(const TArrayView<const FVector> WorldLocations, TArrayView<double> OutLatitudes, TArrayView<double> OutLongitudes) const
+{
+	check(WorldLocations.Num() == OutLatitudes.Num());
+	if (StreetMap == nullptr || !StreetMap->GetProjection().IsValid())
+	{
+		return false;
+	}
+
+	const FTransform& ComponentTransform = GetComponentTransform();
+	TArray<FVector2D> MapLocations;
+	MapLocations.SetNumUninitialized(WorldLocations.Num());
+	for (int32 Index = 0; Index < WorldLocations.Num(); ++Index)
+	{
+		MapLocations[Index] = FVector2D(ComponentTransform.InverseTransformPosition(WorldLocations[Index]));
+	}
+
+	StreetMap->GetProjection().WorldToGeo(MapLocations, OutLatitudes, OutLongitudes);
+	return true;
+}
+
+
 FString UStreetMapComponent::GetStreetMapAssetName() const
 {
 	return StreetMap != nullptr ? StreetMap->GetName() : FString(TEXT("NONE"));
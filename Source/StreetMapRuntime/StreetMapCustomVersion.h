@@ -0,0 +1,29 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+
+/** Changes to how street maps are saved */
+struct FStreetMapCustomVersion
+{
+	enum Type
+	{
+		// Before any version changes were made
+		BeforeCustomVersionWasAdded = 0,
+
+		// Road points, node indices and road refs are packed into buffers that all roads and nodes share
+		PackedRoadsAndNodes,
+
+		// Road and building points can be saved quantized and delta-encoded
+		QuantizedPoints,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	/** The GUID for this custom version number */
+	const static FGuid GUID;
+
+private:
+	FStreetMapCustomVersion() {}
+};
@@ -0,0 +1,361 @@
+#include "StreetMapProjection.h"
+#include "Async/ParallelFor.h"
+
+namespace StreetMapProjection
+{
+	// Sinusoidal projections have always used this for the length of a degree of latitude, so street maps still come
+	// out the same as they used to.  See https://en.wikipedia.org/wiki/Equator#Exact_length
+	static const double SinusoidalEarthCircumference = 40075036.0;
+
+	// WGS 84 ellipsoid
+	static const double EquatorialRadius = 6378137.0;
+	static const double Flattening = 1.0 / 298.257223563;
+
+	// Web Mercator can't reach the poles, so it's cut off where the map becomes square
+	static const double MaxWebMercatorLatitude = 85.051128779806589;
+
+	// Number of locations each task converts in the batched conversions
+	static const int32 LocationsPerTask = 16 * 1024;
+
+	// Number of locations that fit in a vector register
+	static const int32 LocationsPerVector = 4;
+
+	static double Sinh( const double X )
+	{
+		return 0.5 * ( FMath::Exp( X ) - FMath::Exp( -X ) );
+	}
+
+	static double Cosh( const double X )
+	{
+		return 0.5 * ( FMath::Exp( X ) + FMath::Exp( -X ) );
+	}
+
+	static double Atanh( const double X )
+	{
+		return 0.5 * FMath::Loge( ( 1.0 + X ) / ( 1.0 - X ) );
+	}
+
+
+	/** Krüger's series for the transverse Mercator projection, to fourth order in the ellipsoid's third flattening.
+	    Accurate to well under a millimeter within a few thousand kilometers of the central meridian.  See C. Karney,
+	    "Transverse Mercator with an accuracy of a few nanometers", J. Geodesy 85(8), 2011. */
+	struct FTransverseMercatorSeries
+	{
+		double Eccentricity;
+		double RectifyingRadius;
+		double Alpha[ 4 ];
+		double Beta[ 4 ];
+		double Delta[ 4 ];
+
+		FTransverseMercatorSeries()
+		{
+			const double N = Flattening / ( 2.0 - Flattening );
+			const double N2 = N * N;
+			const double N3 = N2 * N;
+			const double N4 = N3 * N;
+
+			Eccentricity = FMath::Sqrt( Flattening * ( 2.0 - Flattening ) );
+			RectifyingRadius = EquatorialRadius / ( 1.0 + N ) * ( 1.0 + N2 / 4.0 + N4 / 64.0 );
+
+			Alpha[ 0 ] = N / 2.0 - 2.0 * N2 / 3.0 + 5.0 * N3 / 16.0 + 41.0 * N4 / 180.0;
+			Alpha[ 1 ] = 13.0 * N2 / 48.0 - 3.0 * N3 / 5.0 + 557.0 * N4 / 1440.0;
+			Alpha[ 2 ] = 61.0 * N3 / 240.0 - 103.0 * N4 / 140.0;
+			Alpha[ 3 ] = 49561.0 * N4 / 161280.0;
+
+			Beta[ 0 ] = N / 2.0 - 2.0 * N2 / 3.0 + 37.0 * N3 / 96.0 - N4 / 360.0;
+			Beta[ 1 ] = N2 / 48.0 + N3 / 15.0 - 437.0 * N4 / 1440.0;
+			Beta[ 2 ] = 17.0 * N3 / 480.0 - 37.0 * N4 / 840.0;
+			Beta[ 3 ] = 4397.0 * N4 / 161280.0;
+
+			Delta[ 0 ] = 2.0 * N - 2.0 * N2 / 3.0 - 2.0 * N3 + 116.0 * N4 / 45.0;
+			Delta[ 1 ] = 7.0 * N2 / 3.0 - 8.0 * N3 / 5.0 - 227.0 * N4 / 45.0;
+			Delta[ 2 ] = 56.0 * N3 / 15.0 - 136.0 * N4 / 35.0;
+			Delta[ 3 ] = 4279.0 * N4 / 630.0;
+		}
+
+		/** Projects a location, relative to the central meridian, to its easting (X) and northing from the equator (Y) in meters */
+		FVector2D Forward( const double Latitude, const double RelativeLongitude ) const
+		{
+			const double SinLatitude = FMath::Sin( Latitude );
+			const double T = Sinh( Atanh( SinLatitude ) - Eccentricity * Atanh( Eccentricity * SinLatitude ) );
+			const double XiPrime = FMath::Atan2( T, FMath::Cos( RelativeLongitude ) );
+			const double EtaPrime = Atanh( FMath::Sin( RelativeLongitude ) / FMath::Sqrt( 1.0 + T * T ) );
+
+			double Xi = XiPrime;
+			double Eta = EtaPrime;
+			for( int32 Term = 0; Term < 4; ++Term )
+			{
+				const double Multiple = 2.0 * ( Term + 1 );
+				Xi += Alpha[ Term ] * FMath::Sin( Multiple * XiPrime ) * Cosh( Multiple * EtaPrime );
+				Eta += Alpha[ Term ] * FMath::Cos( Multiple * XiPrime ) * Sinh( Multiple * EtaPrime );
+			}
+			return FVector2D( RectifyingRadius * Eta, RectifyingRadius * Xi );
+		}
+
+		/** Turns an easting and northing in meters back into a latitude and a longitude relative to the central meridian */
+		void Inverse( const FVector2D EastingNorthing, double& OutLatitude, double& OutRelativeLongitude ) const
+		{
+			const double Xi = EastingNorthing.Y / RectifyingRadius;
+			const double Eta = EastingNorthing.X / RectifyingRadius;
+
+			double XiPrime = Xi;
+			double EtaPrime = Eta;
+			for( int32 Term = 0; Term < 4; ++Term )
+			{
+				const double Multiple = 2.0 * ( Term + 1 );
+				XiPrime -= Beta[ Term ] * FMath::Sin( Multiple * Xi ) * Cosh( Multiple * Eta );
+				EtaPrime -= Beta[ Term ] * FMath::Cos( Multiple * Xi ) * Sinh( Multiple * Eta );
+			}
+
+			const double Chi = FMath::Asin( FMath::Clamp( FMath::Sin( XiPrime ) / Cosh( EtaPrime ), -1.0, 1.0 ) );
+			OutLatitude = Chi;
+			for( int32 Term = 0; Term < 4; ++Term )
+			{
+				OutLatitude += Delta[ Term ] * FMath::Sin( 2.0 * ( Term + 1 ) * Chi );
+			}
+			OutRelativeLongitude = FMath::Atan2( Sinh( EtaPrime ), FMath::Cos( XiPrime ) );
+		}
+	};
+
+	static const FTransverseMercatorSeries& GetTransverseMercatorSeries()
+	{
+		static const FTransverseMercatorSeries Series;
+		return Series;
+	}
+
+
+	static double GetMercatorY( const double Latitude )
+	{
+		const double ClampedLatitude = FMath::Clamp( Latitude, -MaxWebMercatorLatitude, MaxWebMercatorLatitude );
+		return FMath::Loge( FMath::Tan( PI / 4.0 + FMath::DegreesToRadians( ClampedLatitude ) / 2.0 ) );
+	}
+
+
+	/** Everything about a projection that only depends on its origin, worked out once for each conversion call */
+	struct FProjector
+	{
+		const FStreetMapProjection& Projection;
+
+		// Sinusoidal: length of one degree of latitude.  Mercator: length of one radian along the origin's parallel.
+		double Scale;
+
+		// Transverse Mercator: northing of the origin, in meters.  Web Mercator: unscaled Y of the origin.
+		double OriginY;
+
+		explicit FProjector( const FStreetMapProjection& InProjection )
+			: Projection( InProjection ),
+			  Scale( 0.0 ),
+			  OriginY( 0.0 )
+		{
+			switch( Projection.Type )
+			{
+				case EStreetMapProjectionType::Sinusoidal:
+					Scale = SinusoidalEarthCircumference / 360.0 * Projection.UnitsPerMeter;
+					break;
+
+				case EStreetMapProjectionType::TransverseMercator:
+					OriginY = GetTransverseMercatorSeries().Forward( FMath::DegreesToRadians( Projection.OriginLatitude ), 0.0 ).Y;
+					break;
+
+				case EStreetMapProjectionType::WebMercator:
+					Scale = EquatorialRadius * FMath::Cos( FMath::DegreesToRadians( Projection.OriginLatitude ) ) * Projection.UnitsPerMeter;
+					OriginY = GetMercatorY( Projection.OriginLatitude );
+					break;
+			}
+		}
+
+		FVector2D Project( const double Latitude, const double Longitude ) const
+		{
+			const double RelativeLongitude = FMath::UnwindDegrees( Longitude - Projection.OriginLongitude );
+
+			FVector2D Location;
+			switch( Projection.Type )
+			{
+				case EStreetMapProjectionType::TransverseMercator:
+				{
+					const FVector2D EastingNorthing = GetTransverseMercatorSeries().Forward( FMath::DegreesToRadians( Latitude ), FMath::DegreesToRadians( RelativeLongitude ) );
+					Location = FVector2D( EastingNorthing.X, OriginY - EastingNorthing.Y ) * Projection.UnitsPerMeter;
+					break;
+				}
+
+				case EStreetMapProjectionType::WebMercator:
+					Location = FVector2D( FMath::DegreesToRadians( RelativeLongitude ), OriginY - GetMercatorY( Latitude ) ) * Scale;
+					break;
+
+				default:
+					Location = FVector2D(
+						RelativeLongitude * Scale * FMath::Cos( FMath::DegreesToRadians( Latitude ) ),
+						( Projection.OriginLatitude - Latitude ) * Scale );
+					break;
+			}
+			return Location - Projection.Offset;
+		}
+
+		void Unproject( const FVector2D InLocation, double& OutLatitude, double& OutLongitude ) const
+		{
+			const FVector2D Location = InLocation + Projection.Offset;
+
+			double RelativeLongitude = 0.0;
+			switch( Projection.Type )
+			{
+				case EStreetMapProjectionType::TransverseMercator:
+				{
+					double LatitudeRadians = 0.0;
+					double RelativeLongitudeRadians = 0.0;
+					const FVector2D EastingNorthing( Location.X / Projection.UnitsPerMeter, OriginY - Location.Y / Projection.UnitsPerMeter );
+					GetTransverseMercatorSeries().Inverse( EastingNorthing, LatitudeRadians, RelativeLongitudeRadians );
+					OutLatitude = FMath::RadiansToDegrees( LatitudeRadians );
+					RelativeLongitude = FMath::RadiansToDegrees( RelativeLongitudeRadians );
+					break;
+				}
+
+				case EStreetMapProjectionType::WebMercator:
+					OutLatitude = FMath::RadiansToDegrees( 2.0 * FMath::Atan( FMath::Exp( OriginY - Location.Y / Scale ) ) - PI / 2.0 );
+					RelativeLongitude = FMath::RadiansToDegrees( Location.X / Scale );
+					break;
+
+				default:
+				{
+					// Every longitude is at the poles, so we just pick the origin's
+					OutLatitude = Projection.OriginLatitude - Location.Y / Scale;
+					const double ParallelScale = Scale * FMath::Cos( FMath::DegreesToRadians( OutLatitude ) );
+					RelativeLongitude = FMath::Abs( ParallelScale ) > UE_DOUBLE_SMALL_NUMBER ? Location.X / ParallelScale : 0.0;
+					break;
+				}
+			}
+			OutLongitude = FMath::UnwindDegrees( Projection.OriginLongitude + RelativeLongitude );
+		}
+	};
+}
+
+
+FVector2D FStreetMapProjection::GeoToWorld( const double Latitude, const double Longitude ) const
+{
+	return StreetMapProjection::FProjector( *this ).Project( Latitude, Longitude );
+}
+
+
+void FStreetMapProjection::WorldToGeo( const FVector2D Location, double& OutLatitude, double& OutLongitude ) const
+{
+	StreetMapProjection::FProjector( *this ).Unproject( Location, OutLatitude, OutLongitude );
+}
+
+
+void FStreetMapProjection::GeoToWorld( const TArrayView<const double> Latitudes, const TArrayView<const double> Longitudes, TArrayView<FVector2D> OutLocations ) const
+{
+	using namespace StreetMapProjection;
+
+	check( Latitudes.Num() == Longitudes.Num() && Latitudes.Num() == OutLocations.Num() );
+
+	const FProjector Projector( *this );
+	const int32 TaskCount = FMath::DivideAndRoundUp( Latitudes.Num(), LocationsPerTask );
+	ParallelFor( TaskCount, [this, &Projector, Latitudes, Longitudes, OutLocations]( const int32 TaskIndex ) mutable
+	{
+		const int32 FirstIndex = TaskIndex * LocationsPerTask;
+		const int32 EndIndex = FMath::Min( FirstIndex + LocationsPerTask, Latitudes.Num() );
+
+		// The cosine is what makes sinusoidal projections expensive, so we compute it for a whole register of
+		// locations at a time
+		int32 Index = FirstIndex;
+		if( Type == EStreetMapProjectionType::Sinusoidal )
+		{
+			const VectorRegister4Double DegreesToRadians = VectorSetFloat1( PI / 180.0 );
+			const VectorRegister4Double OriginLatitudes = VectorSetFloat1( OriginLatitude );
+			const VectorRegister4Double OriginLongitudes = VectorSetFloat1( OriginLongitude );
+			const VectorRegister4Double Scale = VectorSetFloat1( Projector.Scale );
+			const VectorRegister4Double OffsetX = VectorSetFloat1( Offset.X );
+			const VectorRegister4Double OffsetY = VectorSetFloat1( Offset.Y );
+
+			for( ; Index + LocationsPerVector <= EndIndex; Index += LocationsPerVector )
+			{
+				const VectorRegister4Double Latitude = VectorLoad( Latitudes.GetData() + Index );
+				const VectorRegister4Double Longitude = VectorLoad( Longitudes.GetData() + Index );
+
+				// Maps that cross the antimeridian have longitudes on both sides of it
+				alignas( 32 ) double RelativeLongitudes[ LocationsPerVector ];
+				VectorStoreAligned( VectorSubtract( Longitude, OriginLongitudes ), RelativeLongitudes );
+				for( int32 Lane = 0; Lane < LocationsPerVector; ++Lane )
+				{
+					RelativeLongitudes[ Lane ] = FMath::UnwindDegrees( RelativeLongitudes[ Lane ] );
+				}
+
+				const VectorRegister4Double CosLatitude = VectorCos( VectorMultiply( Latitude, DegreesToRadians ) );
+				const VectorRegister4Double X = VectorSubtract( VectorMultiply( VectorMultiply( VectorLoadAligned( RelativeLongitudes ), Scale ), CosLatitude ), OffsetX );
+				const VectorRegister4Double Y = VectorSubtract( VectorMultiply( VectorSubtract( OriginLatitudes, Latitude ), Scale ), OffsetY );
+
+				alignas( 32 ) double Xs[ LocationsPerVector ];
+				alignas( 32 ) double Ys[ LocationsPerVector ];
+				VectorStoreAligned( X, Xs );
+				VectorStoreAligned( Y, Ys );
+				for( int32 Lane = 0; Lane < LocationsPerVector; ++Lane )
+				{
+					OutLocations[ Index + Lane ] = FVector2D( Xs[ Lane ], Ys[ Lane ] );
+				}
+			}
+		}
+
+		// Leftovers, and the other projections
+		for( ; Index < EndIndex; ++Index )
+		{
+			OutLocations[ Index ] = Projector.Project( Latitudes[ Index ], Longitudes[ Index ] );
+		}
+	} );
+}
+
+
+void FStreetMapProjection::WorldToGeo( const TArrayView<const FVector2D> Locations, TArrayView<double> OutLatitudes, TArrayView<double> OutLongitudes ) const
+{
+	using namespace StreetMapProjection;
+
+	check( Locations.Num() == OutLatitudes.Num() && Locations.Num() == OutLongitudes.Num() );
+
+	const FProjector Projector( *this );
+	const int32 TaskCount = FMath::DivideAndRoundUp( Locations.Num(), LocationsPerTask );
+	ParallelFor( TaskCount, [this, &Projector, Locations, OutLatitudes, OutLongitudes]( const int32 TaskIndex ) mutable
+	{
+		const int32 FirstIndex = TaskIndex * LocationsPerTask;
+		const int32 EndIndex = FMath::Min( FirstIndex + LocationsPerTask, Locations.Num() );
+
+		int32 Index = FirstIndex;
+		if( Type == EStreetMapProjectionType::Sinusoidal )
+		{
+			const VectorRegister4Double DegreesToRadians = VectorSetFloat1( PI / 180.0 );
+			const VectorRegister4Double OriginLatitudes = VectorSetFloat1( OriginLatitude );
+			const VectorRegister4Double OriginLongitudes = VectorSetFloat1( OriginLongitude );
+			const VectorRegister4Double Scale = VectorSetFloat1( Projector.Scale );
+
+			for( ; Index + LocationsPerVector <= EndIndex; Index += LocationsPerVector )
+			{
+				alignas( 32 ) double Xs[ LocationsPerVector ];
+				alignas( 32 ) double Ys[ LocationsPerVector ];
+				for( int32 Lane = 0; Lane < LocationsPerVector; ++Lane )
+				{
+					Xs[ Lane ] = Locations[ Index + Lane ].X + Offset.X;
+					Ys[ Lane ] = Locations[ Index + Lane ].Y + Offset.Y;
+				}
+
+				const VectorRegister4Double Latitude = VectorSubtract( OriginLatitudes, VectorDivide( VectorLoadAligned( Ys ), Scale ) );
+				const VectorRegister4Double ParallelScale = VectorMultiply( Scale, VectorCos( VectorMultiply( Latitude, DegreesToRadians ) ) );
+				const VectorRegister4Double Longitude = VectorAdd( OriginLongitudes, VectorDivide( VectorLoadAligned( Xs ), ParallelScale ) );
+
+				alignas( 32 ) double ParallelScales[ LocationsPerVector ];
+				VectorStore( Latitude, OutLatitudes.GetData() + Index );
+				VectorStore( Longitude, OutLongitudes.GetData() + Index );
+				VectorStoreAligned( ParallelScale, ParallelScales );
+
+				// Every longitude is at the poles, so we just pick the origin's
+				for( int32 Lane = 0; Lane < LocationsPerVector; ++Lane )
+				{
+					double& OutLongitude = OutLongitudes[ Index + Lane ];
+					OutLongitude = FMath::Abs( ParallelScales[ Lane ] ) > UE_DOUBLE_SMALL_NUMBER ? FMath::UnwindDegrees( OutLongitude ) : OriginLongitude;
+				}
+			}
+		}
+
+		// Leftovers, and the other projections
+		for( ; Index < EndIndex; ++Index )
+		{
+			Projector.Unproject( Locations[ Index ], OutLatitudes[ Index ], OutLongitudes[ Index ] );
+		}
+	} );
+}
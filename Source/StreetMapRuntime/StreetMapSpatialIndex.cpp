@@ -0,0 +1,658 @@
+#include "StreetMapSpatialIndex.h"
+#include "StreetMap.h"
+#include "PolygonTools.h"
+
+namespace StreetMapSpatialIndex
+{
+	// Number of items the grid aims to have in each cell.  Fewer means more cells to step through on bigger queries,
+	// more means more items to test on smaller ones.
+	static const double AverageItemsPerCell = 4.0;
+
+	// Cells are never smaller than this (ten meters), so that maps with only a few things on them don't get a fine grid
+	static const double MinCellSize = 1000.0;
+
+	// Cells are made bigger when the grid would otherwise have more than this many of them across or down
+	static const int32 MaxCellsPerAxis = 1024;
+
+	/** Returns true if a line segment crosses or touches a box, by clipping it to the box along each axis in turn */
+	static bool DoesSegmentCrossBox( const FVector2D Start, const FVector2D End, const FBox2D& Box )
+	{
+		const FVector2D Delta = End - Start;
+		double EnterTime = 0.0;
+		double ExitTime = 1.0;
+		for( int32 Axis = 0; Axis < 2; ++Axis )
+		{
+			if( Delta[ Axis ] == 0.0 )
+			{
+				if( Start[ Axis ] < Box.Min[ Axis ] || Start[ Axis ] > Box.Max[ Axis ] )
+				{
+					return false;
+				}
+			}
+			else
+			{
+				double MinTime = ( Box.Min[ Axis ] - Start[ Axis ] ) / Delta[ Axis ];
+				double MaxTime = ( Box.Max[ Axis ] - Start[ Axis ] ) / Delta[ Axis ];
+				if( MinTime > MaxTime )
+				{
+					Swap( MinTime, MaxTime );
+				}
+
+				EnterTime = FMath::Max( EnterTime, MinTime );
+				ExitTime = FMath::Min( ExitTime, MaxTime );
+				if( EnterTime > ExitTime )
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	/** Returns true if a box contains a point, including points on its edges */
+	static bool IsPointInBox( const FVector2D Point, const FBox2D& Box )
+	{
+		return Point.X >= Box.Min.X && Point.X <= Box.Max.X && Point.Y >= Box.Min.Y && Point.Y <= Box.Max.Y;
+	}
+
+	/** Gets where a node is, without assuming that the road its first road ref points at is still there.  Returns
+	    false if the node isn't on any road. */
+	static bool GetNodeLocation( const UStreetMap& StreetMap, const FStreetMapNode& Node, FVector2D& OutLocation )
+	{
+		const TArrayView<const FStreetMapRoadRef> RoadRefs = Node.GetRoadRefs( StreetMap );
+		if( RoadRefs.Num() == 0 || !StreetMap.GetRoads().IsValidIndex( RoadRefs[ 0 ].RoadIndex ) )
+		{
+			return false;
+		}
+
+		const TArrayView<const FVector2D> RoadPoints = StreetMap.GetRoadPoints( RoadRefs[ 0 ].RoadIndex );
+		if( !RoadPoints.IsValidIndex( RoadRefs[ 0 ].RoadPointIndex ) )
+		{
+			return false;
+		}
+
+		OutLocation = RoadPoints[ RoadRefs[ 0 ].RoadPointIndex ];
+		return true;
+	}
+}
+
+
+void FStreetMapSpatialIndex::Build( const UStreetMap& StreetMap )
+{
+	using namespace StreetMapSpatialIndex;
+
+	Reset();
+
+	const TArray<FStreetMapRoad>& Roads = StreetMap.GetRoads();
+	const TArray<FStreetMapNode>& Nodes = StreetMap.GetNodes();
+	const TArray<FStreetMapBuilding>& Buildings = StreetMap.GetBuildings();
+
+	// Nodes that aren't on any road (which only happens when roads didn't fit their buffers) are left out
+	TBitArray<> bIsNodeIndexed( false, Nodes.Num() );
+	NodeLocations.SetNumZeroed( Nodes.Num() );
+
+	FBox2D Bounds( ForceInit );
+	int32 ItemCount = 0;
+	for( const FStreetMapRoad& Road : Roads )
+	{
+		for( const FVector2D& RoadPoint : Road.GetRoadPoints( StreetMap ) )
+		{
+			Bounds += RoadPoint;
+		}
+		ItemCount += FMath::Max( Road.PointCount - 1, 0 );
+	}
+	for( int32 NodeIndex = 0; NodeIndex < Nodes.Num(); ++NodeIndex )
+	{
+		if( GetNodeLocation( StreetMap, Nodes[ NodeIndex ], NodeLocations[ NodeIndex ] ) )
+		{
+			bIsNodeIndexed[ NodeIndex ] = true;
+			Bounds += NodeLocations[ NodeIndex ];
+			++ItemCount;
+		}
+	}
+	for( const FStreetMapBuilding& Building : Buildings )
+	{
+		Bounds += Building.BoundsMin;
+		Bounds += Building.BoundsMax;
+		++ItemCount;
+	}
+
+	if( ItemCount == 0 || !Bounds.bIsValid )
+	{
+		NodeLocations.Empty();
+		return;
+	}
+
+	// Size the cells so that there are a few items in each, if they were spread evenly over the map
+	const FVector2D Size = Bounds.GetSize();
+	const double Area = FMath::Max( Size.X, MinCellSize ) * FMath::Max( Size.Y, MinCellSize );
+	CellSize = FMath::Sqrt( Area * AverageItemsPerCell / ItemCount );
+	CellSize = FMath::Max( CellSize, MinCellSize );
+	CellSize = FMath::Max( CellSize, FMath::Max( Size.X, Size.Y ) / MaxCellsPerAxis );
+
+	Origin = Bounds.Min;
+	CellCountX = FMath::Clamp( int32( Size.X / CellSize ) + 1, 1, MaxCellsPerAxis );
+	CellCountY = FMath::Clamp( int32( Size.Y / CellSize ) + 1, 1, MaxCellsPerAxis );
+
+	BuildCellLists<FSegment>(
+		[ &StreetMap, &Roads ]( auto&& AddItem )
+		{
+			for( int32 RoadIndex = 0; RoadIndex < Roads.Num(); ++RoadIndex )
+			{
+				const TArrayView<const FVector2D> RoadPoints = Roads[ RoadIndex ].GetRoadPoints( StreetMap );
+				for( int32 PointIndex = 0; PointIndex < RoadPoints.Num() - 1; ++PointIndex )
+				{
+					const FBox2D SegmentBounds( FVector2D::Min( RoadPoints[ PointIndex ], RoadPoints[ PointIndex + 1 ] ), FVector2D::Max( RoadPoints[ PointIndex ], RoadPoints[ PointIndex + 1 ] ) );
+					AddItem( SegmentBounds, FSegment{ RoadIndex, PointIndex } );
+				}
+			}
+		},
+		SegmentCellOffsets, SegmentCells );
+
+	BuildCellLists<int32>(
+		[ this, &bIsNodeIndexed ]( auto&& AddItem )
+		{
+			for( int32 NodeIndex = 0; NodeIndex < NodeLocations.Num(); ++NodeIndex )
+			{
+				if( bIsNodeIndexed[ NodeIndex ] )
+				{
+					AddItem( FBox2D( NodeLocations[ NodeIndex ], NodeLocations[ NodeIndex ] ), NodeIndex );
+				}
+			}
+		},
+		NodeCellOffsets, NodeCells );
+
+	BuildCellLists<int32>(
+		[ &Buildings ]( auto&& AddItem )
+		{
+			for( int32 BuildingIndex = 0; BuildingIndex < Buildings.Num(); ++BuildingIndex )
+			{
+				AddItem( FBox2D( Buildings[ BuildingIndex ].BoundsMin, Buildings[ BuildingIndex ].BoundsMax ), BuildingIndex );
+			}
+		},
+		BuildingCellOffsets, BuildingCells );
+}
+
+
+void FStreetMapSpatialIndex::Reset()
+{
+	Origin = FVector2D::ZeroVector;
+	CellSize = 0.0;
+	CellCountX = 0;
+	CellCountY = 0;
+	SegmentCellOffsets.Empty();
+	SegmentCells.Empty();
+	NodeCellOffsets.Empty();
+	NodeCells.Empty();
+	BuildingCellOffsets.Empty();
+	BuildingCells.Empty();
+	NodeLocations.Empty();
+}
+
+
+template<typename ItemType, typename ForEachItemType>
+void FStreetMapSpatialIndex::BuildCellLists( ForEachItemType ForEachItem, TArray<int32>& OutOffsets, TArray<ItemType>& OutItems ) const
+{
+	const int32 CellCount = CellCountX * CellCountY;
+
+	// Count the items in each cell, one place along so that adding up the counts leaves where each cell starts
+	OutOffsets.SetNumZeroed( CellCount + 1 );
+	ForEachItem( [ this, &OutOffsets ]( const FBox2D& ItemBounds, const ItemType& Item )
+	{
+		const FIntRect CellRange = GetCellRange( ItemBounds );
+		for( int32 CellY = CellRange.Min.Y; CellY <= CellRange.Max.Y; ++CellY )
+		{
+			for( int32 CellX = CellRange.Min.X; CellX <= CellRange.Max.X; ++CellX )
+			{
+				++OutOffsets[ CellY * CellCountX + CellX + 1 ];
+			}
+		}
+	} );
+	for( int32 CellIndex = 1; CellIndex <= CellCount; ++CellIndex )
+	{
+		OutOffsets[ CellIndex ] += OutOffsets[ CellIndex - 1 ];
+	}
+
+	// Then go through the items again, putting each one in the next free place in every cell it overlaps
+	OutItems.SetNumUninitialized( OutOffsets[ CellCount ] );
+	TArray<int32> NextItemIndices( OutOffsets.GetData(), CellCount );
+	ForEachItem( [ this, &OutItems, &NextItemIndices ]( const FBox2D& ItemBounds, const ItemType& Item )
+	{
+		const FIntRect CellRange = GetCellRange( ItemBounds );
+		for( int32 CellY = CellRange.Min.Y; CellY <= CellRange.Max.Y; ++CellY )
+		{
+			for( int32 CellX = CellRange.Min.X; CellX <= CellRange.Max.X; ++CellX )
+			{
+				OutItems[ NextItemIndices[ CellY * CellCountX + CellX ]++ ] = Item;
+			}
+		}
+	} );
+}
+
+
+FIntPoint FStreetMapSpatialIndex::GetCell( const FVector2D Location ) const
+{
+	// Clamp before converting, so that locations far off the grid can't overflow
+	const double CellX = FMath::Clamp( ( Location.X - Origin.X ) / CellSize, 0.0, double( CellCountX - 1 ) );
+	const double CellY = FMath::Clamp( ( Location.Y - Origin.Y ) / CellSize, 0.0, double( CellCountY - 1 ) );
+	return FIntPoint( int32( CellX ), int32( CellY ) );
+}
+
+
+FIntRect FStreetMapSpatialIndex::GetCellRange( const FBox2D& Box ) const
+{
+	return FIntRect( GetCell( Box.Min ), GetCell( Box.Max ) );
+}
+
+
+bool FStreetMapSpatialIndex::IsReportingCell( const FVector2D ItemBoundsMin, const FBox2D& QueryBox, const int32 CellX, const int32 CellY ) const
+{
+	const FIntPoint ReportingCell = GetCell( FVector2D::Max( ItemBoundsMin, QueryBox.Min ) );
+	return ReportingCell.X == CellX && ReportingCell.Y == CellY;
+}
+
+
+bool FStreetMapSpatialIndex::GetSegmentPoints( const UStreetMap& StreetMap, const FSegment& Segment, FVector2D& OutStart, FVector2D& OutEnd )
+{
+	if( !StreetMap.GetRoads().IsValidIndex( Segment.RoadIndex ) )
+	{
+		return false;
+	}
+
+	const TArrayView<const FVector2D> RoadPoints = StreetMap.GetRoadPoints( Segment.RoadIndex );
+	if( Segment.PointIndex < 0 || Segment.PointIndex + 1 >= RoadPoints.Num() )
+	{
+		return false;
+	}
+
+	OutStart = RoadPoints[ Segment.PointIndex ];
+	OutEnd = RoadPoints[ Segment.PointIndex + 1 ];
+	return true;
+}
+
+
+template<typename VisitCellType, typename GetMaxDistanceSquaredType>
+void FStreetMapSpatialIndex::VisitCellsOutward( const FVector2D Location, VisitCellType VisitCell, GetMaxDistanceSquaredType GetMaxDistanceSquared ) const
+{
+	const FIntPoint CenterCell = GetCell( Location );
+	for( int32 Ring = 0; ; ++Ring )
+	{
+		const int32 MinX = CenterCell.X - Ring;
+		const int32 MaxX = CenterCell.X + Ring;
+		const int32 MinY = CenterCell.Y - Ring;
+		const int32 MaxY = CenterCell.Y + Ring;
+
+		if( Ring > 0 )
+		{
+			// Anything not visited yet is beyond the edges of the rings before this one, on a side where the grid
+			// goes further.  Stop once the nearest of those edges is further away than anything that's still wanted.
+			double NearestEdgeDistance = TNumericLimits<double>::Max();
+			if( MinX >= 0 )
+			{
+				NearestEdgeDistance = FMath::Min( NearestEdgeDistance, Location.X - ( Origin.X + ( MinX + 1 ) * CellSize ) );
+			}
+			if( MaxX < CellCountX )
+			{
+				NearestEdgeDistance = FMath::Min( NearestEdgeDistance, ( Origin.X + MaxX * CellSize ) - Location.X );
+			}
+			if( MinY >= 0 )
+			{
+				NearestEdgeDistance = FMath::Min( NearestEdgeDistance, Location.Y - ( Origin.Y + ( MinY + 1 ) * CellSize ) );
+			}
+			if( MaxY < CellCountY )
+			{
+				NearestEdgeDistance = FMath::Min( NearestEdgeDistance, ( Origin.Y + MaxY * CellSize ) - Location.Y );
+			}
+
+			if( NearestEdgeDistance == TNumericLimits<double>::Max() )
+			{
+				// Every cell has been visited
+				break;
+			}
+
+			NearestEdgeDistance = FMath::Max( NearestEdgeDistance, 0.0 );
+			if( FMath::Square( NearestEdgeDistance ) > GetMaxDistanceSquared() )
+			{
+				break;
+			}
+		}
+
+		for( int32 CellY = FMath::Max( MinY, 0 ); CellY <= FMath::Min( MaxY, CellCountY - 1 ); ++CellY )
+		{
+			if( CellY == MinY || CellY == MaxY )
+			{
+				for( int32 CellX = FMath::Max( MinX, 0 ); CellX <= FMath::Min( MaxX, CellCountX - 1 ); ++CellX )
+				{
+					VisitCell( CellY * CellCountX + CellX );
+				}
+			}
+			else
+			{
+				// Only the ends of the rows in between are on the ring
+				if( MinX >= 0 )
+				{
+					VisitCell( CellY * CellCountX + MinX );
+				}
+				if( MaxX < CellCountX )
+				{
+					VisitCell( CellY * CellCountX + MaxX );
+				}
+			}
+		}
+	}
+}
+
+
+void FStreetMapSpatialIndex::FindRoadSegmentsInBox( const UStreetMap& StreetMap, const FBox2D& Box, TArray<FStreetMapRoadRef>& OutSegments ) const
+{
+	OutSegments.Reset();
+	if( !IsBuilt() || !Box.bIsValid )
+	{
+		return;
+	}
+
+	const FIntRect CellRange = GetCellRange( Box );
+	for( int32 CellY = CellRange.Min.Y; CellY <= CellRange.Max.Y; ++CellY )
+	{
+		for( int32 CellX = CellRange.Min.X; CellX <= CellRange.Max.X; ++CellX )
+		{
+			const int32 CellIndex = CellY * CellCountX + CellX;
+			for( int32 ItemIndex = SegmentCellOffsets[ CellIndex ]; ItemIndex < SegmentCellOffsets[ CellIndex + 1 ]; ++ItemIndex )
+			{
+				const FSegment& Segment = SegmentCells[ ItemIndex ];
+				FVector2D Start, End;
+				if( GetSegmentPoints( StreetMap, Segment, Start, End ) &&
+					IsReportingCell( FVector2D::Min( Start, End ), Box, CellX, CellY ) &&
+					StreetMapSpatialIndex::DoesSegmentCrossBox( Start, End, Box ) )
+				{
+					FStreetMapRoadRef& SegmentRef = OutSegments.AddDefaulted_GetRef();
+					SegmentRef.RoadIndex = Segment.RoadIndex;
+					SegmentRef.RoadPointIndex = Segment.PointIndex;
+				}
+			}
+		}
+	}
+}
+
+
+void FStreetMapSpatialIndex::FindRoadSegmentsInRadius( const UStreetMap& StreetMap, const FVector2D Center, const double Radius, TArray<FStreetMapRoadRef>& OutSegments ) const
+{
+	OutSegments.Reset();
+	if( !IsBuilt() || Radius < 0.0 )
+	{
+		return;
+	}
+
+	const FBox2D Box( Center - FVector2D( Radius ), Center + FVector2D( Radius ) );
+	const double RadiusSquared = FMath::Square( Radius );
+	const FIntRect CellRange = GetCellRange( Box );
+	for( int32 CellY = CellRange.Min.Y; CellY <= CellRange.Max.Y; ++CellY )
+	{
+		for( int32 CellX = CellRange.Min.X; CellX <= CellRange.Max.X; ++CellX )
+		{
+			const int32 CellIndex = CellY * CellCountX + CellX;
+			for( int32 ItemIndex = SegmentCellOffsets[ CellIndex ]; ItemIndex < SegmentCellOffsets[ CellIndex + 1 ]; ++ItemIndex )
+			{
+				const FSegment& Segment = SegmentCells[ ItemIndex ];
+				FVector2D Start, End;
+				if( GetSegmentPoints( StreetMap, Segment, Start, End ) &&
+					IsReportingCell( FVector2D::Min( Start, End ), Box, CellX, CellY ) &&
+					FVector2D::DistSquared( FMath::ClosestPointOnSegment2D( Center, Start, End ), Center ) <= RadiusSquared )
+				{
+					FStreetMapRoadRef& SegmentRef = OutSegments.AddDefaulted_GetRef();
+					SegmentRef.RoadIndex = Segment.RoadIndex;
+					SegmentRef.RoadPointIndex = Segment.PointIndex;
+				}
+			}
+		}
+	}
+}
+
+
+void FStreetMapSpatialIndex::FindNodesInBox( const UStreetMap& StreetMap, const FBox2D& Box, TArray<int32>& OutNodeIndices ) const
+{
+	OutNodeIndices.Reset();
+	if( !IsBuilt() || !Box.bIsValid )
+	{
+		return;
+	}
+
+	// Nodes are only ever listed in the one cell they're in, so there's nothing to skip
+	const FIntRect CellRange = GetCellRange( Box );
+	for( int32 CellY = CellRange.Min.Y; CellY <= CellRange.Max.Y; ++CellY )
+	{
+		for( int32 CellX = CellRange.Min.X; CellX <= CellRange.Max.X; ++CellX )
+		{
+			const int32 CellIndex = CellY * CellCountX + CellX;
+			for( int32 ItemIndex = NodeCellOffsets[ CellIndex ]; ItemIndex < NodeCellOffsets[ CellIndex + 1 ]; ++ItemIndex )
+			{
+				const int32 NodeIndex = NodeCells[ ItemIndex ];
+				if( StreetMap.GetNodes().IsValidIndex( NodeIndex ) && StreetMapSpatialIndex::IsPointInBox( NodeLocations[ NodeIndex ], Box ) )
+				{
+					OutNodeIndices.Add( NodeIndex );
+				}
+			}
+		}
+	}
+}
+
+
+void FStreetMapSpatialIndex::FindNodesInRadius( const UStreetMap& StreetMap, const FVector2D Center, const double Radius, TArray<int32>& OutNodeIndices ) const
+{
+	OutNodeIndices.Reset();
+	if( !IsBuilt() || Radius < 0.0 )
+	{
+		return;
+	}
+
+	const FBox2D Box( Center - FVector2D( Radius ), Center + FVector2D( Radius ) );
+	const double RadiusSquared = FMath::Square( Radius );
+	const FIntRect CellRange = GetCellRange( Box );
+	for( int32 CellY = CellRange.Min.Y; CellY <= CellRange.Max.Y; ++CellY )
+	{
+		for( int32 CellX = CellRange.Min.X; CellX <= CellRange.Max.X; ++CellX )
+		{
+			const int32 CellIndex = CellY * CellCountX + CellX;
+			for( int32 ItemIndex = NodeCellOffsets[ CellIndex ]; ItemIndex < NodeCellOffsets[ CellIndex + 1 ]; ++ItemIndex )
+			{
+				const int32 NodeIndex = NodeCells[ ItemIndex ];
+				if( StreetMap.GetNodes().IsValidIndex( NodeIndex ) && FVector2D::DistSquared( NodeLocations[ NodeIndex ], Center ) <= RadiusSquared )
+				{
+					OutNodeIndices.Add( NodeIndex );
+				}
+			}
+		}
+	}
+}
+
+
+void FStreetMapSpatialIndex::FindBuildingsInBox( const UStreetMap& StreetMap, const FBox2D& Box, TArray<int32>& OutBuildingIndices ) const
+{
+	OutBuildingIndices.Reset();
+	if( !IsBuilt() || !Box.bIsValid )
+	{
+		return;
+	}
+
+	const TArray<FStreetMapBuilding>& Buildings = StreetMap.GetBuildings();
+	const FIntRect CellRange = GetCellRange( Box );
+	for( int32 CellY = CellRange.Min.Y; CellY <= CellRange.Max.Y; ++CellY )
+	{
+		for( int32 CellX = CellRange.Min.X; CellX <= CellRange.Max.X; ++CellX )
+		{
+			const int32 CellIndex = CellY * CellCountX + CellX;
+			for( int32 ItemIndex = BuildingCellOffsets[ CellIndex ]; ItemIndex < BuildingCellOffsets[ CellIndex + 1 ]; ++ItemIndex )
+			{
+				const int32 BuildingIndex = BuildingCells[ ItemIndex ];
+				if( Buildings.IsValidIndex( BuildingIndex ) &&
+					IsReportingCell( Buildings[ BuildingIndex ].BoundsMin, Box, CellX, CellY ) &&
+					Box.Intersect( FBox2D( Buildings[ BuildingIndex ].BoundsMin, Buildings[ BuildingIndex ].BoundsMax ) ) )
+				{
+					OutBuildingIndices.Add( BuildingIndex );
+				}
+			}
+		}
+	}
+}
+
+
+void FStreetMapSpatialIndex::FindBuildingsInRadius( const UStreetMap& StreetMap, const FVector2D Center, const double Radius, TArray<int32>& OutBuildingIndices ) const
+{
+	OutBuildingIndices.Reset();
+	if( !IsBuilt() || Radius < 0.0 )
+	{
+		return;
+	}
+
+	const TArray<FStreetMapBuilding>& Buildings = StreetMap.GetBuildings();
+	const FBox2D Box( Center - FVector2D( Radius ), Center + FVector2D( Radius ) );
+	const double RadiusSquared = FMath::Square( Radius );
+	const FIntRect CellRange = GetCellRange( Box );
+	for( int32 CellY = CellRange.Min.Y; CellY <= CellRange.Max.Y; ++CellY )
+	{
+		for( int32 CellX = CellRange.Min.X; CellX <= CellRange.Max.X; ++CellX )
+		{
+			const int32 CellIndex = CellY * CellCountX + CellX;
+			for( int32 ItemIndex = BuildingCellOffsets[ CellIndex ]; ItemIndex < BuildingCellOffsets[ CellIndex + 1 ]; ++ItemIndex )
+			{
+				const int32 BuildingIndex = BuildingCells[ ItemIndex ];
+				if( !Buildings.IsValidIndex( BuildingIndex ) )
+				{
+					continue;
+				}
+
+				const FStreetMapBuilding& Building = Buildings[ BuildingIndex ];
+				const FBox2D BuildingBounds( Building.BoundsMin, Building.BoundsMax );
+				if( !IsReportingCell( Building.BoundsMin, Box, CellX, CellY ) || BuildingBounds.ComputeSquaredDistanceToPoint( Center ) > RadiusSquared )
+				{
+					continue;
+				}
+
+				// The bounds are close enough, so check the footprint itself
+				bool bIsWithinRadius = FPolygonTools::IsPointInsidePolygon( Building.BuildingPoints, Center );
+				for( int32 PreviousPointIndex = Building.BuildingPoints.Num() - 1, PointIndex = 0; !bIsWithinRadius && PointIndex < Building.BuildingPoints.Num(); PreviousPointIndex = PointIndex++ )
+				{
+					const FVector2D NearestPoint = FMath::ClosestPointOnSegment2D( Center, Building.BuildingPoints[ PreviousPointIndex ], Building.BuildingPoints[ PointIndex ] );
+					bIsWithinRadius = FVector2D::DistSquared( NearestPoint, Center ) <= RadiusSquared;
+				}
+
+				if( bIsWithinRadius )
+				{
+					OutBuildingIndices.Add( BuildingIndex );
+				}
+			}
+		}
+	}
+}
+
+
+bool FStreetMapSpatialIndex::FindNearestRoadSegment( const UStreetMap& StreetMap, const FVector2D Location, const double MaxDistance, FStreetMapRoadRef& OutSegment, FVector2D& OutNearestPoint ) const
+{
+	if( !IsBuilt() || MaxDistance < 0.0 )
+	{
+		return false;
+	}
+
+	// Segments can be listed in more than one cell, but visiting one twice can't change which is nearest
+	const FSegment* NearestSegment = nullptr;
+	double NearestDistanceSquared = FMath::Square( MaxDistance );
+	VisitCellsOutward( Location,
+		[ & ]( const int32 CellIndex )
+		{
+			for( int32 ItemIndex = SegmentCellOffsets[ CellIndex ]; ItemIndex < SegmentCellOffsets[ CellIndex + 1 ]; ++ItemIndex )
+			{
+				FVector2D Start, End;
+				if( GetSegmentPoints( StreetMap, SegmentCells[ ItemIndex ], Start, End ) )
+				{
+					const FVector2D NearestPoint = FMath::ClosestPointOnSegment2D( Location, Start, End );
+					const double DistanceSquared = FVector2D::DistSquared( NearestPoint, Location );
+					if( DistanceSquared < NearestDistanceSquared || ( NearestSegment == nullptr && DistanceSquared == NearestDistanceSquared ) )
+					{
+						NearestSegment = &SegmentCells[ ItemIndex ];
+						NearestDistanceSquared = DistanceSquared;
+						OutNearestPoint = NearestPoint;
+					}
+				}
+			}
+		},
+		[ &NearestDistanceSquared ]()
+		{
+			return NearestDistanceSquared;
+		} );
+
+	if( NearestSegment == nullptr )
+	{
+		return false;
+	}
+
+	OutSegment.RoadIndex = NearestSegment->RoadIndex;
+	OutSegment.RoadPointIndex = NearestSegment->PointIndex;
+	return true;
+}
+
+
+void FStreetMapSpatialIndex::FindNearestNodes( const UStreetMap& StreetMap, const FVector2D Location, const int32 Count, const double MaxDistance, TArray<int32>& OutNodeIndices ) const
+{
+	OutNodeIndices.Reset();
+	if( !IsBuilt() || Count <= 0 || MaxDistance < 0.0 )
+	{
+		return;
+	}
+
+	// Keep the nearest nodes found so far in a heap with the furthest of them on top, so that it's the one that goes
+	// when a nearer node turns up.  Ties go to the lower node index, so results don't depend on the grid.
+	typedef TPair<double, int32> FNearbyNode;
+	const auto IsFurther = []( const FNearbyNode& A, const FNearbyNode& B )
+	{
+		return A.Key > B.Key || ( A.Key == B.Key && A.Value > B.Value );
+	};
+
+	TArray<FNearbyNode> NearestNodes;
+	NearestNodes.Reserve( Count + 1 );
+	const double MaxDistanceSquared = FMath::Square( MaxDistance );
+	VisitCellsOutward( Location,
+		[ & ]( const int32 CellIndex )
+		{
+			for( int32 ItemIndex = NodeCellOffsets[ CellIndex ]; ItemIndex < NodeCellOffsets[ CellIndex + 1 ]; ++ItemIndex )
+			{
+				const int32 NodeIndex = NodeCells[ ItemIndex ];
+				if( !StreetMap.GetNodes().IsValidIndex( NodeIndex ) )
+				{
+					continue;
+				}
+
+				const FNearbyNode NearbyNode( FVector2D::DistSquared( NodeLocations[ NodeIndex ], Location ), NodeIndex );
+				if( NearbyNode.Key > MaxDistanceSquared )
+				{
+					continue;
+				}
+
+				if( NearestNodes.Num() < Count )
+				{
+					NearestNodes.HeapPush( NearbyNode, IsFurther );
+				}
+				else if( IsFurther( NearestNodes.HeapTop(), NearbyNode ) )
+				{
+					const bool bAllowShrinking = false;
+					NearestNodes.HeapPopDiscard( IsFurther, bAllowShrinking );
+					NearestNodes.HeapPush( NearbyNode, IsFurther );
+				}
+			}
+		},
+		[ & ]()
+		{
+			return NearestNodes.Num() < Count ? MaxDistanceSquared : NearestNodes.HeapTop().Key;
+		} );
+
+	NearestNodes.Sort( [ &IsFurther ]( const FNearbyNode& A, const FNearbyNode& B )
+	{
+		return IsFurther( B, A );
+	} );
+
+	OutNodeIndices.Reserve( NearestNodes.Num() );
+	for( const FNearbyNode& NearbyNode : NearestNodes )
+	{
+		OutNodeIndices.Add( NearbyNode.Value );
+	}
+}
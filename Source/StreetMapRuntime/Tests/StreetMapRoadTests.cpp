@@ -0,0 +1,259 @@
+#include "StreetMapTestMaps.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace StreetMapRoadTests
+{
+	// Number of agents in the benchmark, each moving along a road of its own
+	static const int32 BenchmarkAgentCount = 10 * 1000;
+
+	// Number of frames the benchmark moves the agents for
+	static const int32 BenchmarkFrameCount = 100;
+
+	/** Finds the index of the point a position along a road is on the segment up to, by walking the distances one at
+		a time.  This is what the binary searches on PointDistances should find. */
+	static int32 WalkToNextPointIndex( const UStreetMap& StreetMap, const FStreetMapRoad& Road, const float PositionAlongRoad )
+	{
+		const TArrayView<const float> PointDistances = Road.GetPointDistances( StreetMap );
+		int32 NextPointIndex = 1;
+		while( NextPointIndex < PointDistances.Num() - 1 && PointDistances[ NextPointIndex ] < PositionAlongRoad )
+		{
+			++NextPointIndex;
+		}
+		return NextPointIndex;
+	}
+
+	/** Finds a location along a road by walking its segments, the way street maps did before they kept distances */
+	static FVector2D WalkToLocationAlongRoad( const UStreetMap& StreetMap, const FStreetMapRoad& Road, const float PositionAlongRoad )
+	{
+		const TArrayView<const FVector2D> RoadPoints = Road.GetRoadPoints( StreetMap );
+		float CurrentPointPositionAlongRoad = 0.0f;
+		for( int32 PointIndex = 0; PointIndex < RoadPoints.Num() - 1; ++PointIndex )
+		{
+			const float DistanceBetweenPoints = ( RoadPoints[ PointIndex + 1 ] - RoadPoints[ PointIndex ] ).Size();
+			const float NextPointPositionAlongRoad = CurrentPointPositionAlongRoad + DistanceBetweenPoints;
+			if( NextPointPositionAlongRoad >= PositionAlongRoad )
+			{
+				const float LerpAlpha = ( PositionAlongRoad - CurrentPointPositionAlongRoad ) / DistanceBetweenPoints;
+				return FMath::Lerp( RoadPoints[ PointIndex ], RoadPoints[ PointIndex + 1 ], LerpAlpha );
+			}
+			CurrentPointPositionAlongRoad = NextPointPositionAlongRoad;
+		}
+		return RoadPoints.Last();
+	}
+
+	/** Checks the along-road queries of one road at one position against walking the road's distances */
+	static bool CheckPositionAlongRoad( FAutomationTestBase& Test, const FString& What, const UStreetMap& StreetMap, const FStreetMapRoad& Road, const float PositionAlongRoad )
+	{
+		const TArrayView<const FVector2D> RoadPoints = Road.GetRoadPoints( StreetMap );
+		const TArrayView<const int32> NodeIndices = Road.GetNodeIndices( StreetMap );
+		const TArrayView<const float> PointDistances = Road.GetPointDistances( StreetMap );
+
+		const int32 NextPointIndex = WalkToNextPointIndex( StreetMap, Road, PositionAlongRoad );
+		const int32 CurrentPointIndex = NextPointIndex - 1;
+		const float LerpAlpha = FMath::Min( ( PositionAlongRoad - PointDistances[ CurrentPointIndex ] ) / ( PointDistances[ NextPointIndex ] - PointDistances[ CurrentPointIndex ] ), 1.0f );
+		const FVector2D ExpectedLocation = FMath::Lerp( RoadPoints[ CurrentPointIndex ], RoadPoints[ NextPointIndex ], LerpAlpha );
+		const FVector2D Location = Road.MakeLocationAlongRoad( StreetMap, PositionAlongRoad );
+		if( !Location.Equals( ExpectedLocation, 0.001 ) )
+		{
+			Test.AddError( FString::Printf( TEXT( "%s: location at %f is %s, expected %s" ), *What, PositionAlongRoad, *Location.ToString(), *ExpectedLocation.ToString() ) );
+			return false;
+		}
+
+		int32 LaterPointIndex = NextPointIndex;
+		while( NodeIndices[ LaterPointIndex ] == INDEX_NONE )
+		{
+			++LaterPointIndex;
+		}
+		int32 EarlierPointIndex = LaterPointIndex - 1;
+		while( NodeIndices[ EarlierPointIndex ] == INDEX_NONE )
+		{
+			--EarlierPointIndex;
+		}
+
+		const FStreetMapNode* EarlierNode = nullptr;
+		const FStreetMapNode* LaterNode = nullptr;
+		float EarlierNodePositionAlongRoad = -1.0f;
+		float LaterNodePositionAlongRoad = -1.0f;
+		Road.FindEarlierAndLaterNodesForPositionAlongRoad( StreetMap, PositionAlongRoad, EarlierNode, EarlierNodePositionAlongRoad, LaterNode, LaterNodePositionAlongRoad );
+		if( EarlierNode != &StreetMap.GetNodes()[ NodeIndices[ EarlierPointIndex ] ] || EarlierNodePositionAlongRoad != PointDistances[ EarlierPointIndex ] ||
+			LaterNode != &StreetMap.GetNodes()[ NodeIndices[ LaterPointIndex ] ] || LaterNodePositionAlongRoad != PointDistances[ LaterPointIndex ] )
+		{
+			Test.AddError( FString::Printf( TEXT( "%s: nodes around %f are at %f and %f, expected the ones at points %d and %d" ), *What, PositionAlongRoad, EarlierNodePositionAlongRoad, LaterNodePositionAlongRoad, EarlierPointIndex, LaterPointIndex ) );
+			return false;
+		}
+
+		return true;
+	}
+
+	/** An agent in the benchmark, driving along a road and around again when it gets to the end */
+	struct FAgent
+	{
+		int32 RoadIndex;
+		float PositionAlongRoad;
+		float Speed;
+	};
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST( FStreetMapAlongRoadTest, "StreetMap.Runtime.AlongRoad", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter )
+
+bool FStreetMapAlongRoadTest::RunTest( const FString& Parameters )
+{
+	using namespace StreetMapRoadTests;
+	using namespace StreetMapTestMaps;
+
+	// A road with segments 30, 40 and 70 long, and nodes everywhere but the second point
+	{
+		const TArray<TArray<FVector2D>> RoadPointLists = { { FVector2D( 0.0, 0.0 ), FVector2D( 30.0, 0.0 ), FVector2D( 30.0, 40.0 ), FVector2D( 100.0, 40.0 ) } };
+		const TStrongObjectPtr<UStreetMap> StreetMap = MakeStreetMap( RoadPointLists, 2 );
+		const FStreetMapRoad& Road = StreetMap->GetRoads()[ 0 ];
+		const TArray<FStreetMapNode>& Nodes = StreetMap->GetNodes();
+
+		TestTrue( TEXT( "Point distances" ), TArray<float>( Road.GetPointDistances( *StreetMap ) ) == TArray<float>( { 0.0f, 30.0f, 70.0f, 140.0f } ) );
+		TestEqual( TEXT( "Length of road" ), Road.ComputeLengthOfRoad( *StreetMap ), 140.0f );
+		TestEqual( TEXT( "Distance between nodes" ), Road.ComputeDistanceBetweenNodesOnRoad( *StreetMap, 3, 0 ), 140.0f );
+		TestEqual( TEXT( "Distance between nodes past the end" ), Road.ComputeDistanceBetweenNodesOnRoad( *StreetMap, 2, 10 ), 70.0f );
+		TestEqual( TEXT( "Position of the first node" ), Road.FindPositionAlongRoadForNode( *StreetMap, 0 ), 0.0f );
+		TestEqual( TEXT( "Position of the third node" ), Road.FindPositionAlongRoadForNode( *StreetMap, 2 ), 70.0f );
+
+		TestTrue( TEXT( "Location at the start" ), Road.MakeLocationAlongRoad( *StreetMap, 0.0f ).Equals( FVector2D( 0.0, 0.0 ), 0.001 ) );
+		TestTrue( TEXT( "Location on the first segment" ), Road.MakeLocationAlongRoad( *StreetMap, 15.0f ).Equals( FVector2D( 15.0, 0.0 ), 0.001 ) );
+		TestTrue( TEXT( "Location at a point" ), Road.MakeLocationAlongRoad( *StreetMap, 30.0f ).Equals( FVector2D( 30.0, 0.0 ), 0.001 ) );
+		TestTrue( TEXT( "Location on the second segment" ), Road.MakeLocationAlongRoad( *StreetMap, 50.0f ).Equals( FVector2D( 30.0, 20.0 ), 0.001 ) );
+		TestTrue( TEXT( "Location at the end" ), Road.MakeLocationAlongRoad( *StreetMap, 140.0f ).Equals( FVector2D( 100.0, 40.0 ), 0.001 ) );
+		TestTrue( TEXT( "Location past the end" ), Road.MakeLocationAlongRoad( *StreetMap, 500.0f ).Equals( FVector2D( 100.0, 40.0 ), 0.001 ) );
+
+		const FStreetMapNode* EarlierNode = nullptr;
+		const FStreetMapNode* LaterNode = nullptr;
+		float EarlierNodePositionAlongRoad = -1.0f;
+		float LaterNodePositionAlongRoad = -1.0f;
+		Road.FindEarlierAndLaterNodesForPositionAlongRoad( *StreetMap, 0.0f, EarlierNode, EarlierNodePositionAlongRoad, LaterNode, LaterNodePositionAlongRoad );
+		TestTrue( TEXT( "Nodes around the start" ), EarlierNode == &Nodes[ 0 ] && EarlierNodePositionAlongRoad == 0.0f && LaterNode == &Nodes[ 1 ] && LaterNodePositionAlongRoad == 70.0f );
+		Road.FindEarlierAndLaterNodesForPositionAlongRoad( *StreetMap, 70.0f, EarlierNode, EarlierNodePositionAlongRoad, LaterNode, LaterNodePositionAlongRoad );
+		TestTrue( TEXT( "Nodes around a node" ), EarlierNode == &Nodes[ 0 ] && EarlierNodePositionAlongRoad == 0.0f && LaterNode == &Nodes[ 1 ] && LaterNodePositionAlongRoad == 70.0f );
+		Road.FindEarlierAndLaterNodesForPositionAlongRoad( *StreetMap, 140.0f, EarlierNode, EarlierNodePositionAlongRoad, LaterNode, LaterNodePositionAlongRoad );
+		TestTrue( TEXT( "Nodes around the end" ), EarlierNode == &Nodes[ 1 ] && EarlierNodePositionAlongRoad == 70.0f && LaterNode == &Nodes[ 2 ] && LaterNodePositionAlongRoad == 140.0f );
+		Road.FindEarlierAndLaterNodesForPositionAlongRoad( *StreetMap, 500.0f, EarlierNode, EarlierNodePositionAlongRoad, LaterNode, LaterNodePositionAlongRoad );
+		TestTrue( TEXT( "Nodes past the end" ), EarlierNode == &Nodes[ 1 ] && EarlierNodePositionAlongRoad == 70.0f && LaterNode == &Nodes[ 2 ] && LaterNodePositionAlongRoad == 140.0f );
+	}
+
+	// Random roads, checked at the start, at the end, past the end, at every point and at random positions in between
+	FRandomStream Random( 0x0A23 );
+	TArray<TArray<FVector2D>> RoadPointLists;
+	RoadPointLists.SetNum( 50 );
+	for( TArray<FVector2D>& Points : RoadPointLists )
+	{
+		MakeRandomRoadPoints( Random, Random.RandRange( 2, 200 ), 100000.0f, Points );
+	}
+	const TStrongObjectPtr<UStreetMap> StreetMap = MakeStreetMap( RoadPointLists, 3 );
+	for( int32 RoadIndex = 0; RoadIndex < StreetMap->GetRoads().Num(); ++RoadIndex )
+	{
+		const FStreetMapRoad& Road = StreetMap->GetRoads()[ RoadIndex ];
+		const TArrayView<const FVector2D> RoadPoints = StreetMap->GetRoadPoints( RoadIndex );
+		const FString What = FString::Printf( TEXT( "Road %d" ), RoadIndex );
+
+		// Distances are added up at double precision, so they should be within float rounding of walking the road
+		const float Length = Road.ComputeLengthOfRoad( *StreetMap );
+		float WalkedLength = 0.0f;
+		for( int32 PointIndex = 1; PointIndex < RoadPoints.Num(); ++PointIndex )
+		{
+			WalkedLength += ( RoadPoints[ PointIndex ] - RoadPoints[ PointIndex - 1 ] ).Size();
+		}
+		if( !FMath::IsNearlyEqual( Length, WalkedLength, Length * 1.0e-5f ) )
+		{
+			AddError( FString::Printf( TEXT( "%s: length is %f, walking it gives %f" ), *What, Length, WalkedLength ) );
+			continue;
+		}
+		if( !Road.MakeLocationAlongRoad( *StreetMap, Length * 0.5f ).Equals( WalkToLocationAlongRoad( *StreetMap, Road, Length * 0.5f ), Length * 1.0e-5f ) )
+		{
+			AddError( FString::Printf( TEXT( "%s: location halfway along doesn't match walking the road" ), *What ) );
+			continue;
+		}
+
+		TArray<float> Positions = { 0.0f, Length, Length + 1.0f, Length * 2.0f };
+		Positions.Append( StreetMap->GetRoadPointDistances( RoadIndex ) );
+		for( int32 Sample = 0; Sample < 100; ++Sample )
+		{
+			Positions.Add( Random.FRandRange( 0.0f, Length ) );
+		}
+		for( const float PositionAlongRoad : Positions )
+		{
+			if( !CheckPositionAlongRoad( *this, What, *StreetMap, Road, PositionAlongRoad ) )
+			{
+				break;
+			}
+		}
+		TestTrue( What + TEXT( ": location at the end" ), Road.MakeLocationAlongRoad( *StreetMap, Length ).Equals( RoadPoints.Last(), 0.001 ) );
+		TestTrue( What + TEXT( ": location past the end" ), Road.MakeLocationAlongRoad( *StreetMap, Length + 1.0f ).Equals( RoadPoints.Last(), 0.001 ) );
+	}
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST( FStreetMapAlongRoadBenchmark, "StreetMap.Runtime.AlongRoad.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter )
+
+bool FStreetMapAlongRoadBenchmark::RunTest( const FString& Parameters )
+{
+	using namespace StreetMapRoadTests;
+	using namespace StreetMapTestMaps;
+
+	// Roads about as long as the longest ones in a city extract
+	FRandomStream Random( 0x0A24 );
+	TArray<TArray<FVector2D>> RoadPointLists;
+	RoadPointLists.SetNum( 1000 );
+	for( TArray<FVector2D>& Points : RoadPointLists )
+	{
+		MakeRandomRoadPoints( Random, 100, 100000.0f, Points );
+	}
+	const TStrongObjectPtr<UStreetMap> StreetMap = MakeStreetMap( RoadPointLists, 4 );
+	const TArray<FStreetMapRoad>& Roads = StreetMap->GetRoads();
+
+	TArray<FAgent> Agents;
+	Agents.SetNumUninitialized( BenchmarkAgentCount );
+	for( FAgent& Agent : Agents )
+	{
+		Agent.RoadIndex = Random.RandRange( 0, Roads.Num() - 1 );
+		Agent.PositionAlongRoad = Random.FRandRange( 0.0f, Roads[ Agent.RoadIndex ].ComputeLengthOfRoad( *StreetMap ) );
+		Agent.Speed = Random.FRandRange( 500.0f, 3000.0f );
+	}
+
+	// Each frame, every agent moves on and finds where it is now, the way a traffic simulation would.  The same agents
+	// are moved twice, once with the distance queries and once by walking the roads.
+	auto MoveAgents = [&]( TArray<FAgent> MovingAgents, const bool bWalkRoads, FVector2D& OutLocationSum ) -> double
+	{
+		OutLocationSum = FVector2D::ZeroVector;
+		const double StartTime = FPlatformTime::Seconds();
+		for( int32 Frame = 0; Frame < BenchmarkFrameCount; ++Frame )
+		{
+			for( FAgent& Agent : MovingAgents )
+			{
+				const FStreetMapRoad& Road = Roads[ Agent.RoadIndex ];
+				const float Length = StreetMap->GetRoadPointDistances( Agent.RoadIndex ).Last();
+				Agent.PositionAlongRoad += Agent.Speed;
+				if( Agent.PositionAlongRoad > Length )
+				{
+					Agent.PositionAlongRoad -= Length;
+				}
+				OutLocationSum += bWalkRoads ? WalkToLocationAlongRoad( *StreetMap, Road, Agent.PositionAlongRoad ) : Road.MakeLocationAlongRoad( *StreetMap, Agent.PositionAlongRoad );
+			}
+		}
+		return FPlatformTime::Seconds() - StartTime;
+	};
+
+	FVector2D QueryLocationSum, WalkLocationSum;
+	const double QuerySeconds = MoveAgents( Agents, false, QueryLocationSum );
+	const double WalkSeconds = MoveAgents( Agents, true, WalkLocationSum );
+
+	const int32 MoveCount = BenchmarkAgentCount * BenchmarkFrameCount;
+	AddInfo( FString::Printf( TEXT( "%d agents on %d roads of %d points, %d frames" ), BenchmarkAgentCount, Roads.Num(), RoadPointLists[ 0 ].Num(), BenchmarkFrameCount ) );
+	AddInfo( FString::Printf( TEXT( "Distance queries: %.3fs (%.1fns a move)" ), QuerySeconds, QuerySeconds * 1.0e9 / MoveCount ) );
+	AddInfo( FString::Printf( TEXT( "Walking the roads: %.3fs (%.1fns a move)" ), WalkSeconds, WalkSeconds * 1.0e9 / MoveCount ) );
+	AddInfo( FString::Printf( TEXT( "Checksums: %s, %s" ), *QueryLocationSum.ToString(), *WalkLocationSum.ToString() ) );
+
+	return true;
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,446 @@
+#include "StreetMapSpatialIndex.h"
+#include "StreetMapTestMaps.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace StreetMapSpatialIndexTests
+{
+	// Number of each kind of query the benchmark runs through the index
+	static const int32 BenchmarkQueryCount = 100 * 1000;
+
+	// Number of each kind of query the benchmark runs by brute force, which is much slower
+	static const int32 BenchmarkBruteForceQueryCount = 1000;
+
+	/** Returns true if a line segment touches a box, using the separating axis test rather than clipping like the index
+		does.  Only the box's axes and the segment's normal can separate them. */
+	static bool DoesSegmentTouchBox( const FVector2D Start, const FVector2D End, const FBox2D& Box )
+	{
+		if( FMath::Max( Start.X, End.X ) < Box.Min.X || FMath::Min( Start.X, End.X ) > Box.Max.X ||
+			FMath::Max( Start.Y, End.Y ) < Box.Min.Y || FMath::Min( Start.Y, End.Y ) > Box.Max.Y )
+		{
+			return false;
+		}
+
+		const FVector2D Corners[] = { Box.Min, FVector2D( Box.Max.X, Box.Min.Y ), Box.Max, FVector2D( Box.Min.X, Box.Max.Y ) };
+		bool bHasCornerOnLeft = false;
+		bool bHasCornerOnRight = false;
+		for( const FVector2D Corner : Corners )
+		{
+			const double Side = FVector2D::CrossProduct( End - Start, Corner - Start );
+			bHasCornerOnLeft |= Side >= 0.0;
+			bHasCornerOnRight |= Side <= 0.0;
+		}
+		return bHasCornerOnLeft && bHasCornerOnRight;
+	}
+
+	/** Returns true if a point is inside a polygon, by counting the edges a ray going right from it crosses */
+	static bool IsPointInPolygon( const TArray<FVector2D>& Polygon, const FVector2D Point )
+	{
+		bool bIsInside = false;
+		for( int32 PreviousPointIndex = Polygon.Num() - 1, PointIndex = 0; PointIndex < Polygon.Num(); PreviousPointIndex = PointIndex++ )
+		{
+			const FVector2D A = Polygon[ PreviousPointIndex ];
+			const FVector2D B = Polygon[ PointIndex ];
+			if( ( A.Y > Point.Y ) != ( B.Y > Point.Y ) && Point.X < A.X + ( Point.Y - A.Y ) * ( B.X - A.X ) / ( B.Y - A.Y ) )
+			{
+				bIsInside = !bIsInside;
+			}
+		}
+		return bIsInside;
+	}
+
+	/** Turns road segments into sortable keys */
+	static TArray<int64> MakeSegmentKeys( const TArray<FStreetMapRoadRef>& Segments )
+	{
+		TArray<int64> Keys;
+		Keys.Reserve( Segments.Num() );
+		for( const FStreetMapRoadRef& Segment : Segments )
+		{
+			Keys.Add( ( int64( Segment.RoadIndex ) << 32 ) | uint32( Segment.RoadPointIndex ) );
+		}
+		Keys.Sort();
+		return Keys;
+	}
+
+	/** Sorts a copy of a list of indices */
+	static TArray<int32> MakeSorted( TArray<int32> Indices )
+	{
+		Indices.Sort();
+		return Indices;
+	}
+
+	/** Answers every kind of query by looking at everything on a street map */
+	struct FBruteForce
+	{
+		const UStreetMap& StreetMap;
+
+		void FindRoadSegments( TFunctionRef<bool( FVector2D, FVector2D )> IsFound, TArray<FStreetMapRoadRef>& OutSegments ) const
+		{
+			OutSegments.Reset();
+			for( int32 RoadIndex = 0; RoadIndex < StreetMap.GetRoads().Num(); ++RoadIndex )
+			{
+				const TArrayView<const FVector2D> RoadPoints = StreetMap.GetRoadPoints( RoadIndex );
+				for( int32 PointIndex = 0; PointIndex < RoadPoints.Num() - 1; ++PointIndex )
+				{
+					if( IsFound( RoadPoints[ PointIndex ], RoadPoints[ PointIndex + 1 ] ) )
+					{
+						FStreetMapRoadRef& Segment = OutSegments.AddDefaulted_GetRef();
+						Segment.RoadIndex = RoadIndex;
+						Segment.RoadPointIndex = PointIndex;
+					}
+				}
+			}
+		}
+
+		void FindRoadSegmentsInBox( const FBox2D& Box, TArray<FStreetMapRoadRef>& OutSegments ) const
+		{
+			FindRoadSegments( [ &Box ]( const FVector2D Start, const FVector2D End ) { return DoesSegmentTouchBox( Start, End, Box ); }, OutSegments );
+		}
+
+		void FindRoadSegmentsInRadius( const FVector2D Center, const double Radius, TArray<FStreetMapRoadRef>& OutSegments ) const
+		{
+			FindRoadSegments( [ Center, Radius ]( const FVector2D Start, const FVector2D End ) { return FVector2D::DistSquared( FMath::ClosestPointOnSegment2D( Center, Start, End ), Center ) <= FMath::Square( Radius ); }, OutSegments );
+		}
+
+		void FindNodes( TFunctionRef<bool( FVector2D )> IsFound, TArray<int32>& OutNodeIndices ) const
+		{
+			OutNodeIndices.Reset();
+			for( int32 NodeIndex = 0; NodeIndex < StreetMap.GetNodes().Num(); ++NodeIndex )
+			{
+				if( IsFound( StreetMap.GetNodes()[ NodeIndex ].GetLocation( StreetMap ) ) )
+				{
+					OutNodeIndices.Add( NodeIndex );
+				}
+			}
+		}
+
+		void FindNodesInBox( const FBox2D& Box, TArray<int32>& OutNodeIndices ) const
+		{
+			FindNodes( [ &Box ]( const FVector2D Location ) { return Box.IsInsideOrOn( Location ); }, OutNodeIndices );
+		}
+
+		void FindNodesInRadius( const FVector2D Center, const double Radius, TArray<int32>& OutNodeIndices ) const
+		{
+			FindNodes( [ Center, Radius ]( const FVector2D Location ) { return FVector2D::DistSquared( Location, Center ) <= FMath::Square( Radius ); }, OutNodeIndices );
+		}
+
+		void FindBuildingsInBox( const FBox2D& Box, TArray<int32>& OutBuildingIndices ) const
+		{
+			OutBuildingIndices.Reset();
+			for( int32 BuildingIndex = 0; BuildingIndex < StreetMap.GetBuildings().Num(); ++BuildingIndex )
+			{
+				const FStreetMapBuilding& Building = StreetMap.GetBuildings()[ BuildingIndex ];
+				if( Building.BoundsMin.X <= Box.Max.X && Building.BoundsMax.X >= Box.Min.X && Building.BoundsMin.Y <= Box.Max.Y && Building.BoundsMax.Y >= Box.Min.Y )
+				{
+					OutBuildingIndices.Add( BuildingIndex );
+				}
+			}
+		}
+
+		void FindBuildingsInRadius( const FVector2D Center, const double Radius, TArray<int32>& OutBuildingIndices ) const
+		{
+			OutBuildingIndices.Reset();
+			for( int32 BuildingIndex = 0; BuildingIndex < StreetMap.GetBuildings().Num(); ++BuildingIndex )
+			{
+				const TArray<FVector2D>& Points = StreetMap.GetBuildings()[ BuildingIndex ].BuildingPoints;
+				bool bIsFound = IsPointInPolygon( Points, Center );
+				for( int32 PreviousPointIndex = Points.Num() - 1, PointIndex = 0; !bIsFound && PointIndex < Points.Num(); PreviousPointIndex = PointIndex++ )
+				{
+					bIsFound = FVector2D::DistSquared( FMath::ClosestPointOnSegment2D( Center, Points[ PreviousPointIndex ], Points[ PointIndex ] ), Center ) <= FMath::Square( Radius );
+				}
+				if( bIsFound )
+				{
+					OutBuildingIndices.Add( BuildingIndex );
+				}
+			}
+		}
+
+		/** Returns the distance to the nearest road segment, or a negative number if there are none within MaxDistance */
+		double FindNearestRoadSegmentDistance( const FVector2D Location, const double MaxDistance ) const
+		{
+			double NearestDistanceSquared = -1.0;
+			for( const FStreetMapRoad& Road : StreetMap.GetRoads() )
+			{
+				const TArrayView<const FVector2D> RoadPoints = Road.GetRoadPoints( StreetMap );
+				for( int32 PointIndex = 0; PointIndex < RoadPoints.Num() - 1; ++PointIndex )
+				{
+					const double DistanceSquared = FVector2D::DistSquared( FMath::ClosestPointOnSegment2D( Location, RoadPoints[ PointIndex ], RoadPoints[ PointIndex + 1 ] ), Location );
+					if( DistanceSquared <= FMath::Square( MaxDistance ) && ( NearestDistanceSquared < 0.0 || DistanceSquared < NearestDistanceSquared ) )
+					{
+						NearestDistanceSquared = DistanceSquared;
+					}
+				}
+			}
+			return NearestDistanceSquared < 0.0 ? -1.0 : FMath::Sqrt( NearestDistanceSquared );
+		}
+
+		/** Sorts every node by distance (and then index, like the index does) and keeps the first few */
+		void FindNearestNodes( const FVector2D Location, const int32 Count, const double MaxDistance, TArray<int32>& OutNodeIndices ) const
+		{
+			TArray<TPair<double, int32>> NearbyNodes;
+			for( int32 NodeIndex = 0; NodeIndex < StreetMap.GetNodes().Num(); ++NodeIndex )
+			{
+				const double DistanceSquared = FVector2D::DistSquared( StreetMap.GetNodes()[ NodeIndex ].GetLocation( StreetMap ), Location );
+				if( DistanceSquared <= FMath::Square( MaxDistance ) )
+				{
+					NearbyNodes.Emplace( DistanceSquared, NodeIndex );
+				}
+			}
+			NearbyNodes.Sort();
+
+			OutNodeIndices.Reset();
+			for( int32 NearbyNodeIndex = 0; NearbyNodeIndex < FMath::Min( Count, NearbyNodes.Num() ); ++NearbyNodeIndex )
+			{
+				OutNodeIndices.Add( NearbyNodes[ NearbyNodeIndex ].Value );
+			}
+		}
+	};
+
+	/** Runs every kind of query through the index and by brute force, and checks that they agree.  Box and radius
+		queries may list what they find in any order, but must find each thing once. */
+	static bool CheckQueries( FAutomationTestBase& Test, const FString& What, const UStreetMap& StreetMap, const FBox2D& Box, const FVector2D Center, const double Radius, const int32 Count )
+	{
+		const FStreetMapSpatialIndex& SpatialIndex = StreetMap.GetSpatialIndex();
+		const FBruteForce BruteForce{ StreetMap };
+		TArray<FStreetMapRoadRef> Segments, ExpectedSegments;
+		TArray<int32> Indices, ExpectedIndices;
+		bool bAllMatch = true;
+		auto Check = [&]( const TCHAR* Query, const bool bMatches )
+		{
+			if( !bMatches && bAllMatch )
+			{
+				Test.AddError( FString::Printf( TEXT( "%s: %s doesn't match brute force (box %s, center %s, radius %f)" ), *What, Query, *Box.ToString(), *Center.ToString(), Radius ) );
+			}
+			bAllMatch &= bMatches;
+		};
+
+		SpatialIndex.FindRoadSegmentsInBox( StreetMap, Box, Segments );
+		BruteForce.FindRoadSegmentsInBox( Box, ExpectedSegments );
+		Check( TEXT( "FindRoadSegmentsInBox" ), MakeSegmentKeys( Segments ) == MakeSegmentKeys( ExpectedSegments ) );
+
+		SpatialIndex.FindRoadSegmentsInRadius( StreetMap, Center, Radius, Segments );
+		BruteForce.FindRoadSegmentsInRadius( Center, Radius, ExpectedSegments );
+		Check( TEXT( "FindRoadSegmentsInRadius" ), MakeSegmentKeys( Segments ) == MakeSegmentKeys( ExpectedSegments ) );
+
+		SpatialIndex.FindNodesInBox( StreetMap, Box, Indices );
+		BruteForce.FindNodesInBox( Box, ExpectedIndices );
+		Check( TEXT( "FindNodesInBox" ), MakeSorted( Indices ) == ExpectedIndices );
+
+		SpatialIndex.FindNodesInRadius( StreetMap, Center, Radius, Indices );
+		BruteForce.FindNodesInRadius( Center, Radius, ExpectedIndices );
+		Check( TEXT( "FindNodesInRadius" ), MakeSorted( Indices ) == ExpectedIndices );
+
+		SpatialIndex.FindBuildingsInBox( StreetMap, Box, Indices );
+		BruteForce.FindBuildingsInBox( Box, ExpectedIndices );
+		Check( TEXT( "FindBuildingsInBox" ), MakeSorted( Indices ) == ExpectedIndices );
+
+		SpatialIndex.FindBuildingsInRadius( StreetMap, Center, Radius, Indices );
+		BruteForce.FindBuildingsInRadius( Center, Radius, ExpectedIndices );
+		Check( TEXT( "FindBuildingsInRadius" ), MakeSorted( Indices ) == ExpectedIndices );
+
+		// Ties between road segments can go either way, so only the distance has to match
+		FStreetMapRoadRef NearestSegment;
+		FVector2D NearestPoint;
+		const bool bFoundNearestSegment = SpatialIndex.FindNearestRoadSegment( StreetMap, Center, Radius, NearestSegment, NearestPoint );
+		const double ExpectedDistance = BruteForce.FindNearestRoadSegmentDistance( Center, Radius );
+		bool bNearestSegmentMatches = bFoundNearestSegment == ( ExpectedDistance >= 0.0 );
+		if( bNearestSegmentMatches && bFoundNearestSegment )
+		{
+			const TArrayView<const FVector2D> RoadPoints = StreetMap.GetRoadPoints( NearestSegment.RoadIndex );
+			const FVector2D SegmentPoint = FMath::ClosestPointOnSegment2D( Center, RoadPoints[ NearestSegment.RoadPointIndex ], RoadPoints[ NearestSegment.RoadPointIndex + 1 ] );
+			bNearestSegmentMatches = NearestPoint == SegmentPoint && FMath::IsNearlyEqual( FVector2D::Distance( NearestPoint, Center ), ExpectedDistance, 1.0e-6 );
+		}
+		Check( TEXT( "FindNearestRoadSegment" ), bNearestSegmentMatches );
+
+		// Ties between nodes go to the lower index, so the nearest nodes have to match exactly, in order
+		SpatialIndex.FindNearestNodes( StreetMap, Center, Count, Radius, Indices );
+		BruteForce.FindNearestNodes( Center, Count, Radius, ExpectedIndices );
+		Check( TEXT( "FindNearestNodes" ), Indices == ExpectedIndices );
+		SpatialIndex.FindNearestNodes( StreetMap, Center, Count, TNumericLimits<double>::Max(), Indices );
+		BruteForce.FindNearestNodes( Center, Count, TNumericLimits<double>::Max(), ExpectedIndices );
+		Check( TEXT( "FindNearestNodes with no limit" ), Indices == ExpectedIndices );
+
+		return bAllMatch;
+	}
+
+	/** Makes a square building around a point */
+	static FStreetMapBuilding MakeSquareBuilding( const FVector2D Center, const double HalfSize, const double Angle )
+	{
+		FStreetMapBuilding Building;
+		const FVector2D Across = FVector2D( FMath::Cos( Angle ), FMath::Sin( Angle ) ) * HalfSize;
+		const FVector2D Up( -Across.Y, Across.X );
+		Building.BuildingPoints = { Center - Across - Up, Center + Across - Up, Center + Across + Up, Center - Across + Up };
+		const FBox2D Bounds( Building.BuildingPoints );
+		Building.BoundsMin = Bounds.Min;
+		Building.BoundsMax = Bounds.Max;
+		return Building;
+	}
+
+	/** Makes a random street map, spread over a square around the origin */
+	static TStrongObjectPtr<UStreetMap> MakeRandomStreetMap( FRandomStream& Random, const int32 RoadCount, const int32 BuildingCount, const float HalfSize )
+	{
+		TArray<TArray<FVector2D>> RoadPointLists;
+		RoadPointLists.SetNum( RoadCount );
+		for( TArray<FVector2D>& Points : RoadPointLists )
+		{
+			StreetMapTestMaps::MakeRandomRoadPoints( Random, Random.RandRange( 2, 20 ), HalfSize, Points );
+		}
+
+		TArray<FStreetMapBuilding> Buildings;
+		for( int32 BuildingIndex = 0; BuildingIndex < BuildingCount; ++BuildingIndex )
+		{
+			const FVector2D Center( Random.FRandRange( -HalfSize, HalfSize ), Random.FRandRange( -HalfSize, HalfSize ) );
+			Buildings.Add( MakeSquareBuilding( Center, Random.FRandRange( 200.0f, 3000.0f ), Random.FRandRange( 0.0f, PI ) ) );
+		}
+
+		return StreetMapTestMaps::MakeStreetMap( RoadPointLists, 3, Buildings );
+	}
+
+	/** Makes a random box somewhere around a square around the origin, sometimes hanging off it */
+	static FBox2D MakeRandomBox( FRandomStream& Random, const float HalfSize )
+	{
+		const FVector2D Corner( Random.FRandRange( -HalfSize * 1.2f, HalfSize * 1.2f ), Random.FRandRange( -HalfSize * 1.2f, HalfSize * 1.2f ) );
+		return FBox2D( Corner, Corner + FVector2D( Random.FRandRange( 0.0f, HalfSize * 0.2f ), Random.FRandRange( 0.0f, HalfSize * 0.2f ) ) );
+	}
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST( FStreetMapSpatialIndexTest, "StreetMap.Runtime.SpatialIndex", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter )
+
+bool FStreetMapSpatialIndexTest::RunTest( const FString& Parameters )
+{
+	using namespace StreetMapSpatialIndexTests;
+
+	// An empty street map has no grid, and finds nothing
+	{
+		const TStrongObjectPtr<UStreetMap> StreetMap = StreetMapTestMaps::MakeStreetMap( TArray<TArray<FVector2D>>(), 1 );
+		TestFalse( TEXT( "Empty grid is built" ), StreetMap->GetSpatialIndex().IsBuilt() );
+		CheckQueries( *this, TEXT( "Empty grid" ), *StreetMap, FBox2D( FVector2D( -1.0e6 ), FVector2D( 1.0e6 ) ), FVector2D::ZeroVector, 1.0e6, 5 );
+	}
+
+	// A lattice of roads every ten meters, which is as small as cells get.  With this many things on it, the cells
+	// are exactly that size, so every point and building corner is on a cell border.
+	{
+		const int32 LatticeSize = 10;
+		const double Spacing = 1000.0;
+		TArray<TArray<FVector2D>> RoadPointLists;
+		for( int32 Line = 0; Line <= LatticeSize; ++Line )
+		{
+			TArray<FVector2D>& Across = RoadPointLists.AddDefaulted_GetRef();
+			TArray<FVector2D>& Down = RoadPointLists.AddDefaulted_GetRef();
+			for( int32 Step = 0; Step <= LatticeSize; ++Step )
+			{
+				Across.Add( FVector2D( Step * Spacing, Line * Spacing ) );
+				Down.Add( FVector2D( Line * Spacing, Step * Spacing ) );
+			}
+		}
+		TArray<FStreetMapBuilding> Buildings;
+		for( int32 Block = 0; Block < LatticeSize; Block += 3 )
+		{
+			Buildings.Add( MakeSquareBuilding( FVector2D( ( Block + 0.5 ) * Spacing ), Spacing * 0.5, 0.0 ) );
+		}
+		const TStrongObjectPtr<UStreetMap> StreetMap = StreetMapTestMaps::MakeStreetMap( RoadPointLists, 1, Buildings );
+		TestTrue( TEXT( "Lattice grid is built" ), StreetMap->GetSpatialIndex().IsBuilt() );
+
+		// Boxes and circles whose edges lie on the borders, around points on them, in the middle of cells and off
+		// the grid altogether
+		bool bAllMatch = true;
+		for( int32 MinX = -1; bAllMatch && MinX <= LatticeSize; MinX += 2 )
+		{
+			for( int32 MinY = -1; bAllMatch && MinY <= LatticeSize; MinY += 3 )
+			{
+				for( const double Extra : { 0.0, 0.5 } )
+				{
+					const FBox2D Box( FVector2D( double( MinX ), double( MinY ) ) * Spacing, FVector2D( MinX + 1 + Extra, MinY + 2 + Extra ) * Spacing );
+					const FVector2D Center = FVector2D( MinX + Extra, MinY + Extra ) * Spacing;
+					for( const double Radius : { 0.0, Spacing * 0.5, Spacing, Spacing * 2.5 } )
+					{
+						bAllMatch = CheckQueries( *this, TEXT( "Lattice" ), *StreetMap, Box, Center, Radius, 6 );
+					}
+				}
+			}
+		}
+		CheckQueries( *this, TEXT( "Lattice, far off the grid" ), *StreetMap, FBox2D( FVector2D( -50.0 * Spacing ), FVector2D( -40.0 * Spacing ) ), FVector2D( 60.0 * Spacing, -30.0 * Spacing ), Spacing, 3 );
+		CheckQueries( *this, TEXT( "Lattice, whole grid" ), *StreetMap, FBox2D( FVector2D::ZeroVector, FVector2D( LatticeSize * Spacing ) ), FVector2D( LatticeSize * Spacing * 0.5 ), LatticeSize * Spacing, 1000 );
+	}
+
+	// Random street maps, big and small, with random boxes and circles
+	FRandomStream Random( 0x0A25 );
+	for( const float HalfSize : { 2000.0f, 200000.0f } )
+	{
+		const TStrongObjectPtr<UStreetMap> StreetMap = MakeRandomStreetMap( Random, 300, 300, HalfSize );
+		const FString What = FString::Printf( TEXT( "Random map %.0f across" ), HalfSize * 2.0f );
+		for( int32 Query = 0; Query < 200; ++Query )
+		{
+			const FBox2D Box = MakeRandomBox( Random, HalfSize );
+			const FVector2D Center( Random.FRandRange( -HalfSize * 1.2f, HalfSize * 1.2f ), Random.FRandRange( -HalfSize * 1.2f, HalfSize * 1.2f ) );
+			if( !CheckQueries( *this, What, *StreetMap, Box, Center, Random.FRandRange( 0.0f, HalfSize * 0.2f ), Random.RandRange( 1, 20 ) ) )
+			{
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST( FStreetMapSpatialIndexBenchmark, "StreetMap.Runtime.SpatialIndex.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter )
+
+bool FStreetMapSpatialIndexBenchmark::RunTest( const FString& Parameters )
+{
+	using namespace StreetMapSpatialIndexTests;
+
+	// About what a city takes up: twenty kilometers across, with a couple of hundred thousand road segments
+	const float HalfSize = 1000000.0f;
+	FRandomStream Random( 0x0A26 );
+	double StartTime = FPlatformTime::Seconds();
+	const TStrongObjectPtr<UStreetMap> StreetMap = MakeRandomStreetMap( Random, 20 * 1000, 50 * 1000, HalfSize );
+	const double BuildSeconds = FPlatformTime::Seconds() - StartTime;
+
+	const FStreetMapSpatialIndex& SpatialIndex = StreetMap->GetSpatialIndex();
+	const FBruteForce BruteForce{ *StreetMap };
+	TArray<FVector2D> Locations;
+	Locations.SetNumUninitialized( BenchmarkQueryCount );
+	for( FVector2D& Location : Locations )
+	{
+		Location = FVector2D( Random.FRandRange( -HalfSize, HalfSize ), Random.FRandRange( -HalfSize, HalfSize ) );
+	}
+
+	// Each kind of query is timed through the index and by brute force, per query
+	const double Radius = 5000.0;
+	const int32 Count = 8;
+	int32 FoundCount = 0;
+	auto Time = [&]( const int32 QueryCount, TFunctionRef<void( const FVector2D )> RunQuery )
+	{
+		const double QueryStartTime = FPlatformTime::Seconds();
+		for( int32 QueryIndex = 0; QueryIndex < QueryCount; ++QueryIndex )
+		{
+			RunQuery( Locations[ QueryIndex ] );
+		}
+		return ( FPlatformTime::Seconds() - QueryStartTime ) * 1.0e6 / QueryCount;
+	};
+
+	TArray<FStreetMapRoadRef> Segments;
+	TArray<int32> Indices;
+	const double IndexBoxMicroseconds = Time( BenchmarkQueryCount, [&]( const FVector2D Location ) { SpatialIndex.FindRoadSegmentsInBox( *StreetMap, FBox2D( Location, Location + FVector2D( Radius ) ), Segments ); FoundCount += Segments.Num(); } );
+	const double BruteForceBoxMicroseconds = Time( BenchmarkBruteForceQueryCount, [&]( const FVector2D Location ) { BruteForce.FindRoadSegmentsInBox( FBox2D( Location, Location + FVector2D( Radius ) ), Segments ); FoundCount += Segments.Num(); } );
+	const double IndexRadiusMicroseconds = Time( BenchmarkQueryCount, [&]( const FVector2D Location ) { SpatialIndex.FindNodesInRadius( *StreetMap, Location, Radius, Indices ); FoundCount += Indices.Num(); } );
+	const double BruteForceRadiusMicroseconds = Time( BenchmarkBruteForceQueryCount, [&]( const FVector2D Location ) { BruteForce.FindNodesInRadius( Location, Radius, Indices ); FoundCount += Indices.Num(); } );
+	const double IndexNearestSegmentMicroseconds = Time( BenchmarkQueryCount, [&]( const FVector2D Location ) { FStreetMapRoadRef Segment; FVector2D NearestPoint; FoundCount += SpatialIndex.FindNearestRoadSegment( *StreetMap, Location, TNumericLimits<double>::Max(), Segment, NearestPoint ) ? 1 : 0; } );
+	const double BruteForceNearestSegmentMicroseconds = Time( BenchmarkBruteForceQueryCount, [&]( const FVector2D Location ) { FoundCount += BruteForce.FindNearestRoadSegmentDistance( Location, TNumericLimits<double>::Max() ) >= 0.0 ? 1 : 0; } );
+	const double IndexNearestNodesMicroseconds = Time( BenchmarkQueryCount, [&]( const FVector2D Location ) { SpatialIndex.FindNearestNodes( *StreetMap, Location, Count, TNumericLimits<double>::Max(), Indices ); FoundCount += Indices.Num(); } );
+	const double BruteForceNearestNodesMicroseconds = Time( BenchmarkBruteForceQueryCount, [&]( const FVector2D Location ) { BruteForce.FindNearestNodes( Location, Count, TNumericLimits<double>::Max(), Indices ); FoundCount += Indices.Num(); } );
+
+	AddInfo( FString::Printf( TEXT( "%d roads, %d nodes, %d buildings, built with its index in %.3fs" ), StreetMap->GetRoads().Num(), StreetMap->GetNodes().Num(), StreetMap->GetBuildings().Num(), BuildSeconds ) );
+	AddInfo( FString::Printf( TEXT( "Road segments in a box: %.2fus with the index, %.2fus by brute force" ), IndexBoxMicroseconds, BruteForceBoxMicroseconds ) );
+	AddInfo( FString::Printf( TEXT( "Nodes in a radius: %.2fus with the index, %.2fus by brute force" ), IndexRadiusMicroseconds, BruteForceRadiusMicroseconds ) );
+	AddInfo( FString::Printf( TEXT( "Nearest road segment: %.2fus with the index, %.2fus by brute force" ), IndexNearestSegmentMicroseconds, BruteForceNearestSegmentMicroseconds ) );
+	AddInfo( FString::Printf( TEXT( "Nearest %d nodes: %.2fus with the index, %.2fus by brute force" ), Count, IndexNearestNodesMicroseconds, BruteForceNearestNodesMicroseconds ) );
+	AddInfo( FString::Printf( TEXT( "%d things found" ), FoundCount ) );
+
+	return true;
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS
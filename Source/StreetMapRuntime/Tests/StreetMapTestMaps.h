@@ -0,0 +1,75 @@
+#pragma once
+#include "StreetMap.h"
+#include "Math/RandomStream.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/** Street maps made up for the runtime tests */
+namespace StreetMapTestMaps
+{
+	/** Builds a street map with a road for each list of points, and the buildings given.  The first and last point of
+		every road get a node of their own, and so does every NodeSpacing'th point in between. */
+	inline TStrongObjectPtr<UStreetMap> MakeStreetMap( const TArray<TArray<FVector2D>>& RoadPointLists, const int32 NodeSpacing, const TArray<FStreetMapBuilding>& Buildings = TArray<FStreetMapBuilding>() )
+	{
+		TArray<FStreetMapRoad> Roads;
+		TArray<FStreetMapNode> Nodes;
+		TArray<FVector2D> RoadPoints;
+		TArray<int32> RoadNodeIndices;
+		TArray<FStreetMapRoadRef> NodeRoadRefs;
+		for( int32 RoadIndex = 0; RoadIndex < RoadPointLists.Num(); ++RoadIndex )
+		{
+			const TArray<FVector2D>& Points = RoadPointLists[ RoadIndex ];
+			const FBox2D Bounds( Points );
+
+			FStreetMapRoad& Road = Roads.AddDefaulted_GetRef();
+			Road.FirstPointIndex = RoadPoints.Num();
+			Road.PointCount = Points.Num();
+			Road.BoundsMin = Bounds.Min;
+			Road.BoundsMax = Bounds.Max;
+
+			for( int32 PointIndex = 0; PointIndex < Points.Num(); ++PointIndex )
+			{
+				RoadPoints.Add( Points[ PointIndex ] );
+				if( PointIndex == 0 || PointIndex == Points.Num() - 1 || PointIndex % NodeSpacing == 0 )
+				{
+					FStreetMapNode& Node = Nodes.AddDefaulted_GetRef();
+					Node.FirstRoadRefIndex = NodeRoadRefs.Num();
+					Node.RoadRefCount = 1;
+
+					FStreetMapRoadRef& RoadRef = NodeRoadRefs.AddDefaulted_GetRef();
+					RoadRef.RoadIndex = RoadIndex;
+					RoadRef.RoadPointIndex = PointIndex;
+
+					RoadNodeIndices.Add( Nodes.Num() - 1 );
+				}
+				else
+				{
+					RoadNodeIndices.Add( INDEX_NONE );
+				}
+			}
+		}
+
+		TStrongObjectPtr<UStreetMap> StreetMap( NewObject<UStreetMap>() );
+		StreetMap->SetRoadsAndNodes( MoveTemp( Roads ), MoveTemp( Nodes ), MoveTemp( RoadPoints ), MoveTemp( RoadNodeIndices ), MoveTemp( NodeRoadRefs ) );
+		StreetMap->SetBuildings( TArray<FStreetMapBuilding>( Buildings ) );
+		StreetMap->RebuildSpatialIndex();
+		return StreetMap;
+	}
+
+	/** Makes the points of a road that wanders off in random directions from somewhere in a square around the origin,
+		with segments of random lengths */
+	inline void MakeRandomRoadPoints( FRandomStream& Random, const int32 PointCount, const float HalfSize, TArray<FVector2D>& OutPoints )
+	{
+		OutPoints.SetNumUninitialized( PointCount );
+		FVector2D Point( Random.FRandRange( -HalfSize, HalfSize ), Random.FRandRange( -HalfSize, HalfSize ) );
+		for( int32 PointIndex = 0; PointIndex < PointCount; ++PointIndex )
+		{
+			OutPoints[ PointIndex ] = Point;
+			const float Angle = Random.FRandRange( 0.0f, 2.0f * PI );
+			Point += FVector2D( FMath::Cos( Angle ), FMath::Sin( Angle ) ) * Random.FRandRange( 100.0f, 5000.0f );
+		}
+	}
+}
+
+#endif	// WITH_DEV_AUTOMATION_TESTS